@@ -244,6 +244,16 @@ void MEM_use_lockfree_allocator(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_guarded_allocator(void);
 
+/* Switch allocator to mode with per-thread caches of small blocks.
+ *
+ * Use in the production code where many threads allocate and free small blocks concurrently.
+ * Tracking is the same as for the lock-free allocator, but small blocks are recycled from thread
+ * local caches and the counters are updated in batches. Large arrays are backed by huge pages
+ * where the system supports it.
+ *
+ * NOTE: The switch between allocator types can only happen before any allocation did happen. */
+void MEM_use_sizeclass_allocator(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -175,3 +175,34 @@ void MEM_use_guarded_allocator(void)
   MEM_name_ptr = MEM_guarded_name_ptr;
 #endif
 }
+
+void MEM_use_sizeclass_allocator(void)
+{
+  assert_for_allocator_change();
+
+  MEM_allocN_len = MEM_sizeclass_allocN_len;
+  MEM_freeN = MEM_sizeclass_freeN;
+  MEM_dupallocN = MEM_sizeclass_dupallocN;
+  MEM_reallocN_id = MEM_sizeclass_reallocN_id;
+  MEM_recallocN_id = MEM_sizeclass_recallocN_id;
+  MEM_callocN = MEM_sizeclass_callocN;
+  MEM_calloc_arrayN = MEM_sizeclass_calloc_arrayN;
+  MEM_mallocN = MEM_sizeclass_mallocN;
+  MEM_malloc_arrayN = MEM_sizeclass_malloc_arrayN;
+  MEM_mallocN_aligned = MEM_sizeclass_mallocN_aligned;
+  MEM_printmemlist_pydict = MEM_sizeclass_printmemlist_pydict;
+  MEM_printmemlist = MEM_sizeclass_printmemlist;
+  MEM_callbackmemlist = MEM_sizeclass_callbackmemlist;
+  MEM_printmemlist_stats = MEM_sizeclass_printmemlist_stats;
+  MEM_set_error_callback = MEM_sizeclass_set_error_callback;
+  MEM_consistency_check = MEM_sizeclass_consistency_check;
+  MEM_set_memory_debug = MEM_sizeclass_set_memory_debug;
+  MEM_get_memory_in_use = MEM_sizeclass_get_memory_in_use;
+  MEM_get_memory_blocks_in_use = MEM_sizeclass_get_memory_blocks_in_use;
+  MEM_reset_peak_memory = MEM_sizeclass_reset_peak_memory;
+  MEM_get_peak_memory = MEM_sizeclass_get_peak_memory;
+
+#ifndef NDEBUG
+  MEM_name_ptr = MEM_sizeclass_name_ptr;
+#endif
+}
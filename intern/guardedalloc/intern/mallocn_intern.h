@@ -155,6 +155,51 @@ size_t MEM_lockfree_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
 const char *MEM_lockfree_name_ptr(void *vmemh);
 #endif
 
+/* Prototypes for size class allocator functions */
+size_t MEM_sizeclass_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
+void MEM_sizeclass_freeN(void *vmemh);
+void *MEM_sizeclass_dupallocN(const void *vmemh) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void *MEM_sizeclass_reallocN_id(void *vmemh,
+                                size_t len,
+                                const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_sizeclass_recallocN_id(void *vmemh,
+                                 size_t len,
+                                 const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_sizeclass_callocN(size_t len,
+                            const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_sizeclass_calloc_arrayN(size_t len,
+                                  size_t size,
+                                  const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_sizeclass_mallocN(size_t len,
+                            const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_sizeclass_malloc_arrayN(size_t len,
+                                  size_t size,
+                                  const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_sizeclass_mallocN_aligned(size_t len,
+                                    size_t alignment,
+                                    const char *UNUSED(str)) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
+void MEM_sizeclass_printmemlist_pydict(void);
+void MEM_sizeclass_printmemlist(void);
+void MEM_sizeclass_callbackmemlist(void (*func)(void *));
+void MEM_sizeclass_printmemlist_stats(void);
+void MEM_sizeclass_set_error_callback(void (*func)(const char *));
+bool MEM_sizeclass_consistency_check(void);
+void MEM_sizeclass_set_memory_debug(void);
+size_t MEM_sizeclass_get_memory_in_use(void);
+unsigned int MEM_sizeclass_get_memory_blocks_in_use(void);
+void MEM_sizeclass_reset_peak_memory(void);
+size_t MEM_sizeclass_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+#ifndef NDEBUG
+const char *MEM_sizeclass_name_ptr(void *vmemh);
+#endif
+
 /* Prototypes for fully guarded allocator functions */
 size_t MEM_guarded_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
 void MEM_guarded_freeN(void *vmemh);
@@ -0,0 +1,876 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup MEM
+ *
+ * Memory allocation with per-thread caches of small blocks.
+ *
+ * Small blocks are rounded up to a fixed set of size classes and recycled through thread local
+ * free lists, so the common allocate/free pattern of threaded code never touches the system
+ * allocator nor any shared cache line. Blocks which overflow a thread cache are handed over in
+ * batches to a global depot, which other threads refill from.
+ *
+ * The memory counters are kept per thread as well and only folded into the global ones once the
+ * accumulated difference becomes big enough. Queries sum the global counters with the pending
+ * differences of all threads, so they are exact as soon as the threads are idle.
+ *
+ * Large arrays are mapped directly and, where supported, advised to be backed by huge pages.
+ *
+ * NOTE: Memory of the small block chunks is never returned to the system, it is only recycled.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#  define _GNU_SOURCE /* mremap */
+#endif
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h> /* memcpy */
+#include <sys/types.h>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#  include <unistd.h> /* sysconf */
+#  define USE_HUGE_PAGES
+#endif
+
+#include "MEM_guardedalloc.h"
+
+/* to ensure strict conversions */
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+#include "atomic_ops.h"
+#include "mallocn_intern.h"
+
+typedef struct MemHead {
+  /* Length of allocated memory block. */
+  size_t len;
+} MemHead;
+
+typedef struct MemHeadAligned {
+  short alignment;
+  size_t len;
+} MemHeadAligned;
+
+enum {
+  MEMHEAD_ALIGN_FLAG = 1,
+  MEMHEAD_MMAP_FLAG = 2,
+};
+
+#define MEMHEAD_FLAG_MASK ((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_MMAP_FLAG))
+
+#define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
+#define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
+#define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
+#define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_MMAP(memhead) ((memhead)->len & (size_t)MEMHEAD_MMAP_FLAG)
+
+#ifdef _MSC_VER
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#  define MEM_THREAD_LOCAL __thread
+#endif
+
+/* -------------------------------------------------------------------- */
+/** \name Size Classes
+ *
+ * Sizes include the #MemHead. Classes are spaced by 16 bytes up to 256 bytes and by a quarter of
+ * the power of two above that, which keeps the internal fragmentation below 25%.
+ * \{ */
+
+#define SIZE_CLASS_NUM 32
+#define SIZE_CLASS_MAX 4096
+
+static const size_t size_class_sizes[SIZE_CLASS_NUM] = {
+    16,   32,   48,   64,   80,   96,   112,  128,  144,  160,  176,
+    192,  208,  224,  240,  256,  320,  384,  448,  512,  640,  768,
+    896,  1024, 1280, 1536, 1792, 2048, 2560, 3072, 3584, 4096,
+};
+
+/* Size of the chunks the small blocks are carved from. */
+#define SIZE_CLASS_CHUNK_SIZE (64 * 1024)
+/* Amount of blocks moved between a thread cache and the global depot at once. */
+#define SIZE_CLASS_BATCH 32
+/* Thread cache gives a batch back to the depot when it holds more blocks than this. */
+#define SIZE_CLASS_CACHE_MAX (SIZE_CLASS_BATCH * 2)
+
+MEM_INLINE bool size_class_is_small(size_t size)
+{
+  return size <= SIZE_CLASS_MAX;
+}
+
+MEM_INLINE unsigned int size_class_index(size_t size)
+{
+  if (size <= 256) {
+    return (unsigned int)((size + 15) / 16) - 1;
+  }
+  unsigned int shift = 8;
+  while ((size - 1) >> (shift + 1)) {
+    shift++;
+  }
+  const size_t step = (size_t)1 << (shift - 2);
+  return 16 + (shift - 8) * 4 + (unsigned int)((size - 1 - ((size_t)1 << shift)) / step);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Thread Caches
+ * \{ */
+
+typedef struct MemFreeBlock {
+  struct MemFreeBlock *next;
+} MemFreeBlock;
+
+typedef struct MemFreeList {
+  MemFreeBlock *first;
+  unsigned int len;
+} MemFreeList;
+
+typedef struct MemThreadCache {
+  struct MemThreadCache *next, *prev;
+  MemFreeList lists[SIZE_CLASS_NUM];
+  /* Counter differences which are not yet applied to the global counters. Only changed by the
+   * owning thread, but read by queries from any thread, so always accessed atomically. */
+  int32_t totblock_delta;
+  int64_t mem_in_use_delta;
+  bool is_registered;
+} MemThreadCache;
+
+/* Flush counters of a thread once the difference reaches any of these. */
+#define COUNTER_BATCH_BLOCKS 256
+#define COUNTER_BATCH_BYTES (1024 * 1024)
+
+static unsigned int totblock = 0;
+static size_t mem_in_use = 0, peak_mem = 0, mem_reserved = 0;
+static bool malloc_debug_memset = false;
+
+static void (*error_callback)(const char *) = NULL;
+
+static MEM_THREAD_LOCAL MemThreadCache thread_cache;
+
+/* All registered thread caches, used to collect the pending counter differences. */
+static MemThreadCache *thread_caches_first = NULL;
+static pthread_mutex_t thread_caches_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t thread_cache_key;
+static pthread_once_t thread_cache_key_once = PTHREAD_ONCE_INIT;
+
+/* Blocks given back by the thread caches. */
+static MemFreeList depot[SIZE_CLASS_NUM];
+static pthread_mutex_t depot_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#ifdef __GNUC__
+__attribute__((format(printf, 1, 2)))
+#endif
+static void
+print_error(const char *str, ...)
+{
+  char buf[512];
+  va_list ap;
+
+  va_start(ap, str);
+  vsnprintf(buf, sizeof(buf), str, ap);
+  va_end(ap);
+  buf[sizeof(buf) - 1] = '\0';
+
+  if (error_callback) {
+    error_callback(buf);
+  }
+}
+
+MEM_INLINE void free_list_push(MemFreeList *list, MemFreeBlock *block)
+{
+  block->next = list->first;
+  list->first = block;
+  list->len++;
+}
+
+MEM_INLINE MemFreeBlock *free_list_pop(MemFreeList *list)
+{
+  MemFreeBlock *block = list->first;
+  list->first = block->next;
+  list->len--;
+  return block;
+}
+
+static void free_list_move(MemFreeList *dst, MemFreeList *src, unsigned int len)
+{
+  while (len-- && src->first) {
+    free_list_push(dst, free_list_pop(src));
+  }
+}
+
+/* Done under the registry lock, so queries never see a difference applied twice. */
+static void thread_cache_counters_flush(MemThreadCache *cache)
+{
+  pthread_mutex_lock(&thread_caches_lock);
+  const int32_t totblock_delta = atomic_add_and_fetch_int32(&cache->totblock_delta, 0);
+  const int64_t mem_in_use_delta = atomic_add_and_fetch_int64(&cache->mem_in_use_delta, 0);
+  if (totblock_delta >= 0) {
+    atomic_add_and_fetch_u(&totblock, (unsigned int)totblock_delta);
+  }
+  else {
+    atomic_sub_and_fetch_u(&totblock, (unsigned int)-totblock_delta);
+  }
+  if (mem_in_use_delta >= 0) {
+    const size_t mem = atomic_add_and_fetch_z(&mem_in_use, (size_t)mem_in_use_delta);
+    atomic_fetch_and_update_max_z(&peak_mem, mem);
+  }
+  else {
+    atomic_sub_and_fetch_z(&mem_in_use, (size_t)-mem_in_use_delta);
+  }
+  /* Only the owning thread flushes, so nothing was added in the meantime. */
+  atomic_sub_and_fetch_int32(&cache->totblock_delta, totblock_delta);
+  atomic_sub_and_fetch_int64(&cache->mem_in_use_delta, mem_in_use_delta);
+  pthread_mutex_unlock(&thread_caches_lock);
+}
+
+/* Called on thread exit: hand all cached blocks and pending counters over to the globals. */
+static void thread_cache_free(void *cache_v)
+{
+  MemThreadCache *cache = (MemThreadCache *)cache_v;
+
+  pthread_mutex_lock(&depot_lock);
+  for (int i = 0; i < SIZE_CLASS_NUM; i++) {
+    free_list_move(&depot[i], &cache->lists[i], cache->lists[i].len);
+  }
+  pthread_mutex_unlock(&depot_lock);
+
+  thread_cache_counters_flush(cache);
+
+  pthread_mutex_lock(&thread_caches_lock);
+  if (cache->prev) {
+    cache->prev->next = cache->next;
+  }
+  else {
+    thread_caches_first = cache->next;
+  }
+  if (cache->next) {
+    cache->next->prev = cache->prev;
+  }
+  cache->next = cache->prev = NULL;
+  cache->is_registered = false;
+  pthread_mutex_unlock(&thread_caches_lock);
+}
+
+static void thread_cache_key_create(void)
+{
+  pthread_key_create(&thread_cache_key, thread_cache_free);
+}
+
+static void thread_cache_register(MemThreadCache *cache)
+{
+  pthread_once(&thread_cache_key_once, thread_cache_key_create);
+  pthread_setspecific(thread_cache_key, cache);
+
+  pthread_mutex_lock(&thread_caches_lock);
+  cache->prev = NULL;
+  cache->next = thread_caches_first;
+  if (thread_caches_first) {
+    thread_caches_first->prev = cache;
+  }
+  thread_caches_first = cache;
+  cache->is_registered = true;
+  pthread_mutex_unlock(&thread_caches_lock);
+}
+
+MEM_INLINE MemThreadCache *thread_cache_ensure(void)
+{
+  MemThreadCache *cache = &thread_cache;
+  if (UNLIKELY(!cache->is_registered)) {
+    thread_cache_register(cache);
+  }
+  return cache;
+}
+
+MEM_INLINE void thread_cache_counters_add(MemThreadCache *cache, size_t len)
+{
+  const int32_t totblock_delta = atomic_add_and_fetch_int32(&cache->totblock_delta, 1);
+  const int64_t mem_in_use_delta = atomic_add_and_fetch_int64(&cache->mem_in_use_delta,
+                                                              (int64_t)len);
+  if (UNLIKELY(totblock_delta >= COUNTER_BATCH_BLOCKS ||
+               mem_in_use_delta >= COUNTER_BATCH_BYTES)) {
+    thread_cache_counters_flush(cache);
+  }
+}
+
+MEM_INLINE void thread_cache_counters_sub(MemThreadCache *cache, size_t len)
+{
+  const int32_t totblock_delta = atomic_sub_and_fetch_int32(&cache->totblock_delta, 1);
+  const int64_t mem_in_use_delta = atomic_sub_and_fetch_int64(&cache->mem_in_use_delta,
+                                                              (int64_t)len);
+  if (UNLIKELY(totblock_delta <= -COUNTER_BATCH_BLOCKS ||
+               mem_in_use_delta <= -COUNTER_BATCH_BYTES)) {
+    thread_cache_counters_flush(cache);
+  }
+}
+
+/* Fill an empty thread free list, from the depot when possible and from a new chunk otherwise. */
+static bool thread_cache_refill(MemFreeList *list, unsigned int index)
+{
+  pthread_mutex_lock(&depot_lock);
+  free_list_move(list, &depot[index], SIZE_CLASS_BATCH);
+  pthread_mutex_unlock(&depot_lock);
+
+  if (list->first) {
+    return true;
+  }
+
+  char *chunk = (char *)malloc(SIZE_CLASS_CHUNK_SIZE);
+  if (UNLIKELY(chunk == NULL)) {
+    return false;
+  }
+  atomic_add_and_fetch_z(&mem_reserved, SIZE_CLASS_CHUNK_SIZE);
+
+  const size_t size = size_class_sizes[index];
+  for (size_t offset = 0; offset + size <= SIZE_CLASS_CHUNK_SIZE; offset += size) {
+    free_list_push(list, (MemFreeBlock *)(chunk + offset));
+  }
+  return true;
+}
+
+MEM_INLINE MemHead *thread_cache_alloc(MemThreadCache *cache, size_t size)
+{
+  const unsigned int index = size_class_index(size);
+  MemFreeList *list = &cache->lists[index];
+  if (UNLIKELY(list->first == NULL)) {
+    if (!thread_cache_refill(list, index)) {
+      return NULL;
+    }
+  }
+  return (MemHead *)free_list_pop(list);
+}
+
+MEM_INLINE void thread_cache_free_block(MemThreadCache *cache, MemHead *memh, size_t size)
+{
+  const unsigned int index = size_class_index(size);
+  MemFreeList *list = &cache->lists[index];
+  free_list_push(list, (MemFreeBlock *)memh);
+  if (UNLIKELY(list->len > SIZE_CLASS_CACHE_MAX)) {
+    pthread_mutex_lock(&depot_lock);
+    free_list_move(&depot[index], list, SIZE_CLASS_BATCH);
+    pthread_mutex_unlock(&depot_lock);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Huge Arrays
+ * \{ */
+
+#ifdef USE_HUGE_PAGES
+/* Arrays from this size on are mapped directly, so they can be backed by huge pages. */
+#  define HUGE_ARRAY_THRESHOLD (4 * 1024 * 1024)
+
+static void huge_array_advise(void *ptr, size_t size)
+{
+#  ifdef MADV_HUGEPAGE
+  madvise(ptr, size, MADV_HUGEPAGE);
+#  else
+  (void)ptr;
+  (void)size;
+#  endif
+}
+
+static MemHead *huge_array_alloc(size_t len)
+{
+  const size_t size = len + sizeof(MemHead);
+  void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (UNLIKELY(ptr == MAP_FAILED)) {
+    return NULL;
+  }
+  huge_array_advise(ptr, size);
+  return (MemHead *)ptr;
+}
+
+static MemHead *huge_array_realloc(MemHead *memh, size_t old_len, size_t len)
+{
+  const size_t size = len + sizeof(MemHead);
+  void *ptr = mremap(memh, old_len + sizeof(MemHead), size, MREMAP_MAYMOVE);
+  if (UNLIKELY(ptr == MAP_FAILED)) {
+    return NULL;
+  }
+  huge_array_advise(ptr, size);
+  return (MemHead *)ptr;
+}
+
+/**
+ * Pages added by growing a mapping are zeroed already, but the end of the last page of the old
+ * mapping isn't, it may still hold data from before the mapping was shrunk.
+ */
+static void huge_array_zero_tail(void *ptr, size_t old_len, size_t len)
+{
+  const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t old_size = old_len + sizeof(MemHead);
+  const size_t old_end = (old_size + page_size - 1) / page_size * page_size - sizeof(MemHead);
+  memset((char *)ptr + old_len, 0, (len < old_end ? len : old_end) - old_len);
+}
+
+static void huge_array_free(MemHead *memh, size_t len)
+{
+  munmap(memh, len + sizeof(MemHead));
+}
+#endif /* USE_HUGE_PAGES */
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Allocator API
+ * \{ */
+
+size_t MEM_sizeclass_allocN_len(const void *vmemh)
+{
+  if (vmemh) {
+    return MEMHEAD_FROM_PTR(vmemh)->len & ~MEMHEAD_FLAG_MASK;
+  }
+
+  return 0;
+}
+
+void MEM_sizeclass_freeN(void *vmemh)
+{
+  if (leak_detector_has_run) {
+    print_error("%s\n", free_after_leak_detection_message);
+  }
+
+  if (vmemh == NULL) {
+    print_error("Attempt to free NULL pointer\n");
+#ifdef WITH_ASSERT_ABORT
+    abort();
+#endif
+    return;
+  }
+
+  MemThreadCache *cache = thread_cache_ensure();
+  MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+  size_t len = MEM_sizeclass_allocN_len(vmemh);
+
+  thread_cache_counters_sub(cache, len);
+
+  if (UNLIKELY(malloc_debug_memset && len)) {
+    memset(memh + 1, 255, len);
+  }
+  if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+    MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+    aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+  }
+#ifdef USE_HUGE_PAGES
+  else if (UNLIKELY(MEMHEAD_IS_MMAP(memh))) {
+    huge_array_free(memh, len);
+  }
+#endif
+  else if (LIKELY(size_class_is_small(len + sizeof(MemHead)))) {
+    thread_cache_free_block(cache, memh, len + sizeof(MemHead));
+  }
+  else {
+    free(memh);
+  }
+}
+
+void *MEM_sizeclass_dupallocN(const void *vmemh)
+{
+  void *newp = NULL;
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    const size_t prev_size = MEM_sizeclass_allocN_len(vmemh);
+    if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_sizeclass_mallocN_aligned(
+          prev_size, (size_t)memh_aligned->alignment, "dupli_malloc");
+    }
+    else {
+      newp = MEM_sizeclass_mallocN(prev_size, "dupli_malloc");
+    }
+    memcpy(newp, vmemh, prev_size);
+  }
+  return newp;
+}
+
+#ifdef USE_HUGE_PAGES
+/* Grow or shrink a mapped array in place (or by remapping its pages) instead of copying. */
+static void *huge_array_reallocN(void *vmemh, size_t len)
+{
+  MemThreadCache *cache = thread_cache_ensure();
+  MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+  const size_t old_len = MEM_sizeclass_allocN_len(vmemh);
+
+  len = SIZET_ALIGN_4(len);
+  memh = huge_array_realloc(memh, old_len, len);
+  if (UNLIKELY(memh == NULL)) {
+    return NULL;
+  }
+  memh->len = len | (size_t)MEMHEAD_MMAP_FLAG;
+  thread_cache_counters_sub(cache, old_len);
+  thread_cache_counters_add(cache, len);
+  return PTR_FROM_MEMHEAD(memh);
+}
+#endif
+
+void *MEM_sizeclass_reallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_sizeclass_allocN_len(vmemh);
+
+#ifdef USE_HUGE_PAGES
+    if (MEMHEAD_IS_MMAP(memh) && len >= HUGE_ARRAY_THRESHOLD) {
+      newp = huge_array_reallocN(vmemh, len);
+      if (newp) {
+        return newp;
+      }
+    }
+#endif
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_sizeclass_mallocN(len, "realloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_sizeclass_mallocN_aligned(len, (size_t)memh_aligned->alignment, "realloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        /* grow (or remain same size) */
+        memcpy(newp, vmemh, old_len);
+      }
+    }
+
+    MEM_sizeclass_freeN(vmemh);
+  }
+  else {
+    newp = MEM_sizeclass_mallocN(len, str);
+  }
+
+  return newp;
+}
+
+void *MEM_sizeclass_recallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_sizeclass_allocN_len(vmemh);
+
+#ifdef USE_HUGE_PAGES
+    if (MEMHEAD_IS_MMAP(memh) && len >= HUGE_ARRAY_THRESHOLD) {
+      newp = huge_array_reallocN(vmemh, len);
+      if (newp) {
+        if (len > old_len) {
+          huge_array_zero_tail(newp, old_len, len);
+        }
+        return newp;
+      }
+    }
+#endif
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_sizeclass_mallocN(len, "recalloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_sizeclass_mallocN_aligned(len, (size_t)memh_aligned->alignment, "recalloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        memcpy(newp, vmemh, old_len);
+
+        if (len > old_len) {
+          /* grow */
+          /* zero new bytes */
+          memset(((char *)newp) + old_len, 0, len - old_len);
+        }
+      }
+    }
+
+    MEM_sizeclass_freeN(vmemh);
+  }
+  else {
+    newp = MEM_sizeclass_callocN(len, str);
+  }
+
+  return newp;
+}
+
+/* Allocate the block for an unaligned allocation, returns whether its memory is zeroed. */
+MEM_INLINE MemHead *sizeclass_alloc(MemThreadCache *cache, size_t len, bool *r_is_zero)
+{
+  MemHead *memh;
+  *r_is_zero = false;
+  if (LIKELY(size_class_is_small(len + sizeof(MemHead)))) {
+    memh = thread_cache_alloc(cache, len + sizeof(MemHead));
+    if (LIKELY(memh)) {
+      memh->len = len;
+    }
+  }
+#ifdef USE_HUGE_PAGES
+  else if (len >= HUGE_ARRAY_THRESHOLD) {
+    memh = huge_array_alloc(len);
+    if (LIKELY(memh)) {
+      memh->len = len | (size_t)MEMHEAD_MMAP_FLAG;
+      *r_is_zero = true;
+    }
+  }
+#endif
+  else {
+    memh = (MemHead *)malloc(len + sizeof(MemHead));
+    if (LIKELY(memh)) {
+      memh->len = len;
+    }
+  }
+  return memh;
+}
+
+void *MEM_sizeclass_callocN(size_t len, const char *str)
+{
+  MemThreadCache *cache = thread_cache_ensure();
+  MemHead *memh;
+  bool is_zero;
+
+  len = SIZET_ALIGN_4(len);
+
+  memh = sizeclass_alloc(cache, len, &is_zero);
+
+  if (LIKELY(memh)) {
+    if (!is_zero) {
+      memset(memh + 1, 0, len);
+    }
+    thread_cache_counters_add(cache, len);
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)mem_in_use);
+  return NULL;
+}
+
+void *MEM_sizeclass_calloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Calloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)mem_in_use);
+    abort();
+    return NULL;
+  }
+
+  return MEM_sizeclass_callocN(total_size, str);
+}
+
+void *MEM_sizeclass_mallocN(size_t len, const char *str)
+{
+  MemThreadCache *cache = thread_cache_ensure();
+  MemHead *memh;
+  bool is_zero;
+
+  len = SIZET_ALIGN_4(len);
+
+  memh = sizeclass_alloc(cache, len, &is_zero);
+
+  if (LIKELY(memh)) {
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+    thread_cache_counters_add(cache, len);
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)mem_in_use);
+  return NULL;
+}
+
+void *MEM_sizeclass_malloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Malloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)mem_in_use);
+    abort();
+    return NULL;
+  }
+
+  return MEM_sizeclass_mallocN(total_size, str);
+}
+
+void *MEM_sizeclass_mallocN_aligned(size_t len, size_t alignment, const char *str)
+{
+  /* Huge alignment values doesn't make sense and they wouldn't fit into 'short' used in the
+   * MemHead. */
+  assert(alignment < 1024);
+
+  /* We only support alignments that are a power of two. */
+  assert(IS_POW2(alignment));
+
+  /* Some OS specific aligned allocators require a certain minimal alignment. */
+  if (alignment < ALIGNED_MALLOC_MINIMUM_ALIGNMENT) {
+    alignment = ALIGNED_MALLOC_MINIMUM_ALIGNMENT;
+  }
+
+  /* Aligned blocks are rare, they are passed to the system allocator as is. */
+  size_t extra_padding = MEMHEAD_ALIGN_PADDING(alignment);
+
+  len = SIZET_ALIGN_4(len);
+
+  MemHeadAligned *memh = (MemHeadAligned *)aligned_malloc(
+      len + extra_padding + sizeof(MemHeadAligned), alignment);
+
+  if (LIKELY(memh)) {
+    /* We keep padding in the beginning of MemHead,
+     * this way it's always possible to get MemHead
+     * from the data pointer.
+     */
+    memh = (MemHeadAligned *)((char *)memh + extra_padding);
+
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+
+    memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
+    memh->alignment = (short)alignment;
+    thread_cache_counters_add(thread_cache_ensure(), len);
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)mem_in_use);
+  return NULL;
+}
+
+void MEM_sizeclass_printmemlist_pydict(void)
+{
+}
+
+void MEM_sizeclass_printmemlist(void)
+{
+}
+
+/* unused */
+void MEM_sizeclass_callbackmemlist(void (*func)(void *))
+{
+  (void)func; /* Ignored. */
+}
+
+void MEM_sizeclass_printmemlist_stats(void)
+{
+  printf("\ntotal memory len: %.3f MB\n",
+         (double)MEM_sizeclass_get_memory_in_use() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  printf("small block chunks len: %.3f MB\n", (double)mem_reserved / (double)(1024 * 1024));
+  printf(
+      "\nFor more detailed per-block statistics run Blender with memory debugging command line "
+      "argument.\n");
+
+#ifdef HAVE_MALLOC_STATS
+  printf("System Statistics:\n");
+  malloc_stats();
+#endif
+}
+
+void MEM_sizeclass_set_error_callback(void (*func)(const char *))
+{
+  error_callback = func;
+}
+
+bool MEM_sizeclass_consistency_check(void)
+{
+  return true;
+}
+
+void MEM_sizeclass_set_memory_debug(void)
+{
+  malloc_debug_memset = true;
+}
+
+size_t MEM_sizeclass_get_memory_in_use(void)
+{
+  pthread_mutex_lock(&thread_caches_lock);
+  int64_t delta = 0;
+  for (MemThreadCache *cache = thread_caches_first; cache; cache = cache->next) {
+    delta += atomic_add_and_fetch_int64(&cache->mem_in_use_delta, 0);
+  }
+  const size_t result = (size_t)((int64_t)atomic_add_and_fetch_z(&mem_in_use, 0) + delta);
+  pthread_mutex_unlock(&thread_caches_lock);
+  return result;
+}
+
+unsigned int MEM_sizeclass_get_memory_blocks_in_use(void)
+{
+  pthread_mutex_lock(&thread_caches_lock);
+  int32_t delta = 0;
+  for (MemThreadCache *cache = thread_caches_first; cache; cache = cache->next) {
+    delta += atomic_add_and_fetch_int32(&cache->totblock_delta, 0);
+  }
+  const unsigned int result = (unsigned int)((int32_t)atomic_add_and_fetch_u(&totblock, 0) +
+                                             delta);
+  pthread_mutex_unlock(&thread_caches_lock);
+  return result;
+}
+
+void MEM_sizeclass_reset_peak_memory(void)
+{
+  peak_mem = MEM_sizeclass_get_memory_in_use();
+}
+
+size_t MEM_sizeclass_get_peak_memory(void)
+{
+  const size_t mem = MEM_sizeclass_get_memory_in_use();
+  return mem > peak_mem ? mem : peak_mem;
+}
+
+#ifndef NDEBUG
+const char *MEM_sizeclass_name_ptr(void *vmemh)
+{
+  if (vmemh) {
+    return "unknown block name ptr";
+  }
+
+  return "MEM_sizeclass_name_ptr(NULL)";
+}
+#endif /* NDEBUG */
+
+/** \} */
@@ -0,0 +1,128 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "guardedalloc_test_base.h"
+
+TEST_F(SizeClassAllocatorTest, AllocN_len)
+{
+  /* Cover all size classes and the sizes just around the largest one. */
+  std::vector<void *> blocks;
+  for (size_t len = 0; len < 5000; len++) {
+    void *mem = MEM_mallocN(len, __func__);
+    EXPECT_EQ(MEM_allocN_len(mem), (len + 3) & ~size_t(3));
+    memset(mem, 1, len);
+    blocks.push_back(mem);
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks.size());
+  for (void *mem : blocks) {
+    MEM_freeN(mem);
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, CallocRecycled)
+{
+  /* Recycled blocks must be cleared again. */
+  for (int i = 0; i < 100; i++) {
+    char *mem = (char *)MEM_mallocN(100, __func__);
+    memset(mem, 255, 100);
+    MEM_freeN(mem);
+
+    mem = (char *)MEM_callocN(100, __func__);
+    for (int j = 0; j < 100; j++) {
+      EXPECT_EQ(mem[j], 0);
+    }
+    MEM_freeN(mem);
+  }
+}
+
+TEST_F(SizeClassAllocatorTest, HugeArrayRealloc)
+{
+  const size_t len = 8 * 1024 * 1024;
+  int *mem = (int *)MEM_callocN(len, __func__);
+  EXPECT_EQ(MEM_allocN_len(mem), len);
+  EXPECT_EQ(MEM_get_memory_in_use(), len);
+  mem[len / sizeof(int) - 1] = 42;
+
+  mem = (int *)MEM_recallocN(mem, len * 2);
+  EXPECT_EQ(MEM_allocN_len(mem), len * 2);
+  EXPECT_EQ(MEM_get_memory_in_use(), len * 2);
+  EXPECT_EQ(mem[len / sizeof(int) - 1], 42);
+  EXPECT_EQ(mem[len * 2 / sizeof(int) - 1], 0);
+
+  /* Shrinking below the threshold moves the array out of its mapping. */
+  mem = (int *)MEM_reallocN(mem, 1024);
+  EXPECT_EQ(MEM_allocN_len(mem), 1024);
+  EXPECT_EQ(MEM_get_memory_in_use(), 1024);
+
+  MEM_freeN(mem);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, HugeArrayRecallocShrinkGrow)
+{
+  /* Not a multiple of the page size, so the shrunk mapping keeps part of the old data. */
+  const size_t len = 8 * 1024 * 1024 + 100;
+  const size_t len_small = 4 * 1024 * 1024 + 100;
+  char *mem = (char *)MEM_mallocN(len, __func__);
+  memset(mem, 1, len);
+
+  mem = (char *)MEM_recallocN(mem, len_small);
+  mem = (char *)MEM_recallocN(mem, len);
+  EXPECT_EQ(mem[len_small - 1], 1);
+  size_t nonzero_len = 0;
+  for (size_t i = len_small; i < len; i++) {
+    nonzero_len += (mem[i] != 0);
+  }
+  EXPECT_EQ(nonzero_len, 0);
+
+  MEM_freeN(mem);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0);
+}
+
+TEST_F(SizeClassAllocatorTest, Threads)
+{
+  /* Blocks are allocated and freed on different threads, and threads exit with blocks and counter
+   * differences still in their caches. */
+  const int threads_num = 8;
+  const int blocks_num = 10000;
+  std::vector<std::vector<void *>> blocks(threads_num);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_num; t++) {
+    threads.emplace_back([&blocks, t]() {
+      for (int i = 0; i < blocks_num; i++) {
+        void *mem = MEM_mallocN(size_t((i * 37 + t) % 3000), __func__);
+        blocks[t].push_back(mem);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), threads_num * blocks_num);
+
+  for (int t = 0; t < threads_num; t++) {
+    threads.emplace_back([&blocks, t]() {
+      for (void *mem : blocks[(t + 1) % threads_num]) {
+        MEM_freeN(mem);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0);
+}
@@ -319,6 +319,7 @@ class SEQUENCER_MT_view(Menu):
             layout.separator()
             layout.prop(st, "show_seconds")
             layout.prop(st, "show_strip_offset")
+            layout.prop(st, "show_strip_render_time")
             layout.prop(st, "show_fcurves")
             layout.prop(st, "show_markers")
             layout.menu("SEQUENCER_MT_view_cache", text="Show Cache")
@@ -27,6 +27,7 @@
 extern "C" {
 #endif
 
+struct ArmatureDeformData;
 struct BMEditMesh;
 struct Bone;
 struct Depsgraph;
@@ -459,6 +460,17 @@ void BKE_armature_deform_coords_with_editmesh(const struct Object *ob_arm,
                                               const char *defgrp_name,
                                               struct BMEditMesh *em_target);
 
+struct ArmatureDeformData *BKE_armature_deform_data_create(const struct Object *ob_arm,
+                                                           const struct Object *ob_target,
+                                                           int deformflag,
+                                                           const char *defgrp_name,
+                                                           const struct Mesh *me_target);
+void BKE_armature_deform_data_eval_range(const struct ArmatureDeformData *armature_deform_data,
+                                         float (*vert_coords)[3],
+                                         int start,
+                                         int end);
+void BKE_armature_deform_data_destroy(struct ArmatureDeformData *armature_deform_data);
+
 /** \} */
 
 #ifdef __cplusplus
@@ -297,6 +297,13 @@ void CustomData_interp(const struct CustomData *source,
                        const float *sub_weights,
                        int count,
                        int dest_index);
+void CustomData_interp_batch(const struct CustomData *source,
+                             struct CustomData *dest,
+                             const int *src_indices,
+                             const float *weights,
+                             int count,
+                             const int *dest_indices,
+                             int dest_count);
 void CustomData_bmesh_interp_n(struct CustomData *data,
                                const void **src_blocks,
                                const float *weights,
@@ -310,6 +317,12 @@ void CustomData_bmesh_interp(struct CustomData *data,
                              const float *sub_weights,
                              int count,
                              void *dst_block);
+void CustomData_bmesh_interp_batch(struct CustomData *data,
+                                   const void **src_blocks,
+                                   const float *weights,
+                                   int count,
+                                   void **dst_blocks,
+                                   int dest_count);
 
 /* swaps the data in the element corners, to new corners with indices as
  * specified in corner_indices. for edges this is an array of length 2, for
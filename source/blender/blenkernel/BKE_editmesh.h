@@ -24,6 +24,8 @@
  * only concerned with low level operations on the #BMEditMesh structure.
  */
 
+#include "BLI_bitmap.h"
+
 #include "BKE_customdata.h"
 #include "bmesh.h"
 
@@ -83,16 +85,35 @@ typedef struct BMEditMesh {
    */
   char needs_flush_to_id;
 
+  /**
+   * Set when the topology changed since the draw cache last consumed #deform_verts,
+   * the moved vertices can't be used to update the drawing in that case.
+   */
+  char deform_verts_invalid;
+
+  /**
+   * Vertices (by #BMVert index) moved without changing the topology since the last
+   * evaluation, so the draw cache can update only the buffers around them.
+   * NULL when nothing was tagged.
+   */
+  BLI_bitmap *deform_verts;
+  int deform_verts_len;
+
 } BMEditMesh;
 
 /* editmesh.c */
 void BKE_editmesh_looptri_calc(BMEditMesh *em);
+void BKE_editmesh_looptri_calc_deform(BMEditMesh *em);
 BMEditMesh *BKE_editmesh_create(BMesh *bm, const bool do_tessellate);
 BMEditMesh *BKE_editmesh_copy(BMEditMesh *em);
 BMEditMesh *BKE_editmesh_from_object(struct Object *ob);
 void BKE_editmesh_free_derivedmesh(BMEditMesh *em);
 void BKE_editmesh_free(BMEditMesh *em);
 
+BLI_bitmap *BKE_editmesh_deform_verts_ensure(BMEditMesh *em);
+void BKE_editmesh_deform_verts_invalidate(BMEditMesh *em);
+void BKE_editmesh_deform_verts_reset(BMEditMesh *em);
+
 float (*BKE_editmesh_vert_coords_alloc(struct Depsgraph *depsgraph,
                                        struct BMEditMesh *em,
                                        struct Scene *scene,
@@ -26,6 +26,8 @@
 
 //#include "BKE_customdata.h"  /* for CustomDataMask */
 
+#include "BLI_sys_types.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -52,6 +54,18 @@ bool BKE_mesh_runtime_reset_edit_data(struct Mesh *mesh);
 void BKE_mesh_runtime_clear_geometry(struct Mesh *mesh);
 void BKE_mesh_runtime_clear_cache(struct Mesh *mesh);
 
+struct Mesh *BKE_mesh_runtime_shared_eval_find(struct Mesh *mesh,
+                                               const void *key,
+                                               const size_t key_len,
+                                               uint64_t *r_id);
+bool BKE_mesh_runtime_shared_eval_add(struct Mesh *mesh,
+                                      const void *key,
+                                      const size_t key_len,
+                                      struct Mesh *mesh_eval,
+                                      uint64_t *r_id);
+void BKE_mesh_runtime_shared_eval_release(struct Mesh *mesh, const uint64_t id);
+void BKE_mesh_runtime_shared_eval_clear(struct Mesh *mesh);
+
 void BKE_mesh_runtime_verttri_from_looptri(struct MVertTri *r_verttri,
                                            const struct MLoop *mloop,
                                            const struct MLoopTri *looptri,
@@ -28,6 +28,7 @@ extern "C" {
 #endif
 
 struct ARegionType;
+struct BLI_Buffer;
 struct BMEditMesh;
 struct BlendDataReader;
 struct BlendLibReader;
@@ -228,6 +229,32 @@ typedef struct ModifierTypeInfo {
                            float (*defMats)[3][3],
                            int numVerts);
 
+  /**
+   * Optional, for deform types where every vertex is deformed independently of the others.
+   * Prepare the evaluation of #deformVertsRange and return data passed to it, or NULL when
+   * the current settings need the whole vertex array, #deformVerts is used then.
+   *
+   * The coordinates are not available yet, they may still be deformed by previous modifiers.
+   * The mesh is non-NULL and has `numVerts` vertices, it may only be read.
+   */
+  void *(*deformVertsRangeBegin)(struct ModifierData *md,
+                                 const struct ModifierEvalContext *ctx,
+                                 const struct Mesh *mesh,
+                                 int numVerts);
+
+  /**
+   * Deform the vertices from `start` up to `end` (exclusive). Called from multiple threads at
+   * once for different ranges, so only those vertices may be read or written.
+   */
+  void (*deformVertsRange)(struct ModifierData *md,
+                           void *range_data,
+                           float (*vertexCos)[3],
+                           int start,
+                           int end);
+
+  /* Free the data returned by #deformVertsRangeBegin. */
+  void (*deformVertsRangeEnd)(struct ModifierData *md, void *range_data);
+
   /********************* Non-deform modifier functions *********************/
 
   /**
@@ -386,6 +413,16 @@ typedef struct ModifierTypeInfo {
    * not been written (e.g. runtime data) can be reset.
    */
   void (*blendRead)(struct BlendDataReader *reader, struct ModifierData *md);
+
+  /**
+   * Append everything the result depends on besides the input mesh to \a key, see
+   * #BKE_modifier_shared_key_append. Objects using the same mesh whose modifier stacks give
+   * equal keys share one evaluated mesh. Return false when the result can't be shared, for
+   * example when it depends on other objects.
+   *
+   * This function is optional, the result of modifiers without it is never shared.
+   */
+  bool (*sharedResultKey)(struct ModifierData *md, struct Object *ob, struct BLI_Buffer *key);
 } ModifierTypeInfo;
 
 /* Used to find a modifier's panel type. */
@@ -461,6 +498,11 @@ bool BKE_modifiers_uses_multires(struct Object *ob);
 bool BKE_modifiers_uses_armature(struct Object *ob, struct bArmature *arm);
 bool BKE_modifiers_uses_subsurf_facedots(struct Scene *scene, struct Object *ob);
 bool BKE_modifiers_is_correctable_deformed(struct Scene *scene, struct Object *ob);
+bool BKE_modifiers_shared_result_key(const struct Scene *scene,
+                                     struct Object *ob,
+                                     const int required_mode,
+                                     struct BLI_Buffer *key);
+void BKE_modifier_shared_key_append(struct BLI_Buffer *key, const void *data, const size_t size);
 void BKE_modifier_free_temporary_data(struct ModifierData *md);
 
 typedef struct CDMaskLink {
@@ -120,6 +120,8 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
                           void **gridfaces,
                           struct DMFlagMat *flagmats,
                           unsigned int **grid_hidden);
+void BKE_pbvh_build_stable_layout_set(PBVH *pbvh, bool use_stable_layout);
+double BKE_pbvh_build_time_get(const PBVH *pbvh);
 void BKE_pbvh_build_bmesh(PBVH *pbvh,
                           struct BMesh *bm,
                           bool smooth_shading,
@@ -126,6 +126,11 @@ typedef struct SubdivStats {
     double values_[NUM_SUBDIV_STATS_VALUES];
   };
 
+  /* Number of subdivisions to mesh which re-used the previous result because only positions of
+   * the coarse vertices changed, and number of those which had to be done from scratch. */
+  int mesh_cache_hits;
+  int mesh_cache_misses;
+
   /* Per-value timestamp on when corresponding BKE_subdiv_stats_begin() was
    * called. */
   double begin_timestamp_[NUM_SUBDIV_STATS_VALUES];
@@ -190,6 +195,8 @@ typedef struct Subdiv {
     /* Indexed by base face index, element indicates total number of ptex
      * faces created for preceding base faces. */
     int *face_ptex_offset;
+    /* Result of the last BKE_subdiv_to_mesh_with_deform_cache(). */
+    struct SubdivMeshCache *mesh_cache;
   } cache_;
 } Subdiv;
 
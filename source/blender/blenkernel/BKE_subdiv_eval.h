@@ -102,6 +102,24 @@ void BKE_subdiv_eval_displacement(struct Subdiv *subdiv,
 void BKE_subdiv_eval_final_point(
     struct Subdiv *subdiv, const int ptex_face_index, const float u, const float v, float r_P[3]);
 
+/* Batched queries.
+ *
+ * Evaluate many points with a single call into the evaluator, which is much cheaper than the
+ * same number of single point queries. The output arrays are of num_points size. */
+
+void BKE_subdiv_eval_limit_points(struct Subdiv *subdiv,
+                                  const int *ptex_face_indices,
+                                  const float (*uvs)[2],
+                                  const int num_points,
+                                  float (*r_P)[3]);
+void BKE_subdiv_eval_limit_points_and_derivatives(struct Subdiv *subdiv,
+                                                  const int *ptex_face_indices,
+                                                  const float (*uvs)[2],
+                                                  const int num_points,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3]);
+
 /* Patch queries at given resolution.
  *
  * Will evaluate patch at uniformly distributed (u, v) coordinates on a grid
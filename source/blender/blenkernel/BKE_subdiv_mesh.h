@@ -49,6 +49,16 @@ struct Mesh *BKE_subdiv_to_mesh(struct Subdiv *subdiv,
                                 const SubdivToMeshSettings *settings,
                                 const struct Mesh *coarse_mesh);
 
+/* Same as above, but the result is also kept in the subdiv once the same coarse mesh got
+ * subdivided twice in a row. When the coarse mesh of the next call only differs in vertex
+ * positions, as during playback of a deforming character, topology and custom data are copied
+ * from the kept result and only the vertex positions are evaluated. */
+struct Mesh *BKE_subdiv_to_mesh_with_deform_cache(struct Subdiv *subdiv,
+                                                  const SubdivToMeshSettings *settings,
+                                                  const struct Mesh *coarse_mesh);
+
+void BKE_subdiv_mesh_cache_free(struct Subdiv *subdiv);
+
 #ifdef __cplusplus
 }
 #endif
@@ -82,8 +82,15 @@ typedef struct UndoStep {
   struct UndoStep *next, *prev;
   char name[64];
   const struct UndoType *type;
-  /** Size in bytes of all data in step (not including the step). */
+  /**
+   * Size in bytes of all data in step (not including the step).
+   * May change while background tasks compress the step, read it with atomics.
+   */
   size_t data_size;
+  /** Size in bytes of the data before compression, zero when the step isn't compressed. */
+  size_t data_size_uncompressed;
+  /** Duration of the last encode and decode of this step, in seconds. */
+  double encode_time, decode_time;
   /** Users should never see this step (only use for internal consistency). */
   bool skip;
   /** Some situations require the global state to be stored, edge cases when exiting modes. */
@@ -37,6 +37,7 @@
 
 #include "BLI_array.h"
 #include "BLI_bitmap.h"
+#include "BLI_buffer.h"
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
@@ -66,6 +67,8 @@
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#include "PIL_time.h"
+
 #include "BKE_shrinkwrap.h"
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_query.h"
@@ -869,6 +872,181 @@ void BKE_mesh_wrapper_deferred_finalize(Mesh *me_eval,
   BLI_assert(me_eval->runtime.wrapper_type_finalize == 0);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Fused Deform Modifiers
+ *
+ * Consecutive deform modifiers which support #ModifierTypeInfo.deformVertsRange are applied
+ * one range of vertices at a time, so the coordinates stay in cache between the modifiers
+ * instead of the whole array being streamed through memory by every modifier.
+ * \{ */
+
+#define DEFORM_FUSED_MODIFIERS_MAX 16
+#define DEFORM_FUSED_RANGE_SIZE 1024
+
+typedef struct DeformFusedData {
+  ModifierData *modifiers[DEFORM_FUSED_MODIFIERS_MAX];
+  void *range_data[DEFORM_FUSED_MODIFIERS_MAX];
+  int modifiers_len;
+
+  float (*vert_coords)[3];
+  int vert_coords_len;
+} DeformFusedData;
+
+typedef struct DeformFusedTLS {
+  /* Time spent in every modifier by the thread. */
+  double execution_time[DEFORM_FUSED_MODIFIERS_MAX];
+} DeformFusedTLS;
+
+static void deform_fused_range_cb(void *__restrict userdata,
+                                  const int range,
+                                  const TaskParallelTLS *__restrict tls)
+{
+  const DeformFusedData *data = userdata;
+  DeformFusedTLS *fused_tls = tls->userdata_chunk;
+  const int start = range * DEFORM_FUSED_RANGE_SIZE;
+  const int end = min_ii(start + DEFORM_FUSED_RANGE_SIZE, data->vert_coords_len);
+
+  double time = PIL_check_seconds_timer();
+  for (int i = 0; i < data->modifiers_len; i++) {
+    ModifierData *md = data->modifiers[i];
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+    mti->deformVertsRange(md, data->range_data[i], data->vert_coords, start, end);
+
+    const double time_next = PIL_check_seconds_timer();
+    fused_tls->execution_time[i] += time_next - time;
+    time = time_next;
+  }
+}
+
+static void deform_fused_range_reduce(const void *__restrict userdata,
+                                      void *__restrict chunk_join,
+                                      void *__restrict chunk)
+{
+  const DeformFusedData *data = userdata;
+  DeformFusedTLS *join = chunk_join;
+  const DeformFusedTLS *fused_tls = chunk;
+  for (int i = 0; i < data->modifiers_len; i++) {
+    join->execution_time[i] += fused_tls->execution_time[i];
+  }
+}
+
+static bool deform_fused_modifier_skip(const Scene *scene,
+                                       ModifierData *md,
+                                       const int required_mode,
+                                       const int useDeform)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+  if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
+    return true;
+  }
+  if (useDeform < 0 && mti->dependsOnTime && mti->dependsOnTime(md)) {
+    return true;
+  }
+  return false;
+}
+
+static bool deform_fused_modifier_supported(ModifierData *md)
+{
+  const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+  /* Normals would have to be recalculated between the modifiers. */
+  return (mti->type == eModifierTypeType_OnlyDeform && mti->deformVertsRangeBegin &&
+          !(mti->dependsOnNormals && mti->dependsOnNormals(md)));
+}
+
+/**
+ * Apply the run of leading deform modifiers starting at \a md_first together.
+ *
+ * \return The last modifier applied, or NULL when fewer than two modifiers in a row support
+ * range evaluation, nothing is applied then.
+ */
+static ModifierData *deform_fused_modifiers_apply(const Scene *scene,
+                                                  Object *ob,
+                                                  ModifierData *md_first,
+                                                  const ModifierEvalContext *mectx,
+                                                  const int required_mode,
+                                                  const int useDeform,
+                                                  const int index,
+                                                  const Mesh *mesh,
+                                                  float (*vert_coords)[3],
+                                                  const int vert_coords_len)
+{
+  if (vert_coords_len < DEFORM_FUSED_RANGE_SIZE || !deform_fused_modifier_supported(md_first)) {
+    return NULL;
+  }
+
+  const double time_start = PIL_check_seconds_timer();
+
+  DeformFusedData data = {
+      .vert_coords = vert_coords,
+      .vert_coords_len = vert_coords_len,
+  };
+  ModifierData *md_last = NULL;
+
+  for (ModifierData *md = md_first; md && data.modifiers_len < DEFORM_FUSED_MODIFIERS_MAX;
+       md = md->next) {
+    if (md != md_first && deform_fused_modifier_skip(scene, md, required_mode, useDeform)) {
+      continue;
+    }
+    if (!deform_fused_modifier_supported(md)) {
+      break;
+    }
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+    void *range_data = mti->deformVertsRangeBegin(md, mectx, mesh, vert_coords_len);
+    if (range_data == NULL) {
+      break;
+    }
+    data.modifiers[data.modifiers_len] = md;
+    data.range_data[data.modifiers_len] = range_data;
+    data.modifiers_len++;
+    md_last = md;
+
+    /* grab modifiers until index i */
+    if ((index != -1) && (BLI_findindex(&ob->modifiers, md) >= index)) {
+      break;
+    }
+  }
+
+  if (data.modifiers_len >= 2) {
+    DeformFusedTLS fused_tls = {{0.0}};
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    settings.userdata_chunk = &fused_tls;
+    settings.userdata_chunk_size = sizeof(fused_tls);
+    settings.func_reduce = deform_fused_range_reduce;
+    const int ranges_len = (vert_coords_len + DEFORM_FUSED_RANGE_SIZE - 1) /
+                           DEFORM_FUSED_RANGE_SIZE;
+    BLI_task_parallel_range(0, ranges_len, &data, deform_fused_range_cb, &settings);
+
+    /* Split the elapsed time by the share of the time spent in each modifier. */
+    double time_total = 0.0;
+    for (int i = 0; i < data.modifiers_len; i++) {
+      time_total += fused_tls.execution_time[i];
+    }
+    const double time_elapsed = PIL_check_seconds_timer() - time_start;
+    for (int i = 0; i < data.modifiers_len; i++) {
+      data.modifiers[i]->execution_time += (time_total > 0.0) ?
+                                               time_elapsed * fused_tls.execution_time[i] /
+                                                   time_total :
+                                               time_elapsed / data.modifiers_len;
+    }
+  }
+  else {
+    md_last = NULL;
+  }
+
+  for (int i = 0; i < data.modifiers_len; i++) {
+    ModifierData *md = data.modifiers[i];
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+    mti->deformVertsRangeEnd(md, data.range_data[i]);
+  }
+
+  return md_last;
+}
+
+/** \} */
+
 static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
                                 Scene *scene,
                                 Object *ob,
@@ -951,8 +1129,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   /* XXX Always copying POLYINDEX, else tessellated data are no more valid! */
   CustomData_MeshMasks append_mask = CD_MASK_BAREMESH_ORIGINDEX;
 
-  /* Clear errors before evaluation. */
+  /* Clear errors and timings before evaluation. */
   BKE_modifiers_clear_errors(ob);
+  for (ModifierData *md_iter = firstmd; md_iter; md_iter = md_iter->next) {
+    md_iter->execution_time = 0.0;
+  }
 
   /* Apply all leading deform modifiers. */
   if (useDeform) {
@@ -979,7 +1160,28 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
           BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
         }
 
-        BKE_modifier_deform_verts(md, &mectx, mesh_final, deformed_verts, num_deformed_verts);
+        ModifierData *md_fused_last = deform_fused_modifiers_apply(
+            scene,
+            ob,
+            md,
+            &mectx,
+            required_mode,
+            useDeform,
+            index,
+            mesh_final ? mesh_final : mesh_input,
+            deformed_verts,
+            num_deformed_verts);
+        if (md_fused_last) {
+          while (md != md_fused_last) {
+            md = md->next;
+            md_datamask = md_datamask->next;
+          }
+        }
+        else {
+          const double time_start = PIL_check_seconds_timer();
+          BKE_modifier_deform_verts(md, &mectx, mesh_final, deformed_verts, num_deformed_verts);
+          md->execution_time += PIL_check_seconds_timer() - time_start;
+        }
 
         isPrevDeform = true;
       }
@@ -1064,6 +1266,8 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       continue;
     }
 
+    const double time_start = PIL_check_seconds_timer();
+
     /* Add orco mesh as layer if needed by this modifier. */
     if (mesh_final && mesh_orco && mti->requiredDataMask) {
       CustomData_MeshMasks mask = {0};
@@ -1265,6 +1469,8 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       mesh_final->runtime.deformed_only = false;
     }
 
+    md->execution_time += PIL_check_seconds_timer() - time_start;
+
     isPrevDeform = (mti->type == eModifierTypeType_OnlyDeform);
 
     /* grab modifiers until index i */
@@ -1519,8 +1725,11 @@ static void editbmesh_calc_modifiers(struct Depsgraph *depsgraph,
         em_input, &final_datamask, NULL, mesh_input);
   }
 
-  /* Clear errors before evaluation. */
+  /* Clear errors and timings before evaluation. */
   BKE_modifiers_clear_errors(ob);
+  for (ModifierData *md_iter = md; md_iter; md_iter = md_iter->next) {
+    md_iter->execution_time = 0.0;
+  }
 
   for (int i = 0; md; i++, md = md->next, md_datamask = md_datamask->next) {
     const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
@@ -1529,6 +1738,8 @@ static void editbmesh_calc_modifiers(struct Depsgraph *depsgraph,
       continue;
     }
 
+    const double time_start = PIL_check_seconds_timer();
+
     /* Add an orco mesh as layer if needed by this modifier. */
     if (mesh_final && mesh_orco && mti->requiredDataMask) {
       CustomData_MeshMasks mask = {0};
@@ -1654,6 +1865,8 @@ static void editbmesh_calc_modifiers(struct Depsgraph *depsgraph,
       mesh_final->runtime.deformed_only = false;
     }
 
+    md->execution_time += PIL_check_seconds_timer() - time_start;
+
     if (r_cage && i == cageIndex) {
       if (mesh_final && deformed_verts) {
         mesh_cage = BKE_mesh_copy_for_eval(mesh_final, false);
@@ -1758,6 +1971,99 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Key for sharing the evaluated mesh between objects which use the same mesh with identical
+ * modifier stacks, such as linked duplicates, see #BKE_mesh_runtime_shared_eval_find.
+ */
+static bool mesh_build_data_shared_key(struct Depsgraph *depsgraph,
+                                       Scene *scene,
+                                       Object *ob,
+                                       const CustomData_MeshMasks *dataMask,
+                                       const bool need_mapping,
+                                       BLI_Buffer *r_key)
+{
+  Mesh *mesh = ob->data;
+  const ID *mesh_orig = DEG_get_original_id(&mesh->id);
+  if (ID_REAL_USERS(mesh_orig) < 2) {
+    return false;
+  }
+  /* Paint modes and simulations keep object specific data with the evaluated mesh. */
+  if (ob->mode != OB_MODE_OBJECT || ob->sculpt != NULL || ob->rigidbody_object != NULL) {
+    return false;
+  }
+
+  const bool use_render = (DEG_get_mode(depsgraph) == DAG_EVAL_RENDER);
+  const int required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
+  if (!BKE_modifiers_shared_result_key(scene, ob, required_mode, r_key)) {
+    return false;
+  }
+
+  const uint32_t eval_flags = DEG_get_eval_flags_for_id(depsgraph, &ob->id);
+  BKE_modifier_shared_key_append(r_key, dataMask, sizeof(*dataMask));
+  BKE_modifier_shared_key_append(r_key, &need_mapping, sizeof(need_mapping));
+  BKE_modifier_shared_key_append(r_key, &eval_flags, sizeof(eval_flags));
+  return true;
+}
+
+/**
+ * Evaluate the modifier stack of \a ob, or use the result of another object with an equal
+ * \a shared_key. The returned mesh is finalized, it might be used by other objects right away.
+ *
+ * \param r_shared_id: Set when the result is owned by the mesh, not by the object. That's not
+ * the case when too many shared meshes are in use already.
+ */
+static Mesh *mesh_build_data_shared(struct Depsgraph *depsgraph,
+                                    Scene *scene,
+                                    Object *ob,
+                                    const CustomData_MeshMasks *dataMask,
+                                    const bool need_mapping,
+                                    const BLI_Buffer *shared_key,
+                                    Mesh **r_deform,
+                                    uint64_t *r_shared_id)
+{
+  Mesh *mesh = ob->data;
+
+  /* Shared stacks have no deform modifiers, the deformed mesh is the input mesh. It isn't shared
+   * since objects own theirs. */
+  *r_deform = BKE_mesh_copy_for_eval(mesh, true);
+  if (dataMask->vmask & CD_MASK_ORCO) {
+    add_orco_mesh(ob, NULL, *r_deform, NULL, CD_ORCO);
+  }
+
+  BLI_mutex_lock(mesh->runtime.eval_mutex);
+  Mesh *mesh_eval = BKE_mesh_runtime_shared_eval_find(
+      mesh, shared_key->data, shared_key->count, r_shared_id);
+  BLI_mutex_unlock(mesh->runtime.eval_mutex);
+  if (mesh_eval != NULL) {
+    return mesh_eval;
+  }
+
+  /* Evaluate without holding the lock, objects with other keys don't have to wait. The input mesh
+   * itself is never the result here, so it doesn't need the lock either. */
+  Mesh *mesh_eval_new;
+  mesh_calc_modifiers(
+      depsgraph, scene, ob, 1, need_mapping, dataMask, -1, true, false, NULL, &mesh_eval_new);
+  mesh_eval_new->key = mesh->key;
+  mesh_runtime_check_normals_valid(mesh_eval_new);
+  mesh_build_extra_data(depsgraph, ob, mesh_eval_new);
+
+  /* Another object might have published an equal result in the meantime. */
+  BLI_mutex_lock(mesh->runtime.eval_mutex);
+  mesh_eval = BKE_mesh_runtime_shared_eval_find(
+      mesh, shared_key->data, shared_key->count, r_shared_id);
+  if (mesh_eval == NULL) {
+    BKE_mesh_runtime_shared_eval_add(
+        mesh, shared_key->data, shared_key->count, mesh_eval_new, r_shared_id);
+  }
+  BLI_mutex_unlock(mesh->runtime.eval_mutex);
+
+  if (mesh_eval != NULL) {
+    BKE_id_free(NULL, mesh_eval_new);
+    return mesh_eval;
+  }
+  return mesh_eval_new;
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1774,6 +2080,14 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
   }
+  /* The shared result of the previous evaluation might not be used by any object anymore. */
+  if (ob->runtime.shared_eval_id != 0) {
+    Mesh *mesh = ob->data;
+    BLI_mutex_lock(mesh->runtime.eval_mutex);
+    BKE_mesh_runtime_shared_eval_release(mesh, ob->runtime.shared_eval_id);
+    BLI_mutex_unlock(mesh->runtime.eval_mutex);
+    ob->runtime.shared_eval_id = 0;
+  }
 
 #if 0 /* XXX This is already taken care of in mesh_calc_modifiers()... */
   if (need_mapping) {
@@ -1784,18 +2098,37 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   }
 #endif
 
+  Mesh *mesh = ob->data;
   Mesh *mesh_eval = NULL, *mesh_deform_eval = NULL;
-  mesh_calc_modifiers(depsgraph,
-                      scene,
-                      ob,
-                      1,
-                      need_mapping,
-                      dataMask,
-                      -1,
-                      true,
-                      true,
-                      &mesh_deform_eval,
-                      &mesh_eval);
+  uint64_t shared_id = 0;
+  bool is_mesh_eval_finalized = false;
+
+  BLI_buffer_declare_static(char, shared_key, BLI_BUFFER_NOP, 256);
+  if (mesh_build_data_shared_key(depsgraph, scene, ob, dataMask, need_mapping, &shared_key)) {
+    mesh_eval = mesh_build_data_shared(depsgraph,
+                                       scene,
+                                       ob,
+                                       dataMask,
+                                       need_mapping,
+                                       &shared_key,
+                                       &mesh_deform_eval,
+                                       &shared_id);
+    is_mesh_eval_finalized = true;
+  }
+  else {
+    mesh_calc_modifiers(depsgraph,
+                        scene,
+                        ob,
+                        1,
+                        need_mapping,
+                        dataMask,
+                        -1,
+                        true,
+                        true,
+                        &mesh_deform_eval,
+                        &mesh_eval);
+  }
+  BLI_buffer_free(&shared_key);
 
   /* The modifier stack evaluation is storing result in mesh->runtime.mesh_eval, but this result
    * is not guaranteed to be owned by object.
@@ -1803,9 +2136,9 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * Check ownership now, since later on we can not go to a mesh owned by someone else via
    * object's runtime: this could cause access freed data on depsgraph destruction (mesh who owns
    * the final result might be freed prior to object). */
-  Mesh *mesh = ob->data;
-  const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
+  const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval) && shared_id == 0;
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
+  ob->runtime.shared_eval_id = shared_id;
 
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
@@ -1813,6 +2146,11 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
 
   BKE_object_boundbox_calc_from_mesh(ob, mesh_eval);
 
+  /* Results of the shared path are finished before other objects can use them. */
+  if (is_mesh_eval_finalized) {
+    return;
+  }
+
   /* Make sure that drivers can target shapekey properties.
    * Note that this causes a potential inconsistency, as the shapekey may have a
    * different topology than the evaluated mesh. */
@@ -0,0 +1,175 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "CLG_log.h"
+
+#include "DNA_curve_types.h"
+#include "DNA_genfile.h"
+#include "DNA_lattice_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_lattice.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_test_utils.hh"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_object_deform.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "IMB_imbuf.h"
+
+namespace blender::bke::tests {
+
+class derived_mesh_fused_deform : public testing::Test {
+ public:
+  Main *bmain;
+  Scene *scene;
+  Object *ob;
+  Depsgraph *depsgraph = nullptr;
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    DNA_sdna_current_init();
+    BKE_idtype_init();
+    IMB_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestSuite()
+  {
+    DEG_free_node_types();
+    IMB_exit();
+    DNA_sdna_current_free();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  /* A grid with enough vertices to be deformed in several ranges, with a vertex group. */
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+
+    Mesh *mesh = BKE_mesh_add(bmain, "Mesh");
+    BKE_mesh_nomain_to_mesh(mesh_test_grid_create(40), mesh, nullptr, &CD_MASK_MESH, true);
+    id_us_min(&mesh->id);
+
+    ob = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    ob->data = mesh;
+    id_us_plus(&mesh->id);
+    BKE_collection_object_add(bmain, scene->master_collection, ob);
+
+    const int defgrp_index = BLI_listbase_count(&ob->defbase);
+    BKE_object_defgroup_add_name(ob, "Group");
+    CustomData_add_layer(&mesh->vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, mesh->totvert);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    for (int i = 0; i < mesh->totvert; i++) {
+      BKE_defvert_add_index_notest(&mesh->dvert[i], defgrp_index, (float)(i % 3) * 0.5f);
+    }
+  }
+
+  void TearDown() override
+  {
+    DEG_graph_free(depsgraph);
+    BKE_main_free(bmain);
+  }
+
+  /* A lattice around the grid, with its inner points moved. */
+  Object *lattice_add(const char *name, const float offset)
+  {
+    Lattice *lt = BKE_lattice_add(bmain, name);
+    Object *ob_lattice = BKE_object_add_only_object(bmain, OB_LATTICE, name);
+    ob_lattice->data = lt;
+    BKE_collection_object_add(bmain, scene->master_collection, ob_lattice);
+
+    BKE_lattice_resize(lt, 3, 3, 3, nullptr);
+    for (int i = 0; i < lt->pntsu * lt->pntsv * lt->pntsw; i++) {
+      lt->def[i].vec[0] += offset * (float)(i % 5) * 0.05f;
+      lt->def[i].vec[2] += offset * (float)(i % 7) * 0.05f;
+    }
+
+    copy_v3_fl3(ob_lattice->loc, 20.0f, 20.0f, 0.75f);
+    copy_v3_fl3(ob_lattice->scale, 42.0f, 42.0f, 4.0f);
+    return ob_lattice;
+  }
+
+  void lattice_modifier_add(Object *ob_lattice, const float strength, const char *defgrp_name)
+  {
+    ModifierData *md = BKE_modifier_new(eModifierType_Lattice);
+    LatticeModifierData *lmd = (LatticeModifierData *)md;
+    lmd->object = ob_lattice;
+    lmd->strength = strength;
+    STRNCPY(lmd->name, defgrp_name);
+    BLI_addtail(&ob->modifiers, md);
+  }
+
+  void evaluate()
+  {
+    depsgraph = DEG_graph_new(
+        bmain, scene, (ViewLayer *)scene->view_layers.first, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+};
+
+/* Deform modifiers applied together one range of vertices at a time give the same result as
+ * applying every modifier to the whole array in turn. */
+TEST_F(derived_mesh_fused_deform, MatchesUnfused)
+{
+  lattice_modifier_add(lattice_add("Lattice A", 1.0f), 1.0f, "");
+  lattice_modifier_add(lattice_add("Lattice B", -2.0f), 0.75f, "Group");
+  lattice_modifier_add(lattice_add("Lattice C", 3.0f), 1.0f, "");
+  evaluate();
+
+  Object *ob_eval = DEG_get_evaluated_object(depsgraph, ob);
+  Mesh *mesh_eval = BKE_object_get_evaluated_mesh(ob_eval);
+  ASSERT_NE(mesh_eval, nullptr);
+
+  Mesh *mesh = (Mesh *)ob->data;
+  ASSERT_EQ(mesh_eval->totvert, mesh->totvert);
+
+  int vert_coords_len;
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, &vert_coords_len);
+  const ModifierEvalContext mectx = {depsgraph, ob_eval, (ModifierApplyFlag)0};
+  LISTBASE_FOREACH (ModifierData *, md, &ob_eval->modifiers) {
+    BKE_modifier_deform_verts(md, &mectx, mesh, vert_coords, vert_coords_len);
+    /* Each modifier gets its share of the time of the fused run. */
+    EXPECT_GT(md->execution_time, 0.0);
+  }
+
+  bool deformed = false;
+  for (int i = 0; i < vert_coords_len; i++) {
+    EXPECT_V3_NEAR(mesh_eval->mvert[i].co, vert_coords[i], 1e-5f);
+    deformed |= !equals_v3v3(mesh->mvert[i].co, mesh_eval->mvert[i].co);
+  }
+  EXPECT_TRUE(deformed);
+
+  MEM_freeN(vert_coords);
+}
+
+}  // namespace blender::bke::tests
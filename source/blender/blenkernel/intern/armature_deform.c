@@ -459,17 +459,21 @@ static void armature_vert_task_editmesh_no_dvert(void *__restrict userdata, Memp
   armature_vert_task_with_dvert(data, BM_elem_index_get(v), NULL);
 }
 
-static void armature_deform_coords_impl(const Object *ob_arm,
-                                        const Object *ob_target,
-                                        float (*vert_coords)[3],
-                                        float (*vert_deform_mats)[3][3],
-                                        const int vert_coords_len,
-                                        const int deformflag,
-                                        float (*vert_coords_prev)[3],
-                                        const char *defgrp_name,
-                                        const Mesh *me_target,
-                                        BMEditMesh *em_target,
-                                        bGPDstroke *gps_target)
+/**
+ * Fill in \a data with everything shared by all vertices.
+ * Returns false when the armature can't deform anything.
+ */
+static bool armature_userdata_init(ArmatureUserdata *data,
+                                   const Object *ob_arm,
+                                   const Object *ob_target,
+                                   float (*vert_coords)[3],
+                                   float (*vert_deform_mats)[3][3],
+                                   const int deformflag,
+                                   float (*vert_coords_prev)[3],
+                                   const char *defgrp_name,
+                                   const Mesh *me_target,
+                                   BMEditMesh *em_target,
+                                   bGPDstroke *gps_target)
 {
   bArmature *arm = ob_arm->data;
   bPoseChannel **pchan_from_defbase = NULL;
@@ -486,7 +490,7 @@ static void armature_deform_coords_impl(const Object *ob_arm,
 
   /* in editmode, or not an armature */
   if (arm->edbo || (ob_arm->pose == NULL)) {
-    return;
+    return false;
   }
 
   if ((ob_arm->pose->flag & POSE_RECALC) != 0) {
@@ -560,7 +564,7 @@ static void armature_deform_coords_impl(const Object *ob_arm,
     }
   }
 
-  ArmatureUserdata data = {
+  *data = (ArmatureUserdata){
       .ob_arm = ob_arm,
       .ob_target = ob_target,
       .me_target = me_target,
@@ -585,15 +589,45 @@ static void armature_deform_coords_impl(const Object *ob_arm,
   float obinv[4][4];
   invert_m4_m4(obinv, ob_target->obmat);
 
-  mul_m4_m4m4(data.postmat, obinv, ob_arm->obmat);
-  invert_m4_m4(data.premat, data.postmat);
+  mul_m4_m4m4(data->postmat, obinv, ob_arm->obmat);
+  invert_m4_m4(data->premat, data->postmat);
+
+  return true;
+}
+
+static void armature_deform_coords_impl(const Object *ob_arm,
+                                        const Object *ob_target,
+                                        float (*vert_coords)[3],
+                                        float (*vert_deform_mats)[3][3],
+                                        const int vert_coords_len,
+                                        const int deformflag,
+                                        float (*vert_coords_prev)[3],
+                                        const char *defgrp_name,
+                                        const Mesh *me_target,
+                                        BMEditMesh *em_target,
+                                        bGPDstroke *gps_target)
+{
+  ArmatureUserdata data;
+  if (!armature_userdata_init(&data,
+                              ob_arm,
+                              ob_target,
+                              vert_coords,
+                              vert_deform_mats,
+                              deformflag,
+                              vert_coords_prev,
+                              defgrp_name,
+                              me_target,
+                              em_target,
+                              gps_target)) {
+    return;
+  }
 
   if (em_target != NULL) {
     /* While this could cause an extra loop over mesh data, in most cases this will
      * have already been properly set. */
     BM_mesh_elem_index_ensure(em_target->bm, BM_VERT);
 
-    if (use_dverts) {
+    if (data.use_dverts) {
       BLI_task_parallel_mempool(em_target->bm->vpool, &data, armature_vert_task_editmesh, true);
     }
     else {
@@ -608,8 +642,8 @@ static void armature_deform_coords_impl(const Object *ob_arm,
     BLI_task_parallel_range(0, vert_coords_len, &data, armature_vert_task, &settings);
   }
 
-  if (pchan_from_defbase) {
-    MEM_freeN(pchan_from_defbase);
+  if (data.pchan_from_defbase) {
+    MEM_freeN(data.pchan_from_defbase);
   }
 }
 
@@ -683,3 +717,67 @@ void BKE_armature_deform_coords_with_editmesh(const Object *ob_arm,
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Armature Deform #ArmatureDeformData API
+ *
+ * Deform ranges of vertices separately, for callers which evaluate other deformations
+ * on the same range right after.
+ * \{ */
+
+typedef struct ArmatureDeformData {
+  ArmatureUserdata data;
+} ArmatureDeformData;
+
+/**
+ * \return NULL when the armature can't deform anything.
+ */
+ArmatureDeformData *BKE_armature_deform_data_create(const Object *ob_arm,
+                                                    const Object *ob_target,
+                                                    int deformflag,
+                                                    const char *defgrp_name,
+                                                    const Mesh *me_target)
+{
+  ArmatureUserdata data;
+  if (!armature_userdata_init(&data,
+                              ob_arm,
+                              ob_target,
+                              NULL,
+                              NULL,
+                              deformflag,
+                              NULL,
+                              defgrp_name,
+                              me_target,
+                              NULL,
+                              NULL)) {
+    return NULL;
+  }
+
+  ArmatureDeformData *armature_deform_data = MEM_mallocN(sizeof(*armature_deform_data), __func__);
+  armature_deform_data->data = data;
+  return armature_deform_data;
+}
+
+/**
+ * Deform the coordinates from \a start up to \a end (exclusive).
+ * Can be called from multiple threads at once for different ranges.
+ */
+void BKE_armature_deform_data_eval_range(const ArmatureDeformData *armature_deform_data,
+                                         float (*vert_coords)[3],
+                                         const int start,
+                                         const int end)
+{
+  ArmatureUserdata data = armature_deform_data->data;
+  data.vert_coords = vert_coords;
+  for (int i = start; i < end; i++) {
+    armature_vert_task(&data, i, NULL);
+  }
+}
+
+void BKE_armature_deform_data_destroy(ArmatureDeformData *armature_deform_data)
+{
+  MEM_SAFE_FREE(armature_deform_data->data.pchan_from_defbase);
+  MEM_freeN(armature_deform_data);
+}
+
+/** \} */
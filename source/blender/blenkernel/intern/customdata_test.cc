@@ -0,0 +1,235 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_mempool.h"
+#include "BLI_rand.h"
+
+#include "BKE_customdata.h"
+
+#include "bmesh.h"
+
+namespace blender::bke::tests {
+
+/* Layer types with a batched interpolation, and one (deform vertices) without. */
+static const int interp_layer_types[] = {
+    CD_MDEFORMVERT,
+    CD_MLOOPUV,
+    CD_MLOOPCOL,
+    CD_PROP_COLOR,
+    CD_PROP_FLOAT3,
+    CD_PROP_FLOAT2,
+};
+
+static const int sources_len = 5;
+static const int dests_len = 7;
+
+static void interp_element_randomize(const int type, void *data, RNG *rng)
+{
+  switch (type) {
+    case CD_MDEFORMVERT: {
+      MDeformVert *dvert = (MDeformVert *)data;
+      dvert->totweight = 2;
+      dvert->dw = (MDeformWeight *)MEM_callocN(sizeof(MDeformWeight) * 2, __func__);
+      dvert->dw[0].def_nr = 0;
+      dvert->dw[0].weight = BLI_rng_get_float(rng);
+      dvert->dw[1].def_nr = (int)BLI_rng_get_uint(rng) % 3 + 1;
+      dvert->dw[1].weight = BLI_rng_get_float(rng);
+      break;
+    }
+    case CD_MLOOPUV: {
+      MLoopUV *luv = (MLoopUV *)data;
+      luv->uv[0] = BLI_rng_get_float(rng);
+      luv->uv[1] = BLI_rng_get_float(rng);
+      luv->flag = (int)BLI_rng_get_uint(rng) & (MLOOPUV_VERTSEL | MLOOPUV_PINNED);
+      break;
+    }
+    case CD_MLOOPCOL: {
+      MLoopCol *mcol = (MLoopCol *)data;
+      mcol->r = (uchar)BLI_rng_get_uint(rng);
+      mcol->g = (uchar)BLI_rng_get_uint(rng);
+      mcol->b = (uchar)BLI_rng_get_uint(rng);
+      mcol->a = (uchar)BLI_rng_get_uint(rng);
+      break;
+    }
+    default: {
+      const int components = (type == CD_PROP_COLOR) ? 4 : (type == CD_PROP_FLOAT3) ? 3 : 2;
+      for (int c = 0; c < components; c++) {
+        ((float *)data)[c] = BLI_rng_get_float(rng) * 2.0f - 1.0f;
+      }
+      break;
+    }
+  }
+}
+
+static void interp_element_expect_eq(const int type, const void *data_a, const void *data_b)
+{
+  switch (type) {
+    case CD_MDEFORMVERT: {
+      const MDeformVert *dvert_a = (const MDeformVert *)data_a;
+      const MDeformVert *dvert_b = (const MDeformVert *)data_b;
+      ASSERT_EQ(dvert_a->totweight, dvert_b->totweight);
+      for (int i = 0; i < dvert_a->totweight; i++) {
+        EXPECT_EQ(dvert_a->dw[i].def_nr, dvert_b->dw[i].def_nr);
+        EXPECT_FLOAT_EQ(dvert_a->dw[i].weight, dvert_b->dw[i].weight);
+      }
+      break;
+    }
+    case CD_MLOOPUV: {
+      const MLoopUV *luv_a = (const MLoopUV *)data_a;
+      const MLoopUV *luv_b = (const MLoopUV *)data_b;
+      EXPECT_NEAR(luv_a->uv[0], luv_b->uv[0], 1e-6f);
+      EXPECT_NEAR(luv_a->uv[1], luv_b->uv[1], 1e-6f);
+      EXPECT_EQ(luv_a->flag, luv_b->flag);
+      break;
+    }
+    case CD_MLOOPCOL: {
+      const MLoopCol *mcol_a = (const MLoopCol *)data_a;
+      const MLoopCol *mcol_b = (const MLoopCol *)data_b;
+      EXPECT_EQ(mcol_a->r, mcol_b->r);
+      EXPECT_EQ(mcol_a->g, mcol_b->g);
+      EXPECT_EQ(mcol_a->b, mcol_b->b);
+      EXPECT_EQ(mcol_a->a, mcol_b->a);
+      break;
+    }
+    default: {
+      const int components = (type == CD_PROP_COLOR) ? 4 : (type == CD_PROP_FLOAT3) ? 3 : 2;
+      for (int c = 0; c < components; c++) {
+        EXPECT_NEAR(((const float *)data_a)[c], ((const float *)data_b)[c], 1e-6f);
+      }
+      break;
+    }
+  }
+}
+
+/* Weights of every destination, some of them zero so the UV flags differ. */
+static void interp_weights_create(float weights[dests_len][sources_len], RNG *rng)
+{
+  for (int d = 0; d < dests_len; d++) {
+    float sum = 0.0f;
+    for (int i = 0; i < sources_len; i++) {
+      weights[d][i] = ((i + d) % 3 == 0) ? 0.0f : BLI_rng_get_float(rng);
+      sum += weights[d][i];
+    }
+    for (int i = 0; i < sources_len; i++) {
+      weights[d][i] /= sum;
+    }
+  }
+}
+
+TEST(customdata, InterpBatch)
+{
+  RNG *rng = BLI_rng_new(17);
+  const int totelem = sources_len + dests_len;
+
+  CustomData source, dest_batch, dest;
+  CustomData_reset(&source);
+  CustomData_reset(&dest_batch);
+  CustomData_reset(&dest);
+  for (const int type : interp_layer_types) {
+    CustomData_add_layer(&source, type, CD_CALLOC, nullptr, sources_len);
+    CustomData_add_layer(&dest_batch, type, CD_CALLOC, nullptr, totelem);
+    CustomData_add_layer(&dest, type, CD_CALLOC, nullptr, totelem);
+    for (int i = 0; i < sources_len; i++) {
+      interp_element_randomize(type, CustomData_get(&source, i, type), rng);
+    }
+  }
+
+  int src_indices[sources_len];
+  for (int i = 0; i < sources_len; i++) {
+    src_indices[i] = i;
+  }
+  /* Leave gaps between destinations to check the indices are used. */
+  int dest_indices[dests_len];
+  for (int d = 0; d < dests_len; d++) {
+    dest_indices[d] = (d * 5) % totelem;
+  }
+  float weights[dests_len][sources_len];
+  interp_weights_create(weights, rng);
+
+  CustomData_interp_batch(
+      &source, &dest_batch, src_indices, &weights[0][0], sources_len, dest_indices, dests_len);
+  for (int d = 0; d < dests_len; d++) {
+    CustomData_interp(
+        &source, &dest, src_indices, weights[d], nullptr, sources_len, dest_indices[d]);
+  }
+
+  for (const int type : interp_layer_types) {
+    for (int d = 0; d < dests_len; d++) {
+      interp_element_expect_eq(type,
+                               CustomData_get(&dest_batch, dest_indices[d], type),
+                               CustomData_get(&dest, dest_indices[d], type));
+    }
+  }
+
+  CustomData_free(&source, sources_len);
+  CustomData_free(&dest_batch, totelem);
+  CustomData_free(&dest, totelem);
+  BLI_rng_free(rng);
+}
+
+TEST(customdata, BMeshInterpBatch)
+{
+  RNG *rng = BLI_rng_new(23);
+
+  CustomData data;
+  CustomData_reset(&data);
+  for (const int type : interp_layer_types) {
+    CustomData_add_layer(&data, type, CD_DEFAULT, nullptr, 0);
+  }
+  CustomData_bmesh_init_pool(&data, sources_len + dests_len * 2, BM_LOOP);
+
+  const void *src_blocks[sources_len];
+  for (int i = 0; i < sources_len; i++) {
+    void *block = nullptr;
+    CustomData_bmesh_set_default(&data, &block);
+    for (const int type : interp_layer_types) {
+      interp_element_randomize(type, CustomData_bmesh_get(&data, block, type), rng);
+    }
+    src_blocks[i] = block;
+  }
+
+  void *dst_blocks_batch[dests_len];
+  void *dst_blocks[dests_len];
+  for (int d = 0; d < dests_len; d++) {
+    dst_blocks_batch[d] = nullptr;
+    dst_blocks[d] = nullptr;
+    CustomData_bmesh_set_default(&data, &dst_blocks_batch[d]);
+    CustomData_bmesh_set_default(&data, &dst_blocks[d]);
+  }
+  float weights[dests_len][sources_len];
+  interp_weights_create(weights, rng);
+
+  CustomData_bmesh_interp_batch(
+      &data, src_blocks, &weights[0][0], sources_len, dst_blocks_batch, dests_len);
+  for (int d = 0; d < dests_len; d++) {
+    CustomData_bmesh_interp(&data, src_blocks, weights[d], nullptr, sources_len, dst_blocks[d]);
+  }
+
+  for (const int type : interp_layer_types) {
+    for (int d = 0; d < dests_len; d++) {
+      interp_element_expect_eq(type,
+                               CustomData_bmesh_get(&data, dst_blocks_batch[d], type),
+                               CustomData_bmesh_get(&data, dst_blocks[d], type));
+    }
+  }
+
+  for (int i = 0; i < sources_len; i++) {
+    void *block = (void *)src_blocks[i];
+    CustomData_bmesh_free_block(&data, &block);
+  }
+  for (int d = 0; d < dests_len; d++) {
+    CustomData_bmesh_free_block(&data, &dst_blocks_batch[d]);
+    CustomData_bmesh_free_block(&data, &dst_blocks[d]);
+  }
+  BLI_mempool_destroy(data.pool);
+  CustomData_free(&data, 0);
+  BLI_rng_free(rng);
+}
+
+}  // namespace blender::bke::tests
@@ -44,6 +44,7 @@ BMEditMesh *BKE_editmesh_create(BMesh *bm, const bool do_tessellate)
   BMEditMesh *em = MEM_callocN(sizeof(BMEditMesh), __func__);
 
   em->bm = bm;
+  em->deform_verts_invalid = true;
   if (do_tessellate) {
     BKE_editmesh_looptri_calc(em);
   }
@@ -69,6 +70,10 @@ BMEditMesh *BKE_editmesh_copy(BMEditMesh *em)
    * tessellation only when/if that copy ends up getting used. */
   em_copy->looptris = NULL;
 
+  em_copy->deform_verts = NULL;
+  em_copy->deform_verts_len = 0;
+  em_copy->deform_verts_invalid = true;
+
   /* Copy various settings. */
   em_copy->selectmode = em->selectmode;
   em_copy->mat_nr = em->mat_nr;
@@ -136,6 +141,9 @@ void BKE_editmesh_looptri_calc(BMEditMesh *em)
 {
   editmesh_tessface_calc_intern(em);
 
+  /* Any topology change re-tessellates. */
+  BKE_editmesh_deform_verts_invalidate(em);
+
   /* commented because editbmesh_build_data() ensures we get tessfaces */
 #if 0
   if (em->mesh_eval_final && em->mesh_eval_final == em->mesh_eval_cage) {
@@ -148,6 +156,15 @@ void BKE_editmesh_looptri_calc(BMEditMesh *em)
 #endif
 }
 
+/**
+ * Same as #BKE_editmesh_looptri_calc, for callers which only moved vertices
+ * and tag them in #BMEditMesh.deform_verts.
+ */
+void BKE_editmesh_looptri_calc_deform(BMEditMesh *em)
+{
+  editmesh_tessface_calc_intern(em);
+}
+
 void BKE_editmesh_free_derivedmesh(BMEditMesh *em)
 {
   if (em->mesh_eval_cage) {
@@ -173,6 +190,47 @@ void BKE_editmesh_free(BMEditMesh *em)
   if (em->bm) {
     BM_mesh_free(em->bm);
   }
+
+  MEM_SAFE_FREE(em->deform_verts);
+}
+
+/**
+ * Return the bitmap callers enable the moved vertices in (by #BMVert index, which is ensured),
+ * or NULL when the topology changed since the last evaluation and the whole mesh is drawn again.
+ */
+BLI_bitmap *BKE_editmesh_deform_verts_ensure(BMEditMesh *em)
+{
+  BMesh *bm = em->bm;
+  if (em->deform_verts_invalid) {
+    return NULL;
+  }
+  if (em->deform_verts && em->deform_verts_len != bm->totvert) {
+    BKE_editmesh_deform_verts_invalidate(em);
+    return NULL;
+  }
+  if (em->deform_verts == NULL) {
+    em->deform_verts = BLI_BITMAP_NEW(bm->totvert, __func__);
+    em->deform_verts_len = bm->totvert;
+  }
+  BM_mesh_elem_index_ensure(bm, BM_VERT);
+  return em->deform_verts;
+}
+
+void BKE_editmesh_deform_verts_invalidate(BMEditMesh *em)
+{
+  MEM_SAFE_FREE(em->deform_verts);
+  em->deform_verts_len = 0;
+  em->deform_verts_invalid = true;
+}
+
+/**
+ * Called once the moved vertices have been passed to the draw cache.
+ */
+void BKE_editmesh_deform_verts_reset(BMEditMesh *em)
+{
+  MEM_SAFE_FREE(em->deform_verts);
+  em->deform_verts_len = 0;
+  em->deform_verts_invalid = false;
 }
 
 struct CageUserData {
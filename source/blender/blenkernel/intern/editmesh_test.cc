@@ -0,0 +1,93 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_bitmap.h"
+
+#include "BKE_editmesh.h"
+
+#include "bmesh.h"
+
+namespace blender::bke::tests {
+
+static BMEditMesh *editmesh_quad_create()
+{
+  BMeshCreateParams bm_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_params);
+  const float cos[4][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}};
+  BMVert *verts[4];
+  for (int i = 0; i < 4; i++) {
+    verts[i] = BM_vert_create(bm, cos[i], nullptr, BM_CREATE_NOP);
+  }
+  BM_face_create_verts(bm, verts, 4, nullptr, BM_CREATE_NOP, true);
+  return BKE_editmesh_create(bm, true);
+}
+
+static void editmesh_free(BMEditMesh *em)
+{
+  BKE_editmesh_free(em);
+  MEM_freeN(em);
+}
+
+TEST(editmesh, DeformVertsNeedEvaluation)
+{
+  /* Nothing was drawn yet, the whole mesh is extracted on the first evaluation. */
+  BMEditMesh *em = editmesh_quad_create();
+  EXPECT_EQ(BKE_editmesh_deform_verts_ensure(em), nullptr);
+
+  BKE_editmesh_deform_verts_reset(em);
+  BLI_bitmap *deform_verts = BKE_editmesh_deform_verts_ensure(em);
+  ASSERT_NE(deform_verts, nullptr);
+  EXPECT_EQ(em->deform_verts_len, 4);
+  EXPECT_FALSE(BLI_BITMAP_TEST(deform_verts, 2));
+
+  editmesh_free(em);
+}
+
+TEST(editmesh, DeformVertsKeptWhenMoving)
+{
+  BMEditMesh *em = editmesh_quad_create();
+  BKE_editmesh_deform_verts_reset(em);
+
+  BLI_bitmap *deform_verts = BKE_editmesh_deform_verts_ensure(em);
+  BLI_BITMAP_ENABLE(deform_verts, 2);
+  /* Tessellating for moved vertices keeps them, tagging again returns the same set. */
+  BKE_editmesh_looptri_calc_deform(em);
+  EXPECT_EQ(BKE_editmesh_deform_verts_ensure(em), deform_verts);
+  EXPECT_TRUE(BLI_BITMAP_TEST(em->deform_verts, 2));
+
+  /* Consumed by the draw cache, the next step starts empty. */
+  BKE_editmesh_deform_verts_reset(em);
+  EXPECT_EQ(em->deform_verts, nullptr);
+  deform_verts = BKE_editmesh_deform_verts_ensure(em);
+  ASSERT_NE(deform_verts, nullptr);
+  EXPECT_FALSE(BLI_BITMAP_TEST(deform_verts, 2));
+
+  editmesh_free(em);
+}
+
+TEST(editmesh, DeformVertsInvalidOnTopologyChange)
+{
+  BMEditMesh *em = editmesh_quad_create();
+  BKE_editmesh_deform_verts_reset(em);
+
+  /* Any re-tessellation may come from a topology change. */
+  BKE_editmesh_deform_verts_ensure(em);
+  BKE_editmesh_looptri_calc(em);
+  EXPECT_EQ(em->deform_verts, nullptr);
+  EXPECT_EQ(BKE_editmesh_deform_verts_ensure(em), nullptr);
+
+  /* A vertex added after tagging started. */
+  BKE_editmesh_deform_verts_reset(em);
+  BKE_editmesh_deform_verts_ensure(em);
+  const float co[3] = {2, 0, 0};
+  BM_vert_create(em->bm, co, nullptr, BM_CREATE_NOP);
+  EXPECT_EQ(BKE_editmesh_deform_verts_ensure(em), nullptr);
+  EXPECT_EQ(em->deform_verts, nullptr);
+
+  editmesh_free(em);
+}
+
+}  // namespace blender::bke::tests
@@ -2126,6 +2126,7 @@ void BKE_mesh_eval_geometry(Depsgraph *depsgraph, Mesh *mesh)
     BKE_id_free(NULL, mesh->runtime.mesh_eval);
     mesh->runtime.mesh_eval = NULL;
   }
+  BKE_mesh_runtime_shared_eval_clear(mesh);
   if (DEG_is_active(depsgraph)) {
     Mesh *mesh_orig = (Mesh *)DEG_get_original_id(&mesh->id);
     if (mesh->texflag & ME_AUTOSPACE_EVALUATED) {
@@ -213,6 +213,12 @@ typedef struct MeshCalcNormalsData {
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
+
+  /* Loops of every vertex, so vertex normals are gathered from the weighted loop normals instead
+   * of being accumulated into, which would need atomics or a single thread.
+   * The loops of vertex `i` are `vert_loops[vert_loop_offsets[i]..vert_loop_offsets[i + 1]]`. */
+  int *vert_loop_offsets;
+  int *vert_loops;
 } MeshCalcNormalsData;
 
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
@@ -295,7 +301,12 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
   MeshCalcNormalsData *data = userdata;
 
   MVert *mv = &data->mverts[vidx];
-  float *no = data->vnors[vidx];
+  float no[3] = {0.0f, 0.0f, 0.0f};
+
+  /* Summed in loop order, the same as the accumulation on a single thread. */
+  for (int i = data->vert_loop_offsets[vidx]; i < data->vert_loop_offsets[vidx + 1]; i++) {
+    add_v3_v3(no, data->lnors_weighted[data->vert_loops[i]]);
+  }
 
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
     /* following Mesh convention; we use vertex coordinate itself for normal in this case */
@@ -303,6 +314,9 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
   }
 
   normal_float_to_short_v3(mv->no, no);
+  if (data->vnors) {
+    copy_v3_v3(data->vnors[vidx], no);
+  }
 }
 
 void BKE_mesh_calc_normals_poly(MVert *mverts,
@@ -336,19 +350,28 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
     return;
   }
 
-  float(*vnors)[3] = r_vertnors;
   float(*lnors_weighted)[3] = MEM_malloc_arrayN(
       (size_t)numLoops, sizeof(*lnors_weighted), __func__);
-  bool free_vnors = false;
+  int *vert_loop_offsets = MEM_calloc_arrayN(
+      (size_t)numVerts + 1, sizeof(*vert_loop_offsets), __func__);
+  int *vert_loops = MEM_malloc_arrayN((size_t)numLoops, sizeof(*vert_loops), __func__);
 
-  /* first go through and calculate normals for all the polys */
-  if (vnors == NULL) {
-    vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
-    free_vnors = true;
+  /* Group the loops by vertex, in loop order so the sum doesn't depend on scheduling.
+   * A counting sort of integers, cheap compared to the vector additions it replaces. */
+  for (int lidx = 0; lidx < numLoops; lidx++) {
+    vert_loop_offsets[mloop[lidx].v + 1]++;
   }
-  else {
-    memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
+  for (int vidx = 0; vidx < numVerts; vidx++) {
+    vert_loop_offsets[vidx + 1] += vert_loop_offsets[vidx];
+  }
+  for (int lidx = 0; lidx < numLoops; lidx++) {
+    vert_loops[vert_loop_offsets[mloop[lidx].v]++] = lidx;
   }
+  /* Filling moved every offset to the start of the next vertex. */
+  memmove(&vert_loop_offsets[1],
+          &vert_loop_offsets[0],
+          sizeof(*vert_loop_offsets) * (size_t)numVerts);
+  vert_loop_offsets[0] = 0;
 
   MeshCalcNormalsData data = {
       .mpolys = mpolys,
@@ -356,27 +379,20 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       .mverts = mverts,
       .pnors = pnors,
       .lnors_weighted = lnors_weighted,
-      .vnors = vnors,
+      .vnors = r_vertnors,
+      .vert_loop_offsets = vert_loop_offsets,
+      .vert_loops = vert_loops,
   };
 
   /* Compute poly normals, and prepare weighted loop normals. */
   BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
 
-  /* Actually accumulate weighted loop normals into vertex ones. */
-  /* Unfortunately, not possible to thread that
-   * (not in a reasonable, totally lock- and barrier-free fashion),
-   * since several loops will point to the same vertex... */
-  for (int lidx = 0; lidx < numLoops; lidx++) {
-    add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
-  }
-
-  /* Normalize and validate computed vertex normals. */
+  /* Gather weighted loop normals into vertex ones, normalize and validate them. */
   BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_cb, &settings);
 
-  if (free_vnors) {
-    MEM_freeN(vnors);
-  }
   MEM_freeN(lnors_weighted);
+  MEM_freeN(vert_loop_offsets);
+  MEM_freeN(vert_loops);
 }
 
 void BKE_mesh_ensure_normals(Mesh *mesh)
@@ -1596,6 +1612,30 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
 #endif
 }
 
+static void loop_normals_from_poly_cb(void *__restrict userdata,
+                                      const int mp_index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  int ml_index = mp->loopstart;
+  const int ml_index_end = ml_index + mp->totloop;
+  const bool is_poly_flat = ((mp->flag & ME_SMOOTH) == 0);
+
+  for (; ml_index < ml_index_end; ml_index++) {
+    if (common_data->loop_to_poly) {
+      common_data->loop_to_poly[ml_index] = mp_index;
+    }
+    if (is_poly_flat) {
+      copy_v3_v3(common_data->loopnors[ml_index], common_data->polynors[mp_index]);
+    }
+    else {
+      const MVert *mv = &common_data->mverts[common_data->mloops[ml_index].v];
+      normal_short_to_float_v3(common_data->loopnors[ml_index], mv->no);
+    }
+  }
+}
+
 /**
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry
@@ -1629,26 +1669,21 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
      * As usual, we could handle that on case-by-case basis,
      * but simpler to keep it well confined here.
      */
-    int mp_index;
-
-    for (mp_index = 0; mp_index < numPolys; mp_index++) {
-      MPoly *mp = &mpolys[mp_index];
-      int ml_index = mp->loopstart;
-      const int ml_index_end = ml_index + mp->totloop;
-      const bool is_poly_flat = ((mp->flag & ME_SMOOTH) == 0);
+    LoopSplitTaskDataCommon common_data = {
+        .loopnors = r_loopnors,
+        .mverts = mverts,
+        .mloops = mloops,
+        .mpolys = mpolys,
+        .loop_to_poly = r_loop_to_poly,
+        .polynors = polynors,
+        .numLoops = numLoops,
+        .numPolys = numPolys,
+    };
 
-      for (; ml_index < ml_index_end; ml_index++) {
-        if (r_loop_to_poly) {
-          r_loop_to_poly[ml_index] = mp_index;
-        }
-        if (is_poly_flat) {
-          copy_v3_v3(r_loopnors[ml_index], polynors[mp_index]);
-        }
-        else {
-          normal_short_to_float_v3(r_loopnors[ml_index], mverts[mloops[ml_index].v].no);
-        }
-      }
-    }
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1024;
+    BLI_task_parallel_range(0, numPolys, &common_data, loop_normals_from_poly_cb, &settings);
     return;
   }
 
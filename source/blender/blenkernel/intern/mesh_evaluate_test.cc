@@ -0,0 +1,163 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_test_utils.hh"
+
+#include "PIL_time_utildefines.h"
+
+/* Run the biggest tests! */
+//#define MESH_NORMALS_RUN_BIG
+
+namespace blender::bke::tests {
+
+class mesh_normals : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/**
+ * Add a pole in the middle of the shared test grid of \a size, where many faces share a vertex.
+ *
+ * Faces already using the pole are left alone, so none of them is degenerate. The last corner of
+ * the top left face isn't used by any other face, it is left alone so every vertex stays used.
+ */
+static void grid_mesh_pole_add(Mesh *me, const int size)
+{
+  const uint pole = (uint)((size / 2) * (size + 1) + size / 2);
+  const uint corner_top_left = (uint)(size * (size + 1));
+  for (int i = 0; i < me->totpoly; i += 3) {
+    MLoop *ml = &me->mloop[me->mpoly[i].loopstart];
+    const bool uses_pole = ELEM(pole, ml[0].v, ml[1].v, ml[2].v, ml[3].v);
+    if (!uses_pole && ml[3].v != corner_top_left) {
+      ml[3].v = pole;
+    }
+  }
+}
+
+/* Straightforward accumulation of angle weighted face normals into the vertices. */
+static void mesh_normals_reference(const Mesh *me, float (*r_vnors)[3])
+{
+  memset(r_vnors, 0, sizeof(*r_vnors) * me->totvert);
+  for (int i = 0; i < me->totpoly; i++) {
+    const MPoly *mp = &me->mpoly[i];
+    float pnor[3];
+    BKE_mesh_calc_poly_normal(mp, &me->mloop[mp->loopstart], me->mvert, pnor);
+    const MLoop *ml = &me->mloop[mp->loopstart];
+    for (int j = 0; j < mp->totloop; j++) {
+      const float *co_prev = me->mvert[ml[(j + mp->totloop - 1) % mp->totloop].v].co;
+      const float *co = me->mvert[ml[j].v].co;
+      const float *co_next = me->mvert[ml[(j + 1) % mp->totloop].v].co;
+      const float fac = angle_v3v3v3(co_prev, co, co_next);
+      madd_v3_v3fl(r_vnors[ml[j].v], pnor, fac);
+    }
+  }
+  for (int i = 0; i < me->totvert; i++) {
+    normalize_v3(r_vnors[i]);
+  }
+}
+
+static void mesh_normals_calc(Mesh *me, float (*r_vnors)[3])
+{
+  BKE_mesh_calc_normals_poly(me->mvert,
+                             r_vnors,
+                             me->totvert,
+                             me->mloop,
+                             me->mpoly,
+                             me->totloop,
+                             me->totpoly,
+                             nullptr,
+                             false);
+}
+
+static void mesh_normals_test(const int size)
+{
+  Mesh *me = mesh_test_grid_create(size);
+  grid_mesh_pole_add(me, size);
+  float(*vnors_ref)[3] = (float(*)[3])MEM_malloc_arrayN(me->totvert, sizeof(float[3]), __func__);
+  float(*vnors_a)[3] = (float(*)[3])MEM_malloc_arrayN(me->totvert, sizeof(float[3]), __func__);
+  float(*vnors_b)[3] = (float(*)[3])MEM_malloc_arrayN(me->totvert, sizeof(float[3]), __func__);
+
+  mesh_normals_reference(me, vnors_ref);
+  mesh_normals_calc(me, vnors_a);
+  mesh_normals_calc(me, vnors_b);
+
+  /* The corner angles are computed differently from the reference, the pole sums thousands of
+   * them. */
+  for (int i = 0; i < me->totvert; i++) {
+    EXPECT_V3_NEAR(vnors_a[i], vnors_ref[i], 1e-4f);
+    float no[3];
+    normal_short_to_float_v3(no, me->mvert[i].no);
+    EXPECT_V3_NEAR(no, vnors_a[i], 1e-4f);
+  }
+  /* The result doesn't depend on scheduling. */
+  EXPECT_EQ_ARRAY(&vnors_a[0][0], &vnors_b[0][0], me->totvert * 3);
+
+  MEM_freeN(vnors_ref);
+  MEM_freeN(vnors_a);
+  MEM_freeN(vnors_b);
+  BKE_id_free(nullptr, me);
+}
+
+TEST_F(mesh_normals, PolyVertexSmall)
+{
+  mesh_normals_test(16);
+}
+
+/* Large enough for multiple threads. */
+TEST_F(mesh_normals, PolyVertexParallel)
+{
+  mesh_normals_test(256);
+}
+
+#ifdef MESH_NORMALS_RUN_BIG
+static void mesh_normals_performance_test(const int size, const char *id)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  Mesh *me = mesh_test_grid_create(size);
+  grid_mesh_pole_add(me, size);
+  float(*vnors)[3] = (float(*)[3])MEM_malloc_arrayN(me->totvert, sizeof(float[3]), __func__);
+  {
+    /* Accumulation into the vertices on a single thread, as done before gathering. */
+    TIMEIT_START(serial_scatter);
+    mesh_normals_reference(me, vnors);
+    TIMEIT_END(serial_scatter);
+  }
+  {
+    TIMEIT_START(calc_normals);
+    BKE_mesh_calc_normals(me);
+    TIMEIT_END(calc_normals);
+  }
+  MEM_freeN(vnors);
+  BKE_id_free(nullptr, me);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST_F(mesh_normals, Grid_1M)
+{
+  mesh_normals_performance_test(1000, "Grid 1M faces");
+}
+
+TEST_F(mesh_normals, Grid_50M)
+{
+  mesh_normals_performance_test(7072, "Grid 50M faces");
+}
+#endif
+
+}  // namespace blender::bke::tests
@@ -61,6 +61,7 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   Mesh_Runtime *runtime = &mesh->runtime;
 
   runtime->mesh_eval = NULL;
+  runtime->shared_eval = NULL;
   runtime->edit_data = NULL;
   runtime->batch_cache = NULL;
   runtime->subdiv_ccg = NULL;
@@ -84,6 +85,7 @@ void BKE_mesh_runtime_clear_cache(Mesh *mesh)
     BKE_id_free(NULL, mesh->runtime.mesh_eval);
     mesh->runtime.mesh_eval = NULL;
   }
+  BKE_mesh_runtime_shared_eval_clear(mesh);
   BKE_mesh_runtime_clear_geometry(mesh);
   BKE_mesh_batch_cache_free(mesh);
   BKE_mesh_runtime_clear_edit_data(mesh);
@@ -243,6 +245,142 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Evaluated Meshes
+ *
+ * Objects using the same mesh with identical modifier stacks (linked duplicates for example)
+ * share one evaluated mesh, and with it the draw cache. The entries are identified by a key
+ * built from the modifier stack, see #BKE_modifiers_shared_result_key.
+ *
+ * Every object using an entry counts as a user of it, until it gets evaluated again. Entries
+ * nobody uses anymore (left behind by animated modifier settings for example) are only freed
+ * when the number of entries is exceeded, so objects evaluated one after another can still
+ * share them. Everything is freed when the mesh itself is re-evaluated.
+ *
+ * Objects refer to their entry by a unique identifier instead of a pointer: the entry might be
+ * freed with the mesh before the object is evaluated again.
+ * \{ */
+
+#define MESH_SHARED_EVAL_MAX 4
+
+typedef struct MeshSharedEval {
+  struct MeshSharedEval *next;
+  void *key;
+  size_t key_len;
+  Mesh *mesh_eval;
+  uint64_t id;
+  int users;
+} MeshSharedEval;
+
+static uint64_t mesh_shared_eval_id_last = 0;
+
+static void mesh_shared_eval_free(MeshSharedEval *shared)
+{
+  shared->mesh_eval->edit_mesh = NULL;
+  BKE_id_free(NULL, shared->mesh_eval);
+  MEM_freeN(shared->key);
+  MEM_freeN(shared);
+}
+
+/**
+ * Find the evaluated mesh shared for \a key, the caller becomes one of its users until it
+ * calls #BKE_mesh_runtime_shared_eval_release with \a r_id.
+ *
+ * \note Must be called with the `eval_mutex` of the mesh locked.
+ */
+Mesh *BKE_mesh_runtime_shared_eval_find(Mesh *mesh,
+                                        const void *key,
+                                        const size_t key_len,
+                                        uint64_t *r_id)
+{
+  for (MeshSharedEval *shared = mesh->runtime.shared_eval; shared; shared = shared->next) {
+    if (shared->key_len == key_len && memcmp(shared->key, key, key_len) == 0) {
+      shared->users++;
+      *r_id = shared->id;
+      return shared->mesh_eval;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Take ownership of \a mesh_eval, the caller is its first user. Entries without users are
+ * freed to make room, unless all of them are used.
+ *
+ * \note Must be called with the `eval_mutex` of the mesh locked.
+ */
+bool BKE_mesh_runtime_shared_eval_add(Mesh *mesh,
+                                      const void *key,
+                                      const size_t key_len,
+                                      Mesh *mesh_eval,
+                                      uint64_t *r_id)
+{
+  int len = 0;
+  for (MeshSharedEval *shared = mesh->runtime.shared_eval; shared; shared = shared->next) {
+    BLI_assert(shared->mesh_eval != mesh_eval);
+    len++;
+  }
+  if (len >= MESH_SHARED_EVAL_MAX) {
+    MeshSharedEval **shared_p = &mesh->runtime.shared_eval;
+    while (*shared_p) {
+      MeshSharedEval *shared = *shared_p;
+      if (shared->users == 0) {
+        *shared_p = shared->next;
+        mesh_shared_eval_free(shared);
+        len--;
+      }
+      else {
+        shared_p = &shared->next;
+      }
+    }
+    if (len >= MESH_SHARED_EVAL_MAX) {
+      return false;
+    }
+  }
+
+  MeshSharedEval *shared = MEM_mallocN(sizeof(*shared), __func__);
+  shared->key = MEM_mallocN(key_len, __func__);
+  memcpy(shared->key, key, key_len);
+  shared->key_len = key_len;
+  shared->mesh_eval = mesh_eval;
+  shared->id = atomic_add_and_fetch_uint64(&mesh_shared_eval_id_last, 1);
+  shared->users = 1;
+  shared->next = mesh->runtime.shared_eval;
+  mesh->runtime.shared_eval = shared;
+  *r_id = shared->id;
+  return true;
+}
+
+/**
+ * Stop using the entry \a id of a previous find or add. Nothing happens when the entry was
+ * freed with the other entries of the mesh in the meantime.
+ *
+ * \note Must be called with the `eval_mutex` of the mesh locked.
+ */
+void BKE_mesh_runtime_shared_eval_release(Mesh *mesh, const uint64_t id)
+{
+  for (MeshSharedEval *shared = mesh->runtime.shared_eval; shared; shared = shared->next) {
+    if (shared->id == id) {
+      BLI_assert(shared->users > 0);
+      shared->users--;
+      return;
+    }
+  }
+}
+
+void BKE_mesh_runtime_shared_eval_clear(Mesh *mesh)
+{
+  MeshSharedEval *shared = mesh->runtime.shared_eval;
+  while (shared) {
+    MeshSharedEval *shared_next = shared->next;
+    mesh_shared_eval_free(shared);
+    shared = shared_next;
+  }
+  mesh->runtime.shared_eval = NULL;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Mesh Batch Cache Callbacks
  * \{ */
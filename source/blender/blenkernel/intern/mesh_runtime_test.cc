@@ -0,0 +1,244 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "CLG_log.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "BKE_DerivedMesh.h"
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_fcurve.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+#include "BKE_mesh_test_utils.hh"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "IMB_imbuf.h"
+
+namespace blender::bke::tests {
+
+class mesh_runtime_shared_eval : public testing::Test {
+ public:
+  Main *bmain;
+  Scene *scene;
+  Mesh *mesh;
+  Depsgraph *depsgraph = nullptr;
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    DNA_sdna_current_init();
+    BKE_idtype_init();
+    IMB_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+  }
+
+  static void TearDownTestSuite()
+  {
+    DEG_free_node_types();
+    IMB_exit();
+    DNA_sdna_current_free();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    mesh = BKE_mesh_add(bmain, "Mesh");
+    BKE_mesh_nomain_to_mesh(mesh_test_grid_create(8), mesh, nullptr, &CD_MASK_MESH, true);
+    /* Only count the objects using the mesh. */
+    id_us_min(&mesh->id);
+  }
+
+  void TearDown() override
+  {
+    DEG_graph_free(depsgraph);
+    BKE_main_free(bmain);
+  }
+
+  Object *object_add(const char *name, const int quad_method)
+  {
+    Object *ob = BKE_object_add_only_object(bmain, OB_MESH, name);
+    ob->data = mesh;
+    id_us_plus(&mesh->id);
+    BKE_collection_object_add(bmain, scene->master_collection, ob);
+
+    ModifierData *md = BKE_modifier_new(eModifierType_Triangulate);
+    ((TriangulateModifierData *)md)->quad_method = quad_method;
+    BLI_addtail(&ob->modifiers, md);
+    return ob;
+  }
+
+  void evaluate()
+  {
+    depsgraph = DEG_graph_new(
+        bmain, scene, (ViewLayer *)scene->view_layers.first, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  Object *object_eval(Object *ob)
+  {
+    return DEG_get_evaluated_object(depsgraph, ob);
+  }
+};
+
+TEST_F(mesh_runtime_shared_eval, FindAdd)
+{
+  Mesh *mesh = mesh_test_grid_create(1);
+  const int key_a = 1, key_b = 2;
+  uint64_t id_a = 0, id = 0;
+
+  EXPECT_EQ(BKE_mesh_runtime_shared_eval_find(mesh, &key_a, sizeof(key_a), &id), nullptr);
+  Mesh *mesh_eval_a = mesh_test_grid_create(1);
+  EXPECT_TRUE(BKE_mesh_runtime_shared_eval_add(mesh, &key_a, sizeof(key_a), mesh_eval_a, &id_a));
+  EXPECT_NE(id_a, 0);
+  EXPECT_EQ(BKE_mesh_runtime_shared_eval_find(mesh, &key_a, sizeof(key_a), &id), mesh_eval_a);
+  EXPECT_EQ(id, id_a);
+  EXPECT_EQ(BKE_mesh_runtime_shared_eval_find(mesh, &key_b, sizeof(key_b), &id), nullptr);
+  /* Keys of a different length never match. */
+  EXPECT_EQ(BKE_mesh_runtime_shared_eval_find(mesh, &key_a, 1, &id), nullptr);
+
+  /* The number of shared meshes in use is limited, the caller keeps ownership of the rejected
+   * ones. */
+  int added = 1;
+  for (int key = 100; key < 110; key++) {
+    Mesh *mesh_eval = mesh_test_grid_create(1);
+    if (BKE_mesh_runtime_shared_eval_add(mesh, &key, sizeof(key), mesh_eval, &id)) {
+      added++;
+    }
+    else {
+      BKE_id_free(nullptr, mesh_eval);
+    }
+  }
+  EXPECT_EQ(added, 4);
+
+  /* Both users of the first mesh stop using it, which makes room for another one. */
+  BKE_mesh_runtime_shared_eval_release(mesh, id_a);
+  BKE_mesh_runtime_shared_eval_release(mesh, id_a);
+  EXPECT_EQ(BKE_mesh_runtime_shared_eval_find(mesh, &key_a, sizeof(key_a), &id), mesh_eval_a);
+  BKE_mesh_runtime_shared_eval_release(mesh, id_a);
+  Mesh *mesh_eval_b = mesh_test_grid_create(1);
+  EXPECT_TRUE(BKE_mesh_runtime_shared_eval_add(mesh, &key_b, sizeof(key_b), mesh_eval_b, &id));
+  EXPECT_NE(id, id_a);
+  EXPECT_EQ(BKE_mesh_runtime_shared_eval_find(mesh, &key_a, sizeof(key_a), &id), nullptr);
+  /* Releasing a freed entry does nothing. */
+  BKE_mesh_runtime_shared_eval_release(mesh, id_a);
+
+  BKE_mesh_runtime_shared_eval_clear(mesh);
+  EXPECT_EQ(BKE_mesh_runtime_shared_eval_find(mesh, &key_b, sizeof(key_b), &id), nullptr);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(mesh_runtime_shared_eval, LinkedDuplicates)
+{
+  Object *ob_a = object_add("A", MOD_TRIANGULATE_QUAD_BEAUTY);
+  Object *ob_b = object_add("B", MOD_TRIANGULATE_QUAD_BEAUTY);
+  Object *ob_c = object_add("C", MOD_TRIANGULATE_QUAD_FIXED);
+  evaluate();
+
+  Mesh *mesh_eval_a = BKE_object_get_evaluated_mesh(object_eval(ob_a));
+  Mesh *mesh_eval_b = BKE_object_get_evaluated_mesh(object_eval(ob_b));
+  Mesh *mesh_eval_c = BKE_object_get_evaluated_mesh(object_eval(ob_c));
+  ASSERT_NE(mesh_eval_a, nullptr);
+  ASSERT_NE(mesh_eval_c, nullptr);
+  EXPECT_EQ(mesh_eval_a->totpoly, mesh->totpoly * 2);
+
+  /* Equal modifier stacks share the result, different settings don't. */
+  EXPECT_EQ(mesh_eval_a, mesh_eval_b);
+  EXPECT_NE(mesh_eval_a, mesh_eval_c);
+
+  /* Every object still has its own deformed mesh. */
+  Scene *scene_eval = DEG_get_evaluated_scene(depsgraph);
+  Mesh *mesh_deform_a = mesh_get_eval_deform(
+      depsgraph, scene_eval, object_eval(ob_a), &CD_MASK_BAREMESH);
+  Mesh *mesh_deform_b = mesh_get_eval_deform(
+      depsgraph, scene_eval, object_eval(ob_b), &CD_MASK_BAREMESH);
+  ASSERT_NE(mesh_deform_a, nullptr);
+  ASSERT_NE(mesh_deform_b, nullptr);
+  EXPECT_NE(mesh_deform_a, mesh_deform_b);
+  EXPECT_EQ(mesh_deform_a->totvert, mesh->totvert);
+  EXPECT_EQ(mesh_deform_b->totpoly, mesh->totpoly);
+}
+
+/* Changing the modifier settings of an object over and over again doesn't use up the shared
+ * meshes, the results of the previous settings aren't used anymore. */
+/* An animated setting only evaluates the object again, the results shared for the settings of
+ * previous frames are released and make room for the new ones. */
+TEST_F(mesh_runtime_shared_eval, AnimatedSettings)
+{
+  Object *ob_a = object_add("A", MOD_TRIANGULATE_QUAD_BEAUTY);
+  Object *ob_b = object_add("B", MOD_TRIANGULATE_QUAD_BEAUTY);
+  const int min_vertices = ((TriangulateModifierData *)ob_b->modifiers.first)->min_vertices;
+
+  /* The minimum vertex count of the first object follows the frame. */
+  AnimData *adt = BKE_animdata_add_id(&ob_a->id);
+  adt->action = BKE_action_add(bmain, "Action");
+  FCurve *fcu = BKE_fcurve_create();
+  fcu->rna_path = BLI_strdup("modifiers[\"Triangulate\"].min_vertices");
+  add_fmodifier(&fcu->modifiers, FMODIFIER_TYPE_GENERATOR, fcu);
+  BLI_addtail(&adt->action->curves, fcu);
+
+  scene->r.cfra = min_vertices;
+  evaluate();
+  EXPECT_EQ(BKE_object_get_evaluated_mesh(object_eval(ob_a)),
+            BKE_object_get_evaluated_mesh(object_eval(ob_b)));
+
+  for (int i = 1; i <= 6; i++) {
+    DEG_evaluate_on_framechange(depsgraph, (float)(min_vertices + i));
+
+    Mesh *mesh_eval_a = BKE_object_get_evaluated_mesh(object_eval(ob_a));
+    ASSERT_NE(mesh_eval_a, nullptr);
+    EXPECT_EQ(((TriangulateModifierData *)object_eval(ob_a)->modifiers.first)->min_vertices,
+              min_vertices + i);
+    EXPECT_NE(mesh_eval_a, BKE_object_get_evaluated_mesh(object_eval(ob_b)));
+    EXPECT_FALSE(object_eval(ob_a)->runtime.is_data_eval_owned);
+  }
+
+  /* Back to the settings of the other object, which still uses its result. */
+  DEG_evaluate_on_framechange(depsgraph, (float)min_vertices);
+  EXPECT_EQ(BKE_object_get_evaluated_mesh(object_eval(ob_a)),
+            BKE_object_get_evaluated_mesh(object_eval(ob_b)));
+}
+
+TEST_F(mesh_runtime_shared_eval, SingleUser)
+{
+  Object *ob = object_add("A", MOD_TRIANGULATE_QUAD_BEAUTY);
+  evaluate();
+
+  /* Nothing to share with, the object owns its result. */
+  Mesh *mesh_eval = BKE_object_get_evaluated_mesh(object_eval(ob));
+  ASSERT_NE(mesh_eval, nullptr);
+  EXPECT_EQ(mesh_eval->totpoly, mesh->totpoly * 2);
+  EXPECT_TRUE(object_eval(ob)->runtime.is_data_eval_owned);
+}
+
+}  // namespace blender::bke::tests
@@ -47,6 +47,7 @@
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 
+#include "BLI_buffer.h"
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
@@ -926,6 +927,50 @@ bool BKE_modifiers_is_correctable_deformed(struct Scene *scene, Object *ob)
   return false;
 }
 
+/**
+ * Build the key identifying the result of the modifier stack of \a ob, for sharing the evaluated
+ * mesh between objects which use the same mesh, see #BKE_mesh_runtime_shared_eval_find.
+ *
+ * \return false when the result can't be shared: when any enabled modifier doesn't support it,
+ * depends on time or only deforms, or when there are no modifiers to evaluate.
+ */
+bool BKE_modifiers_shared_result_key(const struct Scene *scene,
+                                     Object *ob,
+                                     const int required_mode,
+                                     BLI_Buffer *key)
+{
+  VirtualModifierData virtualModifierData;
+  ModifierData *md = BKE_modifiers_get_virtual_modifierlist(ob, &virtualModifierData);
+  bool has_modifiers = false;
+
+  for (; md; md = md->next) {
+    if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
+      continue;
+    }
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(md->type);
+    /* Deformed meshes are owned by the objects, they aren't shared. */
+    if (mti->sharedResultKey == NULL || mti->type == eModifierTypeType_OnlyDeform) {
+      return false;
+    }
+    if (mti->dependsOnTime && mti->dependsOnTime(md)) {
+      return false;
+    }
+    const int type = md->type;
+    BKE_modifier_shared_key_append(key, &type, sizeof(type));
+    if (!mti->sharedResultKey(md, ob, key)) {
+      return false;
+    }
+    has_modifiers = true;
+  }
+  return has_modifiers;
+}
+
+void BKE_modifier_shared_key_append(BLI_Buffer *key, const void *data, const size_t size)
+{
+  BLI_assert(key->elem_size == 1);
+  _bli_buffer_append_array(key, (void *)data, size);
+}
+
 void BKE_modifier_free_temporary_data(ModifierData *md)
 {
   if (md->type == eModifierType_Armature) {
@@ -1376,6 +1421,7 @@ void BKE_modifier_blend_read_data(BlendDataReader *reader, ListBase *lb, Object
 
     md->error = NULL;
     md->runtime = NULL;
+    md->execution_time = 0.0;
 
     /* Modifier data has been allocated as a part of data migration process and
      * no reading of nested fields from file is needed. */
@@ -4928,6 +4928,7 @@ void BKE_object_runtime_reset_on_copy(Object *object, const int UNUSED(flag))
 {
   Object_Runtime *runtime = &object->runtime;
   runtime->data_eval = NULL;
+  runtime->shared_eval_id = 0;
   runtime->gpd_eval = NULL;
   runtime->mesh_deform_eval = NULL;
   runtime->curve_cache = NULL;
@@ -173,7 +173,8 @@ static bool grid_materials_match(const DMFlagMat *f1, const DMFlagMat *f2)
 
 /* Adapted from BLI_kdopbvh.c */
 /* Returns the index of the first element on the right of the partition */
-static int partition_indices(int *prim_indices, int lo, int hi, int axis, float mid, BBC *prim_bbc)
+static int partition_indices(
+    int *prim_indices, int lo, int hi, int axis, float mid, const BBC *prim_bbc)
 {
   int i = lo, j = hi;
   for (;;) {
@@ -251,17 +252,21 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
 }
 
 /* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+ * a negative value for additional vertices.
+ * Vertices are unique to the leaf with the lowest build order using them, see #vert_owner. */
+static int map_insert_vert(GHash *map,
+                           unsigned int *face_verts,
+                           unsigned int *uniq_verts,
+                           const int *vert_owner,
+                           int leaf_order,
+                           int vertex)
 {
   void *key, **value_p;
 
   key = POINTER_FROM_INT(vertex);
   if (!BLI_ghash_ensure_p(map, key, &value_p)) {
     int value_i;
-    if (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
+    if (vert_owner[vertex] == leaf_order) {
       value_i = *uniq_verts;
       (*uniq_verts)++;
     }
@@ -277,7 +282,7 @@ static int map_insert_vert(
 }
 
 /* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node, const int *vert_owner, int leaf_order)
 {
   bool has_visible = false;
 
@@ -298,8 +303,12 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      face_vert_indices[i][j] = map_insert_vert(map,
+                                                &node->face_verts,
+                                                &node->uniq_verts,
+                                                vert_owner,
+                                                leaf_order,
+                                                pbvh->mloop[lt->tri[j]].v);
     }
 
     if (has_visible == false) {
@@ -343,15 +352,6 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   BLI_ghash_free(map, NULL, NULL);
 }
 
-static void update_vb(PBVH *pbvh, PBVHNode *node, BBC *prim_bbc, int offset, int count)
-{
-  BB_reset(&node->vb);
-  for (int i = offset + count - 1; i >= offset; i--) {
-    BB_expand_with_bb(&node->vb, (BB *)(&prim_bbc[pbvh->prim_indices[i]]));
-  }
-  node->orig_vb = node->vb;
-}
-
 /* Returns the number of visible quads in the nodes' grids. */
 int BKE_pbvh_count_grid_quads(BLI_bitmap **grid_hidden,
                               const int *grid_indices,
@@ -413,24 +413,6 @@ static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
-static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
-{
-  pbvh->nodes[node_index].flag |= PBVH_Leaf;
-
-  pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + offset;
-  pbvh->nodes[node_index].totprim = count;
-
-  /* Still need vb for searches */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
-  if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
-  else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
-  }
-}
-
 /* Return zero if all primitives in the node can be drawn with the
  * same material (including flat/smooth shading), non-zero otherwise */
 static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
@@ -465,56 +447,247 @@ static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
   return false;
 }
 
-/* Recursively build a node in the tree
+/* -------------------------------------------------------------------- */
+/** \name Tree Building
  *
- * vb is the voxel box around all of the primitives contained in
- * this node.
+ * Primitives are partitioned recursively, with large subtrees built in their own tasks.
+ * The hierarchy is built as #PBVHBuildNode first, then stored in #PBVH.nodes in the same order
+ * as building the tree recursively on a single thread, after which leaves are filled in parallel.
  *
- * cb is the bounding box around all the centroids of the primitives
- * contained in this node
+ * Large ranges are partitioned in parallel too, which changes the side of the split primitives
+ * at the middle end up on, see #BKE_pbvh_build_stable_layout_set.
+ * In both cases the node layout doesn't depend on the number of threads.
+ * \{ */
+
+/** Ranges with at least this many primitives calculate bounds and partition in parallel. */
+#define BUILD_PARALLEL_LIMIT (1 << 16)
+/** Block size for parallel partitioning, fixed so the result doesn't depend on threads. */
+#define BUILD_PARTITION_BLOCK (1 << 13)
+/** Subtrees with fewer primitives are built in the task of their parent. */
+#define BUILD_TASK_LIMIT (1 << 12)
+
+typedef struct PBVHBuildNode {
+  /** Pair of child nodes, NULL for leaves. */
+  struct PBVHBuildNode *children;
+  int offset, count;
+  /** Bounds of the primitives, only calculated for leaves. */
+  BB vb;
+} PBVHBuildNode;
+
+typedef struct PBVHBuildData {
+  PBVH *pbvh;
+  const BBC *prim_bbc;
+  /** Scratch space for parallel partitioning, same layout as #PBVH.prim_indices. */
+  int *prim_indices_tmp;
+  /** NULL when building on a single thread. */
+  TaskPool *task_pool;
+} PBVHBuildData;
+
+typedef struct PBVHBuildBoundsData {
+  const BBC *prim_bbc;
+  const int *prim_indices;
+  bool use_centroid;
+} PBVHBuildBoundsData;
+
+static void pbvh_build_bounds_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict tls)
+{
+  const PBVHBuildBoundsData *data = userdata;
+  BB *bb = tls->userdata_chunk;
+  const BBC *bbc = &data->prim_bbc[data->prim_indices[i]];
+  if (data->use_centroid) {
+    BB_expand(bb, bbc->bcentroid);
+  }
+  else {
+    BB_expand_with_bb(bb, (BB *)bbc);
+  }
+}
+
+static void pbvh_build_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                     void *__restrict chunk_join,
+                                     void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+/* Bounds of the primitives (or their centroids) in \a prim_indices. */
+static void pbvh_build_bounds(
+    const BBC *prim_bbc, const int *prim_indices, int count, bool use_centroid, BB *r_bb)
+{
+  PBVHBuildBoundsData data = {
+      .prim_bbc = prim_bbc,
+      .prim_indices = prim_indices,
+      .use_centroid = use_centroid,
+  };
+
+  BB_reset(r_bb);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = count >= BUILD_PARALLEL_LIMIT;
+  settings.min_iter_per_thread = BUILD_PARTITION_BLOCK;
+  settings.userdata_chunk = r_bb;
+  settings.userdata_chunk_size = sizeof(*r_bb);
+  settings.func_reduce = pbvh_build_bounds_reduce;
+  BLI_task_parallel_range(0, count, &data, pbvh_build_bounds_cb, &settings);
+}
+
+typedef struct PBVHBuildPartitionData {
+  const BBC *prim_bbc;
+  /* Both offset to the start of the range. */
+  int *prim_indices;
+  int *prim_indices_tmp;
+  int count;
+  int axis;
+  float mid;
+  /** Number of primitives left of the split for each block, then their offsets. */
+  int *block_left;
+  int totleft;
+} PBVHBuildPartitionData;
+
+BLI_INLINE int pbvh_build_partition_block_len(const PBVHBuildPartitionData *data, int block)
+{
+  return min_ii(BUILD_PARTITION_BLOCK, data->count - block * BUILD_PARTITION_BLOCK);
+}
+
+static void pbvh_build_partition_count_cb(void *__restrict userdata,
+                                          const int block,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildPartitionData *data = userdata;
+  const int *prim_indices = &data->prim_indices[block * BUILD_PARTITION_BLOCK];
+  const int len = pbvh_build_partition_block_len(data, block);
+  int left = 0;
+  for (int i = 0; i < len; i++) {
+    if (data->prim_bbc[prim_indices[i]].bcentroid[data->axis] < data->mid) {
+      left++;
+    }
+  }
+  data->block_left[block] = left;
+}
+
+static void pbvh_build_partition_scatter_cb(void *__restrict userdata,
+                                            const int block,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildPartitionData *data = userdata;
+  const int *prim_indices = &data->prim_indices[block * BUILD_PARTITION_BLOCK];
+  const int len = pbvh_build_partition_block_len(data, block);
+  int left = data->block_left[block];
+  int right = data->totleft + (block * BUILD_PARTITION_BLOCK - left);
+  for (int i = 0; i < len; i++) {
+    const int prim = prim_indices[i];
+    if (data->prim_bbc[prim].bcentroid[data->axis] < data->mid) {
+      data->prim_indices_tmp[left++] = prim;
+    }
+    else {
+      data->prim_indices_tmp[right++] = prim;
+    }
+  }
+}
+
+static void pbvh_build_partition_copy_cb(void *__restrict userdata,
+                                         const int block,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildPartitionData *data = userdata;
+  const int start = block * BUILD_PARTITION_BLOCK;
+  memcpy(&data->prim_indices[start],
+         &data->prim_indices_tmp[start],
+         sizeof(int) * (size_t)pbvh_build_partition_block_len(data, block));
+}
+
+/* Returns the index of the first element on the right of the partition */
+static int pbvh_build_partition(PBVHBuildData *build, int offset, int count, int axis, float mid)
+{
+  PBVH *pbvh = build->pbvh;
+
+  if ((build->prim_indices_tmp == NULL) || (count < BUILD_PARALLEL_LIMIT)) {
+    return partition_indices(
+        pbvh->prim_indices, offset, offset + count - 1, axis, mid, build->prim_bbc);
+  }
+
+  const int blocks_len = (count + BUILD_PARTITION_BLOCK - 1) / BUILD_PARTITION_BLOCK;
+  PBVHBuildPartitionData data = {
+      .prim_bbc = build->prim_bbc,
+      .prim_indices = &pbvh->prim_indices[offset],
+      .prim_indices_tmp = &build->prim_indices_tmp[offset],
+      .count = count,
+      .axis = axis,
+      .mid = mid,
+      .block_left = MEM_mallocN(sizeof(int) * (size_t)blocks_len, __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  BLI_task_parallel_range(0, blocks_len, &data, pbvh_build_partition_count_cb, &settings);
+  for (int block = 0; block < blocks_len; block++) {
+    const int left = data.block_left[block];
+    data.block_left[block] = data.totleft;
+    data.totleft += left;
+  }
+
+  int end;
+  if (ELEM(data.totleft, 0, count)) {
+    /* All centroids on one side of the middle, only the in-place partitioning
+     * splits primitives at the middle (so the range shrinks). */
+    end = partition_indices(
+        pbvh->prim_indices, offset, offset + count - 1, axis, mid, build->prim_bbc);
+  }
+  else {
+    BLI_task_parallel_range(0, blocks_len, &data, pbvh_build_partition_scatter_cb, &settings);
+    BLI_task_parallel_range(0, blocks_len, &data, pbvh_build_partition_copy_cb, &settings);
+    end = offset + data.totleft;
+  }
+
+  MEM_freeN(data.block_left);
+  return end;
+}
+
+static void pbvh_build_node(PBVHBuildData *build, PBVHBuildNode *node, const BB *cb);
+
+static void pbvh_build_node_task(TaskPool *__restrict pool, void *taskdata)
+{
+  pbvh_build_node(BLI_task_pool_user_data(pool), taskdata, NULL);
+}
+
+/* Recursively build a node in the tree
  *
- * offset and start indicate a range in the array of primitive indices
+ * cb is the bounding box around all the centroids of the primitives
+ * contained in this node, calculated when NULL.
  */
-
-static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int offset, int count)
+static void pbvh_build_node(PBVHBuildData *build, PBVHBuildNode *node, const BB *cb)
 {
+  PBVH *pbvh = build->pbvh;
+  const int offset = node->offset;
+  const int count = node->count;
   int end;
-  BB cb_backing;
 
   /* Decide whether this is a leaf or not */
   const bool below_leaf_limit = count <= pbvh->leaf_limit;
   if (below_leaf_limit) {
     if (!leaf_needs_material_split(pbvh, offset, count)) {
-      build_leaf(pbvh, node_index, prim_bbc, offset, count);
+      /* Still need vb for searches */
+      pbvh_build_bounds(build->prim_bbc, &pbvh->prim_indices[offset], count, false, &node->vb);
       return;
     }
   }
 
-  /* Add two child nodes */
-  pbvh->nodes[node_index].children_offset = pbvh->totnode;
-  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
-
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
   if (!below_leaf_limit) {
     /* Find axis with widest range of primitive centroids */
+    BB cb_backing;
     if (!cb) {
+      pbvh_build_bounds(build->prim_bbc, &pbvh->prim_indices[offset], count, true, &cb_backing);
       cb = &cb_backing;
-      BB_reset(cb);
-      for (int i = offset + count - 1; i >= offset; i--) {
-        BB_expand(cb, prim_bbc[pbvh->prim_indices[i]].bcentroid);
-      }
     }
     const int axis = BB_widest_axis(cb);
 
     /* Partition primitives along that axis */
-    end = partition_indices(pbvh->prim_indices,
-                            offset,
-                            offset + count - 1,
-                            axis,
-                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-                            prim_bbc);
+    end = pbvh_build_partition(
+        build, offset, count, axis, (cb->bmax[axis] + cb->bmin[axis]) * 0.5f);
   }
   else {
     /* Partition primitives by material */
@@ -522,13 +695,147 @@ static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int off
   }
 
   /* Build children */
-  build_sub(pbvh, pbvh->nodes[node_index].children_offset, NULL, prim_bbc, offset, end - offset);
-  build_sub(pbvh,
-            pbvh->nodes[node_index].children_offset + 1,
-            NULL,
-            prim_bbc,
-            end,
-            offset + count - end);
+  node->children = MEM_callocN(sizeof(PBVHBuildNode[2]), __func__);
+  node->children[0].offset = offset;
+  node->children[0].count = end - offset;
+  node->children[1].offset = end;
+  node->children[1].count = offset + count - end;
+
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = &node->children[i];
+    if (build->task_pool && (child->count >= BUILD_TASK_LIMIT)) {
+      BLI_task_pool_push(build->task_pool, pbvh_build_node_task, child, false, NULL);
+    }
+    else {
+      pbvh_build_node(build, child, NULL);
+    }
+  }
+}
+
+static int pbvh_build_node_count(const PBVHBuildNode *node)
+{
+  if (node->children == NULL) {
+    return 1;
+  }
+  return 1 + pbvh_build_node_count(&node->children[0]) +
+         pbvh_build_node_count(&node->children[1]);
+}
+
+static void pbvh_build_node_free_children(PBVHBuildNode *node)
+{
+  if (node->children) {
+    pbvh_build_node_free_children(&node->children[0]);
+    pbvh_build_node_free_children(&node->children[1]);
+    MEM_freeN(node->children);
+  }
+}
+
+/**
+ * Store nodes in the order of a recursive build, where both children are added
+ * before descending into the first one. Leaves are added to \a leaf_indices in build order.
+ */
+static void pbvh_build_node_store(PBVH *pbvh,
+                                  const PBVHBuildNode *bnode,
+                                  const int node_index,
+                                  int *r_totnode,
+                                  int *leaf_indices,
+                                  int *r_totleaf)
+{
+  PBVHNode *node = &pbvh->nodes[node_index];
+
+  if (bnode->children == NULL) {
+    node->flag |= PBVH_Leaf;
+    node->prim_indices = pbvh->prim_indices + bnode->offset;
+    node->totprim = bnode->count;
+    node->vb = bnode->vb;
+    leaf_indices[(*r_totleaf)++] = node_index;
+  }
+  else {
+    const int children_offset = *r_totnode;
+    node->children_offset = children_offset;
+    *r_totnode += 2;
+
+    pbvh_build_node_store(
+        pbvh, &bnode->children[0], children_offset, r_totnode, leaf_indices, r_totleaf);
+    pbvh_build_node_store(
+        pbvh, &bnode->children[1], children_offset + 1, r_totnode, leaf_indices, r_totleaf);
+
+    BB_reset(&node->vb);
+    BB_expand_with_bb(&node->vb, &pbvh->nodes[children_offset].vb);
+    BB_expand_with_bb(&node->vb, &pbvh->nodes[children_offset + 1].vb);
+  }
+
+  node->orig_vb = node->vb;
+}
+
+typedef struct PBVHBuildLeavesData {
+  PBVH *pbvh;
+  const int *leaf_indices;
+  /** For each vertex, the build order of the first leaf using it. */
+  int *vert_owner;
+} PBVHBuildLeavesData;
+
+static void pbvh_build_leaves_vert_owner_cb(void *__restrict userdata,
+                                            const int i,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeavesData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  const PBVHNode *node = &pbvh->nodes[data->leaf_indices[i]];
+
+  for (int p = 0; p < node->totprim; p++) {
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[p]];
+    for (int j = 0; j < 3; j++) {
+      int32_t *owner_p = (int32_t *)&data->vert_owner[pbvh->mloop[lt->tri[j]].v];
+      int32_t owner = *owner_p;
+      while (i < owner) {
+        const int32_t owner_prev = atomic_cas_int32(owner_p, owner, i);
+        if (owner_prev == owner) {
+          break;
+        }
+        owner = owner_prev;
+      }
+    }
+  }
+}
+
+static void pbvh_build_leaves_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeavesData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = &pbvh->nodes[data->leaf_indices[i]];
+
+  if (pbvh->looptri) {
+    build_mesh_leaf_node(pbvh, node, data->vert_owner, i);
+  }
+  else {
+    build_grid_leaf_node(pbvh, node);
+  }
+}
+
+static void pbvh_build_leaves(PBVH *pbvh, const int *leaf_indices, int totleaf)
+{
+  PBVHBuildLeavesData data = {
+      .pbvh = pbvh,
+      .leaf_indices = leaf_indices,
+  };
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, totleaf);
+
+  if (pbvh->looptri) {
+    /* Vertices are unique to the first leaf using them,
+     * matching a single threaded build which claims vertices leaf by leaf. */
+    data.vert_owner = MEM_mallocN(sizeof(int) * (size_t)pbvh->totvert, __func__);
+    copy_vn_i(data.vert_owner, pbvh->totvert, INT_MAX);
+    BLI_task_parallel_range(0, totleaf, &data, pbvh_build_leaves_vert_owner_cb, &settings);
+  }
+
+  BLI_task_parallel_range(0, totleaf, &data, pbvh_build_leaves_cb, &settings);
+
+  MEM_SAFE_FREE(data.vert_owner);
 }
 
 static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
@@ -537,6 +844,8 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
     pbvh->totprim = totprim;
     if (pbvh->nodes) {
       MEM_freeN(pbvh->nodes);
+      pbvh->nodes = NULL;
+      pbvh->node_mem_count = 0;
     }
     if (pbvh->prim_indices) {
       MEM_freeN(pbvh->prim_indices);
@@ -552,8 +861,124 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
     }
   }
 
-  pbvh->totnode = 1;
-  build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  PBVHBuildData build = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  if (!pbvh->build_stable_layout && (totprim >= BUILD_PARALLEL_LIMIT)) {
+    build.prim_indices_tmp = MEM_mallocN(sizeof(int) * (size_t)totprim, __func__);
+  }
+  if (totprim >= BUILD_TASK_LIMIT) {
+    build.task_pool = BLI_task_pool_create(&build, TASK_PRIORITY_HIGH);
+  }
+
+  PBVHBuildNode root = {
+      .offset = 0,
+      .count = totprim,
+  };
+  pbvh_build_node(&build, &root, cb);
+
+  if (build.task_pool) {
+    BLI_task_pool_work_and_wait(build.task_pool);
+    BLI_task_pool_free(build.task_pool);
+  }
+  MEM_SAFE_FREE(build.prim_indices_tmp);
+
+  const int totnode = pbvh_build_node_count(&root);
+  pbvh_grow_nodes(pbvh, totnode);
+  memset(pbvh->nodes, 0, sizeof(PBVHNode) * (size_t)totnode);
+
+  int *leaf_indices = MEM_mallocN(sizeof(int) * (size_t)totnode, __func__);
+  int node_index = 1, totleaf = 0;
+  pbvh_build_node_store(pbvh, &root, 0, &node_index, leaf_indices, &totleaf);
+  BLI_assert(node_index == totnode);
+  pbvh_build_node_free_children(&root);
+
+  pbvh_build_leaves(pbvh, leaf_indices, totleaf);
+  MEM_freeN(leaf_indices);
+}
+
+/** \} */
+
+typedef struct PBVHBuildBBCData {
+  const PBVH *pbvh;
+  BBC *prim_bbc;
+  const MVert *verts;
+} PBVHBuildBBCData;
+
+static void pbvh_build_bbc_reduce(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk_join,
+                                  void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+static void pbvh_build_bbc_mesh_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildBBCData *data = userdata;
+  const MLoopTri *lt = &data->pbvh->looptri[i];
+  const MLoop *mloop = data->pbvh->mloop;
+  BBC *bbc = &data->prim_bbc[i];
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < 3; j++) {
+    BB_expand((BB *)bbc, data->verts[mloop[lt->tri[j]].v].co);
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+static void pbvh_build_bbc_grids_cb(void *__restrict userdata,
+                                    const int i,
+                                    const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildBBCData *data = userdata;
+  const CCGKey *key = &data->pbvh->gridkey;
+  CCGElem *grid = data->pbvh->grids[i];
+  BBC *bbc = &data->prim_bbc[i];
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < key->grid_area; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+/* For each primitive, store the AABB and the AABB centroid,
+ * \a r_cb is the bounds of all centroids. */
+static BBC *pbvh_build_bbc(PBVH *pbvh, const MVert *verts, int totprim, BB *r_cb)
+{
+  PBVHBuildBBCData data = {
+      .pbvh = pbvh,
+      .prim_bbc = MEM_mallocN(sizeof(BBC) * totprim, "prim_bbc"),
+      .verts = verts,
+  };
+
+  BB_reset(r_cb);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = totprim >= BUILD_PARTITION_BLOCK;
+  settings.min_iter_per_thread = BUILD_PARTITION_BLOCK;
+  settings.userdata_chunk = r_cb;
+  settings.userdata_chunk_size = sizeof(*r_cb);
+  settings.func_reduce = pbvh_build_bbc_reduce;
+  BLI_task_parallel_range(0,
+                          totprim,
+                          &data,
+                          pbvh->looptri ? pbvh_build_bbc_mesh_cb : pbvh_build_bbc_grids_cb,
+                          &settings);
+
+  return data.prim_bbc;
 }
 
 /**
@@ -574,7 +999,7 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
                          const MLoopTri *looptri,
                          int looptri_num)
 {
-  BBC *prim_bbc = NULL;
+  const double time_start = PIL_check_seconds_timer();
   BB cb;
 
   pbvh->mesh = mesh;
@@ -583,7 +1008,6 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->mloop = mloop;
   pbvh->looptri = looptri;
   pbvh->verts = verts;
-  pbvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
   pbvh->totvert = totvert;
   pbvh->leaf_limit = LEAF_LIMIT;
   pbvh->vdata = vdata;
@@ -593,33 +1017,15 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->face_sets_color_seed = mesh->face_sets_color_seed;
   pbvh->face_sets_color_default = mesh->face_sets_color_default;
 
-  BB_reset(&cb);
-
-  /* For each face, store the AABB and the AABB centroid */
-  prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
-
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  BBC *prim_bbc = pbvh_build_bbc(pbvh, verts, looptri_num, &cb);
 
   if (looptri_num) {
     pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
   }
 
   MEM_freeN(prim_bbc);
-  MEM_freeN(pbvh->vert_bitmap);
+
+  pbvh->build_time = PIL_check_seconds_timer() - time_start;
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -631,6 +1037,7 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
                           DMFlagMat *flagmats,
                           BLI_bitmap **grid_hidden)
 {
+  const double time_start = PIL_check_seconds_timer();
   const int gridsize = key->grid_size;
 
   pbvh->type = PBVH_GRIDS;
@@ -643,31 +1050,25 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   pbvh->leaf_limit = max_ii(LEAF_LIMIT / (gridsize * gridsize), 1);
 
   BB cb;
-  BB_reset(&cb);
-
-  /* For each grid, store the AABB and the AABB centroid */
-  BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
-
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  BBC *prim_bbc = pbvh_build_bbc(pbvh, NULL, totgrid, &cb);
 
   if (totgrid) {
     pbvh_build(pbvh, &cb, prim_bbc, totgrid);
   }
 
   MEM_freeN(prim_bbc);
+
+  pbvh->build_time = PIL_check_seconds_timer() - time_start;
+}
+
+void BKE_pbvh_build_stable_layout_set(PBVH *pbvh, bool use_stable_layout)
+{
+  pbvh->build_stable_layout = use_stable_layout;
+}
+
+double BKE_pbvh_build_time_get(const PBVH *pbvh)
+{
+  return pbvh->build_time;
 }
 
 PBVH *BKE_pbvh_new(void)
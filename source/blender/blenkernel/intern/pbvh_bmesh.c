@@ -33,6 +33,8 @@
 
 #include "GPU_buffers.h"
 
+#include "PIL_time.h"
+
 #include "bmesh.h"
 #include "pbvh_intern.h"
 
@@ -1883,6 +1885,8 @@ void BKE_pbvh_build_bmesh(PBVH *pbvh,
                           const int cd_vert_node_offset,
                           const int cd_face_node_offset)
 {
+  const double time_start = PIL_check_seconds_timer();
+
   pbvh->cd_vert_node_offset = cd_vert_node_offset;
   pbvh->cd_face_node_offset = cd_face_node_offset;
   pbvh->bm = bm;
@@ -1951,6 +1955,8 @@ void BKE_pbvh_build_bmesh(PBVH *pbvh,
   BLI_memarena_free(arena);
   MEM_freeN(bbc_array);
   MEM_freeN(nodeinfo);
+
+  pbvh->build_time = PIL_check_seconds_timer() - time_start;
 }
 
 /* Collapse short edges, subdivide long edges */
@@ -127,6 +127,10 @@ struct PBVH {
   int totvert;
 
   int leaf_limit;
+  /* Partition on a single thread, giving the same layout as older versions. */
+  bool build_stable_layout;
+  /* Duration of the last full build, in seconds. */
+  double build_time;
 
   /* Mesh data */
   const struct Mesh *mesh;
@@ -150,10 +154,6 @@ struct PBVH {
   int totgrid;
   BLI_bitmap **grid_hidden;
 
-  /* Only used during BVH build and update,
-   * don't need to remain valid after */
-  BLI_bitmap *vert_bitmap;
-
 #ifdef PERFCNTRS
   int perf_modified;
 #endif
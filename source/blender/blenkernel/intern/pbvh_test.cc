@@ -0,0 +1,320 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_test_utils.hh"
+#include "BKE_pbvh.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math.h"
+#include "BLI_vector.hh"
+
+#include "PIL_time_utildefines.h"
+
+#include "bmesh.h"
+#include "bmesh_tools.h"
+
+#include <algorithm>
+#include <array>
+
+/* Run the biggest tests! */
+//#define PBVH_BUILD_RUN_BIG
+
+namespace blender::bke::tests {
+
+class pbvh_build : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+static PBVH *pbvh_build_mesh(Mesh *me, const bool use_stable_layout)
+{
+  const int looptri_num = poly_to_tri_count(me->totpoly, me->totloop);
+  MLoopTri *looptri = (MLoopTri *)MEM_malloc_arrayN(
+      looptri_num, sizeof(*looptri), "pbvh_test looptri");
+  BKE_mesh_recalc_looptri(me->mloop, me->mpoly, me->mvert, me->totloop, me->totpoly, looptri);
+
+  PBVH *pbvh = BKE_pbvh_new();
+  BKE_pbvh_build_stable_layout_set(pbvh, use_stable_layout);
+  BKE_pbvh_build_mesh(pbvh,
+                      me,
+                      me->mpoly,
+                      me->mloop,
+                      me->mvert,
+                      me->totvert,
+                      &me->vdata,
+                      &me->ldata,
+                      &me->pdata,
+                      looptri,
+                      looptri_num);
+  return pbvh;
+}
+
+/** Unique vertices of all leaves, in leaf order. */
+static Vector<int> pbvh_unique_verts(PBVH *pbvh)
+{
+  PBVHNode **nodes;
+  int totnode;
+  BKE_pbvh_search_gather(pbvh, nullptr, nullptr, &nodes, &totnode);
+
+  Vector<int> verts;
+  for (int i = 0; i < totnode; i++) {
+    int uniq_verts, totvert;
+    const int *vert_indices;
+    MVert *mvert;
+    BKE_pbvh_node_num_verts(pbvh, nodes[i], &uniq_verts, &totvert);
+    BKE_pbvh_node_get_verts(pbvh, nodes[i], &vert_indices, &mvert);
+
+    float bb_min[3], bb_max[3];
+    BKE_pbvh_node_get_BB(nodes[i], bb_min, bb_max);
+    for (int j = 0; j < totvert; j++) {
+      const float *co = mvert[vert_indices[j]].co;
+      EXPECT_TRUE(co[0] >= bb_min[0] && co[1] >= bb_min[1] && co[2] >= bb_min[2]);
+      EXPECT_TRUE(co[0] <= bb_max[0] && co[1] <= bb_max[1] && co[2] <= bb_max[2]);
+    }
+    verts.extend(Span<int>(vert_indices, uniq_verts));
+  }
+  MEM_SAFE_FREE(nodes);
+  return verts;
+}
+
+static void pbvh_build_layout_test(const int size)
+{
+  Mesh *me = mesh_test_grid_create(size);
+
+  PBVH *pbvh_stable = pbvh_build_mesh(me, true);
+  PBVH *pbvh_a = pbvh_build_mesh(me, false);
+  PBVH *pbvh_b = pbvh_build_mesh(me, false);
+
+  const Vector<int> verts_stable = pbvh_unique_verts(pbvh_stable);
+  const Vector<int> verts_a = pbvh_unique_verts(pbvh_a);
+  const Vector<int> verts_b = pbvh_unique_verts(pbvh_b);
+
+  /* Every vertex is unique to exactly one leaf. */
+  for (const Vector<int> *verts : {&verts_stable, &verts_a}) {
+    ASSERT_EQ(verts->size(), me->totvert);
+    Vector<int> count(me->totvert, 0);
+    for (const int v : *verts) {
+      count[v]++;
+    }
+    for (const int c : count) {
+      EXPECT_EQ(c, 1);
+    }
+  }
+
+  /* The layout doesn't depend on scheduling. */
+  EXPECT_EQ_ARRAY(verts_a.data(), verts_b.data(), verts_a.size());
+
+  BKE_pbvh_free(pbvh_stable);
+  BKE_pbvh_free(pbvh_a);
+  BKE_pbvh_free(pbvh_b);
+  BKE_id_free(nullptr, me);
+}
+
+TEST_F(pbvh_build, LayoutSmall)
+{
+  pbvh_build_layout_test(64);
+}
+
+/* Large enough for parallel partitioning. */
+TEST_F(pbvh_build, LayoutParallel)
+{
+  pbvh_build_layout_test(384);
+}
+
+#ifdef PBVH_BUILD_RUN_BIG
+static void pbvh_build_performance_test(const int size, const char *id)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  Mesh *me = mesh_test_grid_create(size);
+  PBVH *pbvh;
+  {
+    TIMEIT_START(stable_layout);
+    pbvh = pbvh_build_mesh(me, true);
+    TIMEIT_END(stable_layout);
+  }
+  BKE_pbvh_free(pbvh);
+  {
+    TIMEIT_START(parallel_layout);
+    pbvh = pbvh_build_mesh(me, false);
+    TIMEIT_END(parallel_layout);
+  }
+  printf("build time reported: %f\n", BKE_pbvh_build_time_get(pbvh));
+  BKE_pbvh_free(pbvh);
+  BKE_id_free(nullptr, me);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST_F(pbvh_build, Grid_2M)
+{
+  pbvh_build_performance_test(1000, "Grid 2M triangles");
+}
+
+TEST_F(pbvh_build, Grid_20M)
+{
+  pbvh_build_performance_test(3163, "Grid 20M triangles");
+}
+#endif
+
+/* -------------------------------------------------------------------- */
+/* Dynamic topology. */
+
+class pbvh_bmesh : public pbvh_build {
+};
+
+using StrokeReplayCo = std::array<float, 3>;
+using StrokeReplayTri = std::array<StrokeReplayCo, 3>;
+
+/** The result of a stroke replay, independent of the order of the BMesh elements. */
+struct StrokeReplayResult {
+  Vector<StrokeReplayCo> verts;
+  Vector<StrokeReplayTri> tris;
+};
+
+static StrokeReplayCo stroke_replay_co(const BMVert *v)
+{
+  return {v->co[0], v->co[1], v->co[2]};
+}
+
+static StrokeReplayResult stroke_replay_result_get(BMesh *bm)
+{
+  StrokeReplayResult result;
+  BMIter iter;
+  BMVert *v;
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    result.verts.append(stroke_replay_co(v));
+  }
+  BMFace *f;
+  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+    EXPECT_EQ(f->len, 3);
+    /* Rotate the triangle to start with its lowest coordinate, keeping the winding. */
+    BMLoop *l = BM_FACE_FIRST_LOOP(f);
+    StrokeReplayTri tri = {
+        stroke_replay_co(l->v), stroke_replay_co(l->next->v), stroke_replay_co(l->prev->v)};
+    std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+    result.tris.append(tri);
+  }
+  std::sort(result.verts.begin(), result.verts.end());
+  std::sort(result.tris.begin(), result.tris.end());
+  return result;
+}
+
+/**
+ * Replay a stroke along the diagonal of the grid, with a detail size finer than the grid so
+ * both subdivision and collapsing happen.
+ */
+static StrokeReplayResult pbvh_bmesh_stroke_replay(const int size, const int steps)
+{
+  /* Dynamic topology works on triangles and stores the nodes of the elements in layers. */
+  BMesh *bm = bmesh_test_grid_create(size, false);
+  BM_mesh_triangulate(bm, 0, 0, 4, false, nullptr, nullptr, nullptr);
+  BM_mesh_normals_update(bm);
+  BM_data_layer_add_named(bm, &bm->vdata, CD_PROP_INT32, "_dyntopo_node_id");
+  BM_data_layer_add_named(bm, &bm->pdata, CD_PROP_INT32, "_dyntopo_node_id");
+
+  BMLog *bm_log = BM_log_create(bm);
+
+  PBVH *pbvh = BKE_pbvh_new();
+  BKE_pbvh_build_bmesh(pbvh,
+                       bm,
+                       false,
+                       bm_log,
+                       CustomData_get_offset(&bm->vdata, CD_PROP_INT32),
+                       CustomData_get_offset(&bm->pdata, CD_PROP_INT32));
+  BKE_pbvh_bmesh_detail_size_set(pbvh, 0.4f);
+
+  /* Owned by the undo system otherwise. */
+  Vector<BMLogEntry *> log_entries;
+
+  const float radius = (float)size * 0.1f;
+  for (int step = 0; step < steps; step++) {
+    const float t = (float)step / (float)steps;
+    const float center[3] = {t * (float)size, t * (float)size, 0.0f};
+
+    log_entries.append(BM_log_entry_add(bm_log));
+
+    PBVHNode **nodes;
+    int totnode;
+    BKE_pbvh_search_gather(pbvh, nullptr, nullptr, &nodes, &totnode);
+    for (int i = 0; i < totnode; i++) {
+      BKE_pbvh_node_mark_topology_update(nodes[i]);
+    }
+    MEM_SAFE_FREE(nodes);
+
+    BKE_pbvh_bmesh_update_topology(pbvh,
+                                   PBVHTopologyUpdateMode(PBVH_Collapse | PBVH_Subdivide),
+                                   center,
+                                   nullptr,
+                                   radius,
+                                   false,
+                                   false);
+    BKE_pbvh_bmesh_after_stroke(pbvh);
+  }
+
+#ifdef DEBUG
+  EXPECT_TRUE(BM_mesh_validate(bm));
+#endif
+  StrokeReplayResult result = stroke_replay_result_get(bm);
+
+  BKE_pbvh_free(pbvh);
+  for (BMLogEntry *entry : log_entries) {
+    BM_log_entry_drop(entry);
+  }
+  BM_log_free(bm_log);
+  BM_mesh_free(bm);
+  return result;
+}
+
+TEST_F(pbvh_bmesh, StrokeReplay)
+{
+  const StrokeReplayResult result = pbvh_bmesh_stroke_replay(24, 8);
+
+  /* Subdivided along the stroke. */
+  EXPECT_GT(result.tris.size(), 24 * 24 * 2);
+  EXPECT_GT(result.verts.size(), 25 * 25);
+}
+
+#ifdef PBVH_BUILD_RUN_BIG
+TEST_F(pbvh_bmesh, StrokeReplayPerformance)
+{
+  printf("\n========== STARTING BMesh stroke replay ==========\n");
+  StrokeReplayResult result;
+  {
+    TIMEIT_START(stroke_replay);
+    result = pbvh_bmesh_stroke_replay(200, 64);
+    TIMEIT_END(stroke_replay);
+  }
+  printf("%d vertices, %d faces\n", (int)result.verts.size(), (int)result.tris.size());
+  printf("========== ENDED BMesh stroke replay ==========\n\n");
+}
+#endif
+
+}  // namespace blender::bke::tests
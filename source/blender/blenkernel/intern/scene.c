@@ -1138,6 +1138,7 @@ static void scene_blend_read_data(BlendDataReader *reader, ID *id)
     SEQ_ALL_BEGIN (ed, seq) {
       /* Do as early as possible, so that other parts of reading can rely on valid session UUID. */
       BKE_sequence_session_uuid_generate(seq);
+      seq->runtime.render_time = 0.0f;
 
       BLO_read_data_address(reader, &seq->seq1);
       BLO_read_data_address(reader, &seq->seq2);
@@ -35,6 +35,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
 #include "opensubdiv_evaluator_capi.h"
 #include "opensubdiv_topology_refiner_capi.h"
 
@@ -274,6 +275,66 @@ void BKE_subdiv_eval_final_point(
   }
 }
 
+/* ============================ Batched queries ============================ */
+
+/* Number of points converted to OpenSubdiv patch coordinates at a time. */
+#define PATCH_COORDS_BATCH_SIZE 256
+
+/* Derivatives are optional, evaluated when both r_dPdu and r_dPdv are given. */
+static void eval_limit_points(Subdiv *subdiv,
+                              const int *ptex_face_indices,
+                              const float (*uvs)[2],
+                              const int num_points,
+                              float (*r_P)[3],
+                              float (*r_dPdu)[3],
+                              float (*r_dPdv)[3])
+{
+  OpenSubdiv_Evaluator *evaluator = subdiv->evaluator;
+  OpenSubdiv_PatchCoord patch_coords[PATCH_COORDS_BATCH_SIZE];
+  for (int start = 0; start < num_points; start += PATCH_COORDS_BATCH_SIZE) {
+    const int num_patch_coords = min_ii(num_points - start, PATCH_COORDS_BATCH_SIZE);
+    for (int i = 0; i < num_patch_coords; i++) {
+      patch_coords[i].ptex_face = ptex_face_indices[start + i];
+      patch_coords[i].u = uvs[start + i][0];
+      patch_coords[i].v = uvs[start + i][1];
+    }
+    evaluator->evaluatePatchesLimit(evaluator,
+                                    patch_coords,
+                                    num_patch_coords,
+                                    r_P[start],
+                                    r_dPdu != NULL ? r_dPdu[start] : NULL,
+                                    r_dPdv != NULL ? r_dPdv[start] : NULL);
+  }
+}
+
+void BKE_subdiv_eval_limit_points(Subdiv *subdiv,
+                                  const int *ptex_face_indices,
+                                  const float (*uvs)[2],
+                                  const int num_points,
+                                  float (*r_P)[3])
+{
+  eval_limit_points(subdiv, ptex_face_indices, uvs, num_points, r_P, NULL, NULL);
+}
+
+void BKE_subdiv_eval_limit_points_and_derivatives(Subdiv *subdiv,
+                                                  const int *ptex_face_indices,
+                                                  const float (*uvs)[2],
+                                                  const int num_points,
+                                                  float (*r_P)[3],
+                                                  float (*r_dPdu)[3],
+                                                  float (*r_dPdv)[3])
+{
+  eval_limit_points(subdiv, ptex_face_indices, uvs, num_points, r_P, r_dPdu, r_dPdv);
+  /* Degenerate derivatives are rare, re-evaluate those points with the single point query which
+   * knows how to step away from them. */
+  for (int i = 0; i < num_points; i++) {
+    if ((is_zero_v3(r_dPdu[i]) || is_zero_v3(r_dPdv[i])) || equals_v3v3(r_dPdu[i], r_dPdv[i])) {
+      BKE_subdiv_eval_limit_point_and_derivatives(
+          subdiv, ptex_face_indices[i], uvs[i][0], uvs[i][1], r_P[i], r_dPdu[i], r_dPdv[i]);
+    }
+  }
+}
+
 /* ===================  Patch queries at given resolution =================== */
 
 /* Move buffer forward by a given number of bytes. */
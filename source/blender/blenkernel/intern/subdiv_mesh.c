@@ -30,10 +30,14 @@
 #include "DNA_meshdata_types.h"
 
 #include "BLI_alloca.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_math_base.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_key.h"
+#include "BKE_lib_id.h"
 #include "BKE_mesh.h"
 #include "BKE_subdiv.h"
 #include "BKE_subdiv_eval.h"
@@ -76,6 +80,20 @@ typedef struct SubdivMeshContext {
    * when it's not possible is when displacement is used. */
   bool can_evaluate_normals;
   bool have_displacement;
+  /* Ptex coordinates every subdivided vertex is evaluated at, recorded when the result is going
+   * to be kept in the deform-only cache. */
+  bool use_deform_cache;
+  int *cache_ptex_face_indices;
+  float (*cache_ptex_uv)[2];
+  /* Ptex coordinates the normals of corner and edge vertices are averaged from, in traversal
+   * order. Only recorded when normals are evaluated from the limit surface. */
+  int *cache_normal_vertex_indices;
+  int *cache_normal_ptex_face_indices;
+  float (*cache_normal_ptex_uv)[2];
+  int cache_normal_len, cache_normal_len_alloc;
+  /* Loose vertices and edges are not evaluated from ptex faces, the cache does not support
+   * them. */
+  bool have_loose_geometry;
 } SubdivMeshContext;
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -113,10 +131,26 @@ static void subdiv_mesh_prepare_accumulator(SubdivMeshContext *ctx, int num_vert
       sizeof(*ctx->accumulated_counters), num_vertices, "subdiv accumulated counters");
 }
 
+static void subdiv_mesh_prepare_deform_cache(SubdivMeshContext *ctx, int num_vertices)
+{
+  if (!ctx->use_deform_cache) {
+    return;
+  }
+  ctx->cache_ptex_face_indices = MEM_malloc_arrayN(
+      num_vertices, sizeof(*ctx->cache_ptex_face_indices), "subdiv cache ptex face indices");
+  ctx->cache_ptex_uv = MEM_malloc_arrayN(
+      num_vertices, sizeof(*ctx->cache_ptex_uv), "subdiv cache ptex uv");
+}
+
 static void subdiv_mesh_context_free(SubdivMeshContext *ctx)
 {
   MEM_SAFE_FREE(ctx->accumulated_normals);
   MEM_SAFE_FREE(ctx->accumulated_counters);
+  MEM_SAFE_FREE(ctx->cache_ptex_face_indices);
+  MEM_SAFE_FREE(ctx->cache_ptex_uv);
+  MEM_SAFE_FREE(ctx->cache_normal_vertex_indices);
+  MEM_SAFE_FREE(ctx->cache_normal_ptex_face_indices);
+  MEM_SAFE_FREE(ctx->cache_normal_ptex_uv);
 }
 
 /** \} */
@@ -425,47 +459,151 @@ static void loop_interpolation_end(LoopsForInterpolation *loop_interpolation)
 /** \name TLS
  * \{ */
 
+/* Number of elements interpolated with a single custom data call. */
+#define INTERPOLATION_BATCH_SIZE 64
+
+/* Subdivided elements which are interpolated from the same corner of a coarse poly. They are
+ * interpolated together once the batch is full or the interpolation moves to another corner. */
+typedef struct InterpolationBatch {
+  int dest_indices[INTERPOLATION_BATCH_SIZE];
+  float weights[INTERPOLATION_BATCH_SIZE][4];
+  /* Ptex coordinates of the loops, UV layers are evaluated after the interpolation. */
+  int ptex_face_indices[INTERPOLATION_BATCH_SIZE];
+  float ptex_uv[INTERPOLATION_BATCH_SIZE][2];
+  int len;
+} InterpolationBatch;
+
+/* Number of inner vertices evaluated with a single limit surface query. */
+#define EVALUATION_BATCH_SIZE 256
+
+/* Inner subdivided vertices which are waiting for their final position and normal. Nothing else
+ * reads or writes those during the traversal, so they are evaluated once the batch is full or
+ * the thread is done. */
+typedef struct EvaluationBatch {
+  int subdiv_vertex_indices[EVALUATION_BATCH_SIZE];
+  int ptex_face_indices[EVALUATION_BATCH_SIZE];
+  float ptex_uv[EVALUATION_BATCH_SIZE][2];
+  int len;
+} EvaluationBatch;
+
 typedef struct SubdivMeshTLS {
+  SubdivMeshContext *ctx;
+
+  EvaluationBatch evaluation_batch;
+
   bool vertex_interpolation_initialized;
   VerticesForInterpolation vertex_interpolation;
   const MPoly *vertex_interpolation_coarse_poly;
   int vertex_interpolation_coarse_corner;
+  InterpolationBatch vertex_batch;
 
   bool loop_interpolation_initialized;
   LoopsForInterpolation loop_interpolation;
   const MPoly *loop_interpolation_coarse_poly;
   int loop_interpolation_coarse_corner;
+  InterpolationBatch loop_batch;
 } SubdivMeshTLS;
 
-static void subdiv_mesh_tls_free(void *tls_v)
+static void subdiv_mesh_vertex_batch_flush(SubdivMeshTLS *tls)
 {
-  SubdivMeshTLS *tls = tls_v;
-  if (tls->vertex_interpolation_initialized) {
-    vertex_interpolation_end(&tls->vertex_interpolation);
-  }
-  if (tls->loop_interpolation_initialized) {
-    loop_interpolation_end(&tls->loop_interpolation);
+  InterpolationBatch *batch = &tls->vertex_batch;
+  if (batch->len == 0) {
+    return;
   }
+  const VerticesForInterpolation *vertex_interpolation = &tls->vertex_interpolation;
+  CustomData_interp_batch(vertex_interpolation->vertex_data,
+                          &tls->ctx->subdiv_mesh->vdata,
+                          vertex_interpolation->vertex_indices,
+                          &batch->weights[0][0],
+                          4,
+                          batch->dest_indices,
+                          batch->len);
+  batch->len = 0;
 }
 
-/** \} */
+static void subdiv_mesh_loop_batch_flush(SubdivMeshTLS *tls)
+{
+  InterpolationBatch *batch = &tls->loop_batch;
+  if (batch->len == 0) {
+    return;
+  }
+  SubdivMeshContext *ctx = tls->ctx;
+  const LoopsForInterpolation *loop_interpolation = &tls->loop_interpolation;
+  CustomData_interp_batch(loop_interpolation->loop_data,
+                          &ctx->subdiv_mesh->ldata,
+                          loop_interpolation->loop_indices,
+                          &batch->weights[0][0],
+                          4,
+                          batch->dest_indices,
+                          batch->len);
+  /* Overwrite interpolated UVs with the evaluated ones. */
+  for (int layer_index = 0; layer_index < ctx->num_uv_layers; layer_index++) {
+    for (int i = 0; i < batch->len; i++) {
+      MLoopUV *subdiv_loopuv = &ctx->uv_layers[layer_index][batch->dest_indices[i]];
+      BKE_subdiv_eval_face_varying(ctx->subdiv,
+                                   layer_index,
+                                   batch->ptex_face_indices[i],
+                                   batch->ptex_uv[i][0],
+                                   batch->ptex_uv[i][1],
+                                   subdiv_loopuv->uv);
+    }
+  }
+  batch->len = 0;
+}
 
-/* -------------------------------------------------------------------- */
-/** \name Evaluation helper functions
- * \{ */
+static void subdiv_mesh_evaluation_batch_flush(SubdivMeshTLS *tls)
+{
+  EvaluationBatch *batch = &tls->evaluation_batch;
+  if (batch->len == 0) {
+    return;
+  }
+  SubdivMeshContext *ctx = tls->ctx;
+  Subdiv *subdiv = ctx->subdiv;
+  MVert *subdiv_mvert = ctx->subdiv_mesh->mvert;
+  float P[EVALUATION_BATCH_SIZE][3];
+  float dPdu[EVALUATION_BATCH_SIZE][3], dPdv[EVALUATION_BATCH_SIZE][3];
+  BKE_subdiv_eval_limit_points_and_derivatives(subdiv,
+                                               batch->ptex_face_indices,
+                                               (const float(*)[2])batch->ptex_uv,
+                                               batch->len,
+                                               P,
+                                               dPdu,
+                                               dPdv);
+  for (int i = 0; i < batch->len; i++) {
+    MVert *subdiv_vert = &subdiv_mvert[batch->subdiv_vertex_indices[i]];
+    if (subdiv->displacement_evaluator == NULL) {
+      float N[3];
+      cross_v3_v3v3(N, dPdu[i], dPdv[i]);
+      normalize_v3(N);
+      copy_v3_v3(subdiv_vert->co, P[i]);
+      normal_float_to_short_v3(subdiv_vert->no, N);
+    }
+    else {
+      float D[3];
+      BKE_subdiv_eval_displacement(subdiv,
+                                   batch->ptex_face_indices[i],
+                                   batch->ptex_uv[i][0],
+                                   batch->ptex_uv[i][1],
+                                   dPdu[i],
+                                   dPdv[i],
+                                   D);
+      add_v3_v3v3(subdiv_vert->co, P[i], D);
+    }
+  }
+  batch->len = 0;
+}
 
-static void eval_final_point_and_vertex_normal(Subdiv *subdiv,
-                                               const int ptex_face_index,
-                                               const float u,
-                                               const float v,
-                                               float r_P[3],
-                                               short r_N[3])
+static void subdiv_mesh_tls_free(void *tls_v)
 {
-  if (subdiv->displacement_evaluator == NULL) {
-    BKE_subdiv_eval_limit_point_and_short_normal(subdiv, ptex_face_index, u, v, r_P, r_N);
+  SubdivMeshTLS *tls = tls_v;
+  subdiv_mesh_evaluation_batch_flush(tls);
+  if (tls->vertex_interpolation_initialized) {
+    subdiv_mesh_vertex_batch_flush(tls);
+    vertex_interpolation_end(&tls->vertex_interpolation);
   }
-  else {
-    BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, r_P);
+  if (tls->loop_interpolation_initialized) {
+    subdiv_mesh_loop_batch_flush(tls);
+    loop_interpolation_end(&tls->loop_interpolation);
   }
 }
 
@@ -526,6 +664,7 @@ static bool subdiv_mesh_topology_info(const SubdivForeachContext *foreach_contex
       subdiv_context->coarse_mesh, num_vertices, num_edges, 0, num_loops, num_polygons, mask);
   subdiv_mesh_ctx_cache_custom_data_layers(subdiv_context);
   subdiv_mesh_prepare_accumulator(subdiv_context, num_vertices);
+  subdiv_mesh_prepare_deform_cache(subdiv_context, num_vertices);
   return true;
 }
 
@@ -535,6 +674,48 @@ static bool subdiv_mesh_topology_info(const SubdivForeachContext *foreach_contex
 /** \name Vertex subdivision process
  * \{ */
 
+static void subdiv_vertex_cache_ptex_coord(const SubdivMeshContext *ctx,
+                                           const int subdiv_vertex_index,
+                                           const int ptex_face_index,
+                                           const float u,
+                                           const float v)
+{
+  if (ctx->cache_ptex_face_indices == NULL) {
+    return;
+  }
+  ctx->cache_ptex_face_indices[subdiv_vertex_index] = ptex_face_index;
+  ctx->cache_ptex_uv[subdiv_vertex_index][0] = u;
+  ctx->cache_ptex_uv[subdiv_vertex_index][1] = v;
+}
+
+/* Called from the single threaded pass over every corner and edge vertex of all ptex faces. */
+static void subdiv_vertex_cache_normal_ptex_coord(SubdivMeshContext *ctx,
+                                                  const int subdiv_vertex_index,
+                                                  const int ptex_face_index,
+                                                  const float u,
+                                                  const float v)
+{
+  if (ctx->cache_ptex_face_indices == NULL || !ctx->can_evaluate_normals) {
+    return;
+  }
+  if (ctx->cache_normal_len == ctx->cache_normal_len_alloc) {
+    ctx->cache_normal_len_alloc = max_ii(ctx->cache_normal_len_alloc * 2, 1024);
+    const size_t len_alloc = (size_t)ctx->cache_normal_len_alloc;
+    ctx->cache_normal_vertex_indices = MEM_reallocN(
+        ctx->cache_normal_vertex_indices, sizeof(*ctx->cache_normal_vertex_indices) * len_alloc);
+    ctx->cache_normal_ptex_face_indices = MEM_reallocN(
+        ctx->cache_normal_ptex_face_indices,
+        sizeof(*ctx->cache_normal_ptex_face_indices) * len_alloc);
+    ctx->cache_normal_ptex_uv = MEM_reallocN(ctx->cache_normal_ptex_uv,
+                                             sizeof(*ctx->cache_normal_ptex_uv) * len_alloc);
+  }
+  const int i = ctx->cache_normal_len++;
+  ctx->cache_normal_vertex_indices[i] = subdiv_vertex_index;
+  ctx->cache_normal_ptex_face_indices[i] = ptex_face_index;
+  ctx->cache_normal_ptex_uv[i][0] = u;
+  ctx->cache_normal_ptex_uv[i][1] = v;
+}
+
 static void subdiv_vertex_data_copy(const SubdivMeshContext *ctx,
                                     const MVert *coarse_vertex,
                                     MVert *subdiv_vertex)
@@ -548,25 +729,47 @@ static void subdiv_vertex_data_copy(const SubdivMeshContext *ctx,
 }
 
 static void subdiv_vertex_data_interpolate(const SubdivMeshContext *ctx,
+                                           SubdivMeshTLS *tls,
                                            MVert *subdiv_vertex,
-                                           const VerticesForInterpolation *vertex_interpolation,
                                            const float u,
                                            const float v)
 {
   const int subdiv_vertex_index = subdiv_vertex - ctx->subdiv_mesh->mvert;
-  const float weights[4] = {(1.0f - u) * (1.0f - v), u * (1.0f - v), u * v, (1.0f - u) * v};
-  CustomData_interp(vertex_interpolation->vertex_data,
-                    &ctx->subdiv_mesh->vdata,
-                    vertex_interpolation->vertex_indices,
-                    weights,
-                    NULL,
-                    4,
-                    subdiv_vertex_index);
+  /* Custom data is interpolated with the other vertices of the batch, none of the interpolated
+   * layers is accessed until then. */
+  InterpolationBatch *batch = &tls->vertex_batch;
+  if (batch->len == INTERPOLATION_BATCH_SIZE) {
+    subdiv_mesh_vertex_batch_flush(tls);
+  }
+  float *weights = batch->weights[batch->len];
+  weights[0] = (1.0f - u) * (1.0f - v);
+  weights[1] = u * (1.0f - v);
+  weights[2] = u * v;
+  weights[3] = (1.0f - u) * v;
+  batch->dest_indices[batch->len++] = subdiv_vertex_index;
   if (ctx->vert_origindex != NULL) {
     ctx->vert_origindex[subdiv_vertex_index] = ORIGINDEX_NONE;
   }
 }
 
+/* Position and normal of inner vertices are evaluated together with the other vertices of the
+ * batch. */
+static void subdiv_vertex_evaluate(SubdivMeshTLS *tls,
+                                   const int subdiv_vertex_index,
+                                   const int ptex_face_index,
+                                   const float u,
+                                   const float v)
+{
+  EvaluationBatch *batch = &tls->evaluation_batch;
+  if (batch->len == EVALUATION_BATCH_SIZE) {
+    subdiv_mesh_evaluation_batch_flush(tls);
+  }
+  batch->ptex_face_indices[batch->len] = ptex_face_index;
+  batch->ptex_uv[batch->len][0] = u;
+  batch->ptex_uv[batch->len][1] = v;
+  batch->subdiv_vertex_indices[batch->len++] = subdiv_vertex_index;
+}
+
 static void evaluate_vertex_and_apply_displacement_copy(const SubdivMeshContext *ctx,
                                                         const int ptex_face_index,
                                                         const float u,
@@ -604,7 +807,7 @@ static void evaluate_vertex_and_apply_displacement_interpolate(
     const int ptex_face_index,
     const float u,
     const float v,
-    VerticesForInterpolation *vertex_interpolation,
+    SubdivMeshTLS *tls,
     MVert *subdiv_vert)
 {
   const int subdiv_vertex_index = subdiv_vert - ctx->subdiv_mesh->mvert;
@@ -617,7 +820,7 @@ static void evaluate_vertex_and_apply_displacement_interpolate(
     mul_v3_fl(D, inv_num_accumulated);
   }
   /* Interpolate custom data and evaluate position. */
-  subdiv_vertex_data_interpolate(ctx, subdiv_vert, vertex_interpolation, u, v);
+  subdiv_vertex_data_interpolate(ctx, tls, subdiv_vert, u, v);
   BKE_subdiv_eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_vert->co);
   /* Apply displacement. */
   add_v3_v3(subdiv_vert->co, D);
@@ -644,6 +847,7 @@ static void subdiv_mesh_vertex_every_corner_or_edge(const SubdivForeachContext *
   MVert *subdiv_mvert = subdiv_mesh->mvert;
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_accumulate_vertex_normal_and_displacement(ctx, ptex_face_index, u, v, subdiv_vert);
+  subdiv_vertex_cache_normal_ptex_coord(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 static void subdiv_mesh_vertex_every_corner(const SubdivForeachContext *foreach_context,
@@ -694,6 +898,7 @@ static void subdiv_mesh_vertex_corner(const SubdivForeachContext *foreach_contex
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   evaluate_vertex_and_apply_displacement_copy(
       ctx, ptex_face_index, u, v, coarse_vert, subdiv_vert);
+  subdiv_vertex_cache_ptex_coord(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 static void subdiv_mesh_ensure_vertex_interpolation(SubdivMeshContext *ctx,
@@ -705,6 +910,7 @@ static void subdiv_mesh_ensure_vertex_interpolation(SubdivMeshContext *ctx,
   if (tls->vertex_interpolation_initialized) {
     if (tls->vertex_interpolation_coarse_poly != coarse_poly ||
         tls->vertex_interpolation_coarse_corner != coarse_corner) {
+      subdiv_mesh_vertex_batch_flush(tls);
       vertex_interpolation_end(&tls->vertex_interpolation);
       tls->vertex_interpolation_initialized = false;
     }
@@ -744,7 +950,8 @@ static void subdiv_mesh_vertex_edge(const SubdivForeachContext *foreach_context,
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   evaluate_vertex_and_apply_displacement_interpolate(
-      ctx, ptex_face_index, u, v, &tls->vertex_interpolation, subdiv_vert);
+      ctx, ptex_face_index, u, v, tls, subdiv_vert);
+  subdiv_vertex_cache_ptex_coord(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 static bool subdiv_mesh_is_center_vertex(const MPoly *coarse_poly, const float u, const float v)
@@ -783,7 +990,6 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
 {
   SubdivMeshContext *ctx = foreach_context->user_data;
   SubdivMeshTLS *tls = tls_v;
-  Subdiv *subdiv = ctx->subdiv;
   const Mesh *coarse_mesh = ctx->coarse_mesh;
   const MPoly *coarse_mpoly = coarse_mesh->mpoly;
   const MPoly *coarse_poly = &coarse_mpoly[coarse_poly_index];
@@ -791,10 +997,10 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_mvert = subdiv_mesh->mvert;
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
-  subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
-  eval_final_point_and_vertex_normal(
-      subdiv, ptex_face_index, u, v, subdiv_vert->co, subdiv_vert->no);
+  subdiv_vertex_data_interpolate(ctx, tls, subdiv_vert, u, v);
+  subdiv_vertex_evaluate(tls, subdiv_vertex_index, ptex_face_index, u, v);
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
+  subdiv_vertex_cache_ptex_coord(ctx, subdiv_vertex_index, ptex_face_index, u, v);
 }
 
 /** \} */
@@ -855,38 +1061,29 @@ static void subdiv_mesh_edge(const SubdivForeachContext *foreach_context,
  * \{ */
 
 static void subdiv_interpolate_loop_data(const SubdivMeshContext *ctx,
+                                         SubdivMeshTLS *tls,
                                          MLoop *subdiv_loop,
-                                         const LoopsForInterpolation *loop_interpolation,
+                                         const int ptex_face_index,
                                          const float u,
                                          const float v)
 {
   const int subdiv_loop_index = subdiv_loop - ctx->subdiv_mesh->mloop;
-  const float weights[4] = {(1.0f - u) * (1.0f - v), u * (1.0f - v), u * v, (1.0f - u) * v};
-  CustomData_interp(loop_interpolation->loop_data,
-                    &ctx->subdiv_mesh->ldata,
-                    loop_interpolation->loop_indices,
-                    weights,
-                    NULL,
-                    4,
-                    subdiv_loop_index);
-  /* TODO(sergey): Set ORIGINDEX. */
-}
-
-static void subdiv_eval_uv_layer(SubdivMeshContext *ctx,
-                                 MLoop *subdiv_loop,
-                                 const int ptex_face_index,
-                                 const float u,
-                                 const float v)
-{
-  if (ctx->num_uv_layers == 0) {
-    return;
-  }
-  Subdiv *subdiv = ctx->subdiv;
-  const int mloop_index = subdiv_loop - ctx->subdiv_mesh->mloop;
-  for (int layer_index = 0; layer_index < ctx->num_uv_layers; layer_index++) {
-    MLoopUV *subdiv_loopuv = &ctx->uv_layers[layer_index][mloop_index];
-    BKE_subdiv_eval_face_varying(subdiv, layer_index, ptex_face_index, u, v, subdiv_loopuv->uv);
+  /* Custom data is interpolated and UV layers are evaluated with the other loops of the batch,
+   * none of the interpolated layers is accessed until then. */
+  InterpolationBatch *batch = &tls->loop_batch;
+  if (batch->len == INTERPOLATION_BATCH_SIZE) {
+    subdiv_mesh_loop_batch_flush(tls);
   }
+  float *weights = batch->weights[batch->len];
+  weights[0] = (1.0f - u) * (1.0f - v);
+  weights[1] = u * (1.0f - v);
+  weights[2] = u * v;
+  weights[3] = (1.0f - u) * v;
+  batch->ptex_face_indices[batch->len] = ptex_face_index;
+  batch->ptex_uv[batch->len][0] = u;
+  batch->ptex_uv[batch->len][1] = v;
+  batch->dest_indices[batch->len++] = subdiv_loop_index;
+  /* TODO(sergey): Set ORIGINDEX. */
 }
 
 static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
@@ -898,6 +1095,7 @@ static void subdiv_mesh_ensure_loop_interpolation(SubdivMeshContext *ctx,
   if (tls->loop_interpolation_initialized) {
     if (tls->loop_interpolation_coarse_poly != coarse_poly ||
         tls->loop_interpolation_coarse_corner != coarse_corner) {
+      subdiv_mesh_loop_batch_flush(tls);
       loop_interpolation_end(&tls->loop_interpolation);
       tls->loop_interpolation_initialized = false;
     }
@@ -938,8 +1136,7 @@ static void subdiv_mesh_loop(const SubdivForeachContext *foreach_context,
   MLoop *subdiv_mloop = subdiv_mesh->mloop;
   MLoop *subdiv_loop = &subdiv_mloop[subdiv_loop_index];
   subdiv_mesh_ensure_loop_interpolation(ctx, tls, coarse_poly, coarse_corner);
-  subdiv_interpolate_loop_data(ctx, subdiv_loop, &tls->loop_interpolation, u, v);
-  subdiv_eval_uv_layer(ctx, subdiv_loop, ptex_face_index, u, v);
+  subdiv_interpolate_loop_data(ctx, tls, subdiv_loop, ptex_face_index, u, v);
   subdiv_loop->v = subdiv_vertex_index;
   subdiv_loop->e = subdiv_edge_index;
 }
@@ -999,6 +1196,7 @@ static void subdiv_mesh_vertex_loose(const SubdivForeachContext *foreach_context
   MVert *subdiv_mvert = subdiv_mesh->mvert;
   MVert *subdiv_vertex = &subdiv_mvert[subdiv_vertex_index];
   subdiv_vertex_data_copy(ctx, coarse_vertex, subdiv_vertex);
+  ctx->have_loose_geometry = true;
 }
 
 /* Get neighbor edges of the given one.
@@ -1121,6 +1319,7 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
   Mesh *subdiv_mesh = ctx->subdiv_mesh;
   MVert *subdiv_mvert = subdiv_mesh->mvert;
   const bool is_simple = ctx->subdiv->settings.is_simple;
+  ctx->have_loose_geometry = true;
   /* Find neighbors of the current loose edge. */
   const MEdge *neighbors[2];
   find_edge_neighbors(ctx, coarse_edge, neighbors);
@@ -1188,13 +1387,372 @@ static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Deform-only cache
+ * \{ */
+
+typedef struct SubdivMeshCache {
+  SubdivToMeshSettings settings;
+  /* Everything of the coarse mesh the result depends on, except of the vertex positions. */
+  int coarse_totvert, coarse_totedge, coarse_totloop, coarse_totpoly;
+  uint32_t coarse_hash;
+  /* Compared on a hash match, so a hash collision can't re-use the wrong topology. */
+  MEdge *coarse_medge;
+  MLoop *coarse_mloop;
+  MPoly *coarse_mpoly;
+  /* Result of the subdivision, is copied for every re-use. NULL until the coarse mesh got
+   * evaluated twice with the same topology: a mesh which is not deformed over and over again
+   * does not keep a copy of its result around. */
+  Mesh *mesh;
+  /* Ptex coordinates every vertex of the mesh was evaluated at. */
+  int *ptex_face_indices;
+  float (*ptex_uv)[2];
+  /* Corner and edge vertices come first, their positions are evaluated without derivatives.
+   * Inner vertices come after them. */
+  int num_boundary_vertices;
+  /* Normals are evaluated from the limit surface. Inner vertices use the derivatives at their
+   * own ptex coordinate. Corner and edge vertices average the normals at every ptex coordinate
+   * they are shared by: those of vertex i are normal_ptex_*[normal_offsets[i]] until
+   * normal_ptex_*[normal_offsets[i + 1]]. */
+  bool use_limit_normals;
+  int *normal_offsets;
+  int *normal_ptex_face_indices;
+  float (*normal_ptex_uv)[2];
+} SubdivMeshCache;
+
+static void subdiv_mesh_cache_hash_custom_data(BLI_HashMurmur2A *mm2,
+                                               const CustomData *data,
+                                               const int num_elements)
+{
+  for (int layer_index = 0; layer_index < data->totlayer; layer_index++) {
+    const CustomDataLayer *layer = &data->layers[layer_index];
+    BLI_hash_mm2a_add_int(mm2, layer->type);
+    BLI_hash_mm2a_add(mm2, (const uchar *)layer->name, strlen(layer->name));
+    /* The active layers are copied to the result, switching them must not re-use it. */
+    BLI_hash_mm2a_add_int(mm2, layer->active);
+    BLI_hash_mm2a_add_int(mm2, layer->active_rnd);
+    BLI_hash_mm2a_add_int(mm2, layer->active_clone);
+    BLI_hash_mm2a_add_int(mm2, layer->active_mask);
+    switch (layer->type) {
+      case CD_MVERT: {
+        const MVert *mvert = layer->data;
+        for (int i = 0; i < num_elements; i++) {
+          BLI_hash_mm2a_add_int(mm2, mvert[i].flag);
+          BLI_hash_mm2a_add_int(mm2, mvert[i].bweight);
+        }
+        break;
+      }
+      case CD_MDEFORMVERT: {
+        const MDeformVert *dvert = layer->data;
+        for (int i = 0; i < num_elements; i++) {
+          BLI_hash_mm2a_add_int(mm2, dvert[i].totweight);
+          BLI_hash_mm2a_add(
+              mm2, (const uchar *)dvert[i].dw, sizeof(*dvert[i].dw) * dvert[i].totweight);
+        }
+        break;
+      }
+      case CD_NORMAL:
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+        /* Derived from positions, or not interpolated to the subdivided mesh. */
+        break;
+      default:
+        BLI_hash_mm2a_add(
+            mm2, layer->data, (size_t)CustomData_sizeof(layer->type) * (size_t)num_elements);
+        break;
+    }
+  }
+}
+
+static uint32_t subdiv_mesh_cache_coarse_hash(const Mesh *coarse_mesh)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  subdiv_mesh_cache_hash_custom_data(&mm2, &coarse_mesh->vdata, coarse_mesh->totvert);
+  subdiv_mesh_cache_hash_custom_data(&mm2, &coarse_mesh->edata, coarse_mesh->totedge);
+  subdiv_mesh_cache_hash_custom_data(&mm2, &coarse_mesh->ldata, coarse_mesh->totloop);
+  subdiv_mesh_cache_hash_custom_data(&mm2, &coarse_mesh->pdata, coarse_mesh->totpoly);
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+/* Whether the result can be re-used for the coarse mesh with new vertex positions at all. Only
+ * positions are evaluated on re-use, so all other data must not depend on them. */
+static bool subdiv_mesh_cache_is_supported(const SubdivMeshContext *ctx)
+{
+  return !ctx->have_displacement && !CustomData_has_layer(&ctx->coarse_mesh->ldata, CD_NORMAL);
+}
+
+static bool subdiv_mesh_cache_topology_matches(const SubdivMeshCache *cache,
+                                               const Mesh *coarse_mesh)
+{
+  for (int i = 0; i < coarse_mesh->totedge; i++) {
+    const MEdge *med = &coarse_mesh->medge[i];
+    if (med->v1 != cache->coarse_medge[i].v1 || med->v2 != cache->coarse_medge[i].v2) {
+      return false;
+    }
+  }
+  for (int i = 0; i < coarse_mesh->totloop; i++) {
+    const MLoop *ml = &coarse_mesh->mloop[i];
+    if (ml->v != cache->coarse_mloop[i].v || ml->e != cache->coarse_mloop[i].e) {
+      return false;
+    }
+  }
+  for (int i = 0; i < coarse_mesh->totpoly; i++) {
+    const MPoly *mp = &coarse_mesh->mpoly[i];
+    if (mp->loopstart != cache->coarse_mpoly[i].loopstart ||
+        mp->totloop != cache->coarse_mpoly[i].totloop) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool subdiv_mesh_cache_matches(const SubdivMeshCache *cache,
+                                      const SubdivMeshContext *ctx,
+                                      const SubdivToMeshSettings *settings,
+                                      const uint32_t coarse_hash)
+{
+  const Mesh *coarse_mesh = ctx->coarse_mesh;
+  return cache->settings.resolution == settings->resolution &&
+         cache->settings.use_optimal_display == settings->use_optimal_display &&
+         cache->use_limit_normals == ctx->can_evaluate_normals &&
+         cache->coarse_totvert == coarse_mesh->totvert &&
+         cache->coarse_totedge == coarse_mesh->totedge &&
+         cache->coarse_totloop == coarse_mesh->totloop &&
+         cache->coarse_totpoly == coarse_mesh->totpoly && cache->coarse_hash == coarse_hash &&
+         subdiv_mesh_cache_topology_matches(cache, coarse_mesh);
+}
+
+/* Sort the recorded normal ptex coordinates by vertex, so every vertex can be evaluated on its
+ * own. */
+static void subdiv_mesh_cache_store_normals(SubdivMeshCache *cache, const SubdivMeshContext *ctx)
+{
+  const int num_boundary_vertices = cache->num_boundary_vertices;
+  const int len = ctx->cache_normal_len;
+  int *offsets = MEM_calloc_arrayN(
+      (size_t)num_boundary_vertices + 1, sizeof(*offsets), "subdiv cache normal offsets");
+  for (int i = 0; i < len; i++) {
+    BLI_assert(ctx->cache_normal_vertex_indices[i] < num_boundary_vertices);
+    offsets[ctx->cache_normal_vertex_indices[i] + 1]++;
+  }
+  for (int i = 0; i < num_boundary_vertices; i++) {
+    offsets[i + 1] += offsets[i];
+  }
+  cache->normal_offsets = offsets;
+  cache->normal_ptex_face_indices = MEM_malloc_arrayN(
+      (uint)len, sizeof(*cache->normal_ptex_face_indices), "subdiv cache normal ptex faces");
+  cache->normal_ptex_uv = MEM_malloc_arrayN(
+      (uint)len, sizeof(*cache->normal_ptex_uv), "subdiv cache normal ptex uv");
+
+  /* Fill in traversal order, stepping the offsets and shifting them back afterwards. */
+  for (int i = 0; i < len; i++) {
+    const int dst = offsets[ctx->cache_normal_vertex_indices[i]]++;
+    cache->normal_ptex_face_indices[dst] = ctx->cache_normal_ptex_face_indices[i];
+    copy_v2_v2(cache->normal_ptex_uv[dst], ctx->cache_normal_ptex_uv[i]);
+  }
+  memmove(&offsets[1], &offsets[0], sizeof(*offsets) * (size_t)num_boundary_vertices);
+  offsets[0] = 0;
+}
+
+/* Remembers what the result depends on, the result itself is only stored the next time the
+ * same coarse mesh is evaluated. */
+static void subdiv_mesh_cache_store_key(SubdivMeshContext *ctx,
+                                        const SubdivToMeshSettings *settings,
+                                        const uint32_t coarse_hash)
+{
+  Subdiv *subdiv = ctx->subdiv;
+  const Mesh *coarse_mesh = ctx->coarse_mesh;
+  BKE_subdiv_mesh_cache_free(subdiv);
+  SubdivMeshCache *cache = MEM_callocN(sizeof(*cache), "subdiv mesh cache");
+  cache->settings = *settings;
+  cache->coarse_totvert = coarse_mesh->totvert;
+  cache->coarse_totedge = coarse_mesh->totedge;
+  cache->coarse_totloop = coarse_mesh->totloop;
+  cache->coarse_totpoly = coarse_mesh->totpoly;
+  cache->coarse_hash = coarse_hash;
+  cache->coarse_medge = MEM_dupallocN(coarse_mesh->medge);
+  cache->coarse_mloop = MEM_dupallocN(coarse_mesh->mloop);
+  cache->coarse_mpoly = MEM_dupallocN(coarse_mesh->mpoly);
+  cache->use_limit_normals = ctx->can_evaluate_normals;
+  subdiv->cache_.mesh_cache = cache;
+}
+
+/* Takes ownership of the recorded ptex coordinates. */
+static void subdiv_mesh_cache_store(SubdivMeshContext *ctx, Mesh *result)
+{
+  SubdivMeshCache *cache = ctx->subdiv->cache_.mesh_cache;
+  const Mesh *coarse_mesh = ctx->coarse_mesh;
+  BLI_assert(cache->mesh == NULL);
+  cache->mesh = BKE_mesh_copy_for_eval(result, false);
+  cache->ptex_face_indices = ctx->cache_ptex_face_indices;
+  cache->ptex_uv = ctx->cache_ptex_uv;
+  cache->num_boundary_vertices = coarse_mesh->totvert +
+                                 coarse_mesh->totedge * (cache->settings.resolution - 2);
+  if (cache->use_limit_normals) {
+    subdiv_mesh_cache_store_normals(cache, ctx);
+  }
+  ctx->cache_ptex_face_indices = NULL;
+  ctx->cache_ptex_uv = NULL;
+}
+
+typedef struct SubdivMeshCacheEvalData {
+  Subdiv *subdiv;
+  const SubdivMeshCache *cache;
+  MVert *mvert;
+} SubdivMeshCacheEvalData;
+
+static void subdiv_mesh_cache_eval_positions(const SubdivMeshCacheEvalData *data,
+                                             const int start,
+                                             const int num_vertices,
+                                             const bool is_inner)
+{
+  if (num_vertices <= 0) {
+    return;
+  }
+  const SubdivMeshCache *cache = data->cache;
+  float P[EVALUATION_BATCH_SIZE][3];
+  if (is_inner) {
+    /* Same as the batched evaluation of inner vertices, which might step away from degenerate
+     * derivatives. */
+    float dPdu[EVALUATION_BATCH_SIZE][3], dPdv[EVALUATION_BATCH_SIZE][3];
+    BKE_subdiv_eval_limit_points_and_derivatives(data->subdiv,
+                                                 &cache->ptex_face_indices[start],
+                                                 (const float(*)[2])&cache->ptex_uv[start],
+                                                 num_vertices,
+                                                 P,
+                                                 dPdu,
+                                                 dPdv);
+    if (cache->use_limit_normals) {
+      for (int i = 0; i < num_vertices; i++) {
+        float N[3];
+        cross_v3_v3v3(N, dPdu[i], dPdv[i]);
+        normalize_v3(N);
+        normal_float_to_short_v3(data->mvert[start + i].no, N);
+      }
+    }
+  }
+  else {
+    BKE_subdiv_eval_limit_points(data->subdiv,
+                                 &cache->ptex_face_indices[start],
+                                 (const float(*)[2])&cache->ptex_uv[start],
+                                 num_vertices,
+                                 P);
+  }
+  for (int i = 0; i < num_vertices; i++) {
+    copy_v3_v3(data->mvert[start + i].co, P[i]);
+  }
+}
+
+/* Same averaging as the accumulation of corner and edge vertex normals in the full path. */
+static void subdiv_mesh_cache_eval_boundary_normals(const SubdivMeshCacheEvalData *data,
+                                                    const int start,
+                                                    const int num_vertices)
+{
+  if (num_vertices <= 0) {
+    return;
+  }
+  const SubdivMeshCache *cache = data->cache;
+  BLI_assert(num_vertices <= EVALUATION_BATCH_SIZE);
+  float N_accum[EVALUATION_BATCH_SIZE][3] = {{0.0f}};
+  float P[EVALUATION_BATCH_SIZE][3];
+  float dPdu[EVALUATION_BATCH_SIZE][3], dPdv[EVALUATION_BATCH_SIZE][3];
+  const int *offsets = cache->normal_offsets;
+  const int coord_end = offsets[start + num_vertices];
+  int vertex = start;
+  for (int coord_start = offsets[start]; coord_start < coord_end;
+       coord_start += EVALUATION_BATCH_SIZE) {
+    const int num_coords = min_ii(coord_end - coord_start, EVALUATION_BATCH_SIZE);
+    BKE_subdiv_eval_limit_points_and_derivatives(
+        data->subdiv,
+        &cache->normal_ptex_face_indices[coord_start],
+        (const float(*)[2])&cache->normal_ptex_uv[coord_start],
+        num_coords,
+        P,
+        dPdu,
+        dPdv);
+    for (int i = 0; i < num_coords; i++) {
+      while (offsets[vertex + 1] <= coord_start + i) {
+        vertex++;
+      }
+      float N[3];
+      cross_v3_v3v3(N, dPdu[i], dPdv[i]);
+      normalize_v3(N);
+      add_v3_v3(N_accum[vertex - start], N);
+    }
+  }
+  for (int i = 0; i < num_vertices; i++) {
+    normalize_v3(N_accum[i]);
+    normal_float_to_short_v3(data->mvert[start + i].no, N_accum[i]);
+  }
+}
+
+static void subdiv_mesh_cache_eval_task(void *__restrict userdata,
+                                        const int batch_index,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const SubdivMeshCacheEvalData *data = userdata;
+  const SubdivMeshCache *cache = data->cache;
+  const int start = batch_index * EVALUATION_BATCH_SIZE;
+  const int end = min_ii(start + EVALUATION_BATCH_SIZE, cache->mesh->totvert);
+  const int boundary_end = min_ii(end, cache->num_boundary_vertices);
+  subdiv_mesh_cache_eval_positions(data, start, boundary_end - start, false);
+  if (cache->use_limit_normals) {
+    subdiv_mesh_cache_eval_boundary_normals(data, start, boundary_end - start);
+  }
+  const int inner_start = max_ii(start, cache->num_boundary_vertices);
+  subdiv_mesh_cache_eval_positions(data, inner_start, end - inner_start, true);
+}
+
+static Mesh *subdiv_mesh_cache_eval(Subdiv *subdiv)
+{
+  const SubdivMeshCache *cache = subdiv->cache_.mesh_cache;
+  Mesh *result = BKE_mesh_copy_for_eval(cache->mesh, false);
+  SubdivMeshCacheEvalData data = {
+      .subdiv = subdiv,
+      .cache = cache,
+      .mvert = result->mvert,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  const int num_batches = divide_ceil_u(result->totvert, EVALUATION_BATCH_SIZE);
+  BLI_task_parallel_range(0, num_batches, &data, subdiv_mesh_cache_eval_task, &settings);
+  if (!cache->use_limit_normals) {
+    result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  }
+  return result;
+}
+
+void BKE_subdiv_mesh_cache_free(Subdiv *subdiv)
+{
+  SubdivMeshCache *cache = subdiv->cache_.mesh_cache;
+  if (cache == NULL) {
+    return;
+  }
+  if (cache->mesh != NULL) {
+    BKE_id_free(NULL, cache->mesh);
+  }
+  MEM_SAFE_FREE(cache->coarse_medge);
+  MEM_SAFE_FREE(cache->coarse_mloop);
+  MEM_SAFE_FREE(cache->coarse_mpoly);
+  MEM_SAFE_FREE(cache->ptex_face_indices);
+  MEM_SAFE_FREE(cache->ptex_uv);
+  MEM_SAFE_FREE(cache->normal_offsets);
+  MEM_SAFE_FREE(cache->normal_ptex_face_indices);
+  MEM_SAFE_FREE(cache->normal_ptex_uv);
+  MEM_freeN(cache);
+  subdiv->cache_.mesh_cache = NULL;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Public entry point
  * \{ */
 
-Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
-                         const SubdivToMeshSettings *settings,
-                         const Mesh *coarse_mesh)
+static Mesh *subdiv_to_mesh(Subdiv *subdiv,
+                            const SubdivToMeshSettings *settings,
+                            const Mesh *coarse_mesh,
+                            const bool use_deform_cache)
 {
   BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
   /* Make sure evaluator is up to date with possible new topology, and that
@@ -1218,11 +1776,38 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   subdiv_context.have_displacement = (subdiv->displacement_evaluator != NULL);
   subdiv_context.can_evaluate_normals = !subdiv_context.have_displacement &&
                                         subdiv_context.subdiv->settings.is_adaptive;
+  /* Re-use the previous result if only the vertex positions changed. */
+  uint32_t coarse_hash = 0;
+  bool is_cache_supported = false;
+  if (use_deform_cache) {
+    is_cache_supported = subdiv_mesh_cache_is_supported(&subdiv_context);
+  }
+  if (is_cache_supported) {
+    coarse_hash = subdiv_mesh_cache_coarse_hash(coarse_mesh);
+    const SubdivMeshCache *cache = subdiv->cache_.mesh_cache;
+    /* Same coarse mesh as last time, except of the vertex positions. */
+    bool is_stable = false;
+    if (cache != NULL) {
+      is_stable = subdiv_mesh_cache_matches(cache, &subdiv_context, settings, coarse_hash);
+    }
+    if (is_stable && cache->mesh != NULL) {
+      subdiv->stats.mesh_cache_hits++;
+      BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
+      Mesh *result = subdiv_mesh_cache_eval(subdiv);
+      BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
+      BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
+      return result;
+    }
+    subdiv->stats.mesh_cache_misses++;
+    /* Only record the ptex coordinates when the result is going to be stored. */
+    subdiv_context.use_deform_cache = is_stable;
+  }
   /* Multi-threaded traversal/evaluation. */
   BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   SubdivForeachContext foreach_context;
   setup_foreach_callbacks(&subdiv_context, &foreach_context);
   SubdivMeshTLS tls = {0};
+  tls.ctx = &subdiv_context;
   foreach_context.user_data = &subdiv_context;
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
   foreach_context.user_data_tls = &tls;
@@ -1230,6 +1815,17 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   Mesh *result = subdiv_context.subdiv_mesh;
   // BKE_mesh_validate(result, true, true);
+  if (!is_cache_supported || subdiv_context.have_loose_geometry) {
+    if (use_deform_cache) {
+      BKE_subdiv_mesh_cache_free(subdiv);
+    }
+  }
+  else if (subdiv_context.use_deform_cache) {
+    subdiv_mesh_cache_store(&subdiv_context, result);
+  }
+  else {
+    subdiv_mesh_cache_store_key(&subdiv_context, settings, coarse_hash);
+  }
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
   if (!subdiv_context.can_evaluate_normals) {
     result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
@@ -1239,4 +1835,18 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   return result;
 }
 
+Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
+                         const SubdivToMeshSettings *settings,
+                         const Mesh *coarse_mesh)
+{
+  return subdiv_to_mesh(subdiv, settings, coarse_mesh, false);
+}
+
+Mesh *BKE_subdiv_to_mesh_with_deform_cache(Subdiv *subdiv,
+                                           const SubdivToMeshSettings *settings,
+                                           const Mesh *coarse_mesh)
+{
+  return subdiv_to_mesh(subdiv, settings, coarse_mesh, true);
+}
+
 /** \} */
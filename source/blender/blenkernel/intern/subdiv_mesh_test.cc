@@ -0,0 +1,143 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_math_vector.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_test_utils.hh"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_mesh.h"
+
+namespace blender::bke::tests {
+
+class subdiv_mesh_deform_cache : public testing::Test {
+ public:
+  Mesh *coarse_mesh = nullptr;
+  Subdiv *subdiv = nullptr;
+  SubdivToMeshSettings mesh_settings = {};
+
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+
+  /* A grid with two UV maps, subdivided at level 2 with normals from the limit surface. */
+  void SetUp() override
+  {
+    coarse_mesh = mesh_test_grid_create(4);
+    const char *uv_names[2] = {"UVMap", "UVMap.001"};
+    for (int n = 0; n < 2; n++) {
+      MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer_named(
+          &coarse_mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, coarse_mesh->totloop, uv_names[n]);
+      for (int i = 0; i < coarse_mesh->totloop; i++) {
+        copy_v2_v2(mloopuv[i].uv, coarse_mesh->mvert[coarse_mesh->mloop[i].v].co);
+        mloopuv[i].uv[n] *= 0.5f;
+      }
+    }
+    BKE_mesh_update_customdata_pointers(coarse_mesh, false);
+
+    SubdivSettings settings = {};
+    settings.is_simple = false;
+    settings.is_adaptive = true;
+    settings.level = 2;
+    settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_ONLY;
+    settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_BOUNDARIES;
+    subdiv = BKE_subdiv_new_from_mesh(&settings, coarse_mesh);
+    mesh_settings.resolution = (1 << settings.level) + 1;
+  }
+
+  void TearDown() override
+  {
+    if (subdiv) {
+      BKE_subdiv_free(subdiv);
+    }
+    BKE_id_free(nullptr, coarse_mesh);
+  }
+
+  void verts_move(const float offset)
+  {
+    for (int i = 0; i < coarse_mesh->totvert; i++) {
+      coarse_mesh->mvert[i].co[2] += offset * (float)(i % 3);
+    }
+  }
+
+  /* Subdivide through the cache, the result must be the same as subdivided from scratch. */
+  void subdivide_expect_eq()
+  {
+    Mesh *result = BKE_subdiv_to_mesh_with_deform_cache(subdiv, &mesh_settings, coarse_mesh);
+    Mesh *expected = BKE_subdiv_to_mesh(subdiv, &mesh_settings, coarse_mesh);
+    ASSERT_NE(result, nullptr);
+    ASSERT_NE(expected, nullptr);
+    ASSERT_EQ(result->totvert, expected->totvert);
+    ASSERT_EQ(result->totloop, expected->totloop);
+    for (int i = 0; i < result->totvert; i++) {
+      EXPECT_V3_NEAR(result->mvert[i].co, expected->mvert[i].co, 1e-5f);
+    }
+
+    EXPECT_EQ(CustomData_get_active_layer(&result->ldata, CD_MLOOPUV),
+              CustomData_get_active_layer(&expected->ldata, CD_MLOOPUV));
+    for (int n = 0; n < 2; n++) {
+      const MLoopUV *uv = (const MLoopUV *)CustomData_get_layer_n(&result->ldata, CD_MLOOPUV, n);
+      const MLoopUV *uv_expected = (const MLoopUV *)CustomData_get_layer_n(
+          &expected->ldata, CD_MLOOPUV, n);
+      EXPECT_EQ(memcmp(uv, uv_expected, sizeof(*uv) * (size_t)result->totloop), 0);
+    }
+
+    BKE_id_free(nullptr, result);
+    BKE_id_free(nullptr, expected);
+  }
+};
+
+/* The result is kept once the same mesh got subdivided twice, after that moving the coarse
+ * vertices only evaluates the positions. */
+TEST_F(subdiv_mesh_deform_cache, ReusedForMovedVertices)
+{
+  ASSERT_NE(subdiv, nullptr);
+
+  subdivide_expect_eq();
+  verts_move(0.5f);
+  subdivide_expect_eq();
+  EXPECT_EQ(subdiv->stats.mesh_cache_hits, 0);
+  EXPECT_EQ(subdiv->stats.mesh_cache_misses, 2);
+
+  verts_move(-0.75f);
+  subdivide_expect_eq();
+  verts_move(0.25f);
+  subdivide_expect_eq();
+  EXPECT_EQ(subdiv->stats.mesh_cache_hits, 2);
+  EXPECT_EQ(subdiv->stats.mesh_cache_misses, 2);
+}
+
+/* Switching the active UV map or changing UVs subdivides again. */
+TEST_F(subdiv_mesh_deform_cache, InvalidatedByCustomData)
+{
+  ASSERT_NE(subdiv, nullptr);
+
+  subdivide_expect_eq();
+  subdivide_expect_eq();
+  subdivide_expect_eq();
+  EXPECT_EQ(subdiv->stats.mesh_cache_hits, 1);
+
+  CustomData_set_layer_active(&coarse_mesh->ldata, CD_MLOOPUV, 1);
+  subdivide_expect_eq();
+  EXPECT_EQ(subdiv->stats.mesh_cache_hits, 1);
+  EXPECT_EQ(subdiv->stats.mesh_cache_misses, 3);
+
+  subdivide_expect_eq();
+  MLoopUV *mloopuv = (MLoopUV *)CustomData_get_layer_n(&coarse_mesh->ldata, CD_MLOOPUV, 0);
+  mloopuv[5].uv[0] += 0.1f;
+  subdivide_expect_eq();
+  EXPECT_EQ(subdiv->stats.mesh_cache_hits, 1);
+  EXPECT_EQ(subdiv->stats.mesh_cache_misses, 5);
+}
+
+}  // namespace blender::bke::tests
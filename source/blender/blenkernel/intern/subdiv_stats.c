@@ -37,6 +37,8 @@ void BKE_subdiv_stats_init(SubdivStats *stats)
   stats->subdiv_to_ccg_time = 0.0;
   stats->subdiv_to_ccg_elements_time = 0.0;
   stats->topology_compare_time = 0.0;
+  stats->mesh_cache_hits = 0;
+  stats->mesh_cache_misses = 0;
 }
 
 void BKE_subdiv_stats_begin(SubdivStats *stats, eSubdivStatsValue value)
@@ -74,5 +76,11 @@ void BKE_subdiv_stats_print(const SubdivStats *stats)
   STATS_PRINT_TIME(stats, subdiv_to_ccg_elements_time, "    Elements time");
   STATS_PRINT_TIME(stats, topology_compare_time, "Topology comparison time");
 
+  if (stats->mesh_cache_hits != 0 || stats->mesh_cache_misses != 0) {
+    printf("  Mesh cache hits: %d, misses: %d\n",
+           stats->mesh_cache_hits,
+           stats->mesh_cache_misses);
+  }
+
 #undef STATS_PRINT_TIME
 }
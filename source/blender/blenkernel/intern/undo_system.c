@@ -42,6 +42,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
+#include "PIL_time.h"
+
 #define undo_stack _wm_undo_stack_disallow /* pass in as a variable always. */
 
 /** Odd requirement of Blender that we always keep a memfile undo in the stack. */
@@ -154,9 +158,11 @@ static void undosys_id_ref_resolve(void *user_data, UndoRefID *id_ref)
 static bool undosys_step_encode(bContext *C, Main *bmain, UndoStack *ustack, UndoStep *us)
 {
   CLOG_INFO(&LOG, 2, "addr=%p, name='%s', type='%s'", us, us->name, us->type->name);
+  const double time_start = PIL_check_seconds_timer();
   UNDO_NESTED_CHECK_BEGIN;
   bool ok = us->type->step_encode(C, bmain, us);
   UNDO_NESTED_CHECK_END;
+  us->encode_time = PIL_check_seconds_timer() - time_start;
   if (ok) {
     if (us->type->step_foreach_ID_ref != NULL) {
       /* Don't use from context yet because sometimes context is fake and
@@ -206,9 +212,11 @@ static void undosys_step_decode(
     us->type->step_foreach_ID_ref(us, undosys_id_ref_resolve, bmain);
   }
 
+  const double time_start = PIL_check_seconds_timer();
   UNDO_NESTED_CHECK_BEGIN;
   us->type->step_decode(C, bmain, us, dir, is_final);
   UNDO_NESTED_CHECK_END;
+  us->decode_time = PIL_check_seconds_timer() - time_start;
 
 #ifdef WITH_GLOBAL_UNDO_CORRECT_ORDER
   if (us->type == BKE_UNDOSYS_TYPE_MEMFILE) {
@@ -411,7 +419,7 @@ void BKE_undosys_stack_limit_steps_and_memory(UndoStack *ustack, int steps, size
   size_t us_count = 0;
   for (us = ustack->steps.last; us && us->prev; us = us->prev) {
     if (memory_limit) {
-      data_size_all += us->data_size;
+      data_size_all += atomic_add_and_fetch_z(&us->data_size, 0);
       if (data_size_all > memory_limit) {
         break;
       }
@@ -925,7 +933,7 @@ void BKE_undosys_print(UndoStack *ustack)
          BLI_listbase_count(&ustack->steps));
   int index = 0;
   LISTBASE_FOREACH (UndoStep *, us, &ustack->steps) {
-    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s'\n",
+    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s', size=%zu",
            (us == ustack->step_active) ? '*' : ' ',
            us->is_applied ? '#' : ' ',
            (us == ustack->step_active_memfile) ? 'M' : ' ',
@@ -933,7 +941,12 @@ void BKE_undosys_print(UndoStack *ustack)
            index,
            (void *)us,
            us->type->name,
-           us->name);
+           us->name,
+           atomic_add_and_fetch_z(&us->data_size, 0));
+    if (us->data_size_uncompressed) {
+      printf(" (uncompressed=%zu)", us->data_size_uncompressed);
+    }
+    printf(", encode=%.3f ms, decode=%.3f ms\n", us->encode_time * 1e3, us->decode_time * 1e3);
     index++;
   }
 }
@@ -0,0 +1,96 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "bmesh.h"
+
+namespace blender::bke::tests {
+
+/**
+ * A grid of `size * size` quads, bumpy so the face bounds overlap on all axes.
+ *
+ * Vertices are stored row by row, edges are the horizontal ones followed by the vertical ones
+ * and each face uses its loops in ascending order, starting from its lowest vertex.
+ */
+inline Mesh *mesh_test_grid_create(const int size)
+{
+  const int verts_len = (size + 1) * (size + 1);
+  const int edges_len = 2 * size * (size + 1);
+  const int polys_len = size * size;
+  Mesh *me = BKE_mesh_new_nomain(verts_len, edges_len, 0, polys_len * 4, polys_len);
+
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      MVert *mv = &me->mvert[y * (size + 1) + x];
+      mv->co[0] = (float)x;
+      mv->co[1] = (float)y;
+      mv->co[2] = (float)((x * y) % 7) * 0.25f;
+    }
+  }
+
+  const int edges_vertical = size * (size + 1);
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x < size; x++) {
+      MEdge *med = &me->medge[y * size + x];
+      med->v1 = y * (size + 1) + x;
+      med->v2 = med->v1 + 1;
+    }
+  }
+  for (int x = 0; x <= size; x++) {
+    for (int y = 0; y < size; y++) {
+      MEdge *med = &me->medge[edges_vertical + x * size + y];
+      med->v1 = y * (size + 1) + x;
+      med->v2 = med->v1 + size + 1;
+    }
+  }
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int i = y * size + x;
+      const int v = y * (size + 1) + x;
+      MPoly *mp = &me->mpoly[i];
+      mp->loopstart = i * 4;
+      mp->totloop = 4;
+
+      MLoop *ml = &me->mloop[mp->loopstart];
+      ml[0].v = v;
+      ml[0].e = y * size + x;
+      ml[1].v = v + 1;
+      ml[1].e = edges_vertical + (x + 1) * size + y;
+      ml[2].v = v + size + 2;
+      ml[2].e = (y + 1) * size + x;
+      ml[3].v = v + size + 1;
+      ml[3].e = edges_vertical + x * size + y;
+    }
+  }
+
+  return me;
+}
+
+/**
+ * The grid of #mesh_test_grid_create as a #BMesh, with its normals calculated.
+ * Edit-mode meshes use tool flags, sculpt meshes don't.
+ */
+inline BMesh *bmesh_test_grid_create(const int size, const bool use_toolflags)
+{
+  Mesh *me = mesh_test_grid_create(size);
+
+  BMeshCreateParams bm_create_params = {0};
+  bm_create_params.use_toolflags = use_toolflags;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_create_params);
+  BMeshFromMeshParams bm_from_me_params = {0};
+  bm_from_me_params.calc_face_normal = true;
+  BM_mesh_bm_from_me(bm, me, &bm_from_me_params);
+  BKE_id_free(nullptr, me);
+
+  BM_mesh_normals_update(bm);
+  return bm;
+}
+
+}  // namespace blender::bke::tests
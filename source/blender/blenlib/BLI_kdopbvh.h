@@ -30,9 +30,11 @@ extern "C" {
 #endif
 
 struct BVHTree;
+struct BVHTreeWide;
 struct DistProjectedAABBPrecalc;
 
 typedef struct BVHTree BVHTree;
+typedef struct BVHTreeWide BVHTreeWide;
 #define USE_KDOPBVH_WATERTIGHT
 
 typedef struct BVHTreeAxisRange {
@@ -257,6 +259,55 @@ void BLI_bvhtree_walk_dfs(BVHTree *tree,
                           BVHTree_WalkOrderCallback walk_order_cb,
                           void *userdata);
 
+/* flattened copy of a balanced tree, for fast (batched) queries */
+BVHTreeWide *BLI_bvhtree_wide_new(const BVHTree *tree);
+void BLI_bvhtree_wide_free(BVHTreeWide *tree);
+int BLI_bvhtree_wide_get_len(const BVHTreeWide *tree);
+
+int BLI_bvhtree_wide_ray_cast_ex(const BVHTreeWide *tree,
+                                 const float co[3],
+                                 const float dir[3],
+                                 float radius,
+                                 BVHTreeRayHit *hit,
+                                 BVHTree_RayCastCallback callback,
+                                 void *userdata,
+                                 int flag);
+int BLI_bvhtree_wide_ray_cast(const BVHTreeWide *tree,
+                              const float co[3],
+                              const float dir[3],
+                              float radius,
+                              BVHTreeRayHit *hit,
+                              BVHTree_RayCastCallback callback,
+                              void *userdata);
+void BLI_bvhtree_wide_ray_cast_batch(const BVHTreeWide *tree,
+                                     const float (*co)[3],
+                                     const float (*dir)[3],
+                                     const int rays_len,
+                                     float radius,
+                                     BVHTreeRayHit *hits,
+                                     BVHTree_RayCastCallback callback,
+                                     void *userdata,
+                                     int flag);
+
+int BLI_bvhtree_wide_find_nearest(const BVHTreeWide *tree,
+                                  const float co[3],
+                                  BVHTreeNearest *nearest,
+                                  BVHTree_NearestPointCallback callback,
+                                  void *userdata);
+void BLI_bvhtree_wide_find_nearest_batch(const BVHTreeWide *tree,
+                                         const float (*co)[3],
+                                         const int co_len,
+                                         BVHTreeNearest *nearest,
+                                         BVHTree_NearestPointCallback callback,
+                                         void *userdata);
+
+BVHTreeOverlap *BLI_bvhtree_wide_overlap(const BVHTreeWide *tree1,
+                                         const BVHTreeWide *tree2,
+                                         uint *r_overlap_tot,
+                                         BVHTree_OverlapCallback callback,
+                                         void *userdata,
+                                         const int flag);
+
 /* expose for bvh callbacks to use */
 extern const float bvhtree_kdop_axes[13][3];
 
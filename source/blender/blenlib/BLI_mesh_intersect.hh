@@ -55,12 +55,16 @@ constexpr int NO_INDEX = -1;
  * the algorithm and doesn't match an original Vert.
  * Vertices can be reliably compared for equality,
  * and hashed (on their co_exact field).
+ * The co_is_exact flag says whether co represents co_exact without rounding,
+ * which is true for all input vertices. When it is, predicates on the vertex can
+ * use adaptive-precision double arithmetic instead of GMP arithmetic.
  */
 struct Vert {
   mpq3 co_exact;
   double3 co;
   int id = NO_INDEX;
   int orig = NO_INDEX;
+  bool co_is_exact = false;
 
   Vert() = default;
   Vert(const mpq3 &mco, const double3 &dco, int id, int orig);
@@ -75,6 +79,14 @@ struct Vert {
 
 std::ostream &operator<<(std::ostream &os, const Vert *v);
 
+/**
+ * Exact version of #orient3d on the exact coordinates of the vertices.
+ * When all four vertices have exactly representable double coordinates, this
+ * uses Shewchuk's adaptive-precision predicate, which only does extra work in
+ * nearly degenerate cases; otherwise it falls back to GMP arithmetic.
+ */
+int orient3d(const Vert *a, const Vert *b, const Vert *c, const Vert *d);
+
 /**
  * A Plane whose equation is `dot(norm, p) + d = 0`.
  * The norm and d fields are always present, but the norm_exact
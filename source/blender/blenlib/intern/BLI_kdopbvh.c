@@ -48,6 +48,10 @@
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "BLI_strict_flags.h"
 
 /* used for iterative_raycast */
@@ -2405,3 +2409,947 @@ void BLI_bvhtree_walk_dfs(BVHTree *tree,
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_wide
+ *
+ * A flattened, read-only copy of a balanced #BVHTree, optimized for queries.
+ *
+ * All nodes are stored in one array (in depth first order), each node holds the
+ * bounds of up to #BVH_WIDE_WIDTH children in structure-of-arrays form,
+ * so a ray or point can be tested against all children at once using SIMD.
+ * Children are referenced by index instead of pointers and leafs are stored
+ * directly in their parent, so a query touches far less memory than with #BVHNode.
+ *
+ * Only the axis aligned part of the k-DOP is used, which is a conservative bound
+ * for trees with more axes, so results are the same but callbacks may run more often.
+ * \{ */
+
+#define BVH_WIDE_WIDTH 4
+/* Enough for any balanced tree, deeper trees use a heap allocated stack,
+ * see #BVHTreeWide.depth. */
+#define BVH_WIDE_STACK_SIZE 256
+
+typedef struct BVHWideNode {
+  /* Bounds of the children as [axis][child], unused children have empty (inverted) bounds,
+   * which never pass any of the tests. */
+  float bv_min[3][BVH_WIDE_WIDTH];
+  float bv_max[3][BVH_WIDE_WIDTH];
+  /* Index in #BVHTreeWide.nodes for branches, the user index for leafs. */
+  int children[BVH_WIDE_WIDTH];
+  /* Bit-flag of children that are leafs. */
+  uchar leaf_mask;
+  uchar totnode;
+} BVHWideNode;
+
+struct BVHTreeWide {
+  BVHWideNode *nodes;
+  int totnode;
+  int totleaf;
+  /* Maximum depth, only used to size traversal stacks. */
+  int depth;
+};
+
+/* A child of a node (slot >= 0) or the whole node (slot == -1), used on traversal stacks. */
+typedef struct BVHWideStackItem {
+  int node;
+  int slot;
+  float dist;
+} BVHWideStackItem;
+
+/**
+ * Return \a stack_fixed when it's large enough for traversing \a tree, a new array otherwise,
+ * free with #bvhtree_wide_stack_end.
+ */
+static BVHWideStackItem *bvhtree_wide_stack_begin(const BVHTreeWide *tree,
+                                                  BVHWideStackItem *stack_fixed)
+{
+  /* Each level pops one item and pushes at most #BVH_WIDE_WIDTH. */
+  const int stack_len_max = tree->depth * (BVH_WIDE_WIDTH - 1) + 1;
+  if (LIKELY(stack_len_max <= BVH_WIDE_STACK_SIZE)) {
+    return stack_fixed;
+  }
+  return MEM_mallocN(sizeof(*stack_fixed) * (size_t)stack_len_max, __func__);
+}
+
+static void bvhtree_wide_stack_end(BVHWideStackItem *stack, BVHWideStackItem *stack_fixed)
+{
+  if (stack != stack_fixed) {
+    MEM_freeN(stack);
+  }
+}
+
+MINLINE bool bvhtree_wide_is_leaf(const BVHWideNode *node, const int slot)
+{
+  return (node->leaf_mask & (1 << slot)) != 0;
+}
+
+/* -------------------------------------------------------------------- */
+/* Build */
+
+typedef struct BVHWideBuildData {
+  BVHTreeWide *tree;
+  int nodes_alloc;
+} BVHWideBuildData;
+
+static float bvhtree_wide_node_area(const BVHNode *node)
+{
+  const float *bv = node->bv;
+  const float dx = bv[1] - bv[0];
+  const float dy = bv[3] - bv[2];
+  const float dz = bv[5] - bv[4];
+  return dx * dy + dy * dz + dz * dx;
+}
+
+static void bvhtree_wide_slot_set_bounds(BVHWideNode *wnode, const int slot, const float bv[6])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    wnode->bv_min[axis][slot] = bv[2 * axis];
+    wnode->bv_max[axis][slot] = bv[2 * axis + 1];
+  }
+}
+
+static int bvhtree_wide_build_recursive(BVHWideBuildData *data,
+                                        const BVHNode **items,
+                                        int items_len,
+                                        const int depth)
+{
+  BVHTreeWide *tree = data->tree;
+  const BVHNode *items_expand[MAX_TREETYPE * BVH_WIDE_WIDTH];
+
+  BLI_assert(tree->totnode < data->nodes_alloc);
+  const int node_index = tree->totnode++;
+  tree->depth = max_ii(tree->depth, depth);
+
+  /* Pull grand-children up while they fit, always expanding the largest branch,
+   * this collapses binary trees into (up to) 4-wide trees. */
+  memcpy(items_expand, items, sizeof(*items) * (size_t)items_len);
+  items = items_expand;
+  while (items_len < BVH_WIDE_WIDTH) {
+    int best = -1;
+    float best_area = -1.0f;
+    for (int i = 0; i < items_len; i++) {
+      const BVHNode *item = items[i];
+      if (item->totnode != 0 && items_len + item->totnode - 1 <= BVH_WIDE_WIDTH) {
+        const float area = bvhtree_wide_node_area(item);
+        if (area > best_area) {
+          best = i;
+          best_area = area;
+        }
+      }
+    }
+    if (best == -1) {
+      break;
+    }
+    const BVHNode *item = items[best];
+    memmove(&items_expand[best + item->totnode],
+            &items_expand[best + 1],
+            sizeof(*items) * (size_t)(items_len - best - 1));
+    memcpy(&items_expand[best], item->children, sizeof(*items) * (size_t)item->totnode);
+    items_len += item->totnode - 1;
+  }
+
+  BVHWideNode wnode;
+  for (int axis = 0; axis < 3; axis++) {
+    copy_vn_fl(wnode.bv_min[axis], BVH_WIDE_WIDTH, FLT_MAX);
+    copy_vn_fl(wnode.bv_max[axis], BVH_WIDE_WIDTH, -FLT_MAX);
+  }
+  copy_vn_i(wnode.children, BVH_WIDE_WIDTH, -1);
+  wnode.leaf_mask = 0;
+  wnode.totnode = (uchar)min_ii(items_len, BVH_WIDE_WIDTH);
+
+  if (items_len <= BVH_WIDE_WIDTH) {
+    for (int slot = 0; slot < items_len; slot++) {
+      const BVHNode *item = items[slot];
+      bvhtree_wide_slot_set_bounds(&wnode, slot, item->bv);
+      if (item->totnode == 0) {
+        wnode.children[slot] = item->index;
+        wnode.leaf_mask |= (uchar)(1 << slot);
+      }
+      else {
+        wnode.children[slot] = bvhtree_wide_build_recursive(
+            data, (const BVHNode **)item->children, item->totnode, depth + 1);
+      }
+    }
+  }
+  else {
+    /* Wider source trees (octrees for e.g.), group the (spatially sorted) children. */
+    for (int slot = 0; slot < BVH_WIDE_WIDTH; slot++) {
+      const int start = (items_len * slot) / BVH_WIDE_WIDTH;
+      const int end = (items_len * (slot + 1)) / BVH_WIDE_WIDTH;
+      if (end - start == 1) {
+        const BVHNode *item = items[start];
+        bvhtree_wide_slot_set_bounds(&wnode, slot, item->bv);
+        if (item->totnode == 0) {
+          wnode.children[slot] = item->index;
+          wnode.leaf_mask |= (uchar)(1 << slot);
+        }
+        else {
+          wnode.children[slot] = bvhtree_wide_build_recursive(
+              data, (const BVHNode **)item->children, item->totnode, depth + 1);
+        }
+      }
+      else {
+        float bv[6] = {FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX};
+        for (int i = start; i < end; i++) {
+          for (int axis = 0; axis < 3; axis++) {
+            bv[2 * axis] = min_ff(bv[2 * axis], items[i]->bv[2 * axis]);
+            bv[2 * axis + 1] = max_ff(bv[2 * axis + 1], items[i]->bv[2 * axis + 1]);
+          }
+        }
+        bvhtree_wide_slot_set_bounds(&wnode, slot, bv);
+        wnode.children[slot] = bvhtree_wide_build_recursive(
+            data, &items[start], end - start, depth + 1);
+      }
+    }
+  }
+
+  tree->nodes[node_index] = wnode;
+  return node_index;
+}
+
+/**
+ * Create a flattened copy of \a tree for fast queries,
+ * the copy doesn't reference \a tree, so it can be freed afterwards.
+ *
+ * \note Only trees that include the axis aligned bounds (not 18-DOP) are supported.
+ * \note Updates to \a tree (#BLI_bvhtree_update_tree) are not reflected in the copy.
+ */
+BVHTreeWide *BLI_bvhtree_wide_new(const BVHTree *tree)
+{
+  if (UNLIKELY(tree->start_axis != 0)) {
+    BLI_assert(0);
+    return NULL;
+  }
+
+  BVHTreeWide *wtree = MEM_callocN(sizeof(*wtree), __func__);
+  wtree->totleaf = tree->totleaf;
+
+  const BVHNode *root = tree->totleaf ? tree->nodes[tree->totleaf] : NULL;
+  if (root != NULL) {
+    /* Every node has at least 2 children, except a root with a single leaf. */
+    BVHWideBuildData data = {wtree, max_ii(tree->totleaf, 1)};
+    wtree->nodes = MEM_mallocN(sizeof(*wtree->nodes) * (size_t)data.nodes_alloc, __func__);
+    if (root->totnode == 0) {
+      bvhtree_wide_build_recursive(&data, &root, 1, 1);
+    }
+    else {
+      bvhtree_wide_build_recursive(&data, (const BVHNode **)root->children, root->totnode, 1);
+    }
+  }
+  return wtree;
+}
+
+void BLI_bvhtree_wide_free(BVHTreeWide *tree)
+{
+  if (tree) {
+    MEM_SAFE_FREE(tree->nodes);
+    MEM_freeN(tree);
+  }
+}
+
+int BLI_bvhtree_wide_get_len(const BVHTreeWide *tree)
+{
+  return tree->totleaf;
+}
+
+/* -------------------------------------------------------------------- */
+/* SIMD Kernels */
+
+/**
+ * Intersect the ray with the bounds of all children of \a node.
+ * \return A bit-flag of the children hit closer than `data->hit.dist`, their distance is
+ * written into \a r_dist (clamped to zero when the origin is inside the bounds).
+ */
+static int bvhtree_wide_ray_test(const BVHRayCastData *data,
+                                 const BVHWideNode *node,
+                                 float r_dist[BVH_WIDE_WIDTH])
+{
+  /* Use the bound facing the ray first as near plane,
+   * so empty bounds are never hit regardless of the ray direction. */
+  const float radius = data->ray.radius;
+#ifdef __SSE2__
+  __m128 t_near = _mm_setzero_ps();
+  __m128 t_far = _mm_set1_ps(data->hit.dist);
+  for (int axis = 0; axis < 3; axis++) {
+    const bool negative = data->idot_axis[axis] < 0.0f;
+    const float *bv_near = negative ? node->bv_max[axis] : node->bv_min[axis];
+    const float *bv_far = negative ? node->bv_min[axis] : node->bv_max[axis];
+    const float offset = negative ? radius : -radius;
+    const __m128 idot = _mm_set1_ps(data->idot_axis[axis]);
+    const __m128 t0 = _mm_mul_ps(
+        _mm_sub_ps(_mm_loadu_ps(bv_near), _mm_set1_ps(data->ray.origin[axis] - offset)), idot);
+    const __m128 t1 = _mm_mul_ps(
+        _mm_sub_ps(_mm_loadu_ps(bv_far), _mm_set1_ps(data->ray.origin[axis] + offset)), idot);
+    t_near = _mm_max_ps(t_near, t0);
+    t_far = _mm_min_ps(t_far, t1);
+  }
+  _mm_storeu_ps(r_dist, t_near);
+  const __m128 hit = _mm_and_ps(_mm_cmple_ps(t_near, t_far),
+                                _mm_cmplt_ps(t_near, _mm_set1_ps(data->hit.dist)));
+  return _mm_movemask_ps(hit);
+#else
+  int hit_mask = 0;
+  for (int slot = 0; slot < BVH_WIDE_WIDTH; slot++) {
+    float t_near = 0.0f;
+    float t_far = data->hit.dist;
+    for (int axis = 0; axis < 3; axis++) {
+      const bool negative = data->idot_axis[axis] < 0.0f;
+      const float bv_near = negative ? node->bv_max[axis][slot] : node->bv_min[axis][slot];
+      const float bv_far = negative ? node->bv_min[axis][slot] : node->bv_max[axis][slot];
+      const float offset = negative ? radius : -radius;
+      t_near = max_ff(t_near,
+                      (bv_near - (data->ray.origin[axis] - offset)) * data->idot_axis[axis]);
+      t_far = min_ff(t_far, (bv_far - (data->ray.origin[axis] + offset)) * data->idot_axis[axis]);
+    }
+    r_dist[slot] = t_near;
+    if (t_near <= t_far && t_near < data->hit.dist) {
+      hit_mask |= (1 << slot);
+    }
+  }
+  return hit_mask;
+#endif
+}
+
+/**
+ * Squared distance from \a co to the bounds of all children of \a node.
+ * \return A bit-flag of the children closer than \a dist_sq.
+ */
+static int bvhtree_wide_nearest_test(const float co[3],
+                                     const float dist_sq,
+                                     const BVHWideNode *node,
+                                     float r_dist_sq[BVH_WIDE_WIDTH])
+{
+#ifdef __SSE2__
+  const __m128 zero = _mm_setzero_ps();
+  __m128 len_sq = zero;
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 p = _mm_set1_ps(co[axis]);
+    const __m128 d = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(node->bv_min[axis]), p),
+                                           _mm_sub_ps(p, _mm_loadu_ps(node->bv_max[axis]))),
+                                zero);
+    len_sq = _mm_add_ps(len_sq, _mm_mul_ps(d, d));
+  }
+  _mm_storeu_ps(r_dist_sq, len_sq);
+  return _mm_movemask_ps(_mm_cmplt_ps(len_sq, _mm_set1_ps(dist_sq)));
+#else
+  int hit_mask = 0;
+  for (int slot = 0; slot < BVH_WIDE_WIDTH; slot++) {
+    float len_sq = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      const float d = max_fff(
+          node->bv_min[axis][slot] - co[axis], co[axis] - node->bv_max[axis][slot], 0.0f);
+      len_sq += d * d;
+    }
+    r_dist_sq[slot] = len_sq;
+    if (len_sq < dist_sq) {
+      hit_mask |= (1 << slot);
+    }
+  }
+  return hit_mask;
+#endif
+}
+
+/**
+ * Overlap of the bounds \a bv_min, \a bv_max with the bounds of all children of \a node.
+ * \return A bit-flag of the overlapping children.
+ */
+static int bvhtree_wide_overlap_test(const float bv_min[3],
+                                     const float bv_max[3],
+                                     const BVHWideNode *node)
+{
+#ifdef __SSE2__
+  __m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+  for (int axis = 0; axis < 3; axis++) {
+    overlap = _mm_and_ps(overlap,
+                         _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(node->bv_min[axis]),
+                                                 _mm_set1_ps(bv_max[axis])),
+                                    _mm_cmple_ps(_mm_set1_ps(bv_min[axis]),
+                                                 _mm_loadu_ps(node->bv_max[axis]))));
+  }
+  return _mm_movemask_ps(overlap);
+#else
+  int hit_mask = 0;
+  for (int slot = 0; slot < BVH_WIDE_WIDTH; slot++) {
+    bool overlap = true;
+    for (int axis = 0; axis < 3; axis++) {
+      if (node->bv_min[axis][slot] > bv_max[axis] || bv_min[axis] > node->bv_max[axis][slot]) {
+        overlap = false;
+        break;
+      }
+    }
+    if (overlap) {
+      hit_mask |= (1 << slot);
+    }
+  }
+  return hit_mask;
+#endif
+}
+
+/**
+ * Push the children in \a hit_mask onto \a stack, farthest first, so the closest is popped first.
+ */
+static int bvhtree_wide_stack_push_sorted(BVHWideStackItem *stack,
+                                          int stack_len,
+                                          const int node_index,
+                                          int hit_mask,
+                                          const float dist[BVH_WIDE_WIDTH])
+{
+  const int stack_start = stack_len;
+  for (int slot = 0; hit_mask != 0; slot++, hit_mask >>= 1) {
+    if ((hit_mask & 1) == 0) {
+      continue;
+    }
+    /* Insertion sort, descending. */
+    int i = stack_len++;
+    for (; i > stack_start && stack[i - 1].dist < dist[slot]; i--) {
+      stack[i] = stack[i - 1];
+    }
+    stack[i].node = node_index;
+    stack[i].slot = slot;
+    stack[i].dist = dist[slot];
+  }
+  return stack_len;
+}
+
+/* -------------------------------------------------------------------- */
+/* Ray-Cast */
+
+static void bvhtree_wide_ray_cast_traverse(const BVHTreeWide *tree, BVHRayCastData *data)
+{
+  BVHWideStackItem stack_fixed[BVH_WIDE_STACK_SIZE];
+  BVHWideStackItem *stack = bvhtree_wide_stack_begin(tree, stack_fixed);
+  int stack_len = 0;
+  float dist[BVH_WIDE_WIDTH];
+
+  int hit_mask = bvhtree_wide_ray_test(data, &tree->nodes[0], dist);
+  stack_len = bvhtree_wide_stack_push_sorted(stack, stack_len, 0, hit_mask, dist);
+
+  while (stack_len != 0) {
+    const BVHWideStackItem item = stack[--stack_len];
+    if (item.dist >= data->hit.dist) {
+      continue;
+    }
+    const BVHWideNode *node = &tree->nodes[item.node];
+    const int child = node->children[item.slot];
+    if (bvhtree_wide_is_leaf(node, item.slot)) {
+      if (data->callback) {
+        data->callback(data->userdata, child, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = child;
+        data->hit.dist = item.dist;
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, item.dist);
+      }
+    }
+    else {
+      hit_mask = bvhtree_wide_ray_test(data, &tree->nodes[child], dist);
+      stack_len = bvhtree_wide_stack_push_sorted(stack, stack_len, child, hit_mask, dist);
+    }
+  }
+
+  bvhtree_wide_stack_end(stack, stack_fixed);
+}
+
+static void bvhtree_wide_ray_cast_data_init(BVHRayCastData *data,
+                                            const float co[3],
+                                            const float dir[3],
+                                            float radius,
+                                            BVHTree_RayCastCallback callback,
+                                            void *userdata,
+                                            int flag)
+{
+  BLI_ASSERT_UNIT_V3(dir);
+
+  /* Not used by the wide tree traversal. */
+  data->tree = NULL;
+
+  data->callback = callback;
+  data->userdata = userdata;
+
+  copy_v3_v3(data->ray.origin, co);
+  copy_v3_v3(data->ray.direction, dir);
+  data->ray.radius = radius;
+
+  bvhtree_ray_cast_data_precalc(data, flag);
+}
+
+/**
+ * Same as #BLI_bvhtree_ray_cast_ex, using the flattened tree.
+ */
+int BLI_bvhtree_wide_ray_cast_ex(const BVHTreeWide *tree,
+                                 const float co[3],
+                                 const float dir[3],
+                                 float radius,
+                                 BVHTreeRayHit *hit,
+                                 BVHTree_RayCastCallback callback,
+                                 void *userdata,
+                                 int flag)
+{
+  BVHRayCastData data;
+  bvhtree_wide_ray_cast_data_init(&data, co, dir, radius, callback, userdata, flag);
+
+  if (hit) {
+    memcpy(&data.hit, hit, sizeof(*hit));
+  }
+  else {
+    data.hit.index = -1;
+    data.hit.dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  if (tree->totnode != 0) {
+    bvhtree_wide_ray_cast_traverse(tree, &data);
+  }
+
+  if (hit) {
+    memcpy(hit, &data.hit, sizeof(*hit));
+  }
+
+  return data.hit.index;
+}
+
+int BLI_bvhtree_wide_ray_cast(const BVHTreeWide *tree,
+                              const float co[3],
+                              const float dir[3],
+                              float radius,
+                              BVHTreeRayHit *hit,
+                              BVHTree_RayCastCallback callback,
+                              void *userdata)
+{
+  return BLI_bvhtree_wide_ray_cast_ex(
+      tree, co, dir, radius, hit, callback, userdata, BVH_RAYCAST_DEFAULT);
+}
+
+typedef struct BVHWideRayCastBatchData {
+  const BVHTreeWide *tree;
+  const float (*co)[3];
+  const float (*dir)[3];
+  float radius;
+  BVHTreeRayHit *hits;
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHWideRayCastBatchData;
+
+static void bvhtree_wide_ray_cast_batch_cb(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHWideRayCastBatchData *batch = userdata;
+  BVHRayCastData data;
+  bvhtree_wide_ray_cast_data_init(&data,
+                                  batch->co[i],
+                                  batch->dir[i],
+                                  batch->radius,
+                                  batch->callback,
+                                  batch->userdata,
+                                  batch->flag);
+  memcpy(&data.hit, &batch->hits[i], sizeof(data.hit));
+  bvhtree_wide_ray_cast_traverse(batch->tree, &data);
+  memcpy(&batch->hits[i], &data.hit, sizeof(data.hit));
+}
+
+/**
+ * Cast many rays in one call, using multiple threads for large batches.
+ *
+ * \param hits: Must be initialized by the caller (index and maximum distance), like the
+ * optional `hit` argument of #BLI_bvhtree_ray_cast_ex, one for each ray.
+ * \param callback: Must be thread-safe.
+ */
+void BLI_bvhtree_wide_ray_cast_batch(const BVHTreeWide *tree,
+                                     const float (*co)[3],
+                                     const float (*dir)[3],
+                                     const int rays_len,
+                                     float radius,
+                                     BVHTreeRayHit *hits,
+                                     BVHTree_RayCastCallback callback,
+                                     void *userdata,
+                                     int flag)
+{
+  if (tree->totnode == 0) {
+    return;
+  }
+
+  BVHWideRayCastBatchData batch = {
+      tree, co, dir, radius, hits, callback, userdata, flag};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (rays_len > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, rays_len, &batch, bvhtree_wide_ray_cast_batch_cb, &settings);
+}
+
+/* -------------------------------------------------------------------- */
+/* Find Nearest */
+
+static void bvhtree_wide_find_nearest_traverse(const BVHTreeWide *tree, BVHNearestData *data)
+{
+  BVHWideStackItem stack_fixed[BVH_WIDE_STACK_SIZE];
+  BVHWideStackItem *stack = bvhtree_wide_stack_begin(tree, stack_fixed);
+  int stack_len = 0;
+  float dist_sq[BVH_WIDE_WIDTH];
+
+  int hit_mask = bvhtree_wide_nearest_test(
+      data->co, data->nearest.dist_sq, &tree->nodes[0], dist_sq);
+  stack_len = bvhtree_wide_stack_push_sorted(stack, stack_len, 0, hit_mask, dist_sq);
+
+  while (stack_len != 0) {
+    const BVHWideStackItem item = stack[--stack_len];
+    if (item.dist >= data->nearest.dist_sq) {
+      continue;
+    }
+    const BVHWideNode *node = &tree->nodes[item.node];
+    const int child = node->children[item.slot];
+    if (bvhtree_wide_is_leaf(node, item.slot)) {
+      if (data->callback) {
+        data->callback(data->userdata, child, data->co, &data->nearest);
+      }
+      else {
+        data->nearest.index = child;
+        data->nearest.dist_sq = item.dist;
+        for (int axis = 0; axis < 3; axis++) {
+          data->nearest.co[axis] = clamp_f(
+              data->co[axis], node->bv_min[axis][item.slot], node->bv_max[axis][item.slot]);
+        }
+      }
+    }
+    else {
+      hit_mask = bvhtree_wide_nearest_test(
+          data->co, data->nearest.dist_sq, &tree->nodes[child], dist_sq);
+      stack_len = bvhtree_wide_stack_push_sorted(stack, stack_len, child, hit_mask, dist_sq);
+    }
+  }
+
+  bvhtree_wide_stack_end(stack, stack_fixed);
+}
+
+static void bvhtree_wide_find_nearest_data_init(BVHNearestData *data,
+                                                const float co[3],
+                                                const BVHTreeNearest *nearest,
+                                                BVHTree_NearestPointCallback callback,
+                                                void *userdata)
+{
+  /* Not used by the wide tree traversal. */
+  data->tree = NULL;
+  data->co = co;
+
+  data->callback = callback;
+  data->userdata = userdata;
+
+  if (nearest) {
+    memcpy(&data->nearest, nearest, sizeof(*nearest));
+  }
+  else {
+    data->nearest.index = -1;
+    data->nearest.dist_sq = FLT_MAX;
+  }
+}
+
+/**
+ * Same as #BLI_bvhtree_find_nearest, using the flattened tree.
+ * Children are always visited closest first, like #BVH_NEAREST_OPTIMAL_ORDER.
+ */
+int BLI_bvhtree_wide_find_nearest(const BVHTreeWide *tree,
+                                  const float co[3],
+                                  BVHTreeNearest *nearest,
+                                  BVHTree_NearestPointCallback callback,
+                                  void *userdata)
+{
+  BVHNearestData data;
+  bvhtree_wide_find_nearest_data_init(&data, co, nearest, callback, userdata);
+
+  if (tree->totnode != 0) {
+    bvhtree_wide_find_nearest_traverse(tree, &data);
+  }
+
+  if (nearest) {
+    memcpy(nearest, &data.nearest, sizeof(*nearest));
+  }
+
+  return data.nearest.index;
+}
+
+typedef struct BVHWideNearestBatchData {
+  const BVHTreeWide *tree;
+  const float (*co)[3];
+  BVHTreeNearest *nearest;
+  BVHTree_NearestPointCallback callback;
+  void *userdata;
+} BVHWideNearestBatchData;
+
+static void bvhtree_wide_find_nearest_batch_cb(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHWideNearestBatchData *batch = userdata;
+  BVHNearestData data;
+  bvhtree_wide_find_nearest_data_init(
+      &data, batch->co[i], &batch->nearest[i], batch->callback, batch->userdata);
+  bvhtree_wide_find_nearest_traverse(batch->tree, &data);
+  memcpy(&batch->nearest[i], &data.nearest, sizeof(data.nearest));
+}
+
+/**
+ * Find the nearest leaf for many points in one call, using multiple threads for large batches.
+ *
+ * \param nearest: Must be initialized by the caller (index and maximum squared distance),
+ * like the `nearest` argument of #BLI_bvhtree_find_nearest, one for each point.
+ * \param callback: Must be thread-safe.
+ */
+void BLI_bvhtree_wide_find_nearest_batch(const BVHTreeWide *tree,
+                                         const float (*co)[3],
+                                         const int co_len,
+                                         BVHTreeNearest *nearest,
+                                         BVHTree_NearestPointCallback callback,
+                                         void *userdata)
+{
+  if (tree->totnode == 0) {
+    return;
+  }
+
+  BVHWideNearestBatchData batch = {tree, co, nearest, callback, userdata};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (co_len > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = 256;
+  BLI_task_parallel_range(0, co_len, &batch, bvhtree_wide_find_nearest_batch_cb, &settings);
+}
+
+/* -------------------------------------------------------------------- */
+/* Overlap */
+
+typedef struct BVHWideOverlapData {
+  const BVHTreeWide *tree1, *tree2;
+  BVHTree_OverlapCallback callback;
+  void *userdata;
+  /* Per thread, NULL unless #BVH_OVERLAP_RETURN_PAIRS is used. */
+  struct BLI_Stack *overlap;
+  int thread;
+} BVHWideOverlapData;
+
+static void bvhtree_wide_overlap_add(BVHWideOverlapData *data, const int index1, const int index2)
+{
+  if (data->callback && !data->callback(data->userdata, index1, index2, data->thread)) {
+    return;
+  }
+  if (data->overlap == NULL) {
+    return;
+  }
+  BVHTreeOverlap *overlap = BLI_stack_push_r(data->overlap);
+  overlap->indexA = index1;
+  overlap->indexB = index2;
+}
+
+/**
+ * Handle the children in \a hit_mask of \a node (from tree2) that overlap \a item (from tree1):
+ * leaf pairs are added, other pairs are pushed onto \a stack.
+ */
+static int bvhtree_wide_overlap_children(BVHWideOverlapData *data,
+                                         BVHWideStackItem *stack,
+                                         int stack_len,
+                                         const BVHWideStackItem *item,
+                                         const BVHWideNode *node,
+                                         const int node_index,
+                                         int hit_mask)
+{
+  const bool is_self = (data->tree1 == data->tree2);
+  const bool item_is_leaf = (item->slot != -1);
+  for (int slot = 0; hit_mask != 0; slot++, hit_mask >>= 1) {
+    if ((hit_mask & 1) == 0) {
+      continue;
+    }
+    if (item_is_leaf && bvhtree_wide_is_leaf(node, slot)) {
+      if (is_self && item->node == node_index && item->slot == slot) {
+        continue;
+      }
+      bvhtree_wide_overlap_add(
+          data, data->tree1->nodes[item->node].children[item->slot], node->children[slot]);
+    }
+    else {
+      /* Stack items are pairs, stored as two consecutive entries (tree1, tree2). */
+      BVHWideStackItem *item1 = &stack[stack_len++];
+      BVHWideStackItem *item2 = &stack[stack_len++];
+      *item1 = *item;
+      item2->node = bvhtree_wide_is_leaf(node, slot) ? node_index : node->children[slot];
+      item2->slot = bvhtree_wide_is_leaf(node, slot) ? slot : -1;
+      item2->dist = 0.0f;
+    }
+  }
+  return stack_len;
+}
+
+static void bvhtree_wide_overlap_traverse(BVHWideOverlapData *data,
+                                          const BVHWideStackItem *item1_init,
+                                          const BVHWideStackItem *item2_init)
+{
+  /* Pairs can't be bounded by depth like the other queries, grow the stack if needed. */
+  int stack_alloc = BVH_WIDE_STACK_SIZE * 2;
+  BVHWideStackItem *stack = MEM_mallocN(sizeof(*stack) * (size_t)stack_alloc, __func__);
+  int stack_len = 0;
+
+  stack[stack_len++] = *item1_init;
+  stack[stack_len++] = *item2_init;
+
+  while (stack_len != 0) {
+    const BVHWideStackItem item2 = stack[--stack_len];
+    const BVHWideStackItem item1 = stack[--stack_len];
+
+    if (stack_alloc - stack_len < BVH_WIDE_WIDTH * BVH_WIDE_WIDTH * 2) {
+      stack_alloc *= 2;
+      stack = MEM_reallocN(stack, sizeof(*stack) * (size_t)stack_alloc);
+    }
+
+    if (item1.slot != -1) {
+      /* Leaf against a branch. */
+      const BVHWideNode *leaf_node = &data->tree1->nodes[item1.node];
+      float bv_min[3], bv_max[3];
+      for (int axis = 0; axis < 3; axis++) {
+        bv_min[axis] = leaf_node->bv_min[axis][item1.slot];
+        bv_max[axis] = leaf_node->bv_max[axis][item1.slot];
+      }
+      const BVHWideNode *node2 = &data->tree2->nodes[item2.node];
+      const int hit_mask = bvhtree_wide_overlap_test(bv_min, bv_max, node2);
+      stack_len = bvhtree_wide_overlap_children(
+          data, stack, stack_len, &item1, node2, item2.node, hit_mask);
+    }
+    else {
+      /* Branch against a leaf or a branch: test each child of the first against the second. */
+      const BVHWideNode *node1 = &data->tree1->nodes[item1.node];
+      for (int slot1 = 0; slot1 < node1->totnode; slot1++) {
+        float bv_min[3], bv_max[3];
+        for (int axis = 0; axis < 3; axis++) {
+          bv_min[axis] = node1->bv_min[axis][slot1];
+          bv_max[axis] = node1->bv_max[axis][slot1];
+        }
+        BVHWideStackItem child1;
+        child1.node = bvhtree_wide_is_leaf(node1, slot1) ? item1.node : node1->children[slot1];
+        child1.slot = bvhtree_wide_is_leaf(node1, slot1) ? slot1 : -1;
+        child1.dist = 0.0f;
+
+        if (item2.slot != -1) {
+          const BVHWideNode *leaf_node = &data->tree2->nodes[item2.node];
+          const int hit_mask = bvhtree_wide_overlap_test(bv_min, bv_max, leaf_node) &
+                               (1 << item2.slot);
+          if (hit_mask == 0) {
+            continue;
+          }
+          if (child1.slot != -1) {
+            if (data->tree1 == data->tree2 && child1.node == item2.node &&
+                child1.slot == item2.slot) {
+              continue;
+            }
+            bvhtree_wide_overlap_add(
+                data, node1->children[slot1], leaf_node->children[item2.slot]);
+          }
+          else {
+            stack[stack_len++] = child1;
+            stack[stack_len++] = item2;
+          }
+        }
+        else {
+          const BVHWideNode *node2 = &data->tree2->nodes[item2.node];
+          const int hit_mask = bvhtree_wide_overlap_test(bv_min, bv_max, node2);
+          stack_len = bvhtree_wide_overlap_children(
+              data, stack, stack_len, &child1, node2, item2.node, hit_mask);
+        }
+      }
+    }
+  }
+
+  MEM_freeN(stack);
+}
+
+static void bvhtree_wide_overlap_task_cb(void *__restrict userdata,
+                                         const int j,
+                                         const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BVHWideOverlapData *data = &((BVHWideOverlapData *)userdata)[j];
+  const BVHWideNode *root1 = &data->tree1->nodes[0];
+  const BVHWideStackItem item1 = {
+      bvhtree_wide_is_leaf(root1, j) ? 0 : root1->children[j],
+      bvhtree_wide_is_leaf(root1, j) ? j : -1,
+      0.0f,
+  };
+  const BVHWideStackItem item2 = {0, -1, 0.0f};
+
+  float bv_min[3], bv_max[3];
+  for (int axis = 0; axis < 3; axis++) {
+    bv_min[axis] = root1->bv_min[axis][j];
+    bv_max[axis] = root1->bv_max[axis][j];
+  }
+  if (bvhtree_wide_overlap_test(bv_min, bv_max, &data->tree2->nodes[0]) == 0) {
+    return;
+  }
+  bvhtree_wide_overlap_traverse(data, &item1, &item2);
+}
+
+/**
+ * Same as #BLI_bvhtree_overlap_ex with `max_interactions` zero, using flattened trees.
+ * Supports #BVH_OVERLAP_USE_THREADING (splitting work over the children of the first root)
+ * and #BVH_OVERLAP_RETURN_PAIRS, the callback runs with the thread index as for #BVHTree.
+ */
+BVHTreeOverlap *BLI_bvhtree_wide_overlap(const BVHTreeWide *tree1,
+                                         const BVHTreeWide *tree2,
+                                         uint *r_overlap_tot,
+                                         BVHTree_OverlapCallback callback,
+                                         void *userdata,
+                                         const int flag)
+{
+  const bool overlap_pairs = (flag & BVH_OVERLAP_RETURN_PAIRS) != 0;
+  const bool use_threading = (flag & BVH_OVERLAP_USE_THREADING) != 0 &&
+                             (tree1->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD);
+
+  if (r_overlap_tot) {
+    *r_overlap_tot = 0;
+  }
+  if (tree1->totnode == 0 || tree2->totnode == 0) {
+    return NULL;
+  }
+
+  const int root_node_len = tree1->nodes[0].totnode;
+  BVHWideOverlapData *data = BLI_array_alloca(data, (size_t)root_node_len);
+  for (int j = 0; j < root_node_len; j++) {
+    data[j].tree1 = tree1;
+    data[j].tree2 = tree2;
+    data[j].callback = callback;
+    data[j].userdata = userdata;
+    data[j].overlap = overlap_pairs ? BLI_stack_new(sizeof(BVHTreeOverlap), __func__) : NULL;
+    data[j].thread = use_threading ? j : 0;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = use_threading;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, root_node_len, data, bvhtree_wide_overlap_task_cb, &settings);
+
+  BVHTreeOverlap *overlap = NULL;
+  if (overlap_pairs) {
+    size_t total = 0;
+    for (int j = 0; j < root_node_len; j++) {
+      total += BLI_stack_count(data[j].overlap);
+    }
+
+    BVHTreeOverlap *to = overlap = MEM_mallocN(sizeof(BVHTreeOverlap) * total, "BVHTreeOverlap");
+    for (int j = 0; j < root_node_len; j++) {
+      uint count = (uint)BLI_stack_count(data[j].overlap);
+      BLI_stack_pop_n(data[j].overlap, to, count);
+      to += count;
+    }
+    if (r_overlap_tot) {
+      *r_overlap_tot = (uint)total;
+    }
+  }
+
+  for (int j = 0; j < root_node_len; j++) {
+    if (data[j].overlap) {
+      BLI_stack_free(data[j].overlap);
+    }
+  }
+
+  return overlap;
+}
+
+/** \} */
@@ -68,6 +68,7 @@ static constexpr bool intersect_use_threading = true;
 Vert::Vert(const mpq3 &mco, const double3 &dco, int id, int orig)
     : co_exact(mco), co(dco), id(id), orig(orig)
 {
+  co_is_exact = (mco[0] == dco[0] && mco[1] == dco[1] && mco[2] == dco[2]);
 }
 
 bool Vert::operator==(const Vert &other) const
@@ -100,6 +101,20 @@ std::ostream &operator<<(std::ostream &os, const Vert *v)
   return os;
 }
 
+int orient3d(const Vert *a, const Vert *b, const Vert *c, const Vert *d)
+{
+  if (a->co_is_exact && b->co_is_exact && c->co_is_exact && d->co_is_exact) {
+#  ifdef PERFDEBUG
+    incperfcount(6); /* Orient3d decided by adaptive double arithmetic. */
+#  endif
+    return blender::orient3d(a->co, b->co, c->co, d->co);
+  }
+#  ifdef PERFDEBUG
+  incperfcount(7); /* Orient3d decided by exact arithmetic. */
+#  endif
+  return blender::orient3d(a->co_exact, b->co_exact, c->co_exact, d->co_exact);
+}
+
 bool Plane::operator==(const Plane &other) const
 {
   return norm_exact == other.norm_exact && d_exact == other.d_exact;
@@ -1231,6 +1246,19 @@ static int filter_plane_side(const double3 &p,
   return 0;
 }
 
+/**
+ * Return the exact sign of `dot(p - c, cross(a - c, b - c))`, that is,
+ * which side of the plane of triangle (a, b, c) (with the normal used by
+ * #Face::populate_plane) the point \a p is on.
+ */
+static int plane_side_exact(const Vert *p, const Vert *a, const Vert *b, const Vert *c)
+{
+#  ifdef PERFDEBUG
+  incperfcount(5); /* Plane side tests not decided by the filter. */
+#  endif
+  return orient3d(a, b, p, c);
+}
+
 /*
  * interesect_tri_tri and helper functions.
  * This code uses the algorithm of Guigue and Devillers, as described
@@ -1517,22 +1545,18 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
     return ITT_value(INONE);
   }
 
-  const mpq3 &p1 = vp1->co_exact;
-  const mpq3 &q1 = vq1->co_exact;
-  const mpq3 &r1 = vr1->co_exact;
-  const mpq3 &p2 = vp2->co_exact;
-  const mpq3 &q2 = vq2->co_exact;
-  const mpq3 &r2 = vr2->co_exact;
-
-  const mpq3 &n2 = tri2.plane->norm_exact;
+  /* The filter was inconclusive for some signs, so get those exactly.
+   * The plane normals are `cross(v0 - v2, v1 - v2)` of the triangle verts,
+   * so the sign of `dot(p - v2, n)` is the #orient3d of (v0, v1, p, v2).
+   * That avoids GMP arithmetic entirely when the verts are input verts. */
   if (sp1 == 0) {
-    sp1 = sgn(mpq3::dot(p1 - r2, n2));
+    sp1 = plane_side_exact(vp1, vp2, vq2, vr2);
   }
   if (sq1 == 0) {
-    sq1 = sgn(mpq3::dot(q1 - r2, n2));
+    sq1 = plane_side_exact(vq1, vp2, vq2, vr2);
   }
   if (sr1 == 0) {
-    sr1 = sgn(mpq3::dot(r1 - r2, n2));
+    sr1 = plane_side_exact(vr1, vp2, vq2, vr2);
   }
 
   if (dbg_level > 1) {
@@ -1550,15 +1574,14 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   }
 
   /* Repeat for signs of t2's vertices with respect to plane of t1. */
-  const mpq3 &n1 = tri1.plane->norm_exact;
   if (sp2 == 0) {
-    sp2 = sgn(mpq3::dot(p2 - r1, n1));
+    sp2 = plane_side_exact(vp2, vp1, vq1, vr1);
   }
   if (sq2 == 0) {
-    sq2 = sgn(mpq3::dot(q2 - r1, n1));
+    sq2 = plane_side_exact(vq2, vp1, vq1, vr1);
   }
   if (sr2 == 0) {
-    sr2 = sgn(mpq3::dot(r2 - r1, n1));
+    sr2 = plane_side_exact(vr2, vp1, vq1, vr1);
   }
 
   if (dbg_level > 1) {
@@ -1575,6 +1598,15 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
     return ITT_value(INONE);
   }
 
+  const mpq3 &p1 = vp1->co_exact;
+  const mpq3 &q1 = vq1->co_exact;
+  const mpq3 &r1 = vr1->co_exact;
+  const mpq3 &p2 = vp2->co_exact;
+  const mpq3 &q2 = vq2->co_exact;
+  const mpq3 &r2 = vr2->co_exact;
+  const mpq3 &n1 = tri1.plane->norm_exact;
+  const mpq3 &n2 = tri2.plane->norm_exact;
+
   /* Do rest of the work with vertices in a canonical order, where p1 is on
    * positive side of plane and q1, r1 are not, or p1 is on the plane and
    * q1 and r1 are off the plane on the same side. */
@@ -2871,6 +2903,18 @@ static void perfdata_init(void)
   perfdata->count.append(0);
   perfdata->count_name.append("final non-NONE intersects");
 
+  /* count 5. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("plane side tests not decided by filter");
+
+  /* count 6. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("orient3d decided by adaptive double arithmetic");
+
+  /* count 7. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("orient3d decided by exact arithmetic");
+
   /* max 0. */
   perfdata->max.append(0);
   perfdata->max_name.append("total faces");
@@ -132,3 +132,272 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+/* -------------------------------------------------------------------- */
+/* Flattened (Wide) Tree */
+
+static BVHTree *bvhtree_from_points(
+    float (*points)[3], int points_len, float epsilon, char tree_type, char axis)
+{
+  BVHTree *tree = BLI_bvhtree_new(points_len, epsilon, tree_type, axis);
+  for (int i = 0; i < points_len; i++) {
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+  return tree;
+}
+
+static void wide_find_nearest_test(int points_len, char tree_type, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  rng_v3_round(&points[0][0], points_len * 3, rng, 1000, 1.0f);
+
+  BVHTree *tree = bvhtree_from_points(points, points_len, 0.0f, tree_type, 6);
+  BVHTreeWide *wtree = BLI_bvhtree_wide_new(tree);
+  EXPECT_EQ(BLI_bvhtree_wide_get_len(wtree), points_len);
+
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * points_len,
+                                                          __func__);
+  for (int i = 0; i < points_len; i++) {
+    const int j = BLI_bvhtree_wide_find_nearest(
+        wtree, points[i], nullptr, optimal_check_callback, points);
+    EXPECT_EQ_ARRAY(points[i], points[j], 3);
+
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+
+  BLI_bvhtree_wide_find_nearest_batch(
+      wtree, points, points_len, nearest, optimal_check_callback, points);
+  for (int i = 0; i < points_len; i++) {
+    EXPECT_EQ_ARRAY(points[i], points[nearest[i].index], 3);
+  }
+
+  BLI_bvhtree_wide_free(wtree);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(nearest);
+  MEM_freeN(points);
+}
+
+TEST(kdopbvh, WideFindNearest_1)
+{
+  wide_find_nearest_test(1, 2, 1234);
+}
+TEST(kdopbvh, WideFindNearest_Binary_500)
+{
+  wide_find_nearest_test(500, 2, 12);
+}
+TEST(kdopbvh, WideFindNearest_Octree_500)
+{
+  wide_find_nearest_test(500, 8, 12);
+}
+
+#define SPHERE_RADIUS 0.01f
+
+static void sphere_raycast_callback(void *userdata,
+                                    int index,
+                                    const BVHTreeRay *ray,
+                                    BVHTreeRayHit *hit)
+{
+  float(*points)[3] = (float(*)[3])userdata;
+  float delta[3];
+  sub_v3_v3v3(delta, points[index], ray->origin);
+  const float b = dot_v3v3(delta, ray->direction);
+  const float disc = b * b - len_squared_v3(delta) + SPHERE_RADIUS * SPHERE_RADIUS;
+  if (disc < 0.0f) {
+    return;
+  }
+  const float dist = b - sqrtf(disc);
+  if (dist >= 0.0f && dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+static void wide_ray_cast_test(int points_len, int rays_len, char tree_type, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*ray_co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  float(*ray_dir)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * rays_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * rays_len, __func__);
+
+  rng_v3_round(&points[0][0], points_len * 3, rng, 1000, 1.0f);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(ray_co[i], 3, rng, 1000, 2.0f);
+    /* Aim close to a point, so most rays hit something. */
+    sub_v3_v3v3(ray_dir[i], points[i % points_len], ray_co[i]);
+    /* Include some axis aligned rays. */
+    if (i % 7 == 0) {
+      ray_dir[i][0] = ray_dir[i][1] = 0.0f;
+      ray_dir[i][2] = 1.0f;
+    }
+    normalize_v3(ray_dir[i]);
+  }
+
+  BVHTree *tree = bvhtree_from_points(points, points_len, SPHERE_RADIUS, tree_type, 6);
+  BVHTreeWide *wtree = BLI_bvhtree_wide_new(tree);
+
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit = {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX};
+    BLI_bvhtree_ray_cast(
+        tree, ray_co[i], ray_dir[i], 0.0f, &hit, sphere_raycast_callback, points);
+
+    BVHTreeRayHit whit = {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX};
+    BLI_bvhtree_wide_ray_cast(
+        wtree, ray_co[i], ray_dir[i], 0.0f, &whit, sphere_raycast_callback, points);
+    EXPECT_EQ(hit.index, whit.index);
+    if (hit.index != -1) {
+      EXPECT_FLOAT_EQ(hit.dist, whit.dist);
+    }
+
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+
+  BLI_bvhtree_wide_ray_cast_batch(wtree,
+                                  ray_co,
+                                  ray_dir,
+                                  rays_len,
+                                  0.0f,
+                                  hits,
+                                  sphere_raycast_callback,
+                                  points,
+                                  BVH_RAYCAST_DEFAULT);
+  for (int i = 0; i < rays_len; i++) {
+    BVHTreeRayHit hit = {-1, {0.0f}, {0.0f}, BVH_RAYCAST_DIST_MAX};
+    BLI_bvhtree_ray_cast(
+        tree, ray_co[i], ray_dir[i], 0.0f, &hit, sphere_raycast_callback, points);
+    EXPECT_EQ(hit.index, hits[i].index);
+  }
+
+  BLI_bvhtree_wide_free(wtree);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(hits);
+  MEM_freeN(ray_dir);
+  MEM_freeN(ray_co);
+  MEM_freeN(points);
+}
+
+TEST(kdopbvh, WideRayCast_Binary_500)
+{
+  wide_ray_cast_test(500, 500, 2, 12);
+}
+TEST(kdopbvh, WideRayCast_Quad_500)
+{
+  wide_ray_cast_test(500, 500, 4, 123);
+}
+TEST(kdopbvh, WideRayCast_Octree_500)
+{
+  wide_ray_cast_test(500, 500, 8, 1234);
+}
+
+static int overlap_pair_cmp(const void *a_v, const void *b_v)
+{
+  const BVHTreeOverlap *a = (const BVHTreeOverlap *)a_v;
+  const BVHTreeOverlap *b = (const BVHTreeOverlap *)b_v;
+  if (a->indexA != b->indexA) {
+    return a->indexA < b->indexA ? -1 : 1;
+  }
+  if (a->indexB != b->indexB) {
+    return a->indexB < b->indexB ? -1 : 1;
+  }
+  return 0;
+}
+
+static void wide_overlap_test(int points_len, char tree_type, int flag, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  float(*points_a)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*points_b)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  rng_v3_round(&points_a[0][0], points_len * 3, rng, 1000, 1.0f);
+  rng_v3_round(&points_b[0][0], points_len * 3, rng, 1000, 1.0f);
+
+  BVHTree *tree_a = bvhtree_from_points(points_a, points_len, 0.05f, tree_type, 6);
+  BVHTree *tree_b = bvhtree_from_points(points_b, points_len, 0.05f, tree_type, 6);
+  BVHTreeWide *wtree_a = BLI_bvhtree_wide_new(tree_a);
+  BVHTreeWide *wtree_b = BLI_bvhtree_wide_new(tree_b);
+
+  /* Compare against the regular tree, both for two trees and self overlap. */
+  const BVHTree *trees[2][2] = {{tree_a, tree_b}, {tree_a, tree_a}};
+  const BVHTreeWide *wtrees[2][2] = {{wtree_a, wtree_b}, {wtree_a, wtree_a}};
+  for (int i = 0; i < 2; i++) {
+    uint overlap_len = 0, woverlap_len = 0;
+    BVHTreeOverlap *overlap = BLI_bvhtree_overlap_ex(
+        trees[i][0], trees[i][1], &overlap_len, nullptr, nullptr, 0, flag);
+    BVHTreeOverlap *woverlap = BLI_bvhtree_wide_overlap(
+        wtrees[i][0], wtrees[i][1], &woverlap_len, nullptr, nullptr, flag);
+
+    EXPECT_GT(overlap_len, 0u);
+    EXPECT_EQ(overlap_len, woverlap_len);
+    if (overlap_len == woverlap_len) {
+      qsort(overlap, overlap_len, sizeof(*overlap), overlap_pair_cmp);
+      qsort(woverlap, woverlap_len, sizeof(*woverlap), overlap_pair_cmp);
+      for (uint j = 0; j < overlap_len; j++) {
+        EXPECT_EQ(overlap[j].indexA, woverlap[j].indexA);
+        EXPECT_EQ(overlap[j].indexB, woverlap[j].indexB);
+      }
+    }
+    MEM_SAFE_FREE(overlap);
+    MEM_SAFE_FREE(woverlap);
+  }
+
+  BLI_bvhtree_wide_free(wtree_a);
+  BLI_bvhtree_wide_free(wtree_b);
+  BLI_bvhtree_free(tree_a);
+  BLI_bvhtree_free(tree_b);
+  BLI_rng_free(rng);
+  MEM_freeN(points_a);
+  MEM_freeN(points_b);
+}
+
+TEST(kdopbvh, WideOverlap_Binary_500)
+{
+  wide_overlap_test(500, 2, BVH_OVERLAP_RETURN_PAIRS, 12);
+}
+TEST(kdopbvh, WideOverlap_Octree_500)
+{
+  wide_overlap_test(500, 8, BVH_OVERLAP_RETURN_PAIRS, 123);
+}
+TEST(kdopbvh, WideOverlap_Threaded_5000)
+{
+  wide_overlap_test(5000, 4, BVH_OVERLAP_RETURN_PAIRS | BVH_OVERLAP_USE_THREADING, 1234);
+}
+
+static bool wide_overlap_count_cb(void *userdata,
+                                  int UNUSED(index_a),
+                                  int UNUSED(index_b),
+                                  int UNUSED(thread))
+{
+  (*(uint *)userdata)++;
+  return true;
+}
+
+TEST(kdopbvh, WideOverlap_Callback)
+{
+  struct RNG *rng = BLI_rng_new(42);
+  const int points_len = 500;
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  rng_v3_round(&points[0][0], points_len * 3, rng, 1000, 1.0f);
+  BVHTree *tree = bvhtree_from_points(points, points_len, 0.05f, 4, 6);
+  BVHTreeWide *wtree = BLI_bvhtree_wide_new(tree);
+
+  /* Without #BVH_OVERLAP_RETURN_PAIRS only the callback runs, no pairs are returned. */
+  uint overlap_len = 0, callback_len = 0;
+  BVHTreeOverlap *overlap = BLI_bvhtree_wide_overlap(
+      wtree, wtree, &overlap_len, nullptr, nullptr, BVH_OVERLAP_RETURN_PAIRS);
+  BVHTreeOverlap *overlap_none = BLI_bvhtree_wide_overlap(
+      wtree, wtree, nullptr, wide_overlap_count_cb, &callback_len, 0);
+  EXPECT_GT(overlap_len, 0u);
+  EXPECT_EQ(overlap_none, nullptr);
+  EXPECT_EQ(callback_len, overlap_len);
+
+  MEM_SAFE_FREE(overlap);
+  BLI_bvhtree_wide_free(wtree);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+}
@@ -174,6 +174,27 @@ TEST(mesh_intersect, Mesh)
   EXPECT_TRUE(f->is_tri());
 }
 
+TEST(mesh_intersect, VertOrient3d)
+{
+  IMeshArena arena;
+
+  const Vert *v0 = arena.add_or_find_vert(mpq3(0, 0, 0), 0);
+  const Vert *v1 = arena.add_or_find_vert(mpq3(1, 0, 0), 1);
+  const Vert *v2 = arena.add_or_find_vert(mpq3(0, 1, 0), 2);
+  const Vert *v_below = arena.add_or_find_vert(mpq3(1, 1, -1), 3);
+  const Vert *v_on = arena.add_or_find_vert(mpq3(3, -2, 0), 4);
+  /* Not representable as a double, so needs exact arithmetic. */
+  const Vert *v_above = arena.add_or_find_vert(mpq3(mpq_class(1, 3), 0, mpq_class(1, 3)), 5);
+  EXPECT_TRUE(v0->co_is_exact);
+  EXPECT_TRUE(v_below->co_is_exact);
+  EXPECT_FALSE(v_above->co_is_exact);
+
+  EXPECT_EQ(orient3d(v0, v1, v2, v_below), 1);
+  EXPECT_EQ(orient3d(v0, v1, v2, v_on), 0);
+  EXPECT_EQ(orient3d(v0, v1, v2, v_above), -1);
+  EXPECT_EQ(orient3d(v0, v2, v1, v_above), 1);
+}
+
 TEST(mesh_intersect, OneTri)
 {
   const char *spec = R"(3 1
@@ -0,0 +1,197 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vector.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time_utildefines.h"
+
+/* Run the biggest tests! */
+//#define KDOPBVH_RUN_BIG
+
+#define QUERIES_NUM 1000000
+
+/* Leafs are small boxes around random points, queries return the box without callbacks,
+ * so timing is dominated by the tree traversal itself. */
+
+static void rng_points(float (*points)[3], int points_len, struct RNG *rng, float scale)
+{
+  for (int i = 0; i < points_len; i++) {
+    for (int j = 0; j < 3; j++) {
+      points[i][j] = (BLI_rng_get_float(rng) * 2.0f - 1.0f) * scale;
+    }
+  }
+}
+
+static void kdopbvh_query_tests(int points_len, char tree_type, char axis, const char *id)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  struct RNG *rng = BLI_rng_new(0);
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * points_len, __func__);
+  float(*query_co)[3] = (float(*)[3])MEM_mallocN(sizeof(*query_co) * QUERIES_NUM, __func__);
+  float(*query_dir)[3] = (float(*)[3])MEM_mallocN(sizeof(*query_dir) * QUERIES_NUM, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * QUERIES_NUM, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * QUERIES_NUM,
+                                                          __func__);
+
+  rng_points(points, points_len, rng, 1.0f);
+  rng_points(query_co, QUERIES_NUM, rng, 1.5f);
+  rng_points(query_dir, QUERIES_NUM, rng, 1.0f);
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    normalize_v3(query_dir[i]);
+  }
+
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.001f, tree_type, axis);
+  for (int i = 0; i < points_len; i++) {
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance(tree);
+
+  BVHTreeWide *wtree;
+  {
+    TIMEIT_START(wide_build);
+    wtree = BLI_bvhtree_wide_new(tree);
+    TIMEIT_END(wide_build);
+  }
+
+  int hits_tree = 0, hits_wide = 0, hits_batch = 0;
+
+  {
+    TIMEIT_START(ray_cast);
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      if (BLI_bvhtree_ray_cast(tree, query_co[i], query_dir[i], 0.0f, nullptr, nullptr, nullptr) !=
+          -1) {
+        hits_tree++;
+      }
+    }
+    TIMEIT_END(ray_cast);
+  }
+  {
+    TIMEIT_START(wide_ray_cast);
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      if (BLI_bvhtree_wide_ray_cast(
+              wtree, query_co[i], query_dir[i], 0.0f, nullptr, nullptr, nullptr) != -1) {
+        hits_wide++;
+      }
+    }
+    TIMEIT_END(wide_ray_cast);
+  }
+  {
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      hits[i].index = -1;
+      hits[i].dist = BVH_RAYCAST_DIST_MAX;
+    }
+    TIMEIT_START(wide_ray_cast_batch);
+    BLI_bvhtree_wide_ray_cast_batch(wtree,
+                                    query_co,
+                                    query_dir,
+                                    QUERIES_NUM,
+                                    0.0f,
+                                    hits,
+                                    nullptr,
+                                    nullptr,
+                                    BVH_RAYCAST_DEFAULT);
+    TIMEIT_END(wide_ray_cast_batch);
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      if (hits[i].index != -1) {
+        hits_batch++;
+      }
+    }
+  }
+  printf("Ray hits: %d (tree), %d (wide), %d (wide batch)\n", hits_tree, hits_wide, hits_batch);
+  EXPECT_EQ(hits_wide, hits_batch);
+
+  {
+    TIMEIT_START(find_nearest);
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      BLI_bvhtree_find_nearest(tree, query_co[i], nullptr, nullptr, nullptr);
+    }
+    TIMEIT_END(find_nearest);
+  }
+  {
+    TIMEIT_START(find_nearest_optimal);
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      BLI_bvhtree_find_nearest_ex(
+          tree, query_co[i], nullptr, nullptr, nullptr, BVH_NEAREST_OPTIMAL_ORDER);
+    }
+    TIMEIT_END(find_nearest_optimal);
+  }
+  {
+    TIMEIT_START(wide_find_nearest);
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      BLI_bvhtree_wide_find_nearest(wtree, query_co[i], nullptr, nullptr, nullptr);
+    }
+    TIMEIT_END(wide_find_nearest);
+  }
+  {
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      nearest[i].index = -1;
+      nearest[i].dist_sq = FLT_MAX;
+    }
+    TIMEIT_START(wide_find_nearest_batch);
+    BLI_bvhtree_wide_find_nearest_batch(wtree, query_co, QUERIES_NUM, nearest, nullptr, nullptr);
+    TIMEIT_END(wide_find_nearest_batch);
+  }
+
+  {
+    uint overlap_len = 0, woverlap_len = 0;
+    BVHTreeOverlap *overlap, *woverlap;
+    {
+      TIMEIT_START(self_overlap);
+      overlap = BLI_bvhtree_overlap(tree, tree, &overlap_len, nullptr, nullptr);
+      TIMEIT_END(self_overlap);
+    }
+    {
+      TIMEIT_START(wide_self_overlap);
+      woverlap = BLI_bvhtree_wide_overlap(wtree,
+                                          wtree,
+                                          &woverlap_len,
+                                          nullptr,
+                                          nullptr,
+                                          BVH_OVERLAP_USE_THREADING | BVH_OVERLAP_RETURN_PAIRS);
+      TIMEIT_END(wide_self_overlap);
+    }
+    printf("Overlap pairs: %u (tree), %u (wide)\n", overlap_len, woverlap_len);
+    MEM_SAFE_FREE(overlap);
+    MEM_SAFE_FREE(woverlap);
+  }
+
+  BLI_bvhtree_wide_free(wtree);
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(nearest);
+  MEM_freeN(hits);
+  MEM_freeN(query_dir);
+  MEM_freeN(query_co);
+  MEM_freeN(points);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, Binary_100k)
+{
+  kdopbvh_query_tests(100000, 2, 6, "Binary tree 100k leafs");
+}
+
+TEST(kdopbvh, Quad_100k)
+{
+  kdopbvh_query_tests(100000, 4, 6, "Quad tree 100k leafs");
+}
+
+TEST(kdopbvh, Octree_26DOP_100k)
+{
+  kdopbvh_query_tests(100000, 8, 26, "Octree 26-DOP 100k leafs");
+}
+
+#ifdef KDOPBVH_RUN_BIG
+TEST(kdopbvh, Quad_10M)
+{
+  kdopbvh_query_tests(10000000, 4, 6, "Quad tree 10M leafs");
+}
+#endif
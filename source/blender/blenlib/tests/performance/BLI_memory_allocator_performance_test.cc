@@ -0,0 +1,128 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time_utildefines.h"
+
+/* Compare the allocator backends on the patterns which are common in threaded code: many small
+ * short lived blocks, blocks outliving the task they were allocated in, and large arrays. */
+
+#define BLOCKS_NUM 1000000
+#define TASKS_NUM 256
+
+static size_t block_size(int i)
+{
+  /* 'Random' small sizes, biased towards the smallest ones like in mesh data. */
+  const uint hash = (uint)i * 2654435761u;
+  return (hash >> 24) < 192 ? 16 + ((hash >> 8) & 63) : 64 + ((hash >> 8) & 2047);
+}
+
+static void alloc_free_func(void *__restrict UNUSED(userdata),
+                            const int task,
+                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  void *blocks[64];
+  for (int i = 0; i < BLOCKS_NUM / TASKS_NUM; i += ARRAY_SIZE(blocks)) {
+    for (int j = 0; j < ARRAY_SIZE(blocks); j++) {
+      blocks[j] = MEM_mallocN(block_size(task * BLOCKS_NUM + i + j), __func__);
+    }
+    for (int j = 0; j < ARRAY_SIZE(blocks); j++) {
+      MEM_freeN(blocks[j]);
+    }
+  }
+}
+
+static void alloc_func(void *__restrict userdata,
+                       const int task,
+                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  void **blocks = (void **)userdata;
+  for (int i = task * (BLOCKS_NUM / TASKS_NUM); i < (task + 1) * (BLOCKS_NUM / TASKS_NUM); i++) {
+    blocks[i] = MEM_mallocN(block_size(i), __func__);
+  }
+}
+
+static void free_func(void *__restrict userdata,
+                      const int task,
+                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  void **blocks = (void **)userdata;
+  /* Free blocks of another task, which most likely ran on another thread. */
+  const int other = (task + TASKS_NUM / 2) % TASKS_NUM;
+  for (int i = other * (BLOCKS_NUM / TASKS_NUM); i < (other + 1) * (BLOCKS_NUM / TASKS_NUM);
+       i++) {
+    MEM_freeN(blocks[i]);
+  }
+}
+
+static void memory_allocator_tests(const char *id)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  {
+    TIMEIT_START(single_thread_alloc_free);
+    for (int task = 0; task < TASKS_NUM; task++) {
+      alloc_free_func(nullptr, task, nullptr);
+    }
+    TIMEIT_END(single_thread_alloc_free);
+  }
+  {
+    TIMEIT_START(threaded_alloc_free);
+    BLI_task_parallel_range(0, TASKS_NUM, nullptr, alloc_free_func, &settings);
+    TIMEIT_END(threaded_alloc_free);
+  }
+  {
+    void **blocks = (void **)malloc(sizeof(*blocks) * BLOCKS_NUM);
+    TIMEIT_START(threaded_alloc_then_free);
+    BLI_task_parallel_range(0, TASKS_NUM, blocks, alloc_func, &settings);
+    BLI_task_parallel_range(0, TASKS_NUM, blocks, free_func, &settings);
+    TIMEIT_END(threaded_alloc_then_free);
+    free(blocks);
+  }
+  {
+    TIMEIT_START(large_array_fill);
+    for (int i = 0; i < 16; i++) {
+      const size_t len = (size_t)64 * 1024 * 1024;
+      char *array = (char *)MEM_mallocN(len, __func__);
+      for (size_t j = 0; j < len; j += 64) {
+        array[j] = (char)j;
+      }
+      MEM_freeN(array);
+    }
+    TIMEIT_END(large_array_fill);
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+/* Blocks can only be freed by the allocator they come from, so switch before anything is
+ * allocated, and back to the allocator of the test runner once everything is freed again. */
+
+TEST(memory_allocator, LockFree)
+{
+  MEM_use_lockfree_allocator();
+  BLI_threadapi_init();
+  memory_allocator_tests("Lock-free allocator");
+  BLI_threadapi_exit();
+  MEM_use_guarded_allocator();
+}
+
+TEST(memory_allocator, SizeClass)
+{
+  MEM_use_sizeclass_allocator();
+  BLI_threadapi_init();
+  memory_allocator_tests("Size class allocator");
+  BLI_threadapi_exit();
+  MEM_use_guarded_allocator();
+}
@@ -193,21 +193,65 @@ void BM_face_interp_from_face_ex(BMesh *bm,
   float co[2];
   int i;
 
-  if (f_src != f_dst) {
-    BM_elem_attrs_copy(bm, bm, f_src, f_dst);
+  if (f_src == f_dst) {
+    /* The blocks may be the ones being written to, interpolate one loop at a time. */
+    l_iter = l_first = BM_FACE_FIRST_LOOP(f_dst);
+    do {
+      mul_v2_m3v3(co, axis_mat, l_iter->v->co);
+      interp_weights_poly_v2(w, cos_2d, f_src->len, co);
+      CustomData_bmesh_interp(&bm->ldata, blocks_l, w, NULL, f_src->len, l_iter->head.data);
+      if (do_vertex) {
+        CustomData_bmesh_interp(&bm->vdata, blocks_v, w, NULL, f_src->len, l_iter->v->head.data);
+      }
+    } while ((l_iter = l_iter->next) != l_first);
+    return;
   }
 
-  /* interpolate */
+  BM_elem_attrs_copy(bm, bm, f_src, f_dst);
+
+  /* Compute the weights of all loops first, so every layer is interpolated in one pass.
+   * Their number grows with the square of the face size, only use the stack for small faces. */
+  const size_t w_all_len = (size_t)f_dst->len * (size_t)f_src->len;
+  const bool w_all_is_heap = w_all_len > BM_DEFAULT_NGON_STACK_SIZE * BM_DEFAULT_NGON_STACK_SIZE;
+  float *w_all = w_all_is_heap ? MEM_malloc_arrayN(w_all_len, sizeof(*w_all), __func__) :
+                                 BLI_array_alloca(w_all, w_all_len);
+  void **dst_blocks_l = BLI_array_alloca(dst_blocks_l, f_dst->len);
+  void **dst_blocks_v = do_vertex ? BLI_array_alloca(dst_blocks_v, f_dst->len) : NULL;
+  /* Vertices shared with the source face are both read and written. */
+  bool use_vertex_batch = do_vertex;
+
   i = 0;
   l_iter = l_first = BM_FACE_FIRST_LOOP(f_dst);
   do {
     mul_v2_m3v3(co, axis_mat, l_iter->v->co);
-    interp_weights_poly_v2(w, cos_2d, f_src->len, co);
-    CustomData_bmesh_interp(&bm->ldata, blocks_l, w, NULL, f_src->len, l_iter->head.data);
+    interp_weights_poly_v2(&w_all[i * f_src->len], cos_2d, f_src->len, co);
+    dst_blocks_l[i] = l_iter->head.data;
     if (do_vertex) {
-      CustomData_bmesh_interp(&bm->vdata, blocks_v, w, NULL, f_src->len, l_iter->v->head.data);
+      dst_blocks_v[i] = l_iter->v->head.data;
+      for (int j = 0; j < f_src->len; j++) {
+        if (blocks_v[j] == dst_blocks_v[i]) {
+          use_vertex_batch = false;
+        }
+      }
     }
   } while ((void)i++, (l_iter = l_iter->next) != l_first);
+
+  CustomData_bmesh_interp_batch(&bm->ldata, blocks_l, w_all, f_src->len, dst_blocks_l, f_dst->len);
+
+  if (use_vertex_batch) {
+    CustomData_bmesh_interp_batch(
+        &bm->vdata, blocks_v, w_all, f_src->len, dst_blocks_v, f_dst->len);
+  }
+  else if (do_vertex) {
+    for (i = 0; i < f_dst->len; i++) {
+      CustomData_bmesh_interp(
+          &bm->vdata, blocks_v, &w_all[i * f_src->len], NULL, f_src->len, dst_blocks_v[i]);
+    }
+  }
+
+  if (w_all_is_heap) {
+    MEM_freeN(w_all);
+  }
 }
 
 void BM_face_interp_from_face(BMesh *bm, BMFace *f_dst, const BMFace *f_src, const bool do_vertex)
@@ -81,6 +81,8 @@
 #include "BLI_alloca.h"
 #include "BLI_listbase.h"
 #include "BLI_math_vector.h"
+#include "BLI_mempool.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -176,6 +178,384 @@ static BMFace *bm_face_create_from_mpoly(
   return BM_face_create(bm, verts, edges, mp->totloop, NULL, BM_CREATE_SKIP_CD);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh -> BMesh Bulk Construction
+ *
+ * Creating elements one at a time with #BM_vert_create & #BM_face_create is dominated by
+ * the custom-data copying and linking the disk & radial cycles, which can't run in parallel.
+ * When converting into a new #BMesh all elements are allocated up-front instead,
+ * then filled in & linked in parallel from vertex/edge & edge/loop maps.
+ *
+ * The resulting #BMesh is identical to the one created one element at a time,
+ * including the memory layout and the order of disk & radial cycles.
+ * \{ */
+
+typedef struct BMFromMeshBulkData {
+  BMesh *bm;
+  const Mesh *me;
+
+  BMVert **vtable;
+  BMEdge **etable;
+  BMFace **ftable;
+  BMLoop **ltable;
+
+  /** Edges using each vertex, in the order they're added to the disk cycle. */
+  int *vert_edges_offset;
+  int *vert_edges;
+  /** Loops using each edge, in the order they're added to the radial cycle. */
+  int *edge_loops_offset;
+  int *edge_loops;
+  /** First loop of each face in #BMesh loop order (faces may not use ascending loops). */
+  int *face_loops_offset;
+
+  const float (*keyco)[3];
+  const float (**shape_key_table)[3];
+  int tot_shape_keys;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+  int cd_shape_key_offset;
+  int cd_shape_keyindex_offset;
+
+  bool calc_face_normal;
+} BMFromMeshBulkData;
+
+static bool bm_mesh_from_me_bulk_poll(const BMesh *bm, const Mesh *me)
+{
+  if (bm->totvert || bm->totedge || bm->totface) {
+    return false;
+  }
+  if (me->totvert < BM_OMP_LIMIT) {
+    return false;
+  }
+  /* The element at a time creation skips faces without loops, keep using it for such meshes. */
+  const MPoly *mp = me->mpoly;
+  for (int i = 0; i < me->totpoly; i++, mp++) {
+    if (UNLIKELY(mp->totloop == 0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+BLI_INLINE void *bm_mesh_from_me_bulk_cd_alloc(CustomData *cdata)
+{
+  return (cdata->totsize > 0) ? BLI_mempool_alloc(cdata->pool) : NULL;
+}
+
+/**
+ * Allocate elements in the order they would be created one at a time,
+ * the custom-data blocks are allocated here too so filling them in doesn't touch the pools.
+ */
+static void bm_mesh_from_me_bulk_alloc(BMFromMeshBulkData *data)
+{
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  int i;
+
+  for (i = 0; i < me->totvert; i++) {
+    BMVert *v = BLI_mempool_alloc(bm->vpool);
+    v->head.data = bm_mesh_from_me_bulk_cd_alloc(&bm->vdata);
+    if (bm->use_toolflags) {
+      ((BMVert_OFlag *)v)->oflags = bm->vtoolflagpool ? BLI_mempool_calloc(bm->vtoolflagpool) :
+                                                        NULL;
+    }
+    data->vtable[i] = v;
+  }
+  for (i = 0; i < me->totedge; i++) {
+    BMEdge *e = BLI_mempool_alloc(bm->epool);
+    e->head.data = bm_mesh_from_me_bulk_cd_alloc(&bm->edata);
+    if (bm->use_toolflags) {
+      ((BMEdge_OFlag *)e)->oflags = bm->etoolflagpool ? BLI_mempool_calloc(bm->etoolflagpool) :
+                                                        NULL;
+    }
+    data->etable[i] = e;
+  }
+  for (i = 0; i < me->totpoly; i++) {
+    BMFace *f = BLI_mempool_alloc(bm->fpool);
+    f->head.data = bm_mesh_from_me_bulk_cd_alloc(&bm->pdata);
+    if (bm->use_toolflags) {
+      ((BMFace_OFlag *)f)->oflags = bm->ftoolflagpool ? BLI_mempool_calloc(bm->ftoolflagpool) :
+                                                        NULL;
+    }
+    data->ftable[i] = f;
+  }
+  for (i = 0; i < me->totloop; i++) {
+    BMLoop *l = BLI_mempool_alloc(bm->lpool);
+    l->head.data = bm_mesh_from_me_bulk_cd_alloc(&bm->ldata);
+    data->ltable[i] = l;
+  }
+
+  bm->totvert = me->totvert;
+  bm->totedge = me->totedge;
+  bm->totface = me->totpoly;
+  bm->totloop = me->totloop;
+}
+
+/**
+ * Build the vertex/edge and edge/loop maps, these only store indices so stay serial.
+ */
+static void bm_mesh_from_me_bulk_maps_create(BMFromMeshBulkData *data)
+{
+  const Mesh *me = data->me;
+  int i;
+
+  int *vert_edges_offset = MEM_callocN(sizeof(int) * (size_t)(me->totvert + 1), __func__);
+  int *vert_edges = MEM_mallocN(sizeof(int) * (size_t)me->totedge * 2, __func__);
+  const MEdge *med = me->medge;
+  for (i = 0; i < me->totedge; i++, med++) {
+    vert_edges_offset[med->v1 + 1]++;
+    vert_edges_offset[med->v2 + 1]++;
+  }
+  for (i = 0; i < me->totvert; i++) {
+    vert_edges_offset[i + 1] += vert_edges_offset[i];
+  }
+  {
+    int *fill = MEM_dupallocN(vert_edges_offset);
+    med = me->medge;
+    for (i = 0; i < me->totedge; i++, med++) {
+      vert_edges[fill[med->v1]++] = i;
+      vert_edges[fill[med->v2]++] = i;
+    }
+    MEM_freeN(fill);
+  }
+
+  int *face_loops_offset = MEM_mallocN(sizeof(int) * (size_t)me->totpoly, __func__);
+  int *edge_loops_offset = MEM_callocN(sizeof(int) * (size_t)(me->totedge + 1), __func__);
+  int *edge_loops = MEM_mallocN(sizeof(int) * (size_t)me->totloop, __func__);
+  const MPoly *mp = me->mpoly;
+  int totloops = 0;
+  for (i = 0; i < me->totpoly; i++, mp++) {
+    face_loops_offset[i] = totloops;
+    totloops += mp->totloop;
+    const MLoop *ml = &me->mloop[mp->loopstart];
+    for (int j = 0; j < mp->totloop; j++, ml++) {
+      edge_loops_offset[ml->e + 1]++;
+    }
+  }
+  for (i = 0; i < me->totedge; i++) {
+    edge_loops_offset[i + 1] += edge_loops_offset[i];
+  }
+  {
+    int *fill = MEM_dupallocN(edge_loops_offset);
+    mp = me->mpoly;
+    for (i = 0; i < me->totpoly; i++, mp++) {
+      const MLoop *ml = &me->mloop[mp->loopstart];
+      for (int j = 0; j < mp->totloop; j++, ml++) {
+        edge_loops[fill[ml->e]++] = face_loops_offset[i] + j;
+      }
+    }
+    MEM_freeN(fill);
+  }
+
+  data->vert_edges_offset = vert_edges_offset;
+  data->vert_edges = vert_edges;
+  data->edge_loops_offset = edge_loops_offset;
+  data->edge_loops = edge_loops;
+  data->face_loops_offset = face_loops_offset;
+}
+
+static void bm_mesh_from_me_bulk_maps_free(BMFromMeshBulkData *data)
+{
+  MEM_freeN(data->vert_edges_offset);
+  MEM_freeN(data->vert_edges);
+  MEM_freeN(data->edge_loops_offset);
+  MEM_freeN(data->edge_loops);
+  MEM_freeN(data->face_loops_offset);
+}
+
+static void bm_mesh_from_me_bulk_verts_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshBulkData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MVert *mvert = &me->mvert[i];
+  BMVert *v = data->vtable[i];
+
+  v->head.htype = BM_VERT;
+  v->head.hflag = BM_vert_flag_from_mflag(mvert->flag & ~SELECT);
+  v->head.api_flag = 0;
+  BM_elem_index_set(v, i); /* set_ok */
+
+  copy_v3_v3(v->co, data->keyco ? data->keyco[i] : mvert->co);
+  normal_short_to_float_v3(v->no, mvert->no);
+
+  /* Disk cycle, matching the order of #bmesh_disk_edge_append. */
+  const int *edges = &data->vert_edges[data->vert_edges_offset[i]];
+  const int edges_len = data->vert_edges_offset[i + 1] - data->vert_edges_offset[i];
+  v->e = edges_len ? data->etable[edges[0]] : NULL;
+  for (int j = 0; j < edges_len; j++) {
+    BMEdge *e = data->etable[edges[j]];
+    BMDiskLink *dl = ((int)me->medge[edges[j]].v1 == i) ? &e->v1_disk_link : &e->v2_disk_link;
+    dl->next = data->etable[edges[(j + 1) % edges_len]];
+    dl->prev = data->etable[edges[(j + edges_len - 1) % edges_len]];
+  }
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+  }
+
+  /* Set shape key original index. */
+  if (data->cd_shape_keyindex_offset != -1) {
+    BM_ELEM_CD_SET_INT(v, data->cd_shape_keyindex_offset, i);
+  }
+
+  /* Set shape-key data. */
+  if (data->tot_shape_keys) {
+    float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, data->cd_shape_key_offset);
+    for (int j = 0; j < data->tot_shape_keys; j++, co_dst++) {
+      copy_v3_v3(*co_dst, data->shape_key_table[j][i]);
+    }
+  }
+}
+
+static void bm_mesh_from_me_bulk_edges_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshBulkData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MEdge *medge = &me->medge[i];
+  BMEdge *e = data->etable[i];
+
+  e->head.htype = BM_EDGE;
+  e->head.hflag = BM_edge_flag_from_mflag(medge->flag & ~SELECT);
+  e->head.api_flag = 0;
+  BM_elem_index_set(e, i); /* set_ok */
+
+  e->v1 = data->vtable[medge->v1];
+  e->v2 = data->vtable[medge->v2];
+
+  /* Radial cycle, matching the order of #bmesh_radial_loop_append,
+   * which leaves the last loop added as the edges loop. */
+  const int *loops = &data->edge_loops[data->edge_loops_offset[i]];
+  const int loops_len = data->edge_loops_offset[i + 1] - data->edge_loops_offset[i];
+  e->l = loops_len ? data->ltable[loops[loops_len - 1]] : NULL;
+  for (int j = 0; j < loops_len; j++) {
+    BMLoop *l = data->ltable[loops[j]];
+    l->radial_next = data->ltable[loops[(j + 1) % loops_len]];
+    l->radial_prev = data->ltable[loops[(j + loops_len - 1) % loops_len]];
+  }
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+
+  if (data->cd_edge_bweight_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+  }
+  if (data->cd_edge_crease_offset != -1) {
+    BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset, (float)medge->crease / 255.0f);
+  }
+}
+
+static void bm_mesh_from_me_bulk_faces_cb(void *__restrict userdata,
+                                          const int i,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMFromMeshBulkData *data = userdata;
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+  const MPoly *mp = &me->mpoly[i];
+  BMFace *f = data->ftable[i];
+
+  f->head.htype = BM_FACE;
+  f->head.hflag = BM_face_flag_from_mflag(mp->flag & ~ME_FACE_SEL);
+  f->head.api_flag = 0;
+  BM_elem_index_set(f, i); /* set_ok */
+
+  f->mat_nr = mp->mat_nr;
+  f->len = mp->totloop;
+
+  const int l_index = data->face_loops_offset[i];
+  BMLoop **loops = &data->ltable[l_index];
+  f->l_first = loops[0];
+  for (int j = 0; j < mp->totloop; j++) {
+    const MLoop *ml = &me->mloop[mp->loopstart + j];
+    BMLoop *l = loops[j];
+
+    l->head.htype = BM_LOOP;
+    l->head.hflag = 0;
+    l->head.api_flag = 0;
+    BM_elem_index_set(l, l_index + j); /* set_ok */
+
+    l->v = data->vtable[ml->v];
+    l->e = data->etable[ml->e];
+    l->f = f;
+    l->next = loops[(j + 1) % mp->totloop];
+    l->prev = loops[(j + mp->totloop - 1) % mp->totloop];
+
+    CustomData_to_bmesh_block(&me->ldata, &bm->ldata, mp->loopstart + j, &l->head.data, true);
+  }
+
+  /* Copy Custom Data */
+  CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+
+  if (data->calc_face_normal) {
+    BM_face_normal_update(f);
+  }
+  else {
+    zero_v3(f->no);
+  }
+}
+
+/**
+ * Create all elements of \a me in a new \a bm, filling in \a data tables.
+ */
+static void bm_mesh_from_me_bulk(BMFromMeshBulkData *data)
+{
+  BMesh *bm = data->bm;
+  const Mesh *me = data->me;
+
+  bm_mesh_from_me_bulk_alloc(data);
+  bm_mesh_from_me_bulk_maps_create(data);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  /* Vertices first, face normals use their coordinates. */
+  BLI_task_parallel_range(0, me->totvert, data, bm_mesh_from_me_bulk_verts_cb, &settings);
+  BLI_task_parallel_range(0, me->totedge, data, bm_mesh_from_me_bulk_edges_cb, &settings);
+  BLI_task_parallel_range(0, me->totpoly, data, bm_mesh_from_me_bulk_faces_cb, &settings);
+
+  bm_mesh_from_me_bulk_maps_free(data);
+
+  /* Added in order, only the tables are dirty. */
+  bm->elem_index_dirty &= ~(BM_VERT | BM_EDGE | BM_FACE | BM_LOOP);
+  bm->elem_table_dirty |= BM_VERT | BM_EDGE | BM_FACE;
+  bm->spacearr_dirty |= BM_SPACEARR_DIRTY_ALL;
+
+  /* Selection flushes to connected elements, so it's set once all elements exist. */
+  int i;
+  for (i = 0; i < me->totvert; i++) {
+    if (me->mvert[i].flag & SELECT) {
+      BM_vert_select_set(bm, data->vtable[i], true);
+    }
+  }
+  for (i = 0; i < me->totedge; i++) {
+    if (me->medge[i].flag & SELECT) {
+      BM_edge_select_set(bm, data->etable[i], true);
+    }
+  }
+  for (i = 0; i < me->totpoly; i++) {
+    if (me->mpoly[i].flag & ME_FACE_SEL) {
+      BM_face_select_set(bm, data->ftable[i], true);
+    }
+  }
+  if (me->act_face >= 0 && me->act_face < me->totpoly) {
+    bm->act_face = data->ftable[me->act_face];
+  }
+}
+
+/** \} */
+
 /**
  * \brief Mesh -> BMesh
  * \param bm: The mesh to write into, while this is typically a newly created BMesh,
@@ -313,136 +693,160 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
                                            -1;
 
   vtable = MEM_mallocN(sizeof(BMVert **) * me->totvert, __func__);
+  etable = MEM_mallocN(sizeof(BMEdge **) * me->totedge, __func__);
 
-  for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
-    v = vtable[i] = BM_vert_create(bm, keyco ? keyco[i] : mvert->co, NULL, BM_CREATE_SKIP_CD);
-    BM_elem_index_set(v, i); /* set_ok */
+  if (is_new && bm_mesh_from_me_bulk_poll(bm, me)) {
+    ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
+    BMLoop **ltable = MEM_mallocN(sizeof(BMLoop **) * me->totloop, __func__);
+    BMFromMeshBulkData data = {
+        .bm = bm,
+        .me = me,
+        .vtable = vtable,
+        .etable = etable,
+        .ftable = ftable,
+        .ltable = ltable,
+        .keyco = (const float(*)[3])keyco,
+        .shape_key_table = shape_key_table,
+        .tot_shape_keys = tot_shape_keys,
+        .cd_vert_bweight_offset = cd_vert_bweight_offset,
+        .cd_edge_bweight_offset = cd_edge_bweight_offset,
+        .cd_edge_crease_offset = cd_edge_crease_offset,
+        .cd_shape_key_offset = cd_shape_key_offset,
+        .cd_shape_keyindex_offset = cd_shape_keyindex_offset,
+        .calc_face_normal = params->calc_face_normal,
+    };
+    bm_mesh_from_me_bulk(&data);
+    MEM_freeN(ltable);
+  }
+  else {
+    for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
+      v = vtable[i] = BM_vert_create(bm, keyco ? keyco[i] : mvert->co, NULL, BM_CREATE_SKIP_CD);
+      BM_elem_index_set(v, i); /* set_ok */
 
-    /* Transfer flag. */
-    v->head.hflag = BM_vert_flag_from_mflag(mvert->flag & ~SELECT);
+      /* Transfer flag. */
+      v->head.hflag = BM_vert_flag_from_mflag(mvert->flag & ~SELECT);
 
-    /* This is necessary for selection counts to work properly. */
-    if (mvert->flag & SELECT) {
-      BM_vert_select_set(bm, v, true);
-    }
+      /* This is necessary for selection counts to work properly. */
+      if (mvert->flag & SELECT) {
+        BM_vert_select_set(bm, v, true);
+      }
 
-    normal_short_to_float_v3(v->no, mvert->no);
+      normal_short_to_float_v3(v->no, mvert->no);
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
+      /* Copy Custom Data */
+      CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
 
-    if (cd_vert_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
-    }
+      if (cd_vert_bweight_offset != -1) {
+        BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+      }
 
-    /* Set shape key original index. */
-    if (cd_shape_keyindex_offset != -1) {
-      BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-    }
+      /* Set shape key original index. */
+      if (cd_shape_keyindex_offset != -1) {
+        BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
+      }
 
-    /* Set shape-key data. */
-    if (tot_shape_keys) {
-      float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
-      for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
-        copy_v3_v3(*co_dst, shape_key_table[j][i]);
+      /* Set shape-key data. */
+      if (tot_shape_keys) {
+        float(*co_dst)[3] = BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
+        for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
+          copy_v3_v3(*co_dst, shape_key_table[j][i]);
+        }
       }
     }
-  }
-  if (is_new) {
-    bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
-  }
-
-  etable = MEM_mallocN(sizeof(BMEdge **) * me->totedge, __func__);
+    if (is_new) {
+      bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
+    }
 
-  medge = me->medge;
-  for (i = 0; i < me->totedge; i++, medge++) {
-    e = etable[i] = BM_edge_create(
-        bm, vtable[medge->v1], vtable[medge->v2], NULL, BM_CREATE_SKIP_CD);
-    BM_elem_index_set(e, i); /* set_ok */
+    medge = me->medge;
+    for (i = 0; i < me->totedge; i++, medge++) {
+      e = etable[i] = BM_edge_create(
+          bm, vtable[medge->v1], vtable[medge->v2], NULL, BM_CREATE_SKIP_CD);
+      BM_elem_index_set(e, i); /* set_ok */
 
-    /* Transfer flags. */
-    e->head.hflag = BM_edge_flag_from_mflag(medge->flag & ~SELECT);
+      /* Transfer flags. */
+      e->head.hflag = BM_edge_flag_from_mflag(medge->flag & ~SELECT);
 
-    /* This is necessary for selection counts to work properly. */
-    if (medge->flag & SELECT) {
-      BM_edge_select_set(bm, e, true);
-    }
+      /* This is necessary for selection counts to work properly. */
+      if (medge->flag & SELECT) {
+        BM_edge_select_set(bm, e, true);
+      }
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+      /* Copy Custom Data */
+      CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
 
-    if (cd_edge_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+      if (cd_edge_bweight_offset != -1) {
+        BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+      }
+      if (cd_edge_crease_offset != -1) {
+        BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge->crease / 255.0f);
+      }
     }
-    if (cd_edge_crease_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge->crease / 255.0f);
+    if (is_new) {
+      bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
     }
-  }
-  if (is_new) {
-    bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
-  }
 
-  /* Only needed for selection. */
-  if (me->mselect && me->totselect != 0) {
-    ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
-  }
+    /* Only needed for selection. */
+    if (me->mselect && me->totselect != 0) {
+      ftable = MEM_mallocN(sizeof(BMFace **) * me->totpoly, __func__);
+    }
 
-  mloop = me->mloop;
-  mp = me->mpoly;
-  for (i = 0, totloops = 0; i < me->totpoly; i++, mp++) {
-    BMLoop *l_iter;
-    BMLoop *l_first;
+    mloop = me->mloop;
+    mp = me->mpoly;
+    for (i = 0, totloops = 0; i < me->totpoly; i++, mp++) {
+      BMLoop *l_iter;
+      BMLoop *l_first;
 
-    f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
-    if (ftable != NULL) {
-      ftable[i] = f;
-    }
+      f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart, bm, vtable, etable);
+      if (ftable != NULL) {
+        ftable[i] = f;
+      }
 
-    if (UNLIKELY(f == NULL)) {
-      printf(
-          "%s: Warning! Bad face in mesh"
-          " \"%s\" at index %d!, skipping\n",
-          __func__,
-          me->id.name + 2,
-          i);
-      continue;
-    }
+      if (UNLIKELY(f == NULL)) {
+        printf(
+            "%s: Warning! Bad face in mesh"
+            " \"%s\" at index %d!, skipping\n",
+            __func__,
+            me->id.name + 2,
+            i);
+        continue;
+      }
 
-    /* Don't use 'i' since we may have skipped the face. */
-    BM_elem_index_set(f, bm->totface - 1); /* set_ok */
+      /* Don't use 'i' since we may have skipped the face. */
+      BM_elem_index_set(f, bm->totface - 1); /* set_ok */
 
-    /* Transfer flag. */
-    f->head.hflag = BM_face_flag_from_mflag(mp->flag & ~ME_FACE_SEL);
+      /* Transfer flag. */
+      f->head.hflag = BM_face_flag_from_mflag(mp->flag & ~ME_FACE_SEL);
 
-    /* This is necessary for selection counts to work properly. */
-    if (mp->flag & ME_FACE_SEL) {
-      BM_face_select_set(bm, f, true);
-    }
+      /* This is necessary for selection counts to work properly. */
+      if (mp->flag & ME_FACE_SEL) {
+        BM_face_select_set(bm, f, true);
+      }
 
-    f->mat_nr = mp->mat_nr;
-    if (i == me->act_face) {
-      bm->act_face = f;
-    }
+      f->mat_nr = mp->mat_nr;
+      if (i == me->act_face) {
+        bm->act_face = f;
+      }
 
-    int j = mp->loopstart;
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      /* Don't use 'j' since we may have skipped some faces, hence some loops. */
-      BM_elem_index_set(l_iter, totloops++); /* set_ok */
+      int j = mp->loopstart;
+      l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+      do {
+        /* Don't use 'j' since we may have skipped some faces, hence some loops. */
+        BM_elem_index_set(l_iter, totloops++); /* set_ok */
 
-      /* Save index of corresponding #MLoop. */
-      CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
-    } while ((l_iter = l_iter->next) != l_first);
+        /* Save index of corresponding #MLoop. */
+        CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+      } while ((l_iter = l_iter->next) != l_first);
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+      /* Copy Custom Data */
+      CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
 
-    if (params->calc_face_normal) {
-      BM_face_normal_update(f);
+      if (params->calc_face_normal) {
+        BM_face_normal_update(f);
+      }
+    }
+    if (is_new) {
+      bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
     }
-  }
-  if (is_new) {
-    bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
   }
 
   /* -------------------------------------------------------------------- */
@@ -564,16 +968,219 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name BMesh -> Mesh Element Copying
+ *
+ * Shared by #BM_mesh_bm_to_me and #BM_mesh_bm_to_me_for_eval,
+ * elements are copied in parallel from arrays of the #BMesh elements.
+ * \{ */
+
+typedef struct BMToMeshData {
+  BMesh *bm;
+  Mesh *me;
+
+  BMVert **verts;
+  BMEdge **edges;
+  BMFace **faces;
+
+  int cd_vert_bweight_offset;
+  int cd_edge_bweight_offset;
+  int cd_edge_crease_offset;
+
+  /** Original index layers, only set when converting for evaluation. */
+  int *vert_origindex;
+  int *edge_origindex;
+  int *poly_origindex;
+  /** Converting for evaluation, see #BM_mesh_bm_to_me_for_eval. */
+  bool for_eval;
+} BMToMeshData;
+
+static void bm_to_mesh_verts_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMVert *v = data->verts[i];
+  MVert *mv = &me->mvert[i];
+
+  copy_v3_v3(mv->co, v->co);
+  normal_float_to_short_v3(mv->no, v->no);
+
+  mv->flag = BM_vert_flag_to_mflag(v);
+
+  BM_elem_index_set(v, i); /* set_inline */
+
+  if (data->vert_origindex) {
+    data->vert_origindex[i] = i;
+  }
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
+
+  if (data->cd_vert_bweight_offset != -1) {
+    mv->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+  }
+
+  BM_CHECK_ELEMENT(v);
+}
+
+static void bm_to_mesh_edges_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMEdge *e = data->edges[i];
+  MEdge *med = &me->medge[i];
+
+  med->v1 = BM_elem_index_get(e->v1);
+  med->v2 = BM_elem_index_get(e->v2);
+
+  med->flag = BM_edge_flag_to_mflag(e);
+
+  BM_elem_index_set(e, i); /* set_inline */
+
+  if (data->for_eval) {
+    /* Handle this differently to editmode switching,
+     * only enable draw for single user edges rather than calculating angle. */
+    if ((med->flag & ME_EDGEDRAW) == 0) {
+      if (e->l && e->l == e->l->radial_next) {
+        med->flag |= ME_EDGEDRAW;
+      }
+    }
+  }
+  else {
+    bmesh_quick_edgedraw_flag(med, e);
+  }
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
+
+  if (data->cd_edge_crease_offset != -1) {
+    med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+  }
+  if (data->cd_edge_bweight_offset != -1) {
+    med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+  }
+
+  if (data->edge_origindex) {
+    data->edge_origindex[i] = i;
+  }
+
+  BM_CHECK_ELEMENT(e);
+}
+
+/**
+ * \note #MPoly.loopstart must already be set.
+ */
+static void bm_to_mesh_faces_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BMToMeshData *data = userdata;
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  BMFace *f = data->faces[i];
+  MPoly *mp = &me->mpoly[i];
+
+  BM_elem_index_set(f, i); /* set_inline */
+
+  mp->totloop = f->len;
+  mp->flag = BM_face_flag_to_mflag(f);
+  mp->mat_nr = f->mat_nr;
+
+  int j = mp->loopstart;
+  MLoop *ml = &me->mloop[j];
+  BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+  do {
+    ml->v = BM_elem_index_get(l_iter->v);
+    ml->e = BM_elem_index_get(l_iter->e);
+
+    /* Copy over custom-data. */
+    CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+
+    BM_elem_index_set(l_iter, j); /* set_inline */
+
+    j++;
+    ml++;
+    BM_CHECK_ELEMENT(l_iter);
+    BM_CHECK_ELEMENT(l_iter->e);
+    BM_CHECK_ELEMENT(l_iter->v);
+  } while ((l_iter = l_iter->next) != l_first);
+
+  if (!data->for_eval && (f == bm->act_face)) {
+    me->act_face = i;
+  }
+
+  /* Copy over custom-data. */
+  CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
+
+  if (data->poly_origindex) {
+    data->poly_origindex[i] = i;
+  }
+
+  BM_CHECK_ELEMENT(f);
+}
+
+/**
+ * Copy all elements of \a bm into the (already allocated) arrays of \a me,
+ * setting the element indices of \a bm.
+ */
+static void bm_to_mesh_elems(BMToMeshData *data)
+{
+  BMesh *bm = data->bm;
+  Mesh *me = data->me;
+  int len;
+
+  /* Local arrays rather than the #BMesh tables,
+   * this runs during evaluation where the tables may be in use elsewhere. */
+  data->verts = BM_iter_as_arrayN(bm, BM_VERTS_OF_MESH, NULL, &len, NULL, 0);
+  data->edges = BM_iter_as_arrayN(bm, BM_EDGES_OF_MESH, NULL, &len, NULL, 0);
+  data->faces = BM_iter_as_arrayN(bm, BM_FACES_OF_MESH, NULL, &len, NULL, 0);
+
+  /* Loop offsets are needed before faces can be filled in independently. */
+  int totloop = 0;
+  for (int i = 0; i < bm->totface; i++) {
+    me->mpoly[i].loopstart = totloop;
+    totloop += data->faces[i]->len;
+  }
+  BLI_assert(totloop == bm->totloop);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  settings.use_threading = bm->totvert >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totvert, data, bm_to_mesh_verts_cb, &settings);
+  bm->elem_index_dirty &= ~BM_VERT;
+
+  /* Edges and loops use the vertex indices set above. */
+  settings.use_threading = bm->totedge >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totedge, data, bm_to_mesh_edges_cb, &settings);
+  bm->elem_index_dirty &= ~BM_EDGE;
+
+  settings.use_threading = bm->totface >= BM_OMP_LIMIT;
+  BLI_task_parallel_range(0, bm->totface, data, bm_to_mesh_faces_cb, &settings);
+  bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP);
+
+  MEM_SAFE_FREE(data->verts);
+  MEM_SAFE_FREE(data->edges);
+  MEM_SAFE_FREE(data->faces);
+}
+
+/** \} */
+
 /**
  *
  * \param bmain: May be NULL in case \a calc_object_remap parameter option is not set.
  */
 void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
 {
-  MEdge *med;
-  BMVert *v, *eve;
-  BMEdge *e;
-  BMFace *f;
+  BMVert *eve;
   BMIter iter;
   int i, j;
 
@@ -640,91 +1247,15 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   /* This is called again, 'dotess' arg is used there. */
   BKE_mesh_update_customdata_pointers(me, 0);
 
-  i = 0;
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    copy_v3_v3(mvert->co, v->co);
-    normal_float_to_short_v3(mvert->no, v->no);
-
-    mvert->flag = BM_vert_flag_to_mflag(v);
-
-    BM_elem_index_set(v, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-    if (cd_vert_bweight_offset != -1) {
-      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-    }
-
-    i++;
-    mvert++;
-
-    BM_CHECK_ELEMENT(v);
-  }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  med = medge;
-  i = 0;
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    med->v1 = BM_elem_index_get(e->v1);
-    med->v2 = BM_elem_index_get(e->v2);
-
-    med->flag = BM_edge_flag_to_mflag(e);
-
-    BM_elem_index_set(e, i); /* set_inline */
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-    bmesh_quick_edgedraw_flag(med, e);
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-    }
-
-    i++;
-    med++;
-    BM_CHECK_ELEMENT(e);
-  }
-  bm->elem_index_dirty &= ~BM_EDGE;
-
-  i = 0;
-  j = 0;
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_iter, *l_first;
-    mpoly->loopstart = j;
-    mpoly->totloop = f->len;
-    mpoly->mat_nr = f->mat_nr;
-    mpoly->flag = BM_face_flag_to_mflag(f);
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      mloop->e = BM_elem_index_get(l_iter->e);
-      mloop->v = BM_elem_index_get(l_iter->v);
-
-      /* Copy over custom-data. */
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      j++;
-      mloop++;
-      BM_CHECK_ELEMENT(l_iter);
-      BM_CHECK_ELEMENT(l_iter->e);
-      BM_CHECK_ELEMENT(l_iter->v);
-    } while ((l_iter = l_iter->next) != l_first);
-
-    if (f == bm->act_face) {
-      me->act_face = i;
-    }
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
-    i++;
-    mpoly++;
-    BM_CHECK_ELEMENT(f);
+  {
+    BMToMeshData data = {
+        .bm = bm,
+        .me = me,
+        .cd_vert_bweight_offset = cd_vert_bweight_offset,
+        .cd_edge_bweight_offset = cd_edge_bweight_offset,
+        .cd_edge_crease_offset = cd_edge_crease_offset,
+    };
+    bm_to_mesh_elems(&data);
   }
 
   /* Patch hook indices and vertex parents. */
@@ -1039,17 +1570,6 @@ void BM_mesh_bm_to_me_for_eval(BMesh *bm, Mesh *me, const CustomData_MeshMasks *
 
   BKE_mesh_update_customdata_pointers(me, false);
 
-  BMIter iter;
-  BMVert *eve;
-  BMEdge *eed;
-  BMFace *efa;
-  MVert *mvert = me->mvert;
-  MEdge *medge = me->medge;
-  MLoop *mloop = me->mloop;
-  MPoly *mpoly = me->mpoly;
-  int *index, add_orig;
-  unsigned int i, j;
-
   const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
   const int cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
   const int cd_edge_crease_offset = CustomData_get_offset(&bm->edata, CD_CREASE);
@@ -1057,99 +1577,20 @@ void BM_mesh_bm_to_me_for_eval(BMesh *bm, Mesh *me, const CustomData_MeshMasks *
   me->runtime.deformed_only = true;
 
   /* Don't add origindex layer if one already exists. */
-  add_orig = !CustomData_has_layer(&bm->pdata, CD_ORIGINDEX);
-
-  index = CustomData_get_layer(&me->vdata, CD_ORIGINDEX);
-
-  BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
-    MVert *mv = &mvert[i];
-
-    copy_v3_v3(mv->co, eve->co);
-
-    BM_elem_index_set(eve, i); /* set_inline */
-
-    normal_float_to_short_v3(mv->no, eve->no);
-
-    mv->flag = BM_vert_flag_to_mflag(eve);
-
-    if (cd_vert_bweight_offset != -1) {
-      mv->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eve, cd_vert_bweight_offset);
-    }
-
-    if (add_orig) {
-      *index++ = i;
-    }
-
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, eve->head.data, i);
-  }
-  bm->elem_index_dirty &= ~BM_VERT;
-
-  index = CustomData_get_layer(&me->edata, CD_ORIGINDEX);
-  BM_ITER_MESH_INDEX (eed, &iter, bm, BM_EDGES_OF_MESH, i) {
-    MEdge *med = &medge[i];
-
-    BM_elem_index_set(eed, i); /* set_inline */
-
-    med->v1 = BM_elem_index_get(eed->v1);
-    med->v2 = BM_elem_index_get(eed->v2);
-
-    med->flag = BM_edge_flag_to_mflag(eed);
-
-    /* Handle this differently to editmode switching,
-     * only enable draw for single user edges rather than calculating angle. */
-    if ((med->flag & ME_EDGEDRAW) == 0) {
-      if (eed->l && eed->l == eed->l->radial_next) {
-        med->flag |= ME_EDGEDRAW;
-      }
-    }
-
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(eed, cd_edge_bweight_offset);
-    }
-
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, eed->head.data, i);
-    if (add_orig) {
-      *index++ = i;
-    }
-  }
-  bm->elem_index_dirty &= ~BM_EDGE;
-
-  index = CustomData_get_layer(&me->pdata, CD_ORIGINDEX);
-  j = 0;
-  BM_ITER_MESH_INDEX (efa, &iter, bm, BM_FACES_OF_MESH, i) {
-    BMLoop *l_iter;
-    BMLoop *l_first;
-    MPoly *mp = &mpoly[i];
-
-    BM_elem_index_set(efa, i); /* set_inline */
-
-    mp->totloop = efa->len;
-    mp->flag = BM_face_flag_to_mflag(efa);
-    mp->loopstart = j;
-    mp->mat_nr = efa->mat_nr;
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
-    do {
-      mloop->v = BM_elem_index_get(l_iter->v);
-      mloop->e = BM_elem_index_get(l_iter->e);
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      BM_elem_index_set(l_iter, j); /* set_inline */
-
-      j++;
-      mloop++;
-    } while ((l_iter = l_iter->next) != l_first);
-
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, efa->head.data, i);
-
-    if (add_orig) {
-      *index++ = i;
-    }
-  }
-  bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP);
+  const bool add_orig = !CustomData_has_layer(&bm->pdata, CD_ORIGINDEX);
+
+  BMToMeshData data = {
+      .bm = bm,
+      .me = me,
+      .cd_vert_bweight_offset = cd_vert_bweight_offset,
+      .cd_edge_bweight_offset = cd_edge_bweight_offset,
+      .cd_edge_crease_offset = cd_edge_crease_offset,
+      .vert_origindex = add_orig ? CustomData_get_layer(&me->vdata, CD_ORIGINDEX) : NULL,
+      .edge_origindex = add_orig ? CustomData_get_layer(&me->edata, CD_ORIGINDEX) : NULL,
+      .poly_origindex = add_orig ? CustomData_get_layer(&me->pdata, CD_ORIGINDEX) : NULL,
+      .for_eval = true,
+  };
+  bm_to_mesh_elems(&data);
 
   me->cd_flag = BM_mesh_cd_flag_from_bmesh(bm);
 }
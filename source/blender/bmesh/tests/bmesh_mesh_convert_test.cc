@@ -0,0 +1,310 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_math.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_test_utils.hh"
+
+#include "PIL_time_utildefines.h"
+
+#include "bmesh.h"
+
+/* Run the biggest tests! */
+//#define BM_MESH_CONVERT_RUN_BIG
+
+class bmesh_mesh_convert : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/**
+ * Add selection, material indices and a loop layer to the shared test grid. The faces use their
+ * loops in reverse order so conversion can't rely on #MPoly.loopstart being ascending.
+ */
+static void grid_mesh_data_add(Mesh *me)
+{
+  for (int i = 0; i < me->totvert; i++) {
+    me->mvert[i].flag = (i % 5 == 0) ? SELECT : 0;
+  }
+
+  MLoop *mloop = (MLoop *)MEM_dupallocN(me->mloop);
+  for (int i = 0; i < me->totpoly; i++) {
+    MPoly *mp = &me->mpoly[i];
+    const int loopstart = (me->totpoly - 1 - i) * mp->totloop;
+    memcpy(&me->mloop[loopstart], &mloop[mp->loopstart], sizeof(*mloop) * mp->totloop);
+    mp->loopstart = loopstart;
+    mp->mat_nr = (short)(i % 3);
+    mp->flag = (i % 11 == 0) ? ME_FACE_SEL : 0;
+  }
+  MEM_freeN(mloop);
+
+  float *layer = (float *)CustomData_add_layer(
+      &me->ldata, CD_PROP_FLOAT, CD_CALLOC, nullptr, me->totloop);
+  for (int i = 0; i < me->totloop; i++) {
+    layer[i] = (float)i;
+  }
+}
+
+static BMesh *bmesh_from_mesh(const Mesh *me)
+{
+  BMeshCreateParams bm_create_params = {0};
+  bm_create_params.use_toolflags = true;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_create_params);
+
+  BMeshFromMeshParams bm_from_me_params = {0};
+  bm_from_me_params.calc_face_normal = true;
+  BM_mesh_bm_from_me(bm, me, &bm_from_me_params);
+  return bm;
+}
+
+/** The topology of #bmesh_from_mesh, created one element at a time. */
+static BMesh *bmesh_from_mesh_reference(const Mesh *me)
+{
+  BMeshCreateParams bm_create_params = {0};
+  bm_create_params.use_toolflags = true;
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &bm_create_params);
+
+  BMVert **vtable = (BMVert **)MEM_malloc_arrayN(me->totvert, sizeof(*vtable), __func__);
+  BMEdge **etable = (BMEdge **)MEM_malloc_arrayN(me->totedge, sizeof(*etable), __func__);
+  for (int i = 0; i < me->totvert; i++) {
+    vtable[i] = BM_vert_create(bm, me->mvert[i].co, nullptr, BM_CREATE_NOP);
+  }
+  for (int i = 0; i < me->totedge; i++) {
+    const MEdge *med = &me->medge[i];
+    etable[i] = BM_edge_create(bm, vtable[med->v1], vtable[med->v2], nullptr, BM_CREATE_NOP);
+  }
+  for (int i = 0; i < me->totpoly; i++) {
+    const MPoly *mp = &me->mpoly[i];
+    BMVert *verts[4];
+    BMEdge *edges[4];
+    for (int j = 0; j < mp->totloop; j++) {
+      verts[j] = vtable[me->mloop[mp->loopstart + j].v];
+      edges[j] = etable[me->mloop[mp->loopstart + j].e];
+    }
+    BM_face_create(bm, verts, edges, mp->totloop, nullptr, BM_CREATE_NOP);
+  }
+
+  MEM_freeN(vtable);
+  MEM_freeN(etable);
+  return bm;
+}
+
+/** Compare the order of the disk, radial and face loop cycles of both meshes. */
+static void bmesh_cycles_expect_eq(BMesh *bm, BMesh *bm_ref)
+{
+  ASSERT_EQ(bm->totvert, bm_ref->totvert);
+  ASSERT_EQ(bm->totedge, bm_ref->totedge);
+  ASSERT_EQ(bm->totface, bm_ref->totface);
+  ASSERT_EQ(bm->totloop, bm_ref->totloop);
+  for (BMesh *bm_iter : {bm, bm_ref}) {
+    BM_mesh_elem_index_ensure(bm_iter, BM_VERT | BM_EDGE | BM_LOOP | BM_FACE);
+    BM_mesh_elem_table_ensure(bm_iter, BM_VERT | BM_EDGE | BM_FACE);
+  }
+
+  for (int i = 0; i < bm->totvert; i++) {
+    BMVert *v = BM_vert_at_index(bm, i);
+    BMVert *v_ref = BM_vert_at_index(bm_ref, i);
+    ASSERT_EQ(v->e == nullptr, v_ref->e == nullptr);
+    if (v_ref->e == nullptr) {
+      continue;
+    }
+    BMEdge *e = v->e;
+    BMEdge *e_ref = v_ref->e;
+    do {
+      ASSERT_EQ(BM_elem_index_get(e), BM_elem_index_get(e_ref));
+      e = BM_DISK_EDGE_NEXT(e, v);
+      e_ref = BM_DISK_EDGE_NEXT(e_ref, v_ref);
+    } while (e_ref != v_ref->e);
+    EXPECT_EQ(e, v->e);
+  }
+
+  for (int i = 0; i < bm->totedge; i++) {
+    BMEdge *e = BM_edge_at_index(bm, i);
+    BMEdge *e_ref = BM_edge_at_index(bm_ref, i);
+    ASSERT_EQ(e->l == nullptr, e_ref->l == nullptr);
+    if (e_ref->l == nullptr) {
+      continue;
+    }
+    BMLoop *l = e->l;
+    BMLoop *l_ref = e_ref->l;
+    do {
+      ASSERT_EQ(BM_elem_index_get(l), BM_elem_index_get(l_ref));
+      l = l->radial_next;
+      l_ref = l_ref->radial_next;
+    } while (l_ref != e_ref->l);
+    EXPECT_EQ(l, e->l);
+  }
+
+  for (int i = 0; i < bm->totface; i++) {
+    BMFace *f = BM_face_at_index(bm, i);
+    BMFace *f_ref = BM_face_at_index(bm_ref, i);
+    ASSERT_EQ(f->len, f_ref->len);
+    BMLoop *l = BM_FACE_FIRST_LOOP(f);
+    BMLoop *l_ref = BM_FACE_FIRST_LOOP(f_ref);
+    for (int j = 0; j < f->len; j++, l = l->next, l_ref = l_ref->next) {
+      EXPECT_EQ(BM_elem_index_get(l), BM_elem_index_get(l_ref));
+      EXPECT_EQ(BM_elem_index_get(l->v), BM_elem_index_get(l_ref->v));
+      EXPECT_EQ(BM_elem_index_get(l->e), BM_elem_index_get(l_ref->e));
+    }
+  }
+}
+
+static Mesh *mesh_from_bmesh(BMesh *bm, const bool for_eval)
+{
+  Mesh *me = (Mesh *)BKE_id_new_nomain(ID_ME, nullptr);
+  if (for_eval) {
+    BM_mesh_bm_to_me_for_eval(bm, me, nullptr);
+  }
+  else {
+    BMeshToMeshParams bm_to_me_params = {0};
+    BM_mesh_bm_to_me(nullptr, bm, me, &bm_to_me_params);
+  }
+  return me;
+}
+
+static void mesh_expect_eq(const Mesh *me_dst, const Mesh *me_src)
+{
+  ASSERT_EQ(me_dst->totvert, me_src->totvert);
+  ASSERT_EQ(me_dst->totedge, me_src->totedge);
+  ASSERT_EQ(me_dst->totpoly, me_src->totpoly);
+  ASSERT_EQ(me_dst->totloop, me_src->totloop);
+
+  for (int i = 0; i < me_src->totvert; i++) {
+    EXPECT_V3_NEAR(me_dst->mvert[i].co, me_src->mvert[i].co, 0.0f);
+  }
+  for (int i = 0; i < me_src->totedge; i++) {
+    EXPECT_EQ(me_dst->medge[i].v1, me_src->medge[i].v1);
+    EXPECT_EQ(me_dst->medge[i].v2, me_src->medge[i].v2);
+  }
+  const float *layer_src = (const float *)CustomData_get_layer(&me_src->ldata, CD_PROP_FLOAT);
+  const float *layer_dst = (const float *)CustomData_get_layer(&me_dst->ldata, CD_PROP_FLOAT);
+  ASSERT_NE(layer_dst, nullptr);
+  for (int i = 0; i < me_src->totpoly; i++) {
+    const MPoly *mp_src = &me_src->mpoly[i];
+    const MPoly *mp_dst = &me_dst->mpoly[i];
+    ASSERT_EQ(mp_dst->totloop, mp_src->totloop);
+    EXPECT_EQ(mp_dst->mat_nr, mp_src->mat_nr);
+    for (int j = 0; j < mp_src->totloop; j++) {
+      EXPECT_EQ(me_dst->mloop[mp_dst->loopstart + j].v, me_src->mloop[mp_src->loopstart + j].v);
+      EXPECT_EQ(me_dst->mloop[mp_dst->loopstart + j].e, me_src->mloop[mp_src->loopstart + j].e);
+      EXPECT_EQ(layer_dst[mp_dst->loopstart + j], layer_src[mp_src->loopstart + j]);
+    }
+  }
+}
+
+static void bmesh_mesh_convert_round_trip_test(const int size)
+{
+  Mesh *me_src = blender::bke::tests::mesh_test_grid_create(size);
+  grid_mesh_data_add(me_src);
+  BMesh *bm = bmesh_from_mesh(me_src);
+
+  EXPECT_EQ(bm->totvert, me_src->totvert);
+  EXPECT_EQ(bm->totedge, me_src->totedge);
+  EXPECT_EQ(bm->totface, me_src->totpoly);
+  EXPECT_EQ(bm->totloop, me_src->totloop);
+#ifdef DEBUG
+  EXPECT_TRUE(BM_mesh_validate(bm));
+#endif
+
+  BMesh *bm_ref = bmesh_from_mesh_reference(me_src);
+  bmesh_cycles_expect_eq(bm, bm_ref);
+  BM_mesh_free(bm_ref);
+
+  /* Selection flushes to the vertices of selected faces. */
+  int totvertsel = 0;
+  BMIter iter;
+  BMVert *v;
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    if (BM_elem_flag_test(v, BM_ELEM_SELECT)) {
+      totvertsel++;
+    }
+  }
+  EXPECT_EQ(bm->totvertsel, totvertsel);
+  EXPECT_GT(bm->totfacesel, 0);
+
+  BMFace *f;
+  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
+    EXPECT_FLOAT_EQ(len_v3(f->no), 1.0f);
+  }
+
+  for (const bool for_eval : {true, false}) {
+    Mesh *me_dst = mesh_from_bmesh(bm, for_eval);
+    mesh_expect_eq(me_dst, me_src);
+    BKE_id_free(nullptr, me_dst);
+  }
+
+  BM_mesh_free(bm);
+  BKE_id_free(nullptr, me_src);
+}
+
+/* Below #BM_OMP_LIMIT, elements are created one at a time. */
+TEST_F(bmesh_mesh_convert, RoundTripSmall)
+{
+  bmesh_mesh_convert_round_trip_test(16);
+}
+
+TEST_F(bmesh_mesh_convert, RoundTripBulk)
+{
+  bmesh_mesh_convert_round_trip_test(256);
+}
+
+#ifdef BM_MESH_CONVERT_RUN_BIG
+static void bmesh_mesh_convert_performance_test(const int size, const char *id)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  Mesh *me_src = blender::bke::tests::mesh_test_grid_create(size);
+  grid_mesh_data_add(me_src);
+  BMesh *bm;
+  Mesh *me_dst;
+  {
+    TIMEIT_START(bm_from_me);
+    bm = bmesh_from_mesh(me_src);
+    TIMEIT_END(bm_from_me);
+  }
+  {
+    TIMEIT_START(bm_to_me_for_eval);
+    me_dst = mesh_from_bmesh(bm, true);
+    TIMEIT_END(bm_to_me_for_eval);
+  }
+  EXPECT_EQ(me_dst->totloop, me_src->totloop);
+  BKE_id_free(nullptr, me_dst);
+  {
+    TIMEIT_START(bm_to_me);
+    me_dst = mesh_from_bmesh(bm, false);
+    TIMEIT_END(bm_to_me);
+  }
+  EXPECT_EQ(me_dst->totloop, me_src->totloop);
+  BKE_id_free(nullptr, me_dst);
+
+  BM_mesh_free(bm);
+  BKE_id_free(nullptr, me_src);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST_F(bmesh_mesh_convert, Grid_1M)
+{
+  bmesh_mesh_convert_performance_test(1000, "Grid 1M faces");
+}
+
+TEST_F(bmesh_mesh_convert, Grid_10M)
+{
+  bmesh_mesh_convert_performance_test(3163, "Grid 10M faces");
+}
+#endif
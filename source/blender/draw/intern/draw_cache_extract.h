@@ -241,6 +241,12 @@ typedef struct MeshBatchCache {
   bool is_dirty; /* Instantly invalidates cache, skipping mesh check */
   bool is_editmode;
   bool is_uvsyncsel;
+  /* Vertices are being moved in edit-mode, keep the CPU data of the position and normal
+   * buffers for in place updates, see #mesh_buffer_cache_update_deform. */
+  bool use_deform_update;
+  /* Vertices were moved since the last draw, the buffers are updated for them when the cache
+   * is validated, see #DRW_mesh_batch_cache_validate. */
+  bool is_deform_dirty;
 
   struct DRW_MeshWeightState weight_state;
 
@@ -260,6 +266,10 @@ typedef struct MeshBatchCache {
   bool no_loose_wire;
 } MeshBatchCache;
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                                         MeshBatchCache *cache,
                                         MeshBufferCache mbc,
@@ -275,3 +285,11 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                                         const Scene *scene,
                                         const ToolSettings *ts,
                                         const bool use_hide);
+bool mesh_buffer_cache_update_deform(MeshBufferCache *mbc,
+                                     Mesh *me,
+                                     const BLI_bitmap *deform_verts,
+                                     bool *r_tessellation_changed);
+
+#ifdef __cplusplus
+}
+#endif
@@ -95,6 +95,7 @@ typedef struct MeshRenderData {
   bool use_hide;
   bool use_subsurf_fdots;
   bool use_final_mesh;
+  bool use_deform_update;
 
   /** Use for #MeshStatVis calculation which use world-space coords. */
   float obmat[4][4];
@@ -1900,6 +1901,14 @@ static const MeshExtract extract_edituv_fdots = {
 /** \name Extract Position and Vertex Normal
  * \{ */
 
+/* Edit-mesh buffers keep their data around to be updated in place while transforming,
+ * see #mesh_buffer_cache_update_deform. Otherwise the data isn't needed after the upload. */
+BLI_INLINE GPUUsageType extract_deform_vbo_usage_get(const MeshRenderData *mr)
+{
+  return (mr->use_deform_update && mr->extract_type == MR_EXTRACT_BMESH) ? GPU_USAGE_DYNAMIC :
+                                                                           GPU_USAGE_STATIC;
+}
+
 typedef struct PosNorLoop {
   float pos[3];
   GPUPackedNormal nor;
@@ -1922,7 +1931,7 @@ static void *extract_pos_nor_init(const MeshRenderData *mr,
     GPU_vertformat_alias_add(&format, "vnor");
   }
   GPUVertBuf *vbo = buf;
-  GPU_vertbuf_init_with_format(vbo, &format);
+  GPU_vertbuf_init_with_format_ex(vbo, &format, extract_deform_vbo_usage_get(mr));
   GPU_vertbuf_data_alloc(vbo, mr->loop_len + mr->loop_loose_len);
 
   /* Pack normals per vert, reduce amount of computation. */
@@ -2098,7 +2107,7 @@ static void *extract_lnor_hq_init(const MeshRenderData *mr,
     GPU_vertformat_alias_add(&format, "lnor");
   }
   GPUVertBuf *vbo = buf;
-  GPU_vertbuf_init_with_format(vbo, &format);
+  GPU_vertbuf_init_with_format_ex(vbo, &format, extract_deform_vbo_usage_get(mr));
   GPU_vertbuf_data_alloc(vbo, mr->loop_len);
 
   return GPU_vertbuf_get_data(vbo);
@@ -2186,7 +2195,7 @@ static void *extract_lnor_init(const MeshRenderData *mr,
     GPU_vertformat_alias_add(&format, "lnor");
   }
   GPUVertBuf *vbo = buf;
-  GPU_vertbuf_init_with_format(vbo, &format);
+  GPU_vertbuf_init_with_format_ex(vbo, &format, extract_deform_vbo_usage_get(mr));
   GPU_vertbuf_data_alloc(vbo, mr->loop_len);
 
   return GPU_vertbuf_get_data(vbo);
@@ -5755,6 +5764,7 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
   mr->use_hide = use_hide;
   mr->use_subsurf_fdots = use_subsurf_fdots;
   mr->use_final_mesh = do_final;
+  mr->use_deform_update = cache->use_deform_update;
 
 #ifdef DEBUG_TIME
   double rdata_end = PIL_check_seconds_timer();
@@ -5894,3 +5904,212 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
 }
 
 /** \} */
+
+/* ---------------------------------------------------------------------- */
+/** \name Partial Update of Deformed Edit-Mesh
+ *
+ * Transform only moves vertices, so instead of extracting every loop again the position and
+ * normal buffers are patched in place for the faces whose positions or normals changed.
+ * This only works when the loops are extracted from the #BMesh directly (no modifiers),
+ * where the buffer index of a loop is its #BMLoop index.
+ * \{ */
+
+/* Above this share of faces the threaded full extraction isn't slower. */
+#define DEFORM_UPDATE_FACES_MAX_FAC 0.5f
+
+typedef struct DeformUpdateData {
+  BMFace **faces;
+  PosNorLoop *pos_nor;
+  void *lnor;
+  bool lnor_hq;
+} DeformUpdateData;
+
+static void mesh_deform_update_faces_fn(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const DeformUpdateData *data = userdata;
+  BMFace *efa = data->faces[i];
+  const bool is_hidden = BM_elem_flag_test(efa, BM_ELEM_HIDDEN);
+  const bool is_smooth = BM_elem_flag_test(efa, BM_ELEM_SMOOTH);
+  BMLoop *l_iter, *l_first;
+  l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
+  do {
+    const int l_index = BM_elem_index_get(l_iter);
+    if (data->pos_nor) {
+      PosNorLoop *vert = &data->pos_nor[l_index];
+      copy_v3_v3(vert->pos, l_iter->v->co);
+      vert->nor = GPU_normal_convert_i10_v3(l_iter->v->no);
+      vert->nor.w = is_hidden ? -1 : 0;
+    }
+    if (data->lnor) {
+      const float *no = is_smooth ? l_iter->v->no : efa->no;
+      if (data->lnor_hq) {
+        normal_float_to_short_v3(&((gpuHQNor *)data->lnor)[l_index].x, no);
+      }
+      else {
+        GPUPackedNormal *lnor = &((GPUPackedNormal *)data->lnor)[l_index];
+        *lnor = GPU_normal_convert_i10_v3(no);
+        lnor->w = is_hidden ? -1 : 0;
+      }
+    }
+  } while ((l_iter = l_iter->next) != l_first);
+}
+
+static bool mesh_deform_update_supported(const Mesh *me_eval)
+{
+  return (me_eval->runtime.wrapper_type == ME_WRAPPER_TYPE_BMESH) &&
+         ((me_eval->runtime.edit_data == NULL) || (me_eval->runtime.edit_data->vertexCos == NULL));
+}
+
+/**
+ * Update the position and normal buffers of \a mbc for the vertices in \a deform_verts.
+ * The topology must be unchanged since the buffers were extracted.
+ *
+ * \param r_tessellation_changed: Set when a moved vertex uses a face with more than three sides,
+ * its triangles depend on the vertex positions and the triangle buffers can't be kept.
+ * \return false when the buffers can't be updated and need to be extracted again.
+ */
+bool mesh_buffer_cache_update_deform(MeshBufferCache *mbc,
+                                     Mesh *me,
+                                     const BLI_bitmap *deform_verts,
+                                     bool *r_tessellation_changed)
+{
+  GPUVertBuf *vbo_pos_nor = mbc->vbo.pos_nor;
+  GPUVertBuf *vbo_lnor = mbc->vbo.lnor;
+  if (vbo_pos_nor == NULL && vbo_lnor == NULL) {
+    return true;
+  }
+
+  BMEditMesh *em = me->edit_mesh;
+  BMesh *bm = em->bm;
+  if (!mesh_deform_update_supported(em->mesh_eval_final) ||
+      !mesh_deform_update_supported(em->mesh_eval_cage)) {
+    return false;
+  }
+
+  DeformUpdateData data = {NULL};
+  if (vbo_pos_nor) {
+    data.pos_nor = GPU_vertbuf_get_data(vbo_pos_nor);
+    if (data.pos_nor == NULL || GPU_vertbuf_get_vertex_len(vbo_pos_nor) < bm->totloop) {
+      return false;
+    }
+  }
+  if (vbo_lnor) {
+    /* Auto-smooth loop normals depend on the whole smooth fan. */
+    if (me->flag & ME_AUTOSMOOTH) {
+      return false;
+    }
+    data.lnor = GPU_vertbuf_get_data(vbo_lnor);
+    if (data.lnor == NULL || GPU_vertbuf_get_vertex_len(vbo_lnor) != bm->totloop) {
+      return false;
+    }
+    data.lnor_hq = GPU_vertbuf_get_format(vbo_lnor)->stride == sizeof(gpuHQNor);
+  }
+
+#ifdef DEBUG_TIME
+  double start = PIL_check_seconds_timer();
+#endif
+
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_FACE | BM_LOOP);
+  BM_mesh_elem_table_ensure(bm, BM_VERT);
+
+  /* Vertex normals change for all vertices of the faces using a moved vertex,
+   * loops using those vertices need to be updated. */
+  BLI_bitmap *verts_nor = BLI_BITMAP_NEW(bm->totvert, __func__);
+  BLI_bitmap *faces_update = BLI_BITMAP_NEW(bm->totface, __func__);
+  bool use_full_update = false;
+
+  BMIter iter;
+  BMFace *efa;
+  BMEdge *eed;
+  for (int v = 0; v < bm->totvert; v++) {
+    if (!BLI_BITMAP_TEST(deform_verts, v)) {
+      continue;
+    }
+    BMVert *eve = BM_vert_at_index(bm, v);
+    /* Loose geometry is stored after the loops in an order that isn't kept around. */
+    if (eve->e == NULL) {
+      use_full_update = true;
+      break;
+    }
+    BM_ITER_ELEM (eed, &iter, eve, BM_EDGES_OF_VERT) {
+      if (eed->l == NULL) {
+        use_full_update = true;
+        break;
+      }
+    }
+    if (use_full_update) {
+      break;
+    }
+    BM_ITER_ELEM (efa, &iter, eve, BM_FACES_OF_VERT) {
+      if (efa->len > 3) {
+        *r_tessellation_changed = true;
+      }
+      if (!BLI_BITMAP_TEST(faces_update, BM_elem_index_get(efa))) {
+        BLI_BITMAP_ENABLE(faces_update, BM_elem_index_get(efa));
+        BMLoop *l_iter, *l_first;
+        l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
+        do {
+          BLI_BITMAP_ENABLE(verts_nor, BM_elem_index_get(l_iter->v));
+        } while ((l_iter = l_iter->next) != l_first);
+      }
+    }
+  }
+
+  int faces_len = 0;
+  BMFace **faces = NULL;
+  if (!use_full_update) {
+    for (int v = 0; v < bm->totvert; v++) {
+      if (BLI_BITMAP_TEST(verts_nor, v)) {
+        BM_ITER_ELEM (efa, &iter, BM_vert_at_index(bm, v), BM_FACES_OF_VERT) {
+          BLI_BITMAP_ENABLE(faces_update, BM_elem_index_get(efa));
+        }
+      }
+    }
+    faces = MEM_mallocN(sizeof(*faces) * bm->totface, __func__);
+    const int faces_len_max = (int)((float)bm->totface * DEFORM_UPDATE_FACES_MAX_FAC);
+    BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+      if (BLI_BITMAP_TEST(faces_update, BM_elem_index_get(efa))) {
+        if (faces_len == faces_len_max) {
+          use_full_update = true;
+          break;
+        }
+        faces[faces_len++] = efa;
+      }
+    }
+  }
+  MEM_freeN(verts_nor);
+  MEM_freeN(faces_update);
+
+  if (use_full_update) {
+    MEM_SAFE_FREE(faces);
+    return false;
+  }
+
+  data.faces = faces;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, faces_len, &data, mesh_deform_update_faces_fn, &settings);
+  MEM_freeN(faces);
+
+  if (vbo_pos_nor) {
+    GPU_vertbuf_tag_dirty(vbo_pos_nor);
+  }
+  if (vbo_lnor) {
+    GPU_vertbuf_tag_dirty(vbo_lnor);
+  }
+
+#ifdef DEBUG_TIME
+  printf("deform update %d/%d faces %.2fms\n",
+         faces_len,
+         bm->totface,
+         (PIL_check_seconds_timer() - start) * 1000);
+#endif
+  return true;
+}
+
+#undef DEFORM_UPDATE_FACES_MAX_FAC
+
+/** \} */
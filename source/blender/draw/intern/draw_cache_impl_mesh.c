@@ -72,6 +72,7 @@
 #include "draw_cache_impl.h" /* own include */
 
 static void mesh_batch_cache_clear(Mesh *me);
+static bool mesh_batch_cache_update_deform(Mesh *me, MeshBatchCache *cache);
 
 /* Return true is all layers in _b_ are inside _a_. */
 BLI_INLINE bool mesh_cd_layers_type_overlap(DRW_MeshCDMask a, DRW_MeshCDMask b)
@@ -510,9 +511,26 @@ static void mesh_batch_cache_init(Mesh *me)
 
 void DRW_mesh_batch_cache_validate(Mesh *me)
 {
+  MeshBatchCache *cache = me->runtime.batch_cache;
+  if (cache && cache->is_deform_dirty) {
+    cache->is_deform_dirty = false;
+    if (!mesh_batch_cache_update_deform(me, cache)) {
+      cache->is_dirty = true;
+    }
+  }
+
   if (!mesh_batch_cache_valid(me)) {
+    const bool use_deform_update = cache && cache->use_deform_update;
     mesh_batch_cache_clear(me);
     mesh_batch_cache_init(me);
+    /* Buffers are extracted again for an in place update which wasn't possible. */
+    cache = me->runtime.batch_cache;
+    cache->use_deform_update = use_deform_update && cache->is_editmode;
+  }
+
+  /* The drawing is up to date with the edit-mesh, track the vertices moved from here on. */
+  if (me->edit_mesh) {
+    BKE_editmesh_deform_verts_reset(me->edit_mesh);
   }
 }
 
@@ -622,6 +640,71 @@ static void mesh_batch_cache_discard_uvedit_select(MeshBatchCache *cache)
   cache->batch_ready &= ~MBC_EDITUV;
 }
 
+/**
+ * Update the buffers in place for the vertices moved in edit-mode and discard the other
+ * buffers depending on vertex positions, the topology and selection buffers are kept.
+ *
+ * \return false when the whole cache needs to be extracted again.
+ */
+static bool mesh_batch_cache_update_deform(Mesh *me, MeshBatchCache *cache)
+{
+  BMEditMesh *em = me->edit_mesh;
+  if (cache->is_dirty || !cache->is_editmode || (em == NULL) || (em->deform_verts == NULL) ||
+      (em->deform_verts_len != em->bm->totvert)) {
+    return false;
+  }
+
+  bool tessellation_changed = false;
+  FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+    if (!mesh_buffer_cache_update_deform(
+            mbufcache, me, em->deform_verts, &tessellation_changed)) {
+      return false;
+    }
+  }
+
+  if (tessellation_changed) {
+    /* Quads and n-gons were tessellated again for the new positions. */
+    FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+      GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.tris);
+      GPU_INDEXBUF_DISCARD_SAFE(mbufcache->ibo.edituv_tris);
+      for (int i = 0; i < cache->mat_len; i++) {
+        GPU_INDEXBUF_DISCARD_SAFE(mbufcache->tris_per_mat[i]);
+      }
+    }
+    GPU_BATCH_DISCARD_SAFE(cache->batch.surface_weights);
+    GPU_BATCH_DISCARD_SAFE(cache->batch.sculpt_overlays);
+    GPU_BATCH_DISCARD_SAFE(cache->batch.edit_triangles);
+    GPU_BATCH_DISCARD_SAFE(cache->batch.edit_lnor);
+    GPU_BATCH_DISCARD_SAFE(cache->batch.edit_selection_faces);
+    GPU_BATCH_DISCARD_SAFE(cache->batch.edituv_faces);
+    cache->batch_ready &= ~(MBC_SURFACE_WEIGHTS | MBC_SCULPT_OVERLAYS | MBC_EDIT_TRIANGLES |
+                            MBC_EDIT_LNOR | MBC_EDIT_SELECTION_FACES | MBC_EDITUV_FACES);
+  }
+
+  FOREACH_MESH_BUFFER_CACHE (cache, mbufcache) {
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.edge_fac);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.tan);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_area);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.stretch_angle);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.mesh_analysis);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_pos);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.fdots_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbufcache->vbo.skin_roots);
+  }
+  GPU_BATCH_DISCARD_SAFE(cache->batch.wire_edges);
+  GPU_BATCH_DISCARD_SAFE(cache->batch.edit_mesh_analysis);
+  GPU_BATCH_DISCARD_SAFE(cache->batch.edit_fdots);
+  GPU_BATCH_DISCARD_SAFE(cache->batch.edit_skin_roots);
+  GPU_BATCH_DISCARD_SAFE(cache->batch.edit_selection_fdots);
+  GPU_BATCH_DISCARD_SAFE(cache->batch.edituv_faces_stretch_area);
+  GPU_BATCH_DISCARD_SAFE(cache->batch.edituv_faces_stretch_angle);
+  mesh_batch_cache_discard_surface_batches(cache);
+  cache->batch_ready &= ~(MBC_WIRE_EDGES | MBC_EDIT_MESH_ANALYSIS | MBC_EDIT_FACEDOTS |
+                          MBC_SKIN_ROOTS | MBC_EDIT_SELECTION_FACEDOTS |
+                          MBC_EDITUV_FACES_STRETCH_AREA | MBC_EDITUV_FACES_STRETCH_ANGLE);
+  return true;
+}
+
 void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
 {
   MeshBatchCache *cache = me->runtime.batch_cache;
@@ -666,6 +749,14 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, eMeshBatchDirtyMode mode)
       break;
     case BKE_MESH_BATCH_DIRTY_ALL:
       cache->is_dirty = true;
+      cache->use_deform_update = false;
+      break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      /* Buffers extracted from now on can be updated in place, until the next full update.
+       * Tagged from the depsgraph for every object using the mesh,
+       * the update itself is done once in #DRW_mesh_batch_cache_validate. */
+      cache->use_deform_update = true;
+      cache->is_deform_dirty = true;
       break;
     case BKE_MESH_BATCH_DIRTY_SHADING:
       mesh_batch_cache_discard_shaded_tri(cache);
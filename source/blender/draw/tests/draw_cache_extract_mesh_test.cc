@@ -0,0 +1,227 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_bitmap.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
+#include "BLI_task.h"
+
+#include "BKE_editmesh.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh_test_utils.hh"
+#include "BKE_mesh_wrapper.h"
+
+#include "GPU_batch.h"
+#include "GPU_index_buffer.h"
+#include "GPU_vertex_buffer.h"
+#include "gpu_testing.hh"
+
+#include "bmesh.h"
+
+#include "intern/draw_cache_extract.h"
+
+/* Compare the extraction time with the in place update on a big mesh. */
+//#define DRAW_EXTRACT_MESH_RUN_BIG
+
+#ifdef DRAW_EXTRACT_MESH_RUN_BIG
+#  include "PIL_time.h"
+#endif
+
+namespace blender::draw {
+
+class DrawExtractMeshTest : public blender::gpu::GPUTest {
+ public:
+  Mesh *me = nullptr;
+  BMEditMesh *em = nullptr;
+  Scene scene = {};
+  ToolSettings ts = {};
+
+  void TearDown() override
+  {
+    if (em) {
+      me->edit_mesh = nullptr;
+      BKE_editmesh_free(em);
+      MEM_freeN(em);
+    }
+    if (me) {
+      BKE_id_free(nullptr, me);
+    }
+    GPUTest::TearDown();
+  }
+
+  /* An edit-mesh without modifiers, drawn from the #BMesh directly. */
+  void editmesh_create(const int size)
+  {
+    me = bke::tests::mesh_test_grid_create(size);
+
+    BMeshCreateParams create_params = {};
+    BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+    BMeshFromMeshParams from_params = {};
+    from_params.calc_face_normal = true;
+    BM_mesh_bm_from_me(bm, me, &from_params);
+    BM_mesh_normals_update(bm);
+
+    em = BKE_editmesh_create(bm, true);
+    em->mesh_eval_final = em->mesh_eval_cage = BKE_mesh_wrapper_from_editmesh(em, nullptr, me);
+    me->edit_mesh = em;
+
+    /* Drawn once, vertices moved from here on can be updated in place. */
+    BKE_editmesh_deform_verts_reset(em);
+  }
+
+  void extract(MeshBufferCache *mbc)
+  {
+    MeshBatchCache cache = {};
+    cache.is_editmode = true;
+    cache.use_deform_update = true;
+
+    *mbc = {};
+    mbc->vbo.pos_nor = GPU_vertbuf_calloc();
+    mbc->vbo.lnor = GPU_vertbuf_calloc();
+
+    float obmat[4][4];
+    unit_m4(obmat);
+    const DRW_MeshCDMask cd_used = {};
+    TaskGraph *task_graph = BLI_task_graph_create();
+    mesh_buffer_cache_create_requested(task_graph,
+                                       &cache,
+                                       *mbc,
+                                       me,
+                                       true,
+                                       false,
+                                       true,
+                                       obmat,
+                                       true,
+                                       false,
+                                       false,
+                                       &cd_used,
+                                       &scene,
+                                       &ts,
+                                       true);
+    BLI_task_graph_work_and_wait(task_graph);
+    BLI_task_graph_free(task_graph);
+  }
+
+  /* Move the vertices and tag them like transform does. */
+  void verts_move(const int *verts, const int verts_len, const float offset[3])
+  {
+    BMesh *bm = em->bm;
+    BLI_bitmap *deform_verts = BKE_editmesh_deform_verts_ensure(em);
+    ASSERT_NE(deform_verts, nullptr);
+    BM_mesh_elem_table_ensure(bm, BM_VERT);
+    for (int i = 0; i < verts_len; i++) {
+      add_v3_v3(BM_vert_at_index(bm, verts[i])->co, offset);
+      BLI_BITMAP_ENABLE(deform_verts, verts[i]);
+    }
+    BM_mesh_normals_update(bm);
+    BKE_editmesh_looptri_calc_deform(em);
+  }
+
+  static void expect_vbo_eq(GPUVertBuf *vbo_a, GPUVertBuf *vbo_b)
+  {
+    const uint len = GPU_vertbuf_get_vertex_len(vbo_a);
+    ASSERT_EQ(len, GPU_vertbuf_get_vertex_len(vbo_b));
+    const uint size = len * GPU_vertbuf_get_format(vbo_a)->stride;
+    EXPECT_EQ(memcmp(GPU_vertbuf_get_data(vbo_a), GPU_vertbuf_get_data(vbo_b), size), 0);
+  }
+
+  static void buffers_free(MeshBufferCache *mbc)
+  {
+    GPU_VERTBUF_DISCARD_SAFE(mbc->vbo.pos_nor);
+    GPU_VERTBUF_DISCARD_SAFE(mbc->vbo.lnor);
+  }
+};
+
+/* Buffers updated in place for moved vertices are the same as extracted again. */
+TEST_F(DrawExtractMeshTest, DeformUpdateMatchesExtraction)
+{
+  editmesh_create(10);
+
+  MeshBufferCache mbc;
+  extract(&mbc);
+
+  const int verts[2] = {24, 61};
+  const float offset[3] = {0.3f, -0.2f, 0.5f};
+  verts_move(verts, ARRAY_SIZE(verts), offset);
+
+  bool tessellation_changed = false;
+  EXPECT_TRUE(mesh_buffer_cache_update_deform(&mbc, me, em->deform_verts, &tessellation_changed));
+  /* The grid is made of quads, their triangles need to be extracted again. */
+  EXPECT_TRUE(tessellation_changed);
+
+  MeshBufferCache mbc_full;
+  extract(&mbc_full);
+  expect_vbo_eq(mbc.vbo.pos_nor, mbc_full.vbo.pos_nor);
+  expect_vbo_eq(mbc.vbo.lnor, mbc_full.vbo.lnor);
+
+  buffers_free(&mbc);
+  buffers_free(&mbc_full);
+}
+
+/* Moving most of the mesh is left to the threaded extraction. */
+TEST_F(DrawExtractMeshTest, DeformUpdateFallback)
+{
+  editmesh_create(4);
+
+  MeshBufferCache mbc;
+  extract(&mbc);
+
+  const int verts_len = 25;
+  int verts[verts_len];
+  for (int i = 0; i < verts_len; i++) {
+    verts[i] = i;
+  }
+  const float offset[3] = {0.0f, 0.0f, 1.0f};
+  verts_move(verts, verts_len, offset);
+
+  bool tessellation_changed = false;
+  EXPECT_FALSE(
+      mesh_buffer_cache_update_deform(&mbc, me, em->deform_verts, &tessellation_changed));
+
+  buffers_free(&mbc);
+}
+
+#ifdef DRAW_EXTRACT_MESH_RUN_BIG
+
+TEST_F(DrawExtractMeshTest, DeformUpdateTiming)
+{
+  editmesh_create(1000);
+
+  MeshBufferCache mbc;
+  double start = PIL_check_seconds_timer();
+  extract(&mbc);
+  const double time_extract = PIL_check_seconds_timer() - start;
+
+  const int verts_len = 100;
+  int verts[verts_len];
+  for (int i = 0; i < verts_len; i++) {
+    verts[i] = 500 * 1001 + 450 + i;
+  }
+  const float offset[3] = {0.0f, 0.0f, 1.0f};
+  verts_move(verts, verts_len, offset);
+
+  bool tessellation_changed = false;
+  start = PIL_check_seconds_timer();
+  EXPECT_TRUE(mesh_buffer_cache_update_deform(&mbc, me, em->deform_verts, &tessellation_changed));
+  const double time_update = PIL_check_seconds_timer() - start;
+
+  printf("Extract %d faces: %.2fms, update %d moved vertices: %.2fms\n",
+         em->bm->totface,
+         time_extract * 1000.0,
+         verts_len,
+         time_update * 1000.0);
+
+  buffers_free(&mbc);
+}
+
+#endif
+
+}  // namespace blender::draw
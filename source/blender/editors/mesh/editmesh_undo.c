@@ -27,9 +27,12 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
+#include "DNA_windowmanager_types.h"
 
 #include "BLI_array_utils.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_listbase.h"
+#include "BLI_math_vector.h"
 
 #include "BKE_context.h"
 #include "BKE_editmesh.h"
@@ -50,6 +53,8 @@
 #include "WM_api.h"
 #include "WM_types.h"
 
+#include "PIL_time.h"
+
 #define USE_ARRAY_STORE
 
 #ifdef USE_ARRAY_STORE
@@ -90,6 +95,8 @@ typedef struct BArrayCustomData {
 
 #endif
 
+struct UndoMeshShadow;
+
 typedef struct UndoMesh {
   Mesh me;
   int selectmode;
@@ -113,6 +120,11 @@ typedef struct UndoMesh {
   } store;
 #endif /* USE_ARRAY_STORE */
 
+  /** The steps sharing this full state, delta steps are stored relative to it. */
+  int users;
+  /** The state delta steps are compared against, NULL when deltas can't be used. */
+  struct UndoMeshShadow *shadow;
+
   size_t undo_size;
 } UndoMesh;
 
@@ -689,6 +701,423 @@ static Object *editmesh_object_from_context(bContext *C)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Undo Deltas
+ *
+ * Steps which keep the topology and custom-data unchanged (transform, selection, hiding...)
+ * are stored as the vertex coordinates and element flags changed since the last full step,
+ * avoiding a #BMesh to #Mesh conversion for each of them.
+ * When the edit-mesh still matches the full step they are restored in place too.
+ * \{ */
+
+/* Store a full step after this many delta steps, so deltas don't grow too large. */
+#define UNDO_DELTA_STEPS_MAX 32
+
+/* Element flags stored in the undo mesh, others are not restored. */
+#define UNDO_DELTA_HFLAG (BM_ELEM_SELECT | BM_ELEM_HIDDEN | BM_ELEM_SEAM | BM_ELEM_SMOOTH)
+
+typedef struct UndoMeshSelect {
+  MSelect *mselect;
+  int mselect_len;
+  int act_face;
+  int selectmode;
+  int shapenr;
+} UndoMeshSelect;
+
+/** Data of a full step needed to compare and restore delta steps. */
+typedef struct UndoMeshShadow {
+  /* Deltas only apply to meshes with the same topology and custom-data. */
+  uint32_t topology_hash[2];
+  uint32_t data_hash[2];
+  int totvert, totedge, totloop, totface;
+
+  float (*vert_co)[3];
+  /* Per vertex, edge and face. */
+  char *hflag[3];
+
+  UndoMeshSelect select;
+
+  /** Number of delta steps stored against this full step. */
+  int deltas_len;
+} UndoMeshShadow;
+
+typedef struct UndoMeshDelta {
+  int vert_co_len;
+  int *vert_co_index;
+  float (*vert_co)[3];
+
+  /* Per vertex, edge and face. */
+  int hflag_len[3];
+  int *hflag_index[3];
+  char *hflag[3];
+
+  UndoMeshSelect select;
+} UndoMeshDelta;
+
+/* Two seeds, since a hash collision would restore the wrong state. */
+typedef struct UndoMeshHash {
+  BLI_HashMurmur2A mm2[2];
+} UndoMeshHash;
+
+static void um_hash_init(UndoMeshHash *hash)
+{
+  BLI_hash_mm2a_init(&hash->mm2[0], 0);
+  BLI_hash_mm2a_init(&hash->mm2[1], 1);
+}
+
+static void um_hash_add(UndoMeshHash *hash, const void *data, size_t len)
+{
+  BLI_hash_mm2a_add(&hash->mm2[0], data, len);
+  BLI_hash_mm2a_add(&hash->mm2[1], data, len);
+}
+
+static void um_hash_add_int(UndoMeshHash *hash, int data)
+{
+  BLI_hash_mm2a_add_int(&hash->mm2[0], data);
+  BLI_hash_mm2a_add_int(&hash->mm2[1], data);
+}
+
+static void um_hash_end(UndoMeshHash *hash, uint32_t r_hash[2])
+{
+  r_hash[0] = BLI_hash_mm2a_end(&hash->mm2[0]);
+  r_hash[1] = BLI_hash_mm2a_end(&hash->mm2[1]);
+}
+
+static void um_hash_add_cd_block(UndoMeshHash *hash, const CustomData *cdata, const void *block)
+{
+  for (int i = 0; i < cdata->totlayer; i++) {
+    const CustomDataLayer *layer = &cdata->layers[i];
+    const void *data = POINTER_OFFSET(block, layer->offset);
+    if (layer->type == CD_BM_ELEM_PYPTR) {
+      continue;
+    }
+    if (layer->type == CD_MDEFORMVERT) {
+      /* Hash the weights instead of the pointer to them. */
+      const MDeformVert *dvert = data;
+      um_hash_add_int(hash, dvert->totweight);
+      if (dvert->dw) {
+        um_hash_add(hash, dvert->dw, sizeof(*dvert->dw) * (size_t)dvert->totweight);
+      }
+      continue;
+    }
+    um_hash_add(hash, data, (size_t)CustomData_sizeof(layer->type));
+  }
+}
+
+/**
+ * Layers are restored from full steps, a renamed layer or a different active layer
+ * doesn't change the data in the blocks.
+ */
+static void um_hash_add_cd_layers(UndoMeshHash *hash, const CustomData *cdata)
+{
+  for (int i = 0; i < cdata->totlayer; i++) {
+    const CustomDataLayer *layer = &cdata->layers[i];
+    um_hash_add_int(hash, layer->type);
+    um_hash_add(hash, layer->name, strlen(layer->name));
+    um_hash_add_int(hash, layer->active);
+    um_hash_add_int(hash, layer->active_rnd);
+    um_hash_add_int(hash, layer->active_clone);
+    um_hash_add_int(hash, layer->active_mask);
+  }
+}
+
+/**
+ * Shape keys are only restored from full steps, multi-resolution layers store pointers to data
+ * which could change without the hashed pointers changing.
+ */
+static bool um_delta_supported(BMesh *bm, Key *key)
+{
+  return (key == NULL) && !CustomData_has_layer(&bm->ldata, CD_MDISPS) &&
+         !CustomData_has_layer(&bm->ldata, CD_GRID_PAINT_MASK);
+}
+
+static void um_delta_hash_calc(BMesh *bm, uint32_t r_topology_hash[2], uint32_t r_data_hash[2])
+{
+  UndoMeshHash topology, data;
+  um_hash_init(&topology);
+  um_hash_init(&data);
+
+  BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  um_hash_add_int(&topology, bm->totvert);
+  um_hash_add_int(&topology, bm->totedge);
+  um_hash_add_int(&topology, bm->totloop);
+  um_hash_add_int(&topology, bm->totface);
+
+  um_hash_add_cd_layers(&data, &bm->vdata);
+  um_hash_add_cd_layers(&data, &bm->edata);
+  um_hash_add_cd_layers(&data, &bm->ldata);
+  um_hash_add_cd_layers(&data, &bm->pdata);
+
+  BMIter iter;
+  BMVert *eve;
+  BM_ITER_MESH (eve, &iter, bm, BM_VERTS_OF_MESH) {
+    um_hash_add_cd_block(&data, &bm->vdata, eve->head.data);
+  }
+
+  BMEdge *eed;
+  BM_ITER_MESH (eed, &iter, bm, BM_EDGES_OF_MESH) {
+    um_hash_add_int(&topology, BM_elem_index_get(eed->v1));
+    um_hash_add_int(&topology, BM_elem_index_get(eed->v2));
+    um_hash_add_cd_block(&data, &bm->edata, eed->head.data);
+  }
+
+  BMFace *efa;
+  BM_ITER_MESH (efa, &iter, bm, BM_FACES_OF_MESH) {
+    um_hash_add_int(&topology, efa->len);
+    um_hash_add_int(&data, efa->mat_nr);
+    um_hash_add_cd_block(&data, &bm->pdata, efa->head.data);
+    BMLoop *l_iter, *l_first;
+    l_iter = l_first = BM_FACE_FIRST_LOOP(efa);
+    do {
+      um_hash_add_int(&topology, BM_elem_index_get(l_iter->v));
+      um_hash_add_int(&topology, BM_elem_index_get(l_iter->e));
+      um_hash_add_cd_block(&data, &bm->ldata, l_iter->head.data);
+    } while ((l_iter = l_iter->next) != l_first);
+  }
+
+  um_hash_end(&topology, r_topology_hash);
+  um_hash_end(&data, r_data_hash);
+}
+
+static bool um_shadow_matches(const UndoMeshShadow *shadow,
+                              const BMesh *bm,
+                              const uint32_t topology_hash[2],
+                              const uint32_t data_hash[2])
+{
+  return (shadow->totvert == bm->totvert) && (shadow->totedge == bm->totedge) &&
+         (shadow->totloop == bm->totloop) && (shadow->totface == bm->totface) &&
+         (memcmp(shadow->topology_hash, topology_hash, sizeof(shadow->topology_hash)) == 0) &&
+         (memcmp(shadow->data_hash, data_hash, sizeof(shadow->data_hash)) == 0);
+}
+
+static void um_select_from_editmesh(UndoMeshSelect *select, BMEditMesh *em)
+{
+  BMesh *bm = em->bm;
+  select->mselect_len = BLI_listbase_count(&bm->selected);
+  select->mselect = NULL;
+  if (select->mselect_len) {
+    select->mselect = MEM_mallocN(sizeof(*select->mselect) * select->mselect_len, __func__);
+    MSelect *msel = select->mselect;
+    LISTBASE_FOREACH (BMEditSelection *, ese, &bm->selected) {
+      msel->type = (ese->htype == BM_VERT) ? ME_VSEL : (ese->htype == BM_EDGE) ? ME_ESEL : ME_FSEL;
+      msel->index = BM_elem_index_get(ese->ele);
+      msel++;
+    }
+  }
+  select->act_face = bm->act_face ? BM_elem_index_get(bm->act_face) : -1;
+  select->selectmode = em->selectmode;
+  select->shapenr = bm->shapenr;
+}
+
+static void um_select_to_editmesh(const UndoMeshSelect *select, Object *ob, BMEditMesh *em)
+{
+  BMesh *bm = em->bm;
+  BM_select_history_clear(bm);
+  for (int i = 0; i < select->mselect_len; i++) {
+    const MSelect *msel = &select->mselect[i];
+    BMElem *ele = (msel->type == ME_VSEL) ? (BMElem *)bm->vtable[msel->index] :
+                  (msel->type == ME_ESEL) ? (BMElem *)bm->etable[msel->index] :
+                                            (BMElem *)bm->ftable[msel->index];
+    BM_select_history_store_notest(bm, ele);
+  }
+  bm->act_face = (select->act_face != -1) ? bm->ftable[select->act_face] : NULL;
+  em->selectmode = bm->selectmode = select->selectmode;
+  bm->shapenr = ob->shapenr = select->shapenr;
+}
+
+static UndoMeshShadow *um_shadow_create(BMEditMesh *em,
+                                        const uint32_t topology_hash[2],
+                                        const uint32_t data_hash[2])
+{
+  BMesh *bm = em->bm;
+  UndoMeshShadow *shadow = MEM_callocN(sizeof(*shadow), __func__);
+  memcpy(shadow->topology_hash, topology_hash, sizeof(shadow->topology_hash));
+  memcpy(shadow->data_hash, data_hash, sizeof(shadow->data_hash));
+  shadow->totvert = bm->totvert;
+  shadow->totedge = bm->totedge;
+  shadow->totloop = bm->totloop;
+  shadow->totface = bm->totface;
+
+  const char iter_types[3] = {BM_VERTS_OF_MESH, BM_EDGES_OF_MESH, BM_FACES_OF_MESH};
+  const int elem_len[3] = {bm->totvert, bm->totedge, bm->totface};
+
+  shadow->vert_co = MEM_mallocN(sizeof(*shadow->vert_co) * (size_t)bm->totvert, __func__);
+  BMIter iter;
+  BMVert *eve;
+  int i;
+  BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
+    copy_v3_v3(shadow->vert_co[i], eve->co);
+  }
+  for (int type = 0; type < 3; type++) {
+    shadow->hflag[type] = MEM_mallocN((size_t)elem_len[type], __func__);
+    BMElem *ele;
+    BM_ITER_MESH_INDEX (ele, &iter, bm, iter_types[type], i) {
+      shadow->hflag[type][i] = ele->head.hflag & UNDO_DELTA_HFLAG;
+    }
+  }
+
+  um_select_from_editmesh(&shadow->select, em);
+  return shadow;
+}
+
+static size_t um_shadow_size(const UndoMeshShadow *shadow)
+{
+  return sizeof(*shadow) + sizeof(*shadow->vert_co) * (size_t)shadow->totvert +
+         (size_t)(shadow->totvert + shadow->totedge + shadow->totface) +
+         sizeof(*shadow->select.mselect) * (size_t)shadow->select.mselect_len;
+}
+
+static void um_shadow_free(UndoMeshShadow *shadow)
+{
+  MEM_freeN(shadow->vert_co);
+  for (int type = 0; type < 3; type++) {
+    MEM_freeN(shadow->hflag[type]);
+  }
+  MEM_SAFE_FREE(shadow->select.mselect);
+  MEM_freeN(shadow);
+}
+
+/**
+ * \return NULL when too much changed for a delta to be worth it.
+ */
+static UndoMeshDelta *um_delta_create(const UndoMeshShadow *shadow, BMEditMesh *em)
+{
+  BMesh *bm = em->bm;
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  int vert_co_len = 0;
+  for (int i = 0; i < bm->totvert; i++) {
+    if (!equals_v3v3(bm->vtable[i]->co, shadow->vert_co[i])) {
+      vert_co_len++;
+    }
+  }
+  /* Restoring half of the vertices isn't faster than converting the full mesh. */
+  if (vert_co_len > bm->totvert / 2) {
+    return NULL;
+  }
+
+  UndoMeshDelta *delta = MEM_callocN(sizeof(*delta), __func__);
+  delta->vert_co_len = vert_co_len;
+  if (vert_co_len) {
+    delta->vert_co_index = MEM_mallocN(sizeof(*delta->vert_co_index) * (size_t)vert_co_len,
+                                       __func__);
+    delta->vert_co = MEM_mallocN(sizeof(*delta->vert_co) * (size_t)vert_co_len, __func__);
+    for (int i = 0, j = 0; i < bm->totvert; i++) {
+      if (!equals_v3v3(bm->vtable[i]->co, shadow->vert_co[i])) {
+        delta->vert_co_index[j] = i;
+        copy_v3_v3(delta->vert_co[j], bm->vtable[i]->co);
+        j++;
+      }
+    }
+  }
+
+  BMElem **tables[3] = {(BMElem **)bm->vtable, (BMElem **)bm->etable, (BMElem **)bm->ftable};
+  const int elem_len[3] = {bm->totvert, bm->totedge, bm->totface};
+  for (int type = 0; type < 3; type++) {
+    const char *hflag_ref = shadow->hflag[type];
+    int hflag_len = 0;
+    for (int i = 0; i < elem_len[type]; i++) {
+      if ((tables[type][i]->head.hflag & UNDO_DELTA_HFLAG) != hflag_ref[i]) {
+        hflag_len++;
+      }
+    }
+    delta->hflag_len[type] = hflag_len;
+    if (hflag_len == 0) {
+      continue;
+    }
+    delta->hflag_index[type] = MEM_mallocN(sizeof(int) * (size_t)hflag_len, __func__);
+    delta->hflag[type] = MEM_mallocN((size_t)hflag_len, __func__);
+    for (int i = 0, j = 0; i < elem_len[type]; i++) {
+      const char hflag = tables[type][i]->head.hflag & UNDO_DELTA_HFLAG;
+      if (hflag != hflag_ref[i]) {
+        delta->hflag_index[type][j] = i;
+        delta->hflag[type][j] = hflag;
+        j++;
+      }
+    }
+  }
+
+  um_select_from_editmesh(&delta->select, em);
+  return delta;
+}
+
+static size_t um_delta_size(const UndoMeshDelta *delta)
+{
+  size_t size = sizeof(*delta) + (sizeof(*delta->vert_co_index) + sizeof(*delta->vert_co)) *
+                                     (size_t)delta->vert_co_len;
+  for (int type = 0; type < 3; type++) {
+    size += (sizeof(int) + 1) * (size_t)delta->hflag_len[type];
+  }
+  size += sizeof(*delta->select.mselect) * (size_t)delta->select.mselect_len;
+  return size;
+}
+
+static void um_delta_free(UndoMeshDelta *delta)
+{
+  MEM_SAFE_FREE(delta->vert_co_index);
+  MEM_SAFE_FREE(delta->vert_co);
+  for (int type = 0; type < 3; type++) {
+    MEM_SAFE_FREE(delta->hflag_index[type]);
+    MEM_SAFE_FREE(delta->hflag[type]);
+  }
+  MEM_SAFE_FREE(delta->select.mselect);
+  MEM_freeN(delta);
+}
+
+/**
+ * Restore the state of the full step and \a delta (when not NULL) in place,
+ * the edit-mesh must match the shadow's topology and custom-data.
+ */
+static void um_delta_apply(const UndoMeshShadow *shadow,
+                           const UndoMeshDelta *delta,
+                           Object *ob,
+                           BMEditMesh *em)
+{
+  BMesh *bm = em->bm;
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
+
+  for (int i = 0; i < bm->totvert; i++) {
+    copy_v3_v3(bm->vtable[i]->co, shadow->vert_co[i]);
+  }
+  if (delta) {
+    for (int j = 0; j < delta->vert_co_len; j++) {
+      copy_v3_v3(bm->vtable[delta->vert_co_index[j]]->co, delta->vert_co[j]);
+    }
+  }
+
+  BMElem **tables[3] = {(BMElem **)bm->vtable, (BMElem **)bm->etable, (BMElem **)bm->ftable};
+  const int elem_len[3] = {bm->totvert, bm->totedge, bm->totface};
+  int *totsel[3] = {&bm->totvertsel, &bm->totedgesel, &bm->totfacesel};
+  for (int type = 0; type < 3; type++) {
+    BMElem **table = tables[type];
+    for (int i = 0; i < elem_len[type]; i++) {
+      table[i]->head.hflag = (table[i]->head.hflag & ~UNDO_DELTA_HFLAG) | shadow->hflag[type][i];
+    }
+    if (delta) {
+      for (int j = 0; j < delta->hflag_len[type]; j++) {
+        BMElem *ele = table[delta->hflag_index[type][j]];
+        ele->head.hflag = (ele->head.hflag & ~UNDO_DELTA_HFLAG) | delta->hflag[type][j];
+      }
+    }
+    int count = 0;
+    for (int i = 0; i < elem_len[type]; i++) {
+      if (BM_elem_flag_test(table[i], BM_ELEM_SELECT)) {
+        count++;
+      }
+    }
+    *totsel[type] = count;
+  }
+
+  um_select_to_editmesh(delta ? &delta->select : &shadow->select, ob, em);
+
+  BM_mesh_normals_update(bm);
+  bm->spacearr_dirty = BM_SPACEARR_DIRTY_ALL;
+  BKE_editmesh_looptri_calc(em);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Implements ED Undo System
  *
@@ -698,7 +1127,10 @@ static Object *editmesh_object_from_context(bContext *C)
 typedef struct MeshUndoStep_Elem {
   struct MeshUndoStep_Elem *next, *prev;
   UndoRefID_Object obedit_ref;
-  UndoMesh data;
+  /** Full state, shared with the delta steps stored against it. */
+  UndoMesh *data;
+  /** Changes relative to #data, NULL for full steps. */
+  UndoMeshDelta *delta;
 } MeshUndoStep_Elem;
 
 typedef struct MeshUndoStep {
@@ -712,6 +1144,121 @@ static bool mesh_undosys_poll(bContext *C)
   return editmesh_object_from_context(C) != NULL;
 }
 
+/**
+ * The full step of \a us_prev (the active step, preceding the one being encoded)
+ * for \a ob, to store a delta against.
+ */
+static UndoMesh *mesh_undosys_step_delta_reference(const MeshUndoStep *us,
+                                                   const MeshUndoStep *us_prev,
+                                                   const Object *ob)
+{
+  if ((us_prev == NULL) || (us_prev->step.type != us->step.type)) {
+    return NULL;
+  }
+  for (uint i = 0; i < us_prev->elems_len; i++) {
+    const MeshUndoStep_Elem *elem = &us_prev->elems[i];
+    /* Stored steps only keep the object name, the pointer is set while decoding. */
+    if (STREQ(elem->obedit_ref.name, ob->id.name) && (ob->id.lib == NULL)) {
+      UndoMesh *um = elem->data;
+      if (um->shadow && (um->shadow->deltas_len < UNDO_DELTA_STEPS_MAX)) {
+        return um;
+      }
+      break;
+    }
+  }
+  return NULL;
+}
+
+static void mesh_undosys_elem_encode(MeshUndoStep *us,
+                                     const MeshUndoStep *us_prev,
+                                     MeshUndoStep_Elem *elem,
+                                     Object *ob)
+{
+  const double time_start = PIL_check_seconds_timer();
+  Mesh *me = ob->data;
+  BMEditMesh *em = me->edit_mesh;
+
+  const bool use_delta = um_delta_supported(em->bm, me->key);
+  uint32_t topology_hash[2], data_hash[2];
+  if (use_delta) {
+    um_delta_hash_calc(em->bm, topology_hash, data_hash);
+
+    UndoMesh *um_ref = mesh_undosys_step_delta_reference(us, us_prev, ob);
+    if (um_ref && um_shadow_matches(um_ref->shadow, em->bm, topology_hash, data_hash)) {
+      elem->delta = um_delta_create(um_ref->shadow, em);
+      if (elem->delta) {
+        elem->data = um_ref;
+        um_ref->users += 1;
+        um_ref->shadow->deltas_len += 1;
+        us->step.data_size += um_delta_size(elem->delta);
+        CLOG_INFO(&LOG,
+                  1,
+                  "name='%s', delta step: %d coordinates, %zu bytes, %.3f ms",
+                  us->step.name,
+                  elem->delta->vert_co_len,
+                  um_delta_size(elem->delta),
+                  (PIL_check_seconds_timer() - time_start) * 1000.0);
+        return;
+      }
+    }
+  }
+
+  UndoMesh *um = MEM_callocN(sizeof(*um), __func__);
+  undomesh_from_editmesh(um, em, me->key);
+  um->users = 1;
+  if (use_delta) {
+    um->shadow = um_shadow_create(em, topology_hash, data_hash);
+    um->undo_size += um_shadow_size(um->shadow);
+  }
+  elem->data = um;
+  us->step.data_size += um->undo_size;
+  CLOG_INFO(&LOG,
+            1,
+            "name='%s', full step: %zu bytes, %.3f ms",
+            us->step.name,
+            um->undo_size,
+            (PIL_check_seconds_timer() - time_start) * 1000.0);
+}
+
+static void mesh_undosys_elem_decode(MeshUndoStep_Elem *elem, Object *obedit)
+{
+  Mesh *me = obedit->data;
+  BMEditMesh *em = me->edit_mesh;
+  UndoMesh *um = elem->data;
+  const UndoMeshShadow *shadow = um->shadow;
+
+  if (shadow) {
+    /* Restore in place when the edit-mesh still matches the full step. */
+    uint32_t topology_hash[2], data_hash[2];
+    um_delta_hash_calc(em->bm, topology_hash, data_hash);
+    if (um_shadow_matches(shadow, em->bm, topology_hash, data_hash)) {
+      um_delta_apply(shadow, elem->delta, obedit, em);
+      return;
+    }
+  }
+
+  undomesh_to_editmesh(um, obedit, em, me->key);
+  if (elem->delta) {
+    um_delta_apply(shadow, elem->delta, obedit, em);
+  }
+}
+
+static void mesh_undosys_elem_free(MeshUndoStep_Elem *elem)
+{
+  if (elem->delta) {
+    um_delta_free(elem->delta);
+  }
+  UndoMesh *um = elem->data;
+  um->users -= 1;
+  if (um->users == 0) {
+    if (um->shadow) {
+      um_shadow_free(um->shadow);
+    }
+    undomesh_free_data(um);
+    MEM_freeN(um);
+  }
+}
+
 static bool mesh_undosys_step_encode(struct bContext *C, struct Main *bmain, UndoStep *us_p)
 {
   MeshUndoStep *us = (MeshUndoStep *)us_p;
@@ -725,6 +1272,12 @@ static bool mesh_undosys_step_encode(struct bContext *C, struct Main *bmain, Und
   us->elems = MEM_callocN(sizeof(*us->elems) * objects_len, __func__);
   us->elems_len = objects_len;
 
+  /* The step isn't added to the stack yet, the active step is the one before it. */
+  wmWindowManager *wm = CTX_wm_manager(C);
+  const MeshUndoStep *us_prev = (wm && wm->undo_stack) ?
+                                    (const MeshUndoStep *)wm->undo_stack->step_active :
+                                    NULL;
+
   for (uint i = 0; i < objects_len; i++) {
     Object *ob = objects[i];
     MeshUndoStep_Elem *elem = &us->elems[i];
@@ -732,9 +1285,8 @@ static bool mesh_undosys_step_encode(struct bContext *C, struct Main *bmain, Und
     elem->obedit_ref.ptr = ob;
     Mesh *me = elem->obedit_ref.ptr->data;
     BMEditMesh *em = me->edit_mesh;
-    undomesh_from_editmesh(&elem->data, me->edit_mesh, me->key);
+    mesh_undosys_elem_encode(us, us_prev, elem, ob);
     em->needs_flush_to_id = 1;
-    us->step.data_size += elem->data.undo_size;
   }
   MEM_freeN(objects);
 
@@ -767,7 +1319,7 @@ static void mesh_undosys_step_decode(
       continue;
     }
     BMEditMesh *em = me->edit_mesh;
-    undomesh_to_editmesh(&elem->data, obedit, em, me->key);
+    mesh_undosys_elem_decode(elem, obedit);
     em->needs_flush_to_id = 1;
     DEG_id_tag_update(&obedit->id, ID_RECALC_GEOMETRY);
   }
@@ -777,7 +1329,8 @@ static void mesh_undosys_step_decode(
       CTX_data_view_layer(C), us->elems[0].obedit_ref.ptr, us_p->name, &LOG);
 
   Scene *scene = CTX_data_scene(C);
-  scene->toolsettings->selectmode = us->elems[0].data.selectmode;
+  scene->toolsettings->selectmode = us->elems[0].delta ? us->elems[0].delta->select.selectmode :
+                                                        us->elems[0].data->selectmode;
 
   bmain->is_memfile_undo_flush_needed = true;
 
@@ -790,7 +1343,7 @@ static void mesh_undosys_step_free(UndoStep *us_p)
 
   for (uint i = 0; i < us->elems_len; i++) {
     MeshUndoStep_Elem *elem = &us->elems[i];
-    undomesh_free_data(&elem->data);
+    mesh_undosys_elem_free(elem);
   }
   MEM_freeN(us->elems);
 }
@@ -0,0 +1,228 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "CLG_log.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_windowmanager_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+
+#include "BKE_collection.h"
+#include "BKE_context.h"
+#include "BKE_customdata.h"
+#include "BKE_editmesh.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_layer.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_test_utils.hh"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+#include "BKE_undo_system.h"
+
+#include "ED_mesh.h"
+
+#include "bmesh.h"
+
+namespace blender::ed::mesh::tests {
+
+class editmesh_undo : public testing::Test {
+ public:
+  Main *bmain;
+  bContext *C;
+  wmWindowManager *wm;
+  Object *ob;
+  UndoType *ut;
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    G_MAIN = bmain;
+
+    Scene *scene = BKE_scene_add(bmain, "Scene");
+    Mesh *me = BKE_mesh_add(bmain, "Mesh");
+    ob = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    ob->data = me;
+    id_us_plus(&me->id);
+    BKE_collection_object_add(bmain, scene->master_collection, ob);
+    ViewLayer *view_layer = (ViewLayer *)scene->view_layers.first;
+    view_layer->basact = BKE_view_layer_base_find(view_layer, ob);
+
+    me->edit_mesh = BKE_editmesh_create(bke::tests::bmesh_test_grid_create(32, true), true);
+    ob->mode = OB_MODE_EDIT;
+
+    wm = (wmWindowManager *)MEM_callocN(sizeof(*wm), __func__);
+    wm->undo_stack = BKE_undosys_stack_create();
+    C = CTX_create();
+    CTX_data_main_set(C, bmain);
+    CTX_data_scene_set(C, scene);
+    CTX_wm_manager_set(C, wm);
+
+    ut = BKE_undosys_type_append(ED_mesh_undosys_type);
+  }
+
+  void TearDown() override
+  {
+    BKE_undosys_stack_destroy(wm->undo_stack);
+    BKE_undosys_type_free_all();
+    BLI_freelistN(&wm->queue);
+    MEM_freeN(wm);
+    CTX_free(C);
+
+    Mesh *me = (Mesh *)ob->data;
+    BKE_editmesh_free(me->edit_mesh);
+    MEM_freeN(me->edit_mesh);
+    me->edit_mesh = nullptr;
+    BKE_main_free(bmain);
+    G_MAIN = nullptr;
+  }
+
+  BMesh *bm()
+  {
+    return ((Mesh *)ob->data)->edit_mesh->bm;
+  }
+
+  UndoStep *push(const char *name)
+  {
+    /* Only edit-mode steps are tested, don't push memory-file steps before them. */
+    bmain->is_memfile_undo_written = true;
+    EXPECT_TRUE(BKE_undosys_step_push_with_type(wm->undo_stack, C, name, ut));
+    return wm->undo_stack->step_active;
+  }
+
+  void coords_get(float (*r_coords)[3])
+  {
+    BMIter iter;
+    BMVert *eve;
+    int i;
+    BM_ITER_MESH_INDEX (eve, &iter, bm(), BM_VERTS_OF_MESH, i) {
+      copy_v3_v3(r_coords[i], eve->co);
+    }
+  }
+
+  void coords_expect_eq(const float (*coords)[3])
+  {
+    BMIter iter;
+    BMVert *eve;
+    int i;
+    BM_ITER_MESH_INDEX (eve, &iter, bm(), BM_VERTS_OF_MESH, i) {
+      EXPECT_V3_NEAR(eve->co, coords[i], 0.0f);
+    }
+  }
+
+  void selection_expect_eq(const bool *select)
+  {
+    BMIter iter;
+    BMVert *eve;
+    int i;
+    BM_ITER_MESH_INDEX (eve, &iter, bm(), BM_VERTS_OF_MESH, i) {
+      EXPECT_EQ(BM_elem_flag_test_bool(eve, BM_ELEM_SELECT), select[i]);
+    }
+  }
+};
+
+TEST_F(editmesh_undo, DeltaRoundTrip)
+{
+  const int verts_len = bm()->totvert;
+  float(*coords_orig)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * verts_len, __func__);
+  float(*coords_moved)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * verts_len, __func__);
+  bool *select_orig = (bool *)MEM_callocN(sizeof(bool) * verts_len, __func__);
+  bool *select_moved = (bool *)MEM_callocN(sizeof(bool) * verts_len, __func__);
+  coords_get(coords_orig);
+
+  UndoStep *us_full = push("Original");
+
+  /* Move and select some vertices, keeping the topology. */
+  BMIter iter;
+  BMVert *eve;
+  int i;
+  BM_ITER_MESH_INDEX (eve, &iter, bm(), BM_VERTS_OF_MESH, i) {
+    if (i % 10 == 0) {
+      eve->co[2] += 1.0f;
+      BM_vert_select_set(bm(), eve, true);
+      select_moved[i] = true;
+    }
+  }
+  coords_get(coords_moved);
+  UndoStep *us_delta = push("Move");
+
+  /* Only the moved vertices are stored. */
+  EXPECT_LT(us_delta->data_size * 4, us_full->data_size);
+
+  /* Restored in place, the edit-mesh matches the full step. */
+  EXPECT_TRUE(BKE_undosys_step_undo(wm->undo_stack, C));
+  coords_expect_eq(coords_orig);
+  selection_expect_eq(select_orig);
+  EXPECT_TRUE(BKE_undosys_step_redo(wm->undo_stack, C));
+  coords_expect_eq(coords_moved);
+  selection_expect_eq(select_moved);
+
+  /* Restored from the full step when the topology changed since. */
+  BM_vert_kill(bm(), (BMVert *)BM_iter_at_index(bm(), BM_VERTS_OF_MESH, nullptr, 0));
+  push("Delete");
+  EXPECT_TRUE(BKE_undosys_step_undo(wm->undo_stack, C));
+  ASSERT_EQ(bm()->totvert, verts_len);
+  coords_expect_eq(coords_moved);
+  selection_expect_eq(select_moved);
+  EXPECT_TRUE(BKE_undosys_step_undo(wm->undo_stack, C));
+  coords_expect_eq(coords_orig);
+  selection_expect_eq(select_orig);
+
+  MEM_freeN(coords_orig);
+  MEM_freeN(coords_moved);
+  MEM_freeN(select_orig);
+  MEM_freeN(select_moved);
+}
+
+TEST_F(editmesh_undo, FullStepAfterTopologyChange)
+{
+  UndoStep *us_full = push("Original");
+  BM_vert_kill(bm(), (BMVert *)BM_iter_at_index(bm(), BM_VERTS_OF_MESH, nullptr, 0));
+  UndoStep *us_next = push("Delete");
+  /* Can't be stored as a delta. */
+  EXPECT_GT(us_next->data_size * 4, us_full->data_size);
+}
+
+TEST_F(editmesh_undo, LayerChangesStoreFullStep)
+{
+  BM_data_layer_add_named(bm(), &bm()->ldata, CD_MLOOPUV, "UVMap");
+  BM_data_layer_add_named(bm(), &bm()->ldata, CD_MLOOPUV, "UVMap.001");
+  UndoStep *us_full = push("Original");
+
+  /* The data of the layers is unchanged, restoring it as a delta would keep these. */
+  CustomData_set_layer_active(&bm()->ldata, CD_MLOOPUV, 1);
+  UndoStep *us_active = push("Active UV");
+  EXPECT_GT(us_active->data_size * 4, us_full->data_size);
+
+  CustomData_set_layer_name(&bm()->ldata, CD_MLOOPUV, 0, "Renamed");
+  UndoStep *us_rename = push("Rename UV");
+  EXPECT_GT(us_rename->data_size * 4, us_full->data_size);
+
+  EXPECT_TRUE(BKE_undosys_step_undo(wm->undo_stack, C));
+  EXPECT_EQ(CustomData_get_active_layer(&bm()->ldata, CD_MLOOPUV), 1);
+  EXPECT_STREQ(CustomData_get_layer_name(&bm()->ldata, CD_MLOOPUV, 0), "UVMap");
+  EXPECT_TRUE(BKE_undosys_step_undo(wm->undo_stack, C));
+  EXPECT_EQ(CustomData_get_active_layer(&bm()->ldata, CD_MLOOPUV), 0);
+}
+
+}  // namespace blender::ed::mesh::tests
@@ -579,6 +579,14 @@ typedef struct SculptUndoNode {
   float (*col)[4];
   float *mask;
   int totvert;
+  /* Length of the arrays above. */
+  int allvert;
+
+  /* Compressed copy of the arrays above once the undo step is finished,
+   * these arrays are NULL then (see #sculpt_undo_node_pack). */
+  void *packed;
+  size_t packed_size;
+  int packed_layers;
 
   /* non-multires */
   int maxvert; /* to verify if totvert it still the same */
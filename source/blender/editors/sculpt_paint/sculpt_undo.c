@@ -70,6 +70,16 @@
 #include "bmesh.h"
 #include "sculpt_intern.h"
 
+#include "atomic_ops.h"
+
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#endif
+
 /* Implementation of undo system for objects in sculpt mode.
  *
  * Each undo step in sculpt mode consists of list of nodes, each node contains:
@@ -107,15 +117,26 @@
  * does modifications on it.
  *
  * End of dynamic topology and symmetrize in this mode are handled in a special
- * manner as well. */
+ * manner as well.
+ *
+ * Once a step is finished, the COORDS, MASK and COLOR arrays of its nodes are compressed in the
+ * background, and decompressed again when the step is undone or redone. */
 
 typedef struct UndoSculpt {
   ListBase nodes;
 
   size_t undo_size;
+
+  /* The step owning these nodes, its size is updated along with compression. */
+  UndoStep *step;
+  /* Compression of the nodes which is still running. */
+  TaskPool *pack_pool;
+  /* Some nodes may be compressed, read with atomics since brushes check it from many threads. */
+  char is_packed;
 } UndoSculpt;
 
 static UndoSculpt *sculpt_undo_get_nodes(void);
+static void sculpt_undo_nodes_unpack(UndoSculpt *usculpt);
 
 static void update_cb(PBVHNode *node, void *rebuild)
 {
@@ -857,6 +878,12 @@ static void sculpt_undo_free_list(ListBase *lb)
     if (unode->mask) {
       MEM_freeN(unode->mask);
     }
+    if (unode->col) {
+      MEM_freeN(unode->col);
+    }
+    if (unode->packed) {
+      MEM_freeN(unode->packed);
+    }
 
     if (unode->bm_entry) {
       BM_log_entry_drop(unode->bm_entry);
@@ -899,6 +926,21 @@ static bool sculpt_undo_cleanup(bContext *C, ListBase *lb)
 }
 #endif
 
+/* Nodes of a finished step are only accessed by brushes when they are pushed to the active step
+ * instead of a new one, decompress them on first access. */
+static void sculpt_undo_nodes_unpack_ensure(UndoSculpt *usculpt)
+{
+  static ThreadMutex unpack_mutex = BLI_MUTEX_INITIALIZER;
+
+  /* Set before compression starts and cleared once all nodes are decompressed again,
+   * #sculpt_undo_nodes_unpack checks it again while locked. */
+  if (atomic_fetch_and_or_char(&usculpt->is_packed, 0)) {
+    BLI_mutex_lock(&unpack_mutex);
+    sculpt_undo_nodes_unpack(usculpt);
+    BLI_mutex_unlock(&unpack_mutex);
+  }
+}
+
 SculptUndoNode *SCULPT_undo_get_node(PBVHNode *node)
 {
   UndoSculpt *usculpt = sculpt_undo_get_nodes();
@@ -907,6 +949,8 @@ SculptUndoNode *SCULPT_undo_get_node(PBVHNode *node)
     return NULL;
   }
 
+  sculpt_undo_nodes_unpack_ensure(usculpt);
+
   return BLI_findptr(&usculpt->nodes, node, offsetof(SculptUndoNode, node));
 }
 
@@ -918,6 +962,8 @@ SculptUndoNode *SCULPT_undo_get_first_node()
     return NULL;
   }
 
+  sculpt_undo_nodes_unpack_ensure(usculpt);
+
   return usculpt->nodes.first;
 }
 
@@ -985,6 +1031,7 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, Sculpt
     BKE_pbvh_node_get_grids(ss->pbvh, node, &grids, &totgrid, &maxgrid, &gridsize, NULL);
 
     unode->totvert = totvert;
+    unode->allvert = allvert;
   }
   else {
     maxgrid = 0;
@@ -996,7 +1043,7 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, Sculpt
       unode->co = MEM_callocN(sizeof(float[3]) * allvert, "SculptUndoNode.co");
       unode->no = MEM_callocN(sizeof(short[3]) * allvert, "SculptUndoNode.no");
 
-      usculpt->undo_size = (sizeof(float[3]) + sizeof(short[3]) + sizeof(int)) * allvert;
+      usculpt->undo_size += (sizeof(float[3]) + sizeof(short[3]) + sizeof(int)) * allvert;
       break;
     case SCULPT_UNDO_HIDDEN:
       if (maxgrid) {
@@ -1010,13 +1057,13 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, Sculpt
     case SCULPT_UNDO_MASK:
       unode->mask = MEM_callocN(sizeof(float) * allvert, "SculptUndoNode.mask");
 
-      usculpt->undo_size += (sizeof(float) * sizeof(int)) * allvert;
+      usculpt->undo_size += (sizeof(float) + sizeof(int)) * allvert;
 
       break;
     case SCULPT_UNDO_COLOR:
       unode->col = MEM_callocN(sizeof(MPropCol) * allvert, "SculptUndoNode.col");
 
-      usculpt->undo_size += (sizeof(MPropCol) * sizeof(int)) * allvert;
+      usculpt->undo_size += (sizeof(MPropCol) + sizeof(int)) * allvert;
 
       break;
     case SCULPT_UNDO_DYNTOPO_BEGIN:
@@ -1043,6 +1090,7 @@ static SculptUndoNode *sculpt_undo_alloc_node(Object *ob, PBVHNode *node, Sculpt
 
   if (ss->deform_modifiers_active) {
     unode->orig_co = MEM_callocN(allvert * sizeof(*unode->orig_co), "undoSculpt orig_cos");
+    usculpt->undo_size += allvert * sizeof(*unode->orig_co);
   }
 
   return unode;
@@ -1381,6 +1429,233 @@ void SCULPT_undo_push_end_ex(const bool use_nested_undo)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Compressed Storage
+ *
+ * Per vertex arrays of finished steps are delta-encoded and compressed with LZO on a background
+ * thread. Values are stored as the XOR with the same component of the previous vertex, split
+ * into byte planes: vertices in a PBVH node are close to each other so the sign, exponent and
+ * upper mantissa bytes are mostly zero, which LZO compresses well at close to memcpy speed.
+ * \{ */
+
+#ifdef WITH_LZO
+
+/* Nodes with smaller arrays are kept as they are. */
+#  define SCULPT_UNDO_PACK_MIN_SIZE 4096
+
+#  define LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+
+typedef struct SculptUndoPackLayer {
+  void **data;
+  int stride;
+  const char *name;
+} SculptUndoPackLayer;
+
+#  define SCULPT_UNDO_PACK_LAYERS 4
+
+static void sculpt_undo_pack_layers_get(SculptUndoNode *unode,
+                                        SculptUndoPackLayer r_layers[SCULPT_UNDO_PACK_LAYERS])
+{
+  r_layers[0] = (SculptUndoPackLayer){(void **)&unode->co, 3, "SculptUndoNode.co"};
+  r_layers[1] = (SculptUndoPackLayer){(void **)&unode->orig_co, 3, "undoSculpt orig_cos"};
+  r_layers[2] = (SculptUndoPackLayer){(void **)&unode->col, 4, "SculptUndoNode.col"};
+  r_layers[3] = (SculptUndoPackLayer){(void **)&unode->mask, 1, "SculptUndoNode.mask"};
+}
+
+static void sculpt_undo_pack_filter(const uint32_t *src, uchar *dst, const int len, int stride)
+{
+  for (int i = 0; i < len; i++) {
+    const uint32_t value = src[i] ^ ((i >= stride) ? src[i - stride] : 0);
+    dst[i] = (uchar)value;
+    dst[len + i] = (uchar)(value >> 8);
+    dst[len * 2 + i] = (uchar)(value >> 16);
+    dst[len * 3 + i] = (uchar)(value >> 24);
+  }
+}
+
+static void sculpt_undo_unpack_filter(const uchar *src, uint32_t *dst, const int len, int stride)
+{
+  for (int i = 0; i < len; i++) {
+    const uint32_t value = (uint32_t)src[i] | ((uint32_t)src[len + i] << 8) |
+                           ((uint32_t)src[len * 2 + i] << 16) |
+                           ((uint32_t)src[len * 3 + i] << 24);
+    dst[i] = value ^ ((i >= stride) ? dst[i - stride] : 0);
+  }
+}
+
+/* Compress the per vertex arrays of the node, returns the number of bytes saved. */
+static size_t sculpt_undo_node_pack(SculptUndoNode *unode)
+{
+  SculptUndoPackLayer layers[SCULPT_UNDO_PACK_LAYERS];
+  sculpt_undo_pack_layers_get(unode, layers);
+
+  BLI_assert(unode->packed == NULL);
+
+  size_t raw_size = 0;
+  for (int i = 0; i < SCULPT_UNDO_PACK_LAYERS; i++) {
+    if (*layers[i].data) {
+      raw_size += sizeof(uint32_t) * (size_t)(unode->allvert * layers[i].stride);
+    }
+  }
+  if (raw_size < SCULPT_UNDO_PACK_MIN_SIZE) {
+    return 0;
+  }
+
+  uchar *filtered = MEM_mallocN(raw_size, __func__);
+  size_t offset = 0;
+  for (int i = 0; i < SCULPT_UNDO_PACK_LAYERS; i++) {
+    if (*layers[i].data) {
+      const int len = unode->allvert * layers[i].stride;
+      sculpt_undo_pack_filter(*layers[i].data, filtered + offset, len, layers[i].stride);
+      offset += sizeof(uint32_t) * (size_t)len;
+    }
+  }
+
+  uchar *packed = MEM_mallocN(LZO_OUT_LEN(raw_size), __func__);
+  void *wrkmem = MEM_mallocN(LZO1X_1_MEM_COMPRESS, __func__);
+  lzo_uint packed_size = 0;
+  const int r = lzo1x_1_compress(filtered, (lzo_uint)raw_size, packed, &packed_size, wrkmem);
+  MEM_freeN(wrkmem);
+  MEM_freeN(filtered);
+
+  if ((r != LZO_E_OK) || (packed_size >= raw_size)) {
+    MEM_freeN(packed);
+    return 0;
+  }
+
+  unode->packed = MEM_reallocN(packed, packed_size);
+  unode->packed_size = packed_size;
+  for (int i = 0; i < SCULPT_UNDO_PACK_LAYERS; i++) {
+    if (*layers[i].data) {
+      unode->packed_layers |= (1 << i);
+      MEM_freeN(*layers[i].data);
+      *layers[i].data = NULL;
+    }
+  }
+
+  return raw_size - packed_size;
+}
+
+/* Restore the per vertex arrays of the node, returns the number of bytes added. */
+static size_t sculpt_undo_node_unpack(SculptUndoNode *unode)
+{
+  if (unode->packed == NULL) {
+    return 0;
+  }
+
+  SculptUndoPackLayer layers[SCULPT_UNDO_PACK_LAYERS];
+  sculpt_undo_pack_layers_get(unode, layers);
+
+  size_t raw_size = 0;
+  for (int i = 0; i < SCULPT_UNDO_PACK_LAYERS; i++) {
+    if (unode->packed_layers & (1 << i)) {
+      raw_size += sizeof(uint32_t) * (size_t)(unode->allvert * layers[i].stride);
+    }
+  }
+
+  uchar *filtered = MEM_callocN(raw_size, __func__);
+  lzo_uint raw_size_unpacked = raw_size;
+  const int r = lzo1x_decompress_safe(
+      unode->packed, unode->packed_size, filtered, &raw_size_unpacked, NULL);
+  BLI_assert((r == LZO_E_OK) && (raw_size_unpacked == raw_size));
+  UNUSED_VARS_NDEBUG(r);
+
+  size_t offset = 0;
+  for (int i = 0; i < SCULPT_UNDO_PACK_LAYERS; i++) {
+    if (unode->packed_layers & (1 << i)) {
+      const int len = unode->allvert * layers[i].stride;
+      *layers[i].data = MEM_mallocN(sizeof(uint32_t) * (size_t)len, layers[i].name);
+      sculpt_undo_unpack_filter(filtered + offset, *layers[i].data, len, layers[i].stride);
+      offset += sizeof(uint32_t) * (size_t)len;
+    }
+  }
+  MEM_freeN(filtered);
+
+  const size_t packed_size = unode->packed_size;
+  MEM_freeN(unode->packed);
+  unode->packed = NULL;
+  unode->packed_size = 0;
+  unode->packed_layers = 0;
+
+  return raw_size - packed_size;
+}
+
+static bool sculpt_undo_node_pack_poll(const SculptUndoNode *unode)
+{
+  return ELEM(unode->type, SCULPT_UNDO_COORDS, SCULPT_UNDO_MASK, SCULPT_UNDO_COLOR) &&
+         (unode->bm_entry == NULL);
+}
+
+static void sculpt_undo_node_pack_task(TaskPool *__restrict pool, void *taskdata)
+{
+  UndoSculpt *usculpt = BLI_task_pool_user_data(pool);
+  const size_t size_saved = sculpt_undo_node_pack(taskdata);
+  if (size_saved) {
+    atomic_sub_and_fetch_z(&usculpt->step->data_size, size_saved);
+  }
+}
+
+static void sculpt_undo_node_unpack_cb(void *__restrict userdata,
+                                       void *item,
+                                       int UNUSED(index),
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  UndoSculpt *usculpt = userdata;
+  const size_t size_added = sculpt_undo_node_unpack(item);
+  if (size_added) {
+    atomic_add_and_fetch_z(&usculpt->step->data_size, size_added);
+  }
+}
+
+#endif /* WITH_LZO */
+
+/* Compress the nodes of a finished step in the background. */
+static void sculpt_undo_nodes_pack_begin(UndoSculpt *usculpt)
+{
+  BLI_assert(usculpt->pack_pool == NULL);
+#ifdef WITH_LZO
+  LISTBASE_FOREACH (SculptUndoNode *, unode, &usculpt->nodes) {
+    if (sculpt_undo_node_pack_poll(unode)) {
+      if (usculpt->pack_pool == NULL) {
+        usculpt->pack_pool = BLI_task_pool_create_background(usculpt, TASK_PRIORITY_LOW);
+        usculpt->step->data_size_uncompressed = usculpt->undo_size;
+        atomic_fetch_and_or_char(&usculpt->is_packed, 1);
+      }
+      BLI_task_pool_push(usculpt->pack_pool, sculpt_undo_node_pack_task, unode, false, NULL);
+    }
+  }
+#else
+  UNUSED_VARS(usculpt);
+#endif
+}
+
+static void sculpt_undo_nodes_pack_wait(UndoSculpt *usculpt)
+{
+  if (usculpt->pack_pool) {
+    BLI_task_pool_work_and_wait(usculpt->pack_pool);
+    BLI_task_pool_free(usculpt->pack_pool);
+    usculpt->pack_pool = NULL;
+  }
+}
+
+/* Decompress all nodes, waiting for compression which may still be running. */
+static void sculpt_undo_nodes_unpack(UndoSculpt *usculpt)
+{
+  sculpt_undo_nodes_pack_wait(usculpt);
+  if (!atomic_fetch_and_or_char(&usculpt->is_packed, 0)) {
+    return;
+  }
+#ifdef WITH_LZO
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_listbase(&usculpt->nodes, usculpt, sculpt_undo_node_unpack_cb, &settings);
+#endif
+  atomic_fetch_and_and_char(&usculpt->is_packed, 0);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Implements ED Undo System
  * \{ */
@@ -1396,6 +1671,7 @@ static void sculpt_undosys_step_encode_init(struct bContext *UNUSED(C), UndoStep
   SculptUndoStep *us = (SculptUndoStep *)us_p;
   /* Dummy, memory is cleared anyway. */
   BLI_listbase_clear(&us->data.nodes);
+  us->data.step = us_p;
 }
 
 static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
@@ -1417,6 +1693,8 @@ static bool sculpt_undosys_step_encode(struct bContext *UNUSED(C),
     bmain->is_memfile_undo_flush_needed = true;
   }
 
+  sculpt_undo_nodes_pack_begin(&us->data);
+
   return true;
 }
 
@@ -1425,7 +1703,9 @@ static void sculpt_undosys_step_decode_undo_impl(struct bContext *C,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == true);
+  sculpt_undo_nodes_unpack(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_nodes_pack_begin(&us->data);
   us->step.is_applied = false;
 }
 
@@ -1434,7 +1714,9 @@ static void sculpt_undosys_step_decode_redo_impl(struct bContext *C,
                                                  SculptUndoStep *us)
 {
   BLI_assert(us->step.is_applied == false);
+  sculpt_undo_nodes_unpack(&us->data);
   sculpt_undo_restore_list(C, depsgraph, &us->data.nodes);
+  sculpt_undo_nodes_pack_begin(&us->data);
   us->step.is_applied = true;
 }
 
@@ -1527,6 +1809,7 @@ static void sculpt_undosys_step_decode(
 static void sculpt_undosys_step_free(UndoStep *us_p)
 {
   SculptUndoStep *us = (SculptUndoStep *)us_p;
+  sculpt_undo_nodes_pack_wait(&us->data);
   sculpt_undo_free_list(&us->data.nodes);
 }
 
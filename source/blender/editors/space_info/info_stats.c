@@ -78,6 +78,8 @@ typedef struct SceneStats {
   uint64_t totlamp, totlampsel;
   uint64_t tottri;
   uint64_t totgplayer, totgpframe, totgpstroke, totgppoint;
+  /* Duration of the last sculpt PBVH build, in seconds. */
+  double pbvh_build_time;
 } SceneStats;
 
 typedef struct SceneStatsFmt {
@@ -91,6 +93,7 @@ typedef struct SceneStatsFmt {
   char tottri[MAX_INFO_NUM_LEN];
   char totgplayer[MAX_INFO_NUM_LEN], totgpframe[MAX_INFO_NUM_LEN];
   char totgpstroke[MAX_INFO_NUM_LEN], totgppoint[MAX_INFO_NUM_LEN];
+  char pbvh_build_time[MAX_INFO_NUM_LEN];
 } SceneStatsFmt;
 
 static bool stats_mesheval(Mesh *me_eval, bool is_selected, SceneStats *stats)
@@ -373,14 +376,17 @@ static void stats_object_sculpt(Object *ob, SceneStats *stats)
     case PBVH_FACES:
       stats->totvertsculpt = ss->totvert;
       stats->totfacesculpt = ss->totfaces;
+      stats->pbvh_build_time = BKE_pbvh_build_time_get(ss->pbvh);
       break;
     case PBVH_BMESH:
       stats->totvertsculpt = ob->sculpt->bm->totvert;
       stats->tottri = ob->sculpt->bm->totface;
+      stats->pbvh_build_time = BKE_pbvh_build_time_get(ss->pbvh);
       break;
     case PBVH_GRIDS:
       stats->totvertsculpt = BKE_pbvh_get_grid_num_vertices(ss->pbvh);
       stats->totfacesculpt = BKE_pbvh_get_grid_num_faces(ss->pbvh);
+      stats->pbvh_build_time = BKE_pbvh_build_time_get(ss->pbvh);
       break;
   }
 }
@@ -493,6 +499,11 @@ static bool format_stats(Main *bmain,
   SCENE_STATS_FMT_INT(totgppoint);
 
 #undef SCENE_STATS_FMT_INT
+
+  BLI_snprintf(stats_fmt->pbvh_build_time,
+               sizeof(stats_fmt->pbvh_build_time),
+               "%.1f ms",
+               stats->pbvh_build_time * 1000.0);
   return true;
 }
 
@@ -713,6 +724,7 @@ void ED_info_draw_stats(
     FRAMES,
     STROKES,
     POINTS,
+    BVH_BUILD,
     MAX_LABELS_COUNT
   };
   char labels[MAX_LABELS_COUNT][64];
@@ -728,6 +740,7 @@ void ED_info_draw_stats(
   STRNCPY(labels[FRAMES], IFACE_("Frames"));
   STRNCPY(labels[STROKES], IFACE_("Strokes"));
   STRNCPY(labels[POINTS], IFACE_("Points"));
+  STRNCPY(labels[BVH_BUILD], IFACE_("BVH Build"));
 
   int longest_label = 0;
   int i;
@@ -774,10 +787,12 @@ void ED_info_draw_stats(
     if (stats_is_object_dynamic_topology_sculpt(ob)) {
       stats_row(col1, labels[VERTS], col2, stats_fmt.totvertsculpt, NULL, y, height);
       stats_row(col1, labels[TRIS], col2, stats_fmt.tottri, NULL, y, height);
+      stats_row(col1, labels[BVH_BUILD], col2, stats_fmt.pbvh_build_time, NULL, y, height);
     }
     else {
       stats_row(col1, labels[VERTS], col2, stats_fmt.totvertsculpt, stats_fmt.totvert, y, height);
       stats_row(col1, labels[FACES], col2, stats_fmt.totfacesculpt, stats_fmt.totface, y, height);
+      stats_row(col1, labels[BVH_BUILD], col2, stats_fmt.pbvh_build_time, NULL, y, height);
     }
   }
   else {
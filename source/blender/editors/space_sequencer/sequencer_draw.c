@@ -717,6 +717,12 @@ static void draw_seq_text(View2D *v2d,
     str_len = BLI_snprintf(str, sizeof(str), "%s | %d", name, seq->len);
   }
 
+  /* Time the last render of the strip took, to find strips that slow down playback. */
+  if ((sseq->draw_flag & SEQ_DRAW_RENDER_TIME) && seq->runtime.render_time > 0.0f) {
+    str_len += BLI_snprintf_rlen(
+        str + str_len, sizeof(str) - str_len, " | %.1f ms", seq->runtime.render_time * 1000.0f);
+  }
+
   /* White text for the active strip. */
   col[0] = col[1] = col[2] = seq_active ? 255 : 10;
   col[3] = 255;
@@ -1560,6 +1560,32 @@ static void transform_apply_to_mirror(TransInfo *t)
   }
 }
 
+/**
+ * Let the draw cache update only the moved vertices.
+ * Custom-data correction also changes loop data, which needs a full update.
+ */
+static void mesh_transdata_deform_verts_tag(TransInfo *t, TransDataContainer *tc, BMEditMesh *em)
+{
+  if ((t->data_type != TC_MESH_VERTS) || tc->custom.type.data) {
+    BKE_editmesh_deform_verts_invalidate(em);
+    return;
+  }
+  BLI_bitmap *deform_verts = BKE_editmesh_deform_verts_ensure(em);
+  if (deform_verts == NULL) {
+    return;
+  }
+
+  TransData *td = tc->data;
+  for (int i = tc->data_len; i--; td++) {
+    BLI_BITMAP_ENABLE(deform_verts, BM_elem_index_get((BMVert *)td->extra));
+  }
+
+  TransDataMirror *td_mirror = tc->data_mirror;
+  for (int i = tc->data_mirror_len; i--; td_mirror++) {
+    BLI_BITMAP_ENABLE(deform_verts, BM_elem_index_get((BMVert *)td_mirror->extra));
+  }
+}
+
 void recalcData_mesh(TransInfo *t)
 {
   bool is_canceling = t->state == TRANS_CANCEL;
@@ -1583,7 +1609,8 @@ void recalcData_mesh(TransInfo *t)
     DEG_id_tag_update(tc->obedit->data, 0); /* sets recalc flags */
     BMEditMesh *em = BKE_editmesh_from_object(tc->obedit);
     EDBM_mesh_normals_update(em);
-    BKE_editmesh_looptri_calc(em);
+    BKE_editmesh_looptri_calc_deform(em);
+    mesh_transdata_deform_verts_tag(t, tc, em);
   }
 }
 /** \} */
@@ -43,6 +43,13 @@ typedef void *(*MovieCacheGetPriorityDataFP)(void *userkey);
 typedef int (*MovieCacheGetItemPriorityFP)(void *last_userkey, void *priority_data);
 typedef void (*MovieCachePriorityDeleterFP)(void *priority_data);
 
+/** Usage of one cache, the counters are accumulated since it was created. */
+typedef struct MovieCacheStats {
+  size_t mem_in_use;
+  int totitem;
+  unsigned int hits, misses, puts, evictions;
+} MovieCacheStats;
+
 void IMB_moviecache_init(void);
 void IMB_moviecache_destruct(void);
 
@@ -63,6 +70,7 @@ struct ImBuf *IMB_moviecache_get(struct MovieCache *cache, void *userkey);
 void IMB_moviecache_remove(struct MovieCache *cache, void *userkey);
 bool IMB_moviecache_has_frame(struct MovieCache *cache, void *userkey);
 void IMB_moviecache_free(struct MovieCache *cache);
+void IMB_moviecache_get_stats(struct MovieCache *cache, MovieCacheStats *r_stats);
 
 void IMB_moviecache_cleanup(struct MovieCache *cache,
                             bool(cleanup_check_cb)(struct ImBuf *ibuf,
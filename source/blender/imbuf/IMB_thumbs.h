@@ -76,6 +76,11 @@ struct ImBuf *IMB_thumb_manage(const char *path, ThumbSize size, ThumbSource sou
 /* create the necessary dirs to store the thumbnails */
 void IMB_thumb_makedirs(void);
 
+/* load an image scaled down for a thumbnail, decoding at reduced resolution where possible */
+struct ImBuf *IMB_thumb_load_image(const char *filepath,
+                                   const size_t max_thumb_size,
+                                   char *colorspace);
+
 /* special function for loading a thumbnail embedded into a blend file */
 struct ImBuf *IMB_thumb_load_blend(const char *blen_path,
                                    const char *blen_group,
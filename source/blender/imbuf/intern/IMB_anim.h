@@ -80,6 +80,11 @@
 
 #define MAXNUMSTREAMS 50
 
+/* Maximum number of horizontal bands the color conversion of a movie frame is split into. */
+#define ANIM_CONVERT_BANDS_MAX 16
+/* Maximum number of decoded movie frames kept around for scrubbing and reverse playback. */
+#define ANIM_FRAME_RING_MAX 32
+
 struct IDProperty;
 struct _AviMovie;
 struct anim_index;
@@ -132,10 +137,28 @@ struct anim {
   struct SwsContext *img_convert_ctx;
   int videoStream;
 
+  /* Color conversion split into horizontal bands that are converted in parallel, each with its
+   * own context. Bands start at a multiple of `img_convert_band_height` rows. Every band also
+   * converts a few rows of its neighbors, so chroma is interpolated across band borders. Those
+   * rows go to `img_convert_bands_buffer`, which holds the padded rows of all bands. */
+  struct SwsContext *img_convert_bands[ANIM_CONVERT_BANDS_MAX];
+  int img_convert_bands_len;
+  int img_convert_band_height;
+  uint8_t *img_convert_bands_buffer;
+
+  /* Frame the decoder is at. Unlike `curposition` it doesn't change when a frame comes from the
+   * frame ring. */
+  int decoder_position;
   struct ImBuf *last_frame;
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* Recently decoded frames and their PTS, replaced round-robin. */
+  struct ImBuf *frame_ring[ANIM_FRAME_RING_MAX];
+  int64_t frame_ring_pts[ANIM_FRAME_RING_MAX];
+  int frame_ring_len;
+  int frame_ring_next;
 #endif
 
   char index_dir[768];
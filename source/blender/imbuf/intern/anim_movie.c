@@ -53,10 +53,14 @@
 #  include <io.h>
 #endif
 
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
 #ifdef WITH_AVI
@@ -78,6 +82,7 @@
 
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
+#  include <libavutil/pixdesc.h>
 #  include <libavutil/rational.h>
 #  include <libswscale/swscale.h>
 
@@ -500,11 +505,152 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+/* Rows of the neighboring bands converted along with a band, a multiple of any chroma
+ * subsampling so every band starts on a chroma row. */
+#  define CONVERT_BAND_PADDING 16
+
+/* The frame ring isn't part of the memory cache, so it only uses a small part of the cache
+ * limit, and never more than this. */
+#  define FRAME_RING_MEMORY_MAX ((size_t)128 * 1024 * 1024)
+#  define FRAME_RING_CACHE_LIMIT_DIVISOR 16
+
 BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
 {
   return (anim->x & 31) != 0;
 }
 
+/* Create a context converting `height` rows of the video stream to RGBA. */
+static struct SwsContext *ffmpeg_sws_context_create(struct anim *anim,
+                                                    const int height,
+                                                    const int sws_flags)
+{
+#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+  /* The following for color space determination */
+  int srcRange, dstRange, brightness, contrast, saturation;
+  int *table;
+  const int *inv_table;
+#  endif
+
+  struct SwsContext *sws_ctx = sws_getContext(anim->x,
+                                              height,
+                                              anim->pCodecCtx->pix_fmt,
+                                              anim->x,
+                                              height,
+                                              AV_PIX_FMT_RGBA,
+                                              sws_flags,
+                                              NULL,
+                                              NULL,
+                                              NULL);
+  if (!sws_ctx) {
+    return NULL;
+  }
+
+#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
+  /* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
+  if (!sws_getColorspaceDetails(sws_ctx,
+                                (int **)&inv_table,
+                                &srcRange,
+                                &table,
+                                &dstRange,
+                                &brightness,
+                                &contrast,
+                                &saturation)) {
+    srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
+    inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+
+    if (sws_setColorspaceDetails(sws_ctx,
+                                 (int *)inv_table,
+                                 srcRange,
+                                 table,
+                                 dstRange,
+                                 brightness,
+                                 contrast,
+                                 saturation)) {
+      fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+    }
+  }
+  else {
+    fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+  }
+#  endif
+
+  return sws_ctx;
+}
+
+static void ffmpeg_convert_bands_free(struct anim *anim)
+{
+  for (int i = 0; i < anim->img_convert_bands_len; i++) {
+    sws_freeContext(anim->img_convert_bands[i]);
+    anim->img_convert_bands[i] = NULL;
+  }
+  anim->img_convert_bands_len = 0;
+  MEM_SAFE_FREE(anim->img_convert_bands_buffer);
+}
+
+/* Source rows converted for a band: its own rows and the padding from its neighbors. */
+static void ffmpeg_convert_band_rows(const struct anim *anim,
+                                     const int band,
+                                     int *r_src_y,
+                                     int *r_src_height,
+                                     int *r_padding_top)
+{
+  const int y = band * anim->img_convert_band_height;
+  const int y_end = min_ii(y + anim->img_convert_band_height, anim->y);
+  const int src_y = max_ii(y - CONVERT_BAND_PADDING, 0);
+  const int src_y_end = min_ii(y_end + CONVERT_BAND_PADDING, anim->y);
+
+  *r_src_y = src_y;
+  *r_src_height = src_y_end - src_y;
+  *r_padding_top = y - src_y;
+}
+
+BLI_INLINE size_t ffmpeg_convert_band_stride(const struct anim *anim)
+{
+  return ((size_t)anim->x * 4 + 31) & ~(size_t)31;
+}
+
+/* Split the color conversion of large frames into bands, one context per band. */
+static void ffmpeg_convert_bands_create(struct anim *anim)
+{
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt);
+  /* Bands offset the plane pointers, which doesn't work for palettes and the like. */
+  const uint64_t unsupported_flags = AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM |
+                                     AV_PIX_FMT_FLAG_HWACCEL;
+  if (desc == NULL || desc->nb_components < 3 || (desc->flags & unsupported_flags)) {
+    return;
+  }
+
+  /* Not worth the overhead for small frames. */
+  const int bands_len = min_iii(BLI_system_thread_count(), ANIM_CONVERT_BANDS_MAX, anim->y / 128);
+  if (bands_len < 2) {
+    return;
+  }
+
+  /* Start every band on a chroma row. */
+  const int band_height = ((anim->y + bands_len - 1) / bands_len + CONVERT_BAND_PADDING - 1) &
+                          ~(CONVERT_BAND_PADDING - 1);
+  anim->img_convert_band_height = band_height;
+
+  for (int band = 0; band * band_height < anim->y; band++) {
+    int src_y, src_height, padding_top;
+    ffmpeg_convert_band_rows(anim, band, &src_y, &src_height, &padding_top);
+    struct SwsContext *sws_ctx = ffmpeg_sws_context_create(
+        anim, src_height, SWS_FAST_BILINEAR | SWS_FULL_CHR_H_INT);
+    if (sws_ctx == NULL) {
+      ffmpeg_convert_bands_free(anim);
+      return;
+    }
+    anim->img_convert_bands[anim->img_convert_bands_len++] = sws_ctx;
+  }
+
+  /* Aligned for the same reason as the frames, see #ffmpeg_frame_ibuf_alloc. */
+  anim->img_convert_bands_buffer = MEM_mallocN_aligned(
+      ffmpeg_convert_band_stride(anim) * (band_height + 2 * CONVERT_BAND_PADDING) *
+          anim->img_convert_bands_len,
+      32,
+      "ffmpeg band buffer");
+}
+
 static int startffmpeg(struct anim *anim)
 {
   int i, video_stream_index;
@@ -518,13 +664,6 @@ static int startffmpeg(struct anim *anim)
   double frs_den;
   int streamcount;
 
-#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-  /* The following for color space determination */
-  int srcRange, dstRange, brightness, contrast, saturation;
-  int *table;
-  const int *inv_table;
-#  endif
-
   if (anim == NULL) {
     return (-1);
   }
@@ -573,6 +712,20 @@ static int startffmpeg(struct anim *anim)
 
   pCodecCtx->workaround_bugs = 1;
 
+  /* Let the decoder use multiple threads, preferring whole frames over slices. */
+  if (pCodec->capabilities & AV_CODEC_CAP_AUTO_THREADS) {
+    pCodecCtx->thread_count = 0;
+  }
+  else {
+    pCodecCtx->thread_count = BLI_system_thread_count();
+  }
+  if (pCodec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_FRAME;
+  }
+  else if (pCodec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_SLICE;
+  }
+
   if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
     avformat_close_input(&pFormatCtx);
     return -1;
@@ -636,6 +789,7 @@ static int startffmpeg(struct anim *anim)
   anim->framesize = anim->x * anim->y * 4;
 
   anim->curposition = -1;
+  anim->decoder_position = -1;
   anim->last_frame = 0;
   anim->last_pts = -1;
   anim->next_pts = -1;
@@ -692,16 +846,8 @@ static int startffmpeg(struct anim *anim)
     anim->preseek = 0;
   }
 
-  anim->img_convert_ctx = sws_getContext(anim->x,
-                                         anim->y,
-                                         anim->pCodecCtx->pix_fmt,
-                                         anim->x,
-                                         anim->y,
-                                         AV_PIX_FMT_RGBA,
-                                         SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT,
-                                         NULL,
-                                         NULL,
-                                         NULL);
+  anim->img_convert_ctx = ffmpeg_sws_context_create(
+      anim, anim->y, SWS_FAST_BILINEAR | SWS_PRINT_INFO | SWS_FULL_CHR_H_INT);
 
   if (!anim->img_convert_ctx) {
     fprintf(stderr, "Can't transform color space??? Bailing out...\n");
@@ -714,52 +860,119 @@ static int startffmpeg(struct anim *anim)
     return -1;
   }
 
-#  ifdef FFMPEG_SWSCALE_COLOR_SPACE_SUPPORT
-  /* Try do detect if input has 0-255 YCbCR range (JFIF Jpeg MotionJpeg) */
-  if (!sws_getColorspaceDetails(anim->img_convert_ctx,
-                                (int **)&inv_table,
-                                &srcRange,
-                                &table,
-                                &dstRange,
-                                &brightness,
-                                &contrast,
-                                &saturation)) {
-    srcRange = srcRange || anim->pCodecCtx->color_range == AVCOL_RANGE_JPEG;
-    inv_table = sws_getCoefficients(anim->pCodecCtx->colorspace);
+  ffmpeg_convert_bands_create(anim);
 
-    if (sws_setColorspaceDetails(anim->img_convert_ctx,
-                                 (int *)inv_table,
-                                 srcRange,
-                                 table,
-                                 dstRange,
-                                 brightness,
-                                 contrast,
-                                 saturation)) {
-      fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
-    }
+  size_t frame_ring_memory = FRAME_RING_MEMORY_MAX;
+  if (MEM_CacheLimiter_get_maximum() != 0) {
+    frame_ring_memory = min_zz(frame_ring_memory,
+                               MEM_CacheLimiter_get_maximum() / FRAME_RING_CACHE_LIMIT_DIVISOR);
   }
-  else {
-    fprintf(stderr, "Warning: Could not set libswscale colorspace details.\n");
+  anim->frame_ring_len = (int)min_zz(frame_ring_memory / anim->framesize, ANIM_FRAME_RING_MAX);
+  /* A single frame is already kept as the last frame. */
+  if (anim->frame_ring_len < 2) {
+    anim->frame_ring_len = 0;
   }
-#  endif
+  anim->frame_ring_next = 0;
 
   return 0;
 }
 
+typedef struct ConvertBandsData {
+  struct anim *anim;
+  const AVFrame *input;
+  uint8_t *const *dst;
+  const int *dst_stride;
+} ConvertBandsData;
+
+static void ffmpeg_convert_band_cb(void *__restrict userdata,
+                                   const int band,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ConvertBandsData *data = userdata;
+  struct anim *anim = data->anim;
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(anim->pCodecCtx->pix_fmt);
+  const int y = band * anim->img_convert_band_height;
+  const int height = min_ii(anim->img_convert_band_height, anim->y - y);
+  int src_y, src_height, padding_top;
+  ffmpeg_convert_band_rows(anim, band, &src_y, &src_height, &padding_top);
+
+  const uint8_t *src[4];
+  for (int i = 0; i < 4; i++) {
+    /* Planes 1 and 2 hold the (possibly subsampled) chroma. */
+    const int shift = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
+    const uint8_t *plane = data->input->data[i];
+    src[i] = plane ? plane + (src_y >> shift) * data->input->linesize[i] : NULL;
+  }
+
+  /* The padding rows overlap other bands, so convert into the buffer of this band and only copy
+   * the rows of the band itself. */
+  const size_t band_stride = ffmpeg_convert_band_stride(anim);
+  uint8_t *band_buffer = anim->img_convert_bands_buffer +
+                         band_stride * (anim->img_convert_band_height + 2 * CONVERT_BAND_PADDING) *
+                             band;
+  uint8_t *band_dst[4] = {band_buffer, NULL, NULL, NULL};
+  const int band_dst_stride[4] = {(int)band_stride, 0, 0, 0};
+
+  sws_scale(anim->img_convert_bands[band],
+            src,
+            data->input->linesize,
+            0,
+            src_height,
+            band_dst,
+            band_dst_stride);
+
+  /* RGBA is a single plane. */
+  for (int row = 0; row < height; row++) {
+    memcpy(data->dst[0] + (ptrdiff_t)(y + row) * data->dst_stride[0],
+           band_buffer + band_stride * (padding_top + row),
+           (size_t)anim->x * 4);
+  }
+}
+
+/* Convert the whole input frame to RGBA, in parallel bands when possible. */
+static void ffmpeg_convert_frame(struct anim *anim,
+                                 const AVFrame *input,
+                                 uint8_t *const *dst,
+                                 const int *dst_stride)
+{
+  if (anim->img_convert_bands_len == 0) {
+    sws_scale(anim->img_convert_ctx,
+              (const uint8_t *const *)input->data,
+              input->linesize,
+              0,
+              anim->y,
+              dst,
+              dst_stride);
+    return;
+  }
+
+  ConvertBandsData data = {
+      .anim = anim,
+      .input = input,
+      .dst = dst,
+      .dst_stride = dst_stride,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, anim->img_convert_bands_len, &data, ffmpeg_convert_band_cb, &settings);
+}
+
 /* postprocess the image in anim->pFrame and do color conversion
  * and deinterlacing stuff.
  *
- * Output is anim->last_frame
+ * Output is ibuf, returns false when there is no decoded frame to convert.
  */
 
-static void ffmpeg_postprocess(struct anim *anim)
+static bool ffmpeg_postprocess(struct anim *anim, ImBuf *ibuf)
 {
   AVFrame *input = anim->pFrame;
-  ImBuf *ibuf = anim->last_frame;
   int filter_y = 0;
 
   if (!anim->pFrameComplete) {
-    return;
+    return false;
   }
 
   /* This means the data wasn't read properly,
@@ -768,7 +981,7 @@ static void ffmpeg_postprocess(struct anim *anim)
     fprintf(stderr,
             "ffmpeg_fetchibuf: "
             "data not read properly...\n");
-    return;
+    return false;
   }
 
   av_log(anim->pFormatCtx,
@@ -809,13 +1022,7 @@ static void ffmpeg_postprocess(struct anim *anim)
     unsigned char *bottom;
     unsigned char *top;
 
-    sws_scale(anim->img_convert_ctx,
-              (const uint8_t *const *)input->data,
-              input->linesize,
-              0,
-              anim->y,
-              dst2,
-              dstStride2);
+    ffmpeg_convert_frame(anim, input, dst2, dstStride2);
 
     bottom = (unsigned char *)ibuf->rect;
     top = bottom + ibuf->x * (ibuf->y - 1) * 4;
@@ -852,13 +1059,7 @@ static void ffmpeg_postprocess(struct anim *anim)
     const int dstStride2[4] = {-dstStride[0], 0, 0, 0};
     uint8_t *dst2[4] = {dst[0] + (anim->y - 1) * dstStride[0], 0, 0, 0};
 
-    sws_scale(anim->img_convert_ctx,
-              (const uint8_t *const *)input->data,
-              input->linesize,
-              0,
-              anim->y,
-              dst2,
-              dstStride2);
+    ffmpeg_convert_frame(anim, input, dst2, dstStride2);
   }
 
   if (need_aligned_ffmpeg_buffer(anim)) {
@@ -874,8 +1075,95 @@ static void ffmpeg_postprocess(struct anim *anim)
   if (filter_y) {
     IMB_filtery(ibuf);
   }
+
+  return true;
+}
+
+static ImBuf *ffmpeg_frame_ibuf_alloc(struct anim *anim)
+{
+  /* Certain versions of FFmpeg have a bug in libswscale which ends up in crash
+   * when destination buffer is not properly aligned. For example, this happens
+   * in FFmpeg 4.3.1. It got fixed later on, but for compatibility reasons is
+   * still best to avoid crash.
+   *
+   * This is achieved by using own allocation call rather than relying on
+   * IMB_allocImBuf() to do so since the IMB_allocImBuf() is not guaranteed
+   * to perform aligned allocation.
+   *
+   * In theory this could give better performance, since SIMD operations on
+   * aligned data are usually faster.
+   *
+   * Note that even though sometimes vertical flip is required it does not
+   * affect on alignment of data passed to sws_scale because if the X dimension
+   * is not 32 byte aligned special intermediate buffer is allocated.
+   *
+   * The issue was reported to FFmpeg under ticket #8747 in the FFmpeg tracker
+   * and is fixed in the newer versions than 4.3.1. */
+  ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, 32, 0);
+  ibuf->rect = MEM_mallocN_aligned((size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
+  ibuf->mall |= IB_rect;
+
+  ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+
+  return ibuf;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Decoded Frame Ring
+ *
+ * Keeps the last few decoded frames, so that stepping back while scrubbing or playing in
+ * reverse doesn't have to seek and decode from the previous key frame for every frame.
+ * \{ */
+
+static ImBuf *ffmpeg_frame_ring_find(struct anim *anim, const int64_t pts)
+{
+  for (int i = 0; i < anim->frame_ring_len; i++) {
+    if (anim->frame_ring[i] != NULL && anim->frame_ring_pts[i] == pts) {
+      return anim->frame_ring[i];
+    }
+  }
+  return NULL;
+}
+
+static void ffmpeg_frame_ring_add(struct anim *anim, ImBuf *ibuf, const int64_t pts)
+{
+  if (anim->frame_ring_len == 0 || ffmpeg_frame_ring_find(anim, pts) != NULL) {
+    return;
+  }
+
+  const int index = anim->frame_ring_next;
+  IMB_freeImBuf(anim->frame_ring[index]);
+  IMB_refImBuf(ibuf);
+  anim->frame_ring[index] = ibuf;
+  anim->frame_ring_pts[index] = pts;
+  anim->frame_ring_next = (index + 1) % anim->frame_ring_len;
+}
+
+/* Convert the frame that was just decoded and add it to the ring. */
+static void ffmpeg_frame_ring_add_decoded(struct anim *anim)
+{
+  if (ffmpeg_frame_ring_find(anim, anim->next_pts) != NULL) {
+    return;
+  }
+
+  ImBuf *ibuf = ffmpeg_frame_ibuf_alloc(anim);
+  if (ffmpeg_postprocess(anim, ibuf)) {
+    ffmpeg_frame_ring_add(anim, ibuf, anim->next_pts);
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+static void ffmpeg_frame_ring_clear(struct anim *anim)
+{
+  for (int i = 0; i < ANIM_FRAME_RING_MAX; i++) {
+    IMB_freeImBuf(anim->frame_ring[i]);
+    anim->frame_ring[i] = NULL;
+  }
+  anim->frame_ring_next = 0;
 }
 
+/** \} */
+
 /* decode one video frame also considering the packet read into next_packet */
 
 static int ffmpeg_decode_video_frame(struct anim *anim)
@@ -968,7 +1256,11 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
   return (rval >= 0);
 }
 
-static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_search)
+/* Decode until reaching pts_to_search. The frames passed on the way that are at or after
+ * ring_pts_start are added to the frame ring. */
+static void ffmpeg_decode_video_frame_scan(struct anim *anim,
+                                           int64_t pts_to_search,
+                                           int64_t ring_pts_start)
 {
   /* there seem to exist *very* silly GOP lengths out in the wild... */
   int count = 1000;
@@ -985,6 +1277,9 @@ static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_sea
            "  WHILE: pts=%lld in search of %lld\n",
            (long long int)anim->next_pts,
            (long long int)pts_to_search);
+    if (anim->pFrameComplete && anim->next_pts >= ring_pts_start) {
+      ffmpeg_frame_ring_add_decoded(anim);
+    }
     if (!ffmpeg_decode_video_frame(anim)) {
       break;
     }
@@ -1078,7 +1373,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   if (tc_index) {
     new_frame_index = IMB_indexer_get_frame_index(tc_index, position);
-    old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->curposition);
+    old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->decoder_position);
     pts_to_search = IMB_indexer_get_pts(tc_index, new_frame_index);
   }
   else {
@@ -1106,14 +1401,23 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
            (long long int)anim->next_pts);
     IMB_refImBuf(anim->last_frame);
     anim->curposition = position;
+    anim->decoder_position = position;
     return anim->last_frame;
   }
 
-  if (position > anim->curposition + 1 && anim->preseek && !tc_index &&
-      position - (anim->curposition + 1) < anim->preseek) {
+  /* The decoder state is left alone, the next frames are decoded from decoder_position. */
+  ImBuf *ring_frame = ffmpeg_frame_ring_find(anim, pts_to_search);
+  if (ring_frame != NULL) {
+    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: found in frame ring\n");
+    IMB_refImBuf(ring_frame);
+    return ring_frame;
+  }
+
+  if (position > anim->decoder_position + 1 && anim->preseek && !tc_index &&
+      position - (anim->decoder_position + 1) < anim->preseek) {
     av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within preseek interval (no index)\n");
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search, INT64_MAX);
   }
   else if (tc_index && IMB_indexer_can_scan(tc_index, old_frame_index, new_frame_index)) {
     av_log(anim->pFormatCtx,
@@ -1121,9 +1425,9 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
            "FETCH: within preseek interval "
            "(index tells us)\n");
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search, INT64_MAX);
   }
-  else if (position != anim->curposition + 1) {
+  else if (position != anim->decoder_position + 1) {
     long long pos;
     int ret;
 
@@ -1193,10 +1497,19 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     /* memset(anim->pFrame, ...) ?? */
 
     if (ret >= 0) {
-      ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+      /* When going backwards, keep the frames before the requested one, those are likely to be
+       * requested next. */
+      int64_t ring_pts_start = INT64_MAX;
+      if (position < anim->decoder_position && anim->frame_ring_len > 1) {
+        const double pts_per_frame = 1.0 / (pts_time_base * frame_rate);
+        ring_pts_start = pts_to_search - (int64_t)((anim->frame_ring_len - 1) * pts_per_frame);
+        /* Right after seeking, next_pts is -1 while pFrame still holds an old frame. */
+        ring_pts_start = MAX2(ring_pts_start, 0);
+      }
+      ffmpeg_decode_video_frame_scan(anim, pts_to_search, ring_pts_start);
     }
   }
-  else if (position == 0 && anim->curposition == -1) {
+  else if (position == 0 && anim->decoder_position == -1) {
     /* first frame without seeking special case... */
     ffmpeg_decode_video_frame(anim);
   }
@@ -1205,38 +1518,18 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   }
 
   IMB_freeImBuf(anim->last_frame);
+  anim->last_frame = ffmpeg_frame_ibuf_alloc(anim);
 
-  /* Certain versions of FFmpeg have a bug in libswscale which ends up in crash
-   * when destination buffer is not properly aligned. For example, this happens
-   * in FFmpeg 4.3.1. It got fixed later on, but for compatibility reasons is
-   * still best to avoid crash.
-   *
-   * This is achieved by using own allocation call rather than relying on
-   * IMB_allocImBuf() to do so since the IMB_allocImBuf() is not guaranteed
-   * to perform aligned allocation.
-   *
-   * In theory this could give better performance, since SIMD operations on
-   * aligned data are usually faster.
-   *
-   * Note that even though sometimes vertical flip is required it does not
-   * affect on alignment of data passed to sws_scale because if the X dimension
-   * is not 32 byte aligned special intermediate buffer is allocated.
-   *
-   * The issue was reported to FFmpeg under ticket #8747 in the FFmpeg tracker
-   * and is fixed in the newer versions than 4.3.1. */
-  anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, 0);
-  anim->last_frame->rect = MEM_mallocN_aligned((size_t)4 * anim->x * anim->y, 32, "ffmpeg ibuf");
-  anim->last_frame->mall |= IB_rect;
-
-  anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
-
-  ffmpeg_postprocess(anim);
+  if (ffmpeg_postprocess(anim, anim->last_frame)) {
+    ffmpeg_frame_ring_add(anim, anim->last_frame, anim->next_pts);
+  }
 
   anim->last_pts = anim->next_pts;
 
   ffmpeg_decode_video_frame(anim);
 
   anim->curposition = position;
+  anim->decoder_position = position;
 
   IMB_refImBuf(anim->last_frame);
 
@@ -1272,7 +1565,9 @@ static void free_anim_ffmpeg(struct anim *anim)
     av_frame_free(&anim->pFrameDeinterlaced);
 
     sws_freeContext(anim->img_convert_ctx);
+    ffmpeg_convert_bands_free(anim);
     IMB_freeImBuf(anim->last_frame);
+    ffmpeg_frame_ring_clear(anim);
     if (anim->next_packet.stream_index != -1) {
       av_free_packet(&anim->next_packet);
     }
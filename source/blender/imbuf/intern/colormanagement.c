@@ -43,15 +43,18 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_hash.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_appdir.h"
 #include "BKE_colortools.h"
 #include "BKE_context.h"
+#include "BKE_global.h"
 #include "BKE_image.h"
 #include "BKE_main.h"
 
@@ -61,6 +64,10 @@
 
 #include <ocio_capi.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name Global declarations
  * \{ */
@@ -104,6 +111,8 @@ typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
   CurveMapping *curve_mapping;
   bool is_data_result;
+  /* Baked from the processor and curve mapping, used instead of them for buffers when set. */
+  struct ColormanageDisplayLUT *display_lut;
 } ColormanageProcessor;
 
 static struct global_glsl_state {
@@ -138,6 +147,35 @@ static struct global_color_picking_state {
   bool failed;
 } global_color_picking_state = {NULL};
 
+/* Number of display settings with a LUT kept, so views with different settings don't bake over
+ * each other's LUT. */
+#define DISPLAY_LUT_CACHE_SIZE 4
+
+typedef struct DisplayLUTCacheEntry {
+  /* LUT baked for the settings, NULL if it wasn't accurate enough. */
+  struct ColormanageDisplayLUT *lut;
+
+  /* Settings of the LUT for comparison, with a copy of the curve mapping. */
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  float exposure, gamma;
+  CurveMapping *curve_mapping;
+
+  /* Clock of the state when the entry was last used, zero for an unused entry. */
+  unsigned int last_used;
+} DisplayLUTCacheEntry;
+
+static struct global_display_lut_state {
+  DisplayLUTCacheEntry entries[DISPLAY_LUT_CACHE_SIZE];
+  unsigned int clock;
+} global_display_lut_state = {{{NULL}}};
+
+/* Lock for the display LUT state, and the users of the LUTs. */
+static pthread_mutex_t display_lut_lock = BLI_MUTEX_INITIALIZER;
+
+static void display_lut_cache_entry_clear(DisplayLUTCacheEntry *entry);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -755,8 +793,13 @@ void colormanagement_exit(void)
     OCIO_processorRelease(global_color_picking_state.processor_from);
   }
 
+  for (int i = 0; i < DISPLAY_LUT_CACHE_SIZE; i++) {
+    display_lut_cache_entry_clear(&global_display_lut_state.entries[i]);
+  }
+
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
+  memset(&global_display_lut_state, 0, sizeof(global_display_lut_state));
 
   colormanage_free_config();
 }
@@ -1481,6 +1524,441 @@ const float *IMB_colormangement_get_xyz_to_rgb()
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Baked Display LUT
+ *
+ * Running the display transform (curve mapping, look, view, display, exposure and gamma) for
+ * every pixel of large float buffers is slow. Instead it's baked into a 3D LUT, which is indexed
+ * through a log shaper since scene linear values span many stops.
+ *
+ * A LUT is only used for byte display buffers from #IMB_display_buffer_acquire, unless the view
+ * settings opt out, and when it matches the exact transform to within a fraction of a byte step.
+ * Otherwise the exact transform is used.
+ * \{ */
+
+#define DISPLAY_LUT_SIZE 65
+/* Range of the shaper in stops, values outside of it are clamped. Scene linear black is at the
+ * lower end. */
+#define DISPLAY_LUT_SHAPER_MIN -10.0f
+#define DISPLAY_LUT_SHAPER_MAX 12.0f
+/* Largest allowed difference from the exact transform, in display space. */
+#define DISPLAY_LUT_MAX_ERROR (0.5f / 255.0f)
+#define DISPLAY_LUT_VALIDATE_SAMPLES 4096
+
+typedef struct ColormanageDisplayLUT {
+  /* Display colors of the lattice, indexed by blue, green and red. RGBA so each lattice point
+   * loads as one vector, the alpha is unused. */
+  float (*table)[4];
+  bool has_curve_mapping;
+  int users;
+} ColormanageDisplayLUT;
+
+/* Scene linear value to position in the LUT. */
+BLI_INLINE float display_lut_shaper(const float value)
+{
+  const float stops = log2f(max_ff(value, 0.0f) + exp2f(DISPLAY_LUT_SHAPER_MIN));
+  const float fac = (stops - DISPLAY_LUT_SHAPER_MIN) /
+                    (DISPLAY_LUT_SHAPER_MAX - DISPLAY_LUT_SHAPER_MIN);
+  return clamp_f(fac, 0.0f, 1.0f) * (DISPLAY_LUT_SIZE - 1);
+}
+
+/* Position in the LUT, in 0..1 range, to scene linear value. */
+static float display_lut_shaper_inverse(const float fac)
+{
+  const float stops = DISPLAY_LUT_SHAPER_MIN +
+                      fac * (DISPLAY_LUT_SHAPER_MAX - DISPLAY_LUT_SHAPER_MIN);
+  return exp2f(stops) - exp2f(DISPLAY_LUT_SHAPER_MIN);
+}
+
+/* Tetrahedral interpolation of the RGB of a pixel, leaves alpha unchanged. */
+BLI_INLINE void display_lut_apply_rgb(const ColormanageDisplayLUT *lut, float pixel[3])
+{
+  const float fr = display_lut_shaper(pixel[0]);
+  const float fg = display_lut_shaper(pixel[1]);
+  const float fb = display_lut_shaper(pixel[2]);
+  const int r = min_ii((int)fr, DISPLAY_LUT_SIZE - 2);
+  const int g = min_ii((int)fg, DISPLAY_LUT_SIZE - 2);
+  const int b = min_ii((int)fb, DISPLAY_LUT_SIZE - 2);
+  const float dr = fr - (float)r, dg = fg - (float)g, db = fb - (float)b;
+
+  const int step_r = 1;
+  const int step_g = DISPLAY_LUT_SIZE;
+  const int step_b = DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE;
+  const float(*corner)[4] = lut->table + ((size_t)b * step_b + (size_t)g * step_g + r);
+
+  /* The cube is split in six tetrahedra along its diagonal, pick the one containing the pixel
+   * along with the two corners on the way from the first to the last corner of the cube. */
+  int offset1, offset2;
+  float w0, w1, w2, w3;
+  if (dr > dg) {
+    if (dg > db) {
+      offset1 = step_r, offset2 = step_r + step_g;
+      w0 = 1.0f - dr, w1 = dr - dg, w2 = dg - db, w3 = db;
+    }
+    else if (dr > db) {
+      offset1 = step_r, offset2 = step_r + step_b;
+      w0 = 1.0f - dr, w1 = dr - db, w2 = db - dg, w3 = dg;
+    }
+    else {
+      offset1 = step_b, offset2 = step_r + step_b;
+      w0 = 1.0f - db, w1 = db - dr, w2 = dr - dg, w3 = dg;
+    }
+  }
+  else {
+    if (db > dg) {
+      offset1 = step_b, offset2 = step_g + step_b;
+      w0 = 1.0f - db, w1 = db - dg, w2 = dg - dr, w3 = dr;
+    }
+    else if (db > dr) {
+      offset1 = step_g, offset2 = step_g + step_b;
+      w0 = 1.0f - dg, w1 = dg - db, w2 = db - dr, w3 = dr;
+    }
+    else {
+      offset1 = step_g, offset2 = step_r + step_g;
+      w0 = 1.0f - dg, w1 = dg - dr, w2 = dr - db, w3 = db;
+    }
+  }
+  const int offset3 = step_r + step_g + step_b;
+
+#ifdef __SSE2__
+  __m128 result = _mm_mul_ps(_mm_loadu_ps(corner[0]), _mm_set1_ps(w0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(corner[offset1]), _mm_set1_ps(w1)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(corner[offset2]), _mm_set1_ps(w2)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(corner[offset3]), _mm_set1_ps(w3)));
+  float color[4];
+  _mm_storeu_ps(color, result);
+  copy_v3_v3(pixel, color);
+#else
+  float color[3];
+  mul_v3_v3fl(color, corner[0], w0);
+  madd_v3_v3fl(color, corner[offset1], w1);
+  madd_v3_v3fl(color, corner[offset2], w2);
+  madd_v3_v3fl(color, corner[offset3], w3);
+  copy_v3_v3(pixel, color);
+#endif
+}
+
+static void display_lut_apply(ColormanageProcessor *cm_processor,
+                              float *buffer,
+                              const int width,
+                              const int height,
+                              const int channels,
+                              const bool predivide)
+{
+  const ColormanageDisplayLUT *lut = cm_processor->display_lut;
+  const size_t i_last = ((size_t)width) * height;
+  float *pixel = buffer;
+
+  for (size_t i = 0; i < i_last; i++, pixel += channels) {
+    if (channels == 3 || !predivide || pixel[3] == 1.0f || pixel[3] == 0.0f) {
+      display_lut_apply_rgb(lut, pixel);
+    }
+    else if (lut->has_curve_mapping) {
+      /* Curves are applied to premultiplied colors, which the LUT doesn't reproduce. */
+      IMB_colormanagement_processor_apply_v4_predivide(cm_processor, pixel);
+    }
+    else {
+      const float alpha = pixel[3];
+      mul_v3_fl(pixel, 1.0f / alpha);
+      display_lut_apply_rgb(lut, pixel);
+      mul_v3_fl(pixel, alpha);
+    }
+  }
+}
+
+typedef struct DisplayLUTBakeData {
+  ColormanageProcessor *cm_processor;
+  ColormanageDisplayLUT *lut;
+} DisplayLUTBakeData;
+
+static void display_lut_bake_slice(void *__restrict userdata,
+                                   const int b,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DisplayLUTBakeData *data = userdata;
+  float(*slice)[4] = data->lut->table + (size_t)b * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE;
+  const float blue = display_lut_shaper_inverse((float)b / (DISPLAY_LUT_SIZE - 1));
+
+  for (int g = 0; g < DISPLAY_LUT_SIZE; g++) {
+    const float green = display_lut_shaper_inverse((float)g / (DISPLAY_LUT_SIZE - 1));
+    for (int r = 0; r < DISPLAY_LUT_SIZE; r++) {
+      float *color = slice[g * DISPLAY_LUT_SIZE + r];
+      color[0] = display_lut_shaper_inverse((float)r / (DISPLAY_LUT_SIZE - 1));
+      color[1] = green;
+      color[2] = blue;
+      color[3] = 1.0f;
+    }
+  }
+
+  IMB_colormanagement_processor_apply(
+      data->cm_processor, &slice[0][0], DISPLAY_LUT_SIZE, DISPLAY_LUT_SIZE, 4, false);
+}
+
+/* Scene linear value for validating the LUT. Most are spread over the range of the shaper, some
+ * are negative or above its range, where the LUT clamps. */
+static float display_lut_validate_value(const int index)
+{
+  const float fac = BLI_hash_int_01(index);
+  switch (index % 8) {
+    case 0:
+      return -display_lut_shaper_inverse(fac);
+    case 1:
+      return exp2f(DISPLAY_LUT_SHAPER_MAX + fac * 4.0f);
+    default:
+      return display_lut_shaper_inverse(fac);
+  }
+}
+
+/* Largest difference of the LUT from the exact transform in display space, for colors spread
+ * over the range of the shaper and beyond it. */
+static float display_lut_error(ColormanageProcessor *cm_processor,
+                               const ColormanageDisplayLUT *lut,
+                               float *r_mean_error)
+{
+  float(*exact)[4] = MEM_malloc_arrayN(DISPLAY_LUT_VALIDATE_SAMPLES, sizeof(float[4]), __func__);
+  float(*baked)[4] = MEM_malloc_arrayN(DISPLAY_LUT_VALIDATE_SAMPLES, sizeof(float[4]), __func__);
+
+  for (int i = 0; i < DISPLAY_LUT_VALIDATE_SAMPLES; i++) {
+    for (int c = 0; c < 3; c++) {
+      exact[i][c] = display_lut_validate_value(i * 3 + c);
+    }
+    exact[i][3] = 1.0f;
+    copy_v4_v4(baked[i], exact[i]);
+    display_lut_apply_rgb(lut, baked[i]);
+  }
+  IMB_colormanagement_processor_apply(
+      cm_processor, &exact[0][0], DISPLAY_LUT_VALIDATE_SAMPLES, 1, 4, false);
+
+  float max_error = 0.0f, total_error = 0.0f;
+  for (int i = 0; i < DISPLAY_LUT_VALIDATE_SAMPLES; i++) {
+    for (int c = 0; c < 3; c++) {
+      /* Only the range stored in byte display buffers matters. */
+      const float error = fabsf(clamp_f(exact[i][c], 0.0f, 1.0f) -
+                                clamp_f(baked[i][c], 0.0f, 1.0f));
+      max_error = max_ff(max_error, error);
+      total_error += error;
+    }
+  }
+
+  MEM_freeN(exact);
+  MEM_freeN(baked);
+
+  *r_mean_error = total_error / (DISPLAY_LUT_VALIDATE_SAMPLES * 3);
+  return max_error;
+}
+
+static ColormanageDisplayLUT *display_lut_bake(ColormanageProcessor *cm_processor)
+{
+  ColormanageDisplayLUT *lut = MEM_callocN(sizeof(ColormanageDisplayLUT), __func__);
+  lut->table = MEM_malloc_arrayN((size_t)DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE,
+                                 sizeof(float[4]),
+                                 __func__);
+  lut->has_curve_mapping = (cm_processor->curve_mapping != NULL);
+  lut->users = 1;
+
+  /* The processor must still apply the exact transform. */
+  BLI_assert(cm_processor->display_lut == NULL);
+
+  DisplayLUTBakeData data = {cm_processor, lut};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, DISPLAY_LUT_SIZE, &data, display_lut_bake_slice, &settings);
+
+  return lut;
+}
+
+static void display_lut_free(ColormanageDisplayLUT *lut)
+{
+  MEM_freeN(lut->table);
+  MEM_freeN(lut);
+}
+
+static void display_lut_release(ColormanageDisplayLUT *lut)
+{
+  bool do_free;
+
+  BLI_mutex_lock(&display_lut_lock);
+  lut->users--;
+  do_free = (lut->users == 0);
+  BLI_mutex_unlock(&display_lut_lock);
+
+  if (do_free) {
+    display_lut_free(lut);
+  }
+}
+
+/* Compare the curve mappings by what affects the curves they evaluate. */
+static bool display_lut_curve_mapping_equals(const CurveMapping *cumap_a,
+                                             const CurveMapping *cumap_b)
+{
+  if (cumap_a == NULL || cumap_b == NULL) {
+    return cumap_a == cumap_b;
+  }
+
+  const int flag_mask = CUMA_DO_CLIP | CUMA_EXTEND_EXTRAPOLATE;
+  if ((cumap_a->flag & flag_mask) != (cumap_b->flag & flag_mask) ||
+      !equals_v3v3(cumap_a->black, cumap_b->black) ||
+      !equals_v3v3(cumap_a->white, cumap_b->white) || cumap_a->tone != cumap_b->tone ||
+      memcmp(&cumap_a->clipr, &cumap_b->clipr, sizeof(cumap_a->clipr)) != 0) {
+    return false;
+  }
+
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma_a = &cumap_a->cm[i];
+    const CurveMap *cuma_b = &cumap_b->cm[i];
+    if (cuma_a->totpoint != cuma_b->totpoint) {
+      return false;
+    }
+    for (int a = 0; a < cuma_a->totpoint; a++) {
+      const CurveMapPoint *cmp_a = &cuma_a->curve[a];
+      const CurveMapPoint *cmp_b = &cuma_b->curve[a];
+      if (cmp_a->x != cmp_b->x || cmp_a->y != cmp_b->y ||
+          (cmp_a->flag & ~CUMA_SELECT) != (cmp_b->flag & ~CUMA_SELECT)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool display_lut_cache_entry_matches(const DisplayLUTCacheEntry *entry,
+                                            const ColorManagedViewSettings *view_settings,
+                                            const ColorManagedDisplaySettings *display_settings)
+{
+  const bool use_curve_mapping = (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) != 0;
+
+  return entry->last_used != 0 && entry->exposure == view_settings->exposure &&
+         entry->gamma == view_settings->gamma && STREQ(entry->look, view_settings->look) &&
+         STREQ(entry->view, view_settings->view_transform) &&
+         STREQ(entry->display, display_settings->display_device) &&
+         display_lut_curve_mapping_equals(
+             entry->curve_mapping, use_curve_mapping ? view_settings->curve_mapping : NULL);
+}
+
+/* Release the LUT of the entry, users still applying it keep it alive. */
+static void display_lut_cache_entry_clear(DisplayLUTCacheEntry *entry)
+{
+  if (entry->lut) {
+    if (--entry->lut->users == 0) {
+      display_lut_free(entry->lut);
+    }
+  }
+  if (entry->curve_mapping) {
+    BKE_curvemapping_free(entry->curve_mapping);
+  }
+  memset(entry, 0, sizeof(*entry));
+}
+
+static DisplayLUTCacheEntry *display_lut_cache_find(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  for (int i = 0; i < DISPLAY_LUT_CACHE_SIZE; i++) {
+    DisplayLUTCacheEntry *entry = &global_display_lut_state.entries[i];
+    if (display_lut_cache_entry_matches(entry, view_settings, display_settings)) {
+      entry->last_used = ++global_display_lut_state.clock;
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/* Add an entry for the settings in place of the least recently used one, which takes over the
+ * user of \a lut. */
+static DisplayLUTCacheEntry *display_lut_cache_add(
+    ColormanageDisplayLUT *lut,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  DisplayLUTCacheEntry *entry = &global_display_lut_state.entries[0];
+  for (int i = 1; i < DISPLAY_LUT_CACHE_SIZE; i++) {
+    if (global_display_lut_state.entries[i].last_used < entry->last_used) {
+      entry = &global_display_lut_state.entries[i];
+    }
+  }
+  display_lut_cache_entry_clear(entry);
+
+  entry->lut = lut;
+  STRNCPY(entry->look, view_settings->look);
+  STRNCPY(entry->view, view_settings->view_transform);
+  STRNCPY(entry->display, display_settings->display_device);
+  entry->exposure = view_settings->exposure;
+  entry->gamma = view_settings->gamma;
+  if (view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
+    entry->curve_mapping = BKE_curvemapping_copy(view_settings->curve_mapping);
+  }
+  entry->last_used = ++global_display_lut_state.clock;
+  return entry;
+}
+
+/**
+ * Get the LUT baked for the given settings, baking it with \a cm_processor when they changed.
+ * Returns NULL when the LUT isn't accurate enough. Release with #display_lut_release.
+ */
+static ColormanageDisplayLUT *display_lut_acquire(
+    ColormanageProcessor *cm_processor,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  DisplayLUTCacheEntry *entry;
+  ColormanageDisplayLUT *lut;
+
+  BLI_mutex_lock(&display_lut_lock);
+  entry = display_lut_cache_find(view_settings, display_settings);
+  if (entry) {
+    lut = entry->lut;
+    if (lut) {
+      lut->users++;
+    }
+    BLI_mutex_unlock(&display_lut_lock);
+    return lut;
+  }
+  BLI_mutex_unlock(&display_lut_lock);
+
+  /* Bake without holding the lock, so displaying with the current LUT doesn't wait. */
+  lut = display_lut_bake(cm_processor);
+
+  float mean_error;
+  const float max_error = display_lut_error(cm_processor, lut, &mean_error);
+  const bool is_accurate = (max_error <= DISPLAY_LUT_MAX_ERROR);
+
+  if (G.debug & G_DEBUG) {
+    printf("Color management: display LUT for view \"%s\" on \"%s\" %s, "
+           "max error %.6f, mean error %.6f\n",
+           view_settings->view_transform,
+           display_settings->display_device,
+           is_accurate ? "baked" : "too inaccurate, using exact transform",
+           max_error,
+           mean_error);
+  }
+
+  if (!is_accurate) {
+    display_lut_free(lut);
+    lut = NULL;
+  }
+
+  BLI_mutex_lock(&display_lut_lock);
+  /* Another thread might have baked for the same settings meanwhile, keep the first one. */
+  entry = display_lut_cache_find(view_settings, display_settings);
+  if (entry) {
+    if (lut) {
+      display_lut_free(lut);
+    }
+  }
+  else {
+    entry = display_lut_cache_add(lut, view_settings, display_settings);
+  }
+  lut = entry->lut;
+  if (lut) {
+    lut->users++;
+  }
+  BLI_mutex_unlock(&display_lut_lock);
+
+  return lut;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Threaded Display Buffer Transform Routines
  * \{ */
@@ -1807,12 +2285,17 @@ static bool is_ibuf_rect_in_display_space(ImBuf *ibuf,
   return false;
 }
 
+/**
+ * \param use_display_lut: Allow transforming with a baked LUT, for buffers which are only
+ * displayed. Those are approximations, so they aren't used for buffers that are saved.
+ */
 static void colormanage_display_buffer_process_ex(
     ImBuf *ibuf,
     float *display_buffer,
     unsigned char *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
-    const ColorManagedDisplaySettings *display_settings)
+    const ColorManagedDisplaySettings *display_settings,
+    const bool use_display_lut)
 {
   ColormanageProcessor *cm_processor = NULL;
   bool skip_transform = false;
@@ -1828,6 +2311,15 @@ static void colormanage_display_buffer_process_ex(
 
   if (skip_transform == false) {
     cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+
+    /* Baking the LUT costs about as much as transforming an image of its size. */
+    if (use_display_lut && display_buffer == NULL && view_settings != NULL &&
+        (view_settings->flag & COLORMANAGE_VIEW_NO_DISPLAY_LUT) == 0 &&
+        ((size_t)ibuf->x) * ibuf->y >=
+            (size_t)DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE) {
+      cm_processor->display_lut = display_lut_acquire(
+          cm_processor, view_settings, display_settings);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1848,7 +2340,7 @@ static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                const ColorManagedDisplaySettings *display_settings)
 {
   colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+      ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /** \} */
@@ -2517,8 +3009,12 @@ static void colormanagement_imbuf_make_display_space(
     imb_addrectImBuf(ibuf);
   }
 
-  colormanage_display_buffer_process_ex(
-      ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect, view_settings, display_settings);
+  colormanage_display_buffer_process_ex(ibuf,
+                                        ibuf->rect_float,
+                                        (unsigned char *)ibuf->rect,
+                                        view_settings,
+                                        display_settings,
+                                        false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(
@@ -3927,6 +4423,11 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
                                          int channels,
                                          bool predivide)
 {
+  if (cm_processor->display_lut && channels >= 3) {
+    display_lut_apply(cm_processor, buffer, width, height, channels, predivide);
+    return;
+  }
+
   /* apply curve mapping */
   if (cm_processor->curve_mapping) {
     int x, y;
@@ -3989,6 +4490,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->processor) {
     OCIO_processorRelease(cm_processor->processor);
   }
+  if (cm_processor->display_lut) {
+    display_lut_release(cm_processor->display_lut);
+  }
 
   MEM_freeN(cm_processor);
 }
@@ -30,6 +30,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_ghash.h"
+#include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -40,6 +41,8 @@
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "atomic_ops.h"
+
 #ifdef DEBUG_MESSAGES
 #  if defined __GNUC__
 #    define PRINT(format, args...) printf(format, ##args)
@@ -50,8 +53,29 @@
 #  define PRINT(format, ...)
 #endif
 
-static MEM_CacheLimiterC *limitor = NULL;
-static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
+/* Number of independently locked parts of the cache limiter. */
+#define MOVIECACHE_SHARDS 16
+/* Number of least recently used buffers of a shard compared by priority when evicting. */
+#define MOVIECACHE_EVICT_CANDIDATES 8
+
+typedef struct MovieCacheShard {
+  ThreadMutex mutex;
+  /* Managed items, least recently used first. */
+  ListBase items;
+  int totitem;
+} MovieCacheShard;
+
+/* Buffers of all caches share one memory budget. The items are spread over shards with their own
+ * lock, so threads putting and getting buffers rarely wait on each other. */
+static struct MovieCacheLimiter {
+  MovieCacheShard shards[MOVIECACHE_SHARDS];
+  /* Total size of the managed items in bytes, updated atomically. */
+  size_t mem_in_use;
+  /* Shard to evict from next, so eviction is spread over all of them. */
+  unsigned int evict_shard;
+  bool is_initialized;
+} limiter;
+static pthread_mutex_t limiter_init_lock = BLI_MUTEX_INITIALIZER;
 
 typedef struct MovieCache {
   char name[64];
@@ -74,7 +98,13 @@ typedef struct MovieCache {
   void *last_userkey;
 
   int totseg, *points, proxy, render_flags; /* for visual statistics optimization */
-  int pad;
+
+  /* Items which buffer was evicted, but which are still in the hash. */
+  unsigned int num_evicted;
+
+  /* Statistics, updated atomically. */
+  size_t mem_in_use;
+  unsigned int hits, misses, puts, evictions;
 } MovieCache;
 
 typedef struct MovieCacheKey {
@@ -83,10 +113,19 @@ typedef struct MovieCacheKey {
 } MovieCacheKey;
 
 typedef struct MovieCacheItem {
+  /* In the queue of the shard managing the item. */
+  struct MovieCacheItem *next, *prev;
+
   MovieCache *cache_owner;
   ImBuf *ibuf;
-  MEM_CacheLimiterHandleC *c_handle;
   void *priority_data;
+
+  /* Size in the memory in use while the item is managed. */
+  size_t size;
+  /* Shard managing the item, -1 once the buffer is freed or handed over for freeing. */
+  int shard;
+  /* Set when the buffer is used, eviction then passes it over once. */
+  bool referenced;
 } MovieCacheItem;
 
 static unsigned int moviecache_hashhash(const void *keyv)
@@ -113,16 +152,23 @@ static void moviecache_keyfree(void *val)
   BLI_mempool_free(key->cache_owner->keys_pool, key);
 }
 
+static ImBuf *moviecache_limiter_unmanage(MovieCacheItem *item);
+
 static void moviecache_valfree(void *val)
 {
   MovieCacheItem *item = (MovieCacheItem *)val;
   MovieCache *cache = item->cache_owner;
+  ImBuf *ibuf;
 
   PRINT("%s: cache '%s' free item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
-  if (item->ibuf) {
-    MEM_CacheLimiter_unmanage(item->c_handle);
-    IMB_freeImBuf(item->ibuf);
+  /* The buffer may be evicted by another thread meanwhile, only free it when this takes it. */
+  ibuf = moviecache_limiter_unmanage(item);
+  if (ibuf) {
+    IMB_freeImBuf(ibuf);
+  }
+  else {
+    atomic_sub_and_fetch_u(&cache->num_evicted, 1);
   }
 
   if (item->priority_data && cache->prioritydeleterfp) {
@@ -136,6 +182,16 @@ static void check_unused_keys(MovieCache *cache)
 {
   GHashIterator gh_iter;
 
+  if (atomic_add_and_fetch_u(&cache->num_evicted, 0) == 0) {
+    return;
+  }
+
+  /* force cached segments to be updated */
+  if (cache->points) {
+    MEM_freeN(cache->points);
+    cache->points = NULL;
+  }
+
   BLI_ghashIterator_init(&gh_iter, cache->hash);
 
   while (!BLI_ghashIterator_done(&gh_iter)) {
@@ -164,28 +220,6 @@ static int compare_int(const void *av, const void *bv)
   return *a - *b;
 }
 
-static void IMB_moviecache_destructor(void *p)
-{
-  MovieCacheItem *item = (MovieCacheItem *)p;
-
-  if (item && item->ibuf) {
-    MovieCache *cache = item->cache_owner;
-
-    PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
-
-    IMB_freeImBuf(item->ibuf);
-
-    item->ibuf = NULL;
-    item->c_handle = NULL;
-
-    /* force cached segments to be updated */
-    if (cache->points) {
-      MEM_freeN(cache->points);
-      cache->points = NULL;
-    }
-  }
-}
-
 static size_t get_size_in_memory(ImBuf *ibuf)
 {
   /* Keep textures in the memory to avoid constant file reload on viewport update. */
@@ -195,10 +229,9 @@ static size_t get_size_in_memory(ImBuf *ibuf)
 
   return IMB_get_size_in_memory(ibuf);
 }
-static size_t get_item_size(void *p)
+static size_t get_item_size(MovieCacheItem *item)
 {
   size_t size = sizeof(MovieCacheItem);
-  MovieCacheItem *item = (MovieCacheItem *)p;
 
   if (item->ibuf) {
     size += get_size_in_memory(item->ibuf);
@@ -207,9 +240,8 @@ static size_t get_item_size(void *p)
   return size;
 }
 
-static int get_item_priority(void *item_v, int default_priority)
+static int get_item_priority(MovieCacheItem *item, int default_priority)
 {
-  MovieCacheItem *item = (MovieCacheItem *)item_v;
   MovieCache *cache = item->cache_owner;
   int priority;
 
@@ -230,9 +262,8 @@ static int get_item_priority(void *item_v, int default_priority)
   return priority;
 }
 
-static bool get_item_destroyable(void *item_v)
+static bool get_item_destroyable(MovieCacheItem *item)
 {
-  MovieCacheItem *item = (MovieCacheItem *)item_v;
   /* IB_BITMAPDIRTY means image was modified from inside blender and
    * changes are not saved to disk.
    *
@@ -244,19 +275,214 @@ static bool get_item_destroyable(void *item_v)
   return true;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Cache Limiter
+ * \{ */
+
+static void moviecache_limiter_manage(MovieCacheItem *item)
+{
+  MovieCache *cache = item->cache_owner;
+  const int shard_index = (int)(BLI_ghashutil_ptrhash(item) % MOVIECACHE_SHARDS);
+  MovieCacheShard *shard = &limiter.shards[shard_index];
+
+  item->size = get_item_size(item);
+  item->referenced = true;
+
+  BLI_mutex_lock(&shard->mutex);
+  item->shard = shard_index;
+  BLI_addtail(&shard->items, item);
+  shard->totitem++;
+  BLI_mutex_unlock(&shard->mutex);
+
+  atomic_add_and_fetch_z(&limiter.mem_in_use, item->size);
+  atomic_add_and_fetch_z(&cache->mem_in_use, item->size);
+}
+
+/**
+ * Measure the buffer of the item again, it might have grown since it was put, for example when
+ * mipmaps or a byte buffer were added. Returns true when the item uses more memory than before.
+ *
+ * \note Must be called with the mutex of the shard locked.
+ */
+static bool moviecache_limiter_update_size_locked(MovieCacheItem *item)
+{
+  const size_t size = get_item_size(item);
+  const size_t size_prev = item->size;
+  item->size = size;
+
+  if (size > size_prev) {
+    atomic_add_and_fetch_z(&limiter.mem_in_use, size - size_prev);
+    atomic_add_and_fetch_z(&item->cache_owner->mem_in_use, size - size_prev);
+    return true;
+  }
+  if (size < size_prev) {
+    atomic_sub_and_fetch_z(&limiter.mem_in_use, size_prev - size);
+    atomic_sub_and_fetch_z(&item->cache_owner->mem_in_use, size_prev - size);
+  }
+  return false;
+}
+
+/* Must be called with the mutex of the shard locked. */
+static void moviecache_limiter_remove_locked(MovieCacheShard *shard, MovieCacheItem *item)
+{
+  BLI_remlink(&shard->items, item);
+  shard->totitem--;
+  item->shard = -1;
+
+  atomic_sub_and_fetch_z(&limiter.mem_in_use, item->size);
+  atomic_sub_and_fetch_z(&item->cache_owner->mem_in_use, item->size);
+}
+
+/**
+ * Stop managing the item, returns its buffer for the caller to free, or NULL when it was already
+ * evicted.
+ */
+static ImBuf *moviecache_limiter_unmanage(MovieCacheItem *item)
+{
+  ImBuf *ibuf = NULL;
+  const int shard_index = item->shard;
+
+  if (shard_index == -1) {
+    return NULL;
+  }
+
+  MovieCacheShard *shard = &limiter.shards[shard_index];
+
+  BLI_mutex_lock(&shard->mutex);
+  if (item->shard != -1) {
+    ibuf = item->ibuf;
+    item->ibuf = NULL;
+    moviecache_limiter_remove_locked(shard, item);
+  }
+  BLI_mutex_unlock(&shard->mutex);
+
+  return ibuf;
+}
+
+/**
+ * Free the buffer of the least valuable item in the shard, items used since the last pass get
+ * another chance first. Returns false when there is no item which can be freed.
+ */
+static bool moviecache_shard_evict(MovieCacheShard *shard, const MovieCacheItem *protected_item)
+{
+  MovieCacheItem *candidates[MOVIECACHE_EVICT_CANDIDATES];
+  MovieCacheItem *victim = NULL;
+  ImBuf *ibuf = NULL;
+  int totcandidate = 0;
+
+  BLI_mutex_lock(&shard->mutex);
+
+  const int totitem = shard->totitem;
+  /* When all items were used, the first pass only clears their referenced flags. The second
+   * pass then finds candidates, unless nothing in the shard can be freed. */
+  for (int pass = 0; pass < 2 && totcandidate == 0; pass++) {
+    MovieCacheItem *item = shard->items.first;
+    for (int i = 0; i < totitem && totcandidate < MOVIECACHE_EVICT_CANDIDATES; i++) {
+      MovieCacheItem *item_next = item->next;
+
+      if (item != protected_item && get_item_destroyable(item)) {
+        if (item->referenced) {
+          item->referenced = false;
+          BLI_remlink(&shard->items, item);
+          BLI_addtail(&shard->items, item);
+        }
+        else {
+          candidates[totcandidate++] = item;
+        }
+      }
+
+      item = item_next;
+    }
+  }
+
+  int victim_priority = 0;
+  for (int i = 0; i < totcandidate; i++) {
+    /* By default the least recently used item has the lowest priority. */
+    const int priority = get_item_priority(candidates[i], -(totitem - i - 1));
+
+    if (victim == NULL || priority < victim_priority) {
+      victim = candidates[i];
+      victim_priority = priority;
+    }
+  }
+
+  if (victim) {
+    MovieCache *cache = victim->cache_owner;
+
+    PRINT("%s: cache '%s' evict item %p buffer %p\n", __func__, cache->name, victim, victim->ibuf);
+
+    ibuf = victim->ibuf;
+    victim->ibuf = NULL;
+    moviecache_limiter_remove_locked(shard, victim);
+
+    atomic_add_and_fetch_u(&cache->num_evicted, 1);
+    atomic_add_and_fetch_u(&cache->evictions, 1);
+  }
+
+  BLI_mutex_unlock(&shard->mutex);
+
+  if (ibuf) {
+    IMB_freeImBuf(ibuf);
+  }
+
+  return victim != NULL;
+}
+
+static void moviecache_limiter_enforce(const MovieCacheItem *protected_item)
+{
+  const size_t mem_limit = MEM_CacheLimiter_get_maximum();
+  int tot_failed = 0;
+
+  if (mem_limit == 0 || MEM_CacheLimiter_is_disabled()) {
+    return;
+  }
+
+  /* Give up once no shard has anything left to evict. */
+  while (tot_failed < MOVIECACHE_SHARDS &&
+         atomic_add_and_fetch_z(&limiter.mem_in_use, 0) > mem_limit) {
+    const unsigned int shard_index = atomic_fetch_and_add_u(&limiter.evict_shard, 1) %
+                                     MOVIECACHE_SHARDS;
+
+    if (moviecache_shard_evict(&limiter.shards[shard_index], protected_item)) {
+      tot_failed = 0;
+    }
+    else {
+      tot_failed++;
+    }
+  }
+}
+
+/** \} */
+
 void IMB_moviecache_init(void)
 {
-  limitor = new_MEM_CacheLimiter(IMB_moviecache_destructor, get_item_size);
+  BLI_mutex_lock(&limiter_init_lock);
 
-  MEM_CacheLimiter_ItemPriority_Func_set(limitor, get_item_priority);
-  MEM_CacheLimiter_ItemDestroyable_Func_set(limitor, get_item_destroyable);
+  if (!limiter.is_initialized) {
+    for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+      BLI_mutex_init(&limiter.shards[i].mutex);
+      BLI_listbase_clear(&limiter.shards[i].items);
+      limiter.shards[i].totitem = 0;
+    }
+    limiter.mem_in_use = 0;
+    limiter.is_initialized = true;
+  }
+
+  BLI_mutex_unlock(&limiter_init_lock);
 }
 
 void IMB_moviecache_destruct(void)
 {
-  if (limitor) {
-    delete_MEM_CacheLimiter(limitor);
+  BLI_mutex_lock(&limiter_init_lock);
+
+  if (limiter.is_initialized) {
+    for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+      BLI_mutex_end(&limiter.shards[i].mutex);
+    }
+    limiter.is_initialized = false;
   }
+
+  BLI_mutex_unlock(&limiter_init_lock);
 }
 
 MovieCache *IMB_moviecache_create(const char *name,
@@ -303,12 +529,12 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
   cache->prioritydeleterfp = prioritydeleterfp;
 }
 
-static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
+void IMB_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
   MovieCacheKey *key;
   MovieCacheItem *item;
 
-  if (!limitor) {
+  if (!limiter.is_initialized) {
     IMB_moviecache_init();
   }
 
@@ -323,10 +549,13 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 
   PRINT("%s: cache '%s' put %p, item %p\n", __func__, cache->name, ibuf, item);
 
+  item->next = item->prev = NULL;
   item->ibuf = ibuf;
   item->cache_owner = cache;
-  item->c_handle = NULL;
   item->priority_data = NULL;
+  item->size = 0;
+  item->shard = -1;
+  item->referenced = false;
 
   if (cache->getprioritydatafp) {
     item->priority_data = cache->getprioritydatafp(userkey);
@@ -338,19 +567,10 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
     memcpy(cache->last_userkey, userkey, cache->keysize);
   }
 
-  if (need_lock) {
-    BLI_mutex_lock(&limitor_lock);
-  }
+  moviecache_limiter_manage(item);
+  moviecache_limiter_enforce(item);
 
-  item->c_handle = MEM_CacheLimiter_insert(limitor, item);
-
-  MEM_CacheLimiter_ref(item->c_handle);
-  MEM_CacheLimiter_enforce_limits(limitor);
-  MEM_CacheLimiter_unref(item->c_handle);
-
-  if (need_lock) {
-    BLI_mutex_unlock(&limitor_lock);
-  }
+  atomic_add_and_fetch_u(&cache->puts, 1);
 
   /* cache limiter can't remove unused keys which points to destroyed values */
   check_unused_keys(cache);
@@ -361,30 +581,22 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
   }
 }
 
-void IMB_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
-{
-  do_moviecache_put(cache, userkey, ibuf, true);
-}
-
 bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
   size_t mem_in_use, mem_limit, elem_size;
-  bool result = false;
 
   elem_size = get_size_in_memory(ibuf);
   mem_limit = MEM_CacheLimiter_get_maximum();
+  mem_in_use = atomic_add_and_fetch_z(&limiter.mem_in_use, 0);
 
-  BLI_mutex_lock(&limitor_lock);
-  mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
-
+  /* Puts from other threads may still take the memory meanwhile, in which case the least
+   * valuable buffers are evicted as usual. */
   if (mem_in_use + elem_size <= mem_limit) {
-    do_moviecache_put(cache, userkey, ibuf, false);
-    result = true;
+    IMB_moviecache_put(cache, userkey, ibuf);
+    return true;
   }
 
-  BLI_mutex_unlock(&limitor_lock);
-
-  return result;
+  return false;
 }
 
 void IMB_moviecache_remove(MovieCache *cache, void *userkey)
@@ -404,18 +616,31 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
   key.userkey = userkey;
   item = (MovieCacheItem *)BLI_ghash_lookup(cache->hash, &key);
 
-  if (item) {
-    if (item->ibuf) {
-      BLI_mutex_lock(&limitor_lock);
-      MEM_CacheLimiter_touch(item->c_handle);
-      BLI_mutex_unlock(&limitor_lock);
+  if (item && item->shard != -1) {
+    MovieCacheShard *shard = &limiter.shards[item->shard];
+    ImBuf *ibuf = NULL;
+    bool has_grown = false;
 
-      IMB_refImBuf(item->ibuf);
+    /* Only the shard of the item is locked, so it isn't evicted before it's referenced. */
+    BLI_mutex_lock(&shard->mutex);
+    if (item->ibuf) {
+      ibuf = item->ibuf;
+      IMB_refImBuf(ibuf);
+      item->referenced = true;
+      has_grown = moviecache_limiter_update_size_locked(item);
+    }
+    BLI_mutex_unlock(&shard->mutex);
 
-      return item->ibuf;
+    if (ibuf) {
+      if (has_grown) {
+        moviecache_limiter_enforce(item);
+      }
+      atomic_add_and_fetch_u(&cache->hits, 1);
+      return ibuf;
     }
   }
 
+  atomic_add_and_fetch_u(&cache->misses, 1);
   return NULL;
 }
 
@@ -431,9 +656,26 @@ bool IMB_moviecache_has_frame(MovieCache *cache, void *userkey)
   return item != NULL;
 }
 
+void IMB_moviecache_get_stats(MovieCache *cache, MovieCacheStats *r_stats)
+{
+  r_stats->mem_in_use = atomic_add_and_fetch_z(&cache->mem_in_use, 0);
+  r_stats->totitem = (int)BLI_ghash_len(cache->hash) -
+                     (int)atomic_add_and_fetch_u(&cache->num_evicted, 0);
+  r_stats->hits = atomic_add_and_fetch_u(&cache->hits, 0);
+  r_stats->misses = atomic_add_and_fetch_u(&cache->misses, 0);
+  r_stats->puts = atomic_add_and_fetch_u(&cache->puts, 0);
+  r_stats->evictions = atomic_add_and_fetch_u(&cache->evictions, 0);
+}
+
 void IMB_moviecache_free(MovieCache *cache)
 {
-  PRINT("%s: cache '%s' free\n", __func__, cache->name);
+  PRINT("%s: cache '%s' free, %u hits, %u misses, %u puts, %u evictions\n",
+        __func__,
+        cache->name,
+        cache->hits,
+        cache->misses,
+        cache->puts,
+        cache->evictions);
 
   BLI_ghash_free(cache->hash, moviecache_keyfree, moviecache_valfree);
 
@@ -487,6 +729,9 @@ void IMB_moviecache_get_cache_segments(
     return;
   }
 
+  /* Buffers evicted by puts on other caches invalidate the segments. */
+  check_unused_keys(cache);
+
   if (cache->proxy != proxy || cache->render_flags != render_flags) {
     if (cache->points) {
       MEM_freeN(cache->points);
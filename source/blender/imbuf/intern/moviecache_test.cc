@@ -0,0 +1,248 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_CacheLimiterC-Api.h"
+
+#include "BLI_ghash.h"
+#include "BLI_task.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+
+namespace blender::imbuf::tests {
+
+/* Bytes of one 64x64 RGBA byte buffer. */
+static const size_t buffer_size = 64 * 64 * 4;
+
+class imbuf_moviecache : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    IMB_init();
+    IMB_moviecache_init();
+  }
+  static void TearDownTestSuite()
+  {
+    IMB_moviecache_destruct();
+    IMB_exit();
+  }
+
+ protected:
+  size_t mem_limit_prev_;
+
+  void SetUp() override
+  {
+    mem_limit_prev_ = MEM_CacheLimiter_get_maximum();
+  }
+  void TearDown() override
+  {
+    MEM_CacheLimiter_set_maximum(mem_limit_prev_);
+  }
+};
+
+static unsigned int frame_hash(const void *key)
+{
+  return BLI_ghashutil_inthash(*(const int *)key);
+}
+
+static bool frame_cmp(const void *a, const void *b)
+{
+  return *(const int *)a != *(const int *)b;
+}
+
+static MovieCache *frame_cache_create()
+{
+  return IMB_moviecache_create("test", sizeof(int), frame_hash, frame_cmp);
+}
+
+static void frame_put(MovieCache *cache, int frame)
+{
+  ImBuf *ibuf = IMB_allocImBuf(64, 64, 32, IB_rect);
+  IMB_moviecache_put(cache, &frame, ibuf);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(imbuf_moviecache, PutGet)
+{
+  MEM_CacheLimiter_set_maximum(100 * buffer_size);
+  MovieCache *cache = frame_cache_create();
+
+  for (int frame = 0; frame < 10; frame++) {
+    frame_put(cache, frame);
+  }
+  for (int frame = 0; frame < 10; frame++) {
+    ImBuf *ibuf = IMB_moviecache_get(cache, &frame);
+    ASSERT_NE(ibuf, nullptr);
+    EXPECT_EQ(ibuf->x, 64);
+    IMB_freeImBuf(ibuf);
+  }
+  int missing_frame = 10;
+  EXPECT_EQ(IMB_moviecache_get(cache, &missing_frame), nullptr);
+
+  MovieCacheStats stats;
+  IMB_moviecache_get_stats(cache, &stats);
+  EXPECT_EQ(stats.totitem, 10);
+  EXPECT_EQ(stats.puts, 10);
+  EXPECT_EQ(stats.hits, 10);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_GE(stats.mem_in_use, 10 * buffer_size);
+
+  IMB_moviecache_free(cache);
+}
+
+/* Putting more than fits evicts buffers, keeping the memory within the limit. */
+TEST_F(imbuf_moviecache, Evict)
+{
+  const size_t mem_limit = 20 * buffer_size;
+  MEM_CacheLimiter_set_maximum(mem_limit);
+  MovieCache *cache = frame_cache_create();
+
+  for (int frame = 0; frame < 100; frame++) {
+    frame_put(cache, frame);
+  }
+
+  MovieCacheStats stats;
+  IMB_moviecache_get_stats(cache, &stats);
+  EXPECT_LE(stats.mem_in_use, mem_limit);
+  EXPECT_GT(stats.evictions, 0);
+  EXPECT_LT(stats.totitem, 20);
+  EXPECT_EQ(stats.totitem, 100 - (int)stats.evictions);
+
+  /* The last put buffer is never evicted by its own put. */
+  int last_frame = 99;
+  ImBuf *ibuf = IMB_moviecache_get(cache, &last_frame);
+  EXPECT_NE(ibuf, nullptr);
+  IMB_freeImBuf(ibuf);
+
+  IMB_moviecache_free(cache);
+}
+
+/* Buffers which were all used recently are still evicted by a single put. */
+TEST_F(imbuf_moviecache, EvictReferenced)
+{
+  MEM_CacheLimiter_set_maximum(100 * buffer_size);
+  MovieCache *cache = frame_cache_create();
+
+  for (int frame = 0; frame < 40; frame++) {
+    frame_put(cache, frame);
+  }
+  for (int frame = 0; frame < 40; frame++) {
+    IMB_freeImBuf(IMB_moviecache_get(cache, &frame));
+  }
+
+  const size_t mem_limit = 10 * buffer_size;
+  MEM_CacheLimiter_set_maximum(mem_limit);
+  frame_put(cache, 40);
+
+  MovieCacheStats stats;
+  IMB_moviecache_get_stats(cache, &stats);
+  EXPECT_LE(stats.mem_in_use, mem_limit);
+
+  IMB_moviecache_free(cache);
+}
+
+/* Memory added to a buffer after it was put is counted once the buffer is used again. */
+TEST_F(imbuf_moviecache, SizeChange)
+{
+  MEM_CacheLimiter_set_maximum(100 * buffer_size);
+  MovieCache *cache = frame_cache_create();
+
+  int frame = 0;
+  frame_put(cache, frame);
+  MovieCacheStats stats;
+  IMB_moviecache_get_stats(cache, &stats);
+  const size_t mem_in_use_byte = stats.mem_in_use;
+
+  ImBuf *ibuf = IMB_moviecache_get(cache, &frame);
+  imb_addrectfloatImBuf(ibuf);
+  IMB_freeImBuf(ibuf);
+
+  ibuf = IMB_moviecache_get(cache, &frame);
+  IMB_moviecache_get_stats(cache, &stats);
+  EXPECT_GE(stats.mem_in_use, mem_in_use_byte + 4 * buffer_size);
+
+  imb_freerectfloatImBuf(ibuf);
+  IMB_freeImBuf(ibuf);
+  ibuf = IMB_moviecache_get(cache, &frame);
+  IMB_freeImBuf(ibuf);
+  IMB_moviecache_get_stats(cache, &stats);
+  EXPECT_EQ(stats.mem_in_use, mem_in_use_byte);
+
+  IMB_moviecache_free(cache);
+}
+
+TEST_F(imbuf_moviecache, PutIfPossible)
+{
+  MEM_CacheLimiter_set_maximum(4 * buffer_size);
+  MovieCache *cache = frame_cache_create();
+
+  int frame = 0;
+  ImBuf *ibuf = IMB_allocImBuf(64, 64, 32, IB_rect);
+  EXPECT_TRUE(IMB_moviecache_put_if_possible(cache, &frame, ibuf));
+  IMB_freeImBuf(ibuf);
+
+  ImBuf *ibuf_big = IMB_allocImBuf(256, 256, 32, IB_rect);
+  frame = 1;
+  EXPECT_FALSE(IMB_moviecache_put_if_possible(cache, &frame, ibuf_big));
+  IMB_freeImBuf(ibuf_big);
+
+  IMB_moviecache_free(cache);
+}
+
+struct ThreadedData {
+  MovieCache *caches[4];
+};
+
+static void threaded_put_get(void *__restrict userdata,
+                             const int i,
+                             const TaskParallelTLS *__restrict /*tls*/)
+{
+  ThreadedData *data = static_cast<ThreadedData *>(userdata);
+  MovieCache *cache = data->caches[i % 4];
+  /* Each cache is only written from one thread, like the caches of Blender. */
+  for (int frame = 0; frame < 200; frame++) {
+    frame_put(cache, frame);
+    int prev_frame = frame / 2;
+    ImBuf *ibuf = IMB_moviecache_get(cache, &prev_frame);
+    if (ibuf) {
+      EXPECT_EQ(ibuf->x, 64);
+      IMB_freeImBuf(ibuf);
+    }
+  }
+}
+
+/* Caches on different threads share the memory limit. */
+TEST_F(imbuf_moviecache, Threaded)
+{
+  const size_t mem_limit = 50 * buffer_size;
+  MEM_CacheLimiter_set_maximum(mem_limit);
+
+  ThreadedData data;
+  for (int i = 0; i < 4; i++) {
+    data.caches[i] = frame_cache_create();
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, 4, &data, threaded_put_get, &settings);
+
+  size_t mem_in_use = 0;
+  for (int i = 0; i < 4; i++) {
+    MovieCacheStats stats;
+    IMB_moviecache_get_stats(data.caches[i], &stats);
+    EXPECT_EQ(stats.puts, 200);
+    EXPECT_EQ(stats.hits + stats.misses, 200);
+    mem_in_use += stats.mem_in_use;
+  }
+  EXPECT_LE(mem_in_use, mem_limit);
+
+  for (int i = 0; i < 4; i++) {
+    IMB_moviecache_free(data.caches[i]);
+  }
+}
+
+}  // namespace blender::imbuf::tests
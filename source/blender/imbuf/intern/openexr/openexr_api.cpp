@@ -31,6 +31,7 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <Iex.h>
 #include <ImathBox.h>
@@ -42,6 +43,8 @@
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
 #include <ImfPixelType.h>
+#include <ImfPreviewImage.h>
+#include <ImfRgbaFile.h>
 #include <ImfStandardAttributes.h>
 #include <ImfStringAttribute.h>
 #include <ImfVersion.h>
@@ -78,6 +81,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 }
 #include "BLI_blenlib.h"
 #include "BLI_math_color.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -644,7 +648,7 @@ struct ExrHandle {
   ListBase channels; /* flattened out, ExrChannel */
   ListBase layers;   /* hierarchical, pointing in end to ExrChannel */
 
-  int num_half_channels; /* used during filr save, allows faster temporary buffers allocation */
+  int num_half_channels; /* Used during file save, for allocating the temporary half buffer. */
 };
 
 /* flattened out channel */
@@ -1091,52 +1095,113 @@ void IMB_exr_clear_channels(void *handle)
   }
 
   BLI_freelistN(&data->channels);
+  data->num_half_channels = 0;
+}
+
+/* Scanlines written at once, the temporary half float buffers only hold this many. A multiple of
+ * the scanlines per block of all compression types, so OpenEXR compresses whole blocks on its
+ * threads. */
+#define EXR_WRITE_CHUNK_LINES 256
+
+struct ExrHalfConvertData {
+  ExrChannel **channels;
+  int num_channels;
+  half *rect_half;
+  int width, height;
+  int first_line;
+};
+
+static void exr_half_convert_line(void *__restrict userdata,
+                                  const int line,
+                                  const TaskParallelTLS *__restrict /*tls*/)
+{
+  const ExrHalfConvertData *data = (const ExrHalfConvertData *)userdata;
+  const size_t chunk_size = (size_t)data->width * EXR_WRITE_CHUNK_LINES;
+  /* Writing starts from last scanline. */
+  const int y = data->height - 1 - (data->first_line + line);
+
+  for (int i = 0; i < data->num_channels; i++) {
+    const ExrChannel *echan = data->channels[i];
+    const float *rect = echan->rect + (size_t)y * echan->ystride;
+    half *cur = data->rect_half + i * chunk_size + (size_t)line * data->width;
+
+    for (int x = 0; x < data->width; x++) {
+      cur[x] = rect[(size_t)x * echan->xstride];
+    }
+  }
 }
 
 void IMB_exr_write_channels(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
-  FrameBuffer frameBuffer;
   ExrChannel *echan;
 
   if (data->channels.first) {
-    const size_t num_pixels = ((size_t)data->width) * data->height;
-    half *rect_half = nullptr, *current_rect_half = nullptr;
-
-    /* We allocate teporary storage for half pixels for all the channels at once. */
-    if (data->num_half_channels != 0) {
-      rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * num_pixels,
-                                      __func__);
-      current_rect_half = rect_half;
-    }
+    const size_t chunk_size = (size_t)data->width * EXR_WRITE_CHUNK_LINES;
+    std::vector<ExrChannel *> half_channels;
+    half *rect_half = nullptr;
 
+    /* Float channels are written straight from the passes, only half channels are converted,
+     * one chunk of scanlines at a time. */
+    half_channels.reserve(data->num_half_channels);
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
-      /* Writing starts from last scanline, stride negative. */
       if (echan->use_half_float) {
-        float *rect = echan->rect;
-        half *cur = current_rect_half;
-        for (size_t i = 0; i < num_pixels; i++, cur++) {
-          *cur = rect[i * echan->xstride];
-        }
-        half *rect_to_write = current_rect_half + (data->height - 1L) * data->width;
-        frameBuffer.insert(
-            echan->name,
-            Slice(Imf::HALF, (char *)rect_to_write, sizeof(half), -data->width * sizeof(half)));
-        current_rect_half += num_pixels;
-      }
-      else {
-        float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
-        frameBuffer.insert(echan->name,
-                           Slice(Imf::FLOAT,
-                                 (char *)rect,
-                                 echan->xstride * sizeof(float),
-                                 -echan->ystride * sizeof(float)));
+        half_channels.push_back(echan);
       }
     }
+    BLI_assert(half_channels.size() == (size_t)data->num_half_channels);
+    if (data->num_half_channels != 0) {
+      rect_half = (half *)MEM_mallocN(sizeof(half) * data->num_half_channels * chunk_size,
+                                      __func__);
+    }
+
+    ExrHalfConvertData convert_data;
+    convert_data.channels = half_channels.data();
+    convert_data.num_channels = (int)half_channels.size();
+    convert_data.rect_half = rect_half;
+    convert_data.width = data->width;
+    convert_data.height = data->height;
 
-    data->ofile->setFrameBuffer(frameBuffer);
     try {
-      data->ofile->writePixels(data->height);
+      for (int first_line = 0; first_line < data->height; first_line += EXR_WRITE_CHUNK_LINES) {
+        const int num_lines = std::min(EXR_WRITE_CHUNK_LINES, data->height - first_line);
+        FrameBuffer frameBuffer;
+        int half_index = 0;
+
+        for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
+          if (echan->use_half_float) {
+            /* The chunk holds the scanlines from the first line on, in writing order. */
+            half *rect_to_write = rect_half + half_index * chunk_size -
+                                  (ptrdiff_t)first_line * data->width;
+            frameBuffer.insert(
+                echan->name,
+                Slice(Imf::HALF, (char *)rect_to_write, sizeof(half), data->width * sizeof(half)));
+            half_index++;
+          }
+          else {
+            /* Writing starts from last scanline, stride negative. */
+            float *rect = echan->rect + echan->xstride * (data->height - 1L) * data->width;
+            frameBuffer.insert(echan->name,
+                               Slice(Imf::FLOAT,
+                                     (char *)rect,
+                                     echan->xstride * sizeof(float),
+                                     -echan->ystride * sizeof(float)));
+          }
+        }
+
+        if (rect_half != nullptr) {
+          convert_data.first_line = first_line;
+
+          TaskParallelSettings settings;
+          BLI_parallel_range_settings_defaults(&settings);
+          settings.min_iter_per_thread = 8;
+          BLI_task_parallel_range(0, num_lines, &convert_data, exr_half_convert_line, &settings);
+        }
+
+        /* OpenEXR compresses the scanline blocks of the chunk on its own threads. */
+        data->ofile->setFrameBuffer(frameBuffer);
+        data->ofile->writePixels(num_lines);
+      }
     }
     catch (const std::exception &exc) {
       std::cerr << "OpenEXR-writePixels: ERROR: " << exc.what() << std::endl;
@@ -1233,6 +1298,7 @@ void IMB_exr_read_channels(void *handle)
     /* Insert all matching channel into framebuffer. */
     FrameBuffer frameBuffer;
     ExrChannel *echan;
+    bool has_channels = false;
 
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
       if (echan->m->part_number != i) {
@@ -1264,12 +1330,19 @@ void IMB_exr_read_channels(void *handle)
 
         frameBuffer.insert(echan->m->internal_name,
                            Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+        has_channels = true;
       }
       else {
         printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
       }
     }
 
+    /* Don't decode parts of which no channel is needed, like the other views. Within a part only
+     * the channels in the frame-buffer are copied out, on the threads of OpenEXR. */
+    if (!has_channels) {
+      continue;
+    }
+
     /* Read pixels. */
     try {
       in.setFrameBuffer(frameBuffer);
@@ -2091,6 +2164,91 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
   }
 }
 
+/**
+ * Load an image for a thumbnail, using the preview image embedded in the header when there is
+ * one, otherwise reading only the scanlines and pixels which end up in the thumbnail.
+ */
+struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
+                                                  const int /*flags*/,
+                                                  const size_t max_thumb_size,
+                                                  char colorspace[],
+                                                  size_t *r_width,
+                                                  size_t *r_height)
+{
+  struct ImBuf *ibuf = nullptr;
+  IStream *stream = nullptr;
+  RgbaInputFile *file = nullptr;
+
+  try {
+    stream = new IFileStream(filepath);
+    /* Many thumbnails are made at once on worker threads, decode on the calling thread instead of
+     * making all of them wait for the global thread pool. */
+    file = new RgbaInputFile(*stream, 0);
+
+    const Box2i dw = file->dataWindow();
+    const int source_w = dw.max.x - dw.min.x + 1;
+    const int source_h = dw.max.y - dw.min.y + 1;
+    *r_width = (size_t)source_w;
+    *r_height = (size_t)source_h;
+
+    if (file->header().hasPreviewImage()) {
+      const PreviewImage &preview = file->header().previewImage();
+      ibuf = IMB_allocFromBuffer(
+          (const unsigned int *)preview.pixels(), nullptr, preview.width(), preview.height(), 4);
+      if (ibuf) {
+        /* The preview starts at the top scanline. */
+        IMB_flipy(ibuf);
+        colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+      }
+    }
+    else if (file->isComplete() && (file->channels() & (WRITE_RGB | WRITE_Y))) {
+      /* Multilayer files have no RGB channels in the first part, and are loaded in full. */
+      /* Images smaller than the thumbnail are read at their own size. */
+      const float scale = std::min({(float)max_thumb_size / (float)source_w,
+                                    (float)max_thumb_size / (float)source_h,
+                                    1.0f});
+      const int dest_w = std::max((int)(source_w * scale), 1);
+      const int dest_h = std::max((int)(source_h * scale), 1);
+
+      ibuf = IMB_allocImBuf(dest_w, dest_h, 32, IB_rectfloat);
+      if (ibuf) {
+        Array<Rgba> pixels(source_w);
+
+        for (int y = 0; y < dest_h; y++) {
+          /* Read the one scanline nearest to the destination row. */
+          const int source_y = dw.min.y + std::min((int)(y / scale), source_h - 1);
+          file->setFrameBuffer(&pixels[0] - dw.min.x - (size_t)source_y * source_w, 1, source_w);
+          file->readPixels(source_y);
+
+          /* The image starts at the top scanline. */
+          float *dest = ibuf->rect_float + (size_t)(dest_h - 1 - y) * dest_w * 4;
+          for (int x = 0; x < dest_w; x++, dest += 4) {
+            const Rgba &pixel = pixels[std::min((int)(x / scale), source_w - 1)];
+            dest[0] = pixel.r;
+            dest[1] = pixel.g;
+            dest[2] = pixel.b;
+            dest[3] = pixel.a;
+          }
+        }
+
+        colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+      }
+    }
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-thumbnail: ERROR: " << exc.what() << std::endl;
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+      ibuf = nullptr;
+    }
+  }
+
+  delete file;
+  delete stream;
+
+  return ibuf;
+}
+
 void imb_initopenexr(void)
 {
   int num_threads = BLI_system_thread_count();
@@ -30,8 +30,10 @@
 #endif
 
 #include "BLI_fileops.h"
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include <stdlib.h>
 
@@ -39,6 +41,8 @@
 #include "IMB_filetype.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_metadata.h"
+#include "IMB_thumbs.h"
 #include "imbuf.h"
 
 #include "IMB_colormanagement.h"
@@ -327,3 +331,145 @@ void imb_loadtile(ImBuf *ibuf, int tx, int ty, unsigned int *rect)
 
   close(file);
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Thumbnail Loading
+ * \{ */
+
+/* Memory which images loaded in full resolution for thumbnails may use at once. */
+#define THUMB_LOAD_MEMORY_MAX ((size_t)1024 * 1024 * 1024)
+
+static struct {
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  bool cond_initialized;
+  size_t mem_in_use;
+} thumb_load_memory = {BLI_MUTEX_INITIALIZER};
+
+/* Size of the decoded image, for float images including the byte buffer made for the thumbnail. */
+static size_t thumb_load_memory_estimate(const char *filepath, const ImFileType *type)
+{
+  ImBuf *ibuf = IMB_testiffname(filepath, IB_rect);
+  size_t size = 0;
+
+  if (ibuf) {
+    size = (size_t)ibuf->x * ibuf->y * 4;
+    if (type->flag & IM_FTYPE_FLOAT) {
+      size += size * sizeof(float);
+    }
+    IMB_freeImBuf(ibuf);
+  }
+
+  return size;
+}
+
+static void thumb_load_memory_acquire(const size_t size)
+{
+  BLI_mutex_lock(&thumb_load_memory.mutex);
+
+  if (!thumb_load_memory.cond_initialized) {
+    BLI_condition_init(&thumb_load_memory.cond);
+    thumb_load_memory.cond_initialized = true;
+  }
+
+  /* An image bigger than the budget is still loaded, but on its own. */
+  while (thumb_load_memory.mem_in_use != 0 &&
+         thumb_load_memory.mem_in_use + size > THUMB_LOAD_MEMORY_MAX) {
+    BLI_condition_wait(&thumb_load_memory.cond, &thumb_load_memory.mutex);
+  }
+  thumb_load_memory.mem_in_use += size;
+
+  BLI_mutex_unlock(&thumb_load_memory.mutex);
+}
+
+static void thumb_load_memory_release(const size_t size)
+{
+  BLI_mutex_lock(&thumb_load_memory.mutex);
+  thumb_load_memory.mem_in_use -= size;
+  BLI_condition_notify_all(&thumb_load_memory.cond);
+  BLI_mutex_unlock(&thumb_load_memory.mutex);
+}
+
+/**
+ * Load an image for a thumbnail, scaled down to fit in \a max_thumb_size.
+ *
+ * Formats which can decode at a reduced resolution do so. Other images are loaded in full, unless
+ * the file is bigger than #THUMB_SIZE_MAX, while the images loaded on all threads at once stay
+ * within a memory budget. The size of the full image is stored in the thumbnail metadata.
+ */
+ImBuf *IMB_thumb_load_image(const char *filepath, const size_t max_thumb_size, char *colorspace)
+{
+  const ImFileType *type = IMB_file_type_from_ftype(IMB_ispic_type(filepath));
+  const int flags = IB_rect | IB_metadata;
+  char effective_colorspace[IM_MAX_SPACE] = "";
+  size_t width = 0, height = 0;
+  size_t mem_size = 0;
+  ImBuf *ibuf = NULL;
+
+  if (type == NULL) {
+    return NULL;
+  }
+
+  if (colorspace) {
+    BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+  }
+
+  if (type->load_filepath_thumbnail) {
+    ibuf = type->load_filepath_thumbnail(
+        filepath, flags, max_thumb_size, effective_colorspace, &width, &height);
+    if (ibuf) {
+      imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+    }
+  }
+
+  if (ibuf == NULL) {
+    const size_t file_size = BLI_file_size(filepath);
+    if (file_size != -1 && file_size > THUMB_SIZE_MAX) {
+      return NULL;
+    }
+
+    mem_size = thumb_load_memory_estimate(filepath, type);
+    thumb_load_memory_acquire(mem_size);
+
+    ibuf = IMB_loadiffname(filepath, flags, colorspace);
+    if (ibuf) {
+      width = (size_t)ibuf->x;
+      height = (size_t)ibuf->y;
+
+      /* Only scale the byte buffer, float images are converted for the thumbnail anyway. */
+      if (ibuf->rect_float) {
+        if (ibuf->rect == NULL) {
+          IMB_rect_from_float(ibuf);
+        }
+        imb_freerectfloatImBuf(ibuf);
+      }
+    }
+  }
+
+  if (ibuf) {
+    if ((size_t)ibuf->x > max_thumb_size || (size_t)ibuf->y > max_thumb_size) {
+      const float scale = min_ff((float)max_thumb_size / (float)ibuf->x,
+                                 (float)max_thumb_size / (float)ibuf->y);
+      IMB_scaleImBuf(ibuf, max_ii((int)(ibuf->x * scale), 1), max_ii((int)(ibuf->y * scale), 1));
+    }
+
+    if (width > 0 && height > 0) {
+      char cwidth[40];
+      char cheight[40];
+
+      BLI_snprintf(cwidth, sizeof(cwidth), "%zu", width);
+      BLI_snprintf(cheight, sizeof(cheight), "%zu", height);
+      IMB_metadata_ensure(&ibuf->metadata);
+      IMB_metadata_set_field(ibuf->metadata, "Thumb::Image::Width", cwidth);
+      IMB_metadata_set_field(ibuf->metadata, "Thumb::Image::Height", cheight);
+    }
+  }
+
+  if (mem_size != 0) {
+    thumb_load_memory_release(mem_size);
+  }
+
+  return ibuf;
+}
+
+/** \} */
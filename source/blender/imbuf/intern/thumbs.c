@@ -356,15 +356,6 @@ static ImBuf *thumb_create_ex(const char *file_path,
       return NULL; /* unknown size */
   }
 
-  /* exception, skip images over 100mb */
-  if (source == THB_SOURCE_IMAGE) {
-    const size_t file_size = BLI_file_size(file_path);
-    if (file_size != -1 && file_size > THUMB_SIZE_MAX) {
-      // printf("file too big: %d, skipping %s\n", (int)size, file_path);
-      return NULL;
-    }
-  }
-
   if (get_thumb_dir(tdir, size)) {
     BLI_snprintf(tpath, FILE_MAX, "%s%s", tdir, thumb);
     //      thumb[8] = '\0'; /* shorten for tempname, not needed anymore */
@@ -384,7 +375,8 @@ static ImBuf *thumb_create_ex(const char *file_path,
         if (img == NULL) {
           switch (source) {
             case THB_SOURCE_IMAGE:
-              img = IMB_loadiffname(file_path, IB_rect | IB_metadata, NULL);
+              /* Images over 100mb are skipped, unless they can be decoded at low resolution. */
+              img = IMB_thumb_load_image(file_path, tsize, NULL);
               break;
             case THB_SOURCE_BLEND:
               img = IMB_thumb_load_blend(file_path, blen_group, blen_id);
@@ -401,8 +393,14 @@ static ImBuf *thumb_create_ex(const char *file_path,
           if (BLI_stat(file_path, &info) != -1) {
             BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
           }
-          BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
-          BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+          /* Images are already scaled down, their metadata has the original size. */
+          if (!IMB_metadata_get_field(
+                  img->metadata, "Thumb::Image::Width", cwidth, sizeof(cwidth)) ||
+              !IMB_metadata_get_field(
+                  img->metadata, "Thumb::Image::Height", cheight, sizeof(cheight))) {
+            BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
+            BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+          }
         }
       }
       else if (THB_SOURCE_MOVIE == source) {
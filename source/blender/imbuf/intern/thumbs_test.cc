@@ -0,0 +1,217 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_metadata.h"
+#include "IMB_thumbs.h"
+
+#include "PIL_time_utildefines.h"
+
+namespace blender::imbuf::tests {
+
+//#define IMB_THUMBS_RUN_BIG
+
+class imbuf_thumbs : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    IMB_init();
+  }
+  static void TearDownTestSuite()
+  {
+    IMB_exit();
+  }
+
+ protected:
+  char temp_dir_[FILE_MAX];
+
+  /* Images are written into a directory of their own in the system temporary directory. */
+  void SetUp() override
+  {
+    const char *tmp = BLI_getenv("TMPDIR");
+#ifdef WIN32
+    if (tmp == nullptr) {
+      tmp = BLI_getenv("TEMP");
+    }
+#endif
+    BLI_join_dirfile(temp_dir_,
+                     sizeof(temp_dir_),
+                     (tmp && BLI_is_dir(tmp)) ? tmp : "/tmp",
+                     "blender_imbuf_thumbs_test");
+    BLI_dir_create_recursive(temp_dir_);
+  }
+  void TearDown() override
+  {
+    BLI_delete(temp_dir_, true, true);
+  }
+
+  void temp_filepath(char *filepath, const char *filename)
+  {
+    BLI_join_dirfile(filepath, FILE_MAX, temp_dir_, filename);
+  }
+};
+
+/* Write an image with a gradient. */
+static void test_image_write(const char *filepath,
+                             const int size_x,
+                             const int size_y,
+                             const eImbFileType ftype)
+{
+  ImBuf *ibuf = IMB_allocImBuf(size_x, size_y, 24, IB_rect);
+  for (int y = 0; y < size_y; y++) {
+    for (int x = 0; x < size_x; x++) {
+      unsigned char *px = (unsigned char *)&ibuf->rect[y * size_x + x];
+      px[0] = (unsigned char)(x * 255 / size_x);
+      px[1] = (unsigned char)(y * 255 / size_y);
+      px[2] = 128;
+      px[3] = 255;
+    }
+  }
+  ibuf->ftype = ftype;
+  ibuf->foptions.quality = 90;
+  EXPECT_TRUE(IMB_saveiff(ibuf, filepath, IB_rect));
+  IMB_freeImBuf(ibuf);
+}
+
+static void test_thumb_check(const char *filepath,
+                             const int size_x,
+                             const int size_y,
+                             const int max_thumb_size)
+{
+  ImBuf *ibuf = IMB_thumb_load_image(filepath, max_thumb_size, nullptr);
+  ASSERT_NE(ibuf, nullptr);
+
+  /* Scaled down to fit, keeping the aspect ratio. */
+  EXPECT_EQ(ibuf->x, max_thumb_size);
+  EXPECT_NEAR(ibuf->y, size_y * max_thumb_size / size_x, 1);
+  ASSERT_NE(ibuf->rect, nullptr);
+
+  /* The gradient survives decoding at a reduced resolution. */
+  const unsigned char *px = (unsigned char *)&ibuf->rect[(ibuf->y / 2) * ibuf->x + ibuf->x / 2];
+  EXPECT_NEAR(px[0], 128, 8);
+  EXPECT_NEAR(px[1], 128, 8);
+
+  char value[40];
+  EXPECT_TRUE(IMB_metadata_get_field(ibuf->metadata, "Thumb::Image::Width", value, 40));
+  EXPECT_EQ(atoi(value), size_x);
+  EXPECT_TRUE(IMB_metadata_get_field(ibuf->metadata, "Thumb::Image::Height", value, 40));
+  EXPECT_EQ(atoi(value), size_y);
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(imbuf_thumbs, LoadImageJpeg)
+{
+  char filepath[FILE_MAX];
+  temp_filepath(filepath, "thumbs_test.jpg");
+  test_image_write(filepath, 1600, 1200, IMB_FTYPE_JPG);
+  test_thumb_check(filepath, 1600, 1200, 256);
+  /* Smaller than the image at any reduced scale. */
+  test_thumb_check(filepath, 1600, 1200, 1000);
+}
+
+/* Formats without reduced decoding are loaded in full and scaled. */
+TEST_F(imbuf_thumbs, LoadImagePng)
+{
+  char filepath[FILE_MAX];
+  temp_filepath(filepath, "thumbs_test.png");
+  test_image_write(filepath, 600, 400, IMB_FTYPE_PNG);
+  test_thumb_check(filepath, 600, 400, 256);
+}
+
+/* 16 bit images load as float and are scaled as bytes, the thumbnail only has bytes. */
+TEST_F(imbuf_thumbs, LoadImageFloat)
+{
+  char filepath[FILE_MAX];
+  temp_filepath(filepath, "thumbs_test_16bit.png");
+
+  ImBuf *ibuf = IMB_allocImBuf(600, 400, 32, IB_rect);
+  ibuf->ftype = IMB_FTYPE_PNG;
+  ibuf->foptions.flag |= PNG_16BIT;
+  imb_addrectfloatImBuf(ibuf);
+  for (size_t i = 0; i < (size_t)ibuf->x * ibuf->y * 4; i++) {
+    ibuf->rect_float[i] = 0.5f;
+  }
+  EXPECT_TRUE(IMB_saveiff(ibuf, filepath, IB_rect));
+  IMB_freeImBuf(ibuf);
+
+  ibuf = IMB_thumb_load_image(filepath, 256, nullptr);
+  ASSERT_NE(ibuf, nullptr);
+  EXPECT_EQ(ibuf->x, 256);
+  EXPECT_EQ(ibuf->rect_float, nullptr);
+  EXPECT_NE(ibuf->rect, nullptr);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(imbuf_thumbs, LoadImageInvalid)
+{
+  char filepath[FILE_MAX];
+  temp_filepath(filepath, "thumbs_test_missing.jpg");
+  EXPECT_EQ(IMB_thumb_load_image(filepath, 256, nullptr), nullptr);
+}
+
+#ifdef IMB_THUMBS_RUN_BIG
+
+struct ThumbsBenchmarkData {
+  const char *dir;
+  bool use_thumb_load;
+};
+
+static void thumbs_benchmark_load(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict /*tls*/)
+{
+  const ThumbsBenchmarkData *data = static_cast<const ThumbsBenchmarkData *>(userdata);
+  char filename[64], filepath[FILE_MAX];
+  BLI_snprintf(filename, sizeof(filename), "thumbs_bench_%d.jpg", i);
+  BLI_join_dirfile(filepath, sizeof(filepath), data->dir, filename);
+
+  ImBuf *ibuf;
+  if (data->use_thumb_load) {
+    ibuf = IMB_thumb_load_image(filepath, 256, nullptr);
+  }
+  else {
+    ibuf = IMB_loadiffname(filepath, IB_rect | IB_metadata, nullptr);
+    IMB_scaleImBuf(ibuf, 256, ibuf->y * 256 / ibuf->x);
+  }
+  IMB_freeImBuf(ibuf);
+}
+
+/* Thumbnails of a directory of photos, made on all threads like the file browser does. */
+TEST_F(imbuf_thumbs, Benchmark)
+{
+  const int num_files = 32;
+  for (int i = 0; i < num_files; i++) {
+    char filename[64], filepath[FILE_MAX];
+    BLI_snprintf(filename, sizeof(filename), "thumbs_bench_%d.jpg", i);
+    temp_filepath(filepath, filename);
+    test_image_write(filepath, 3000, 2000, IMB_FTYPE_JPG);
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  printf("\n========== STARTING %s ==========\n", "Thumbnails of 32 JPEG files, 3000x2000");
+  ThumbsBenchmarkData data = {temp_dir_, false};
+  TIMEIT_START(full_load_and_scale);
+  BLI_task_parallel_range(0, num_files, &data, thumbs_benchmark_load, &settings);
+  TIMEIT_END(full_load_and_scale);
+
+  data.use_thumb_load = true;
+  TIMEIT_START(thumb_load);
+  BLI_task_parallel_range(0, num_files, &data, thumbs_benchmark_load, &settings);
+  TIMEIT_END(thumb_load);
+  printf("========== ENDED %s ==========\n\n", "Thumbnails of 32 JPEG files, 3000x2000");
+}
+
+#endif /* IMB_THUMBS_RUN_BIG */
+
+}  // namespace blender::imbuf::tests
@@ -132,6 +132,7 @@ static void export_startjob(void *customdata,
   }
 
   ABCHierarchyIterator iter(data->depsgraph, abc_archive.get(), data->params);
+  iter.set_parallel_prepare(true);
 
   if (export_animation) {
     CLOG_INFO(&LOG, 2, "Exporting animation");
@@ -168,6 +169,7 @@ static void export_startjob(void *customdata,
   }
 
   iter.release_writers();
+  iter.debug_print_write_timings("Alembic");
 
   /* Finish up by going back to the keyframe that was current before we started. */
   if (CFRA != orig_frame) {
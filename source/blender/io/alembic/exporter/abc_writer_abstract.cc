@@ -54,6 +54,19 @@ bool ABCAbstractWriter::is_supported(const HierarchyContext * /*context*/) const
   return true;
 }
 
+void ABCAbstractWriter::prepare(HierarchyContext &context)
+{
+  /* Mirror the check in write(); static data is only written once. */
+  if (frame_has_been_written_ && !is_animated_) {
+    return;
+  }
+  do_prepare(context);
+}
+
+void ABCAbstractWriter::do_prepare(HierarchyContext & /*context*/)
+{
+}
+
 void ABCAbstractWriter::write(HierarchyContext &context)
 {
   if (!frame_has_been_written_) {
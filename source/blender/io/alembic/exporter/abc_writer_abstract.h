@@ -53,6 +53,7 @@ class ABCAbstractWriter : public AbstractHierarchyWriter {
   explicit ABCAbstractWriter(const ABCWriterConstructorArgs &args);
   virtual ~ABCAbstractWriter();
 
+  virtual void prepare(HierarchyContext &context) override;
   virtual void write(HierarchyContext &context) override;
 
   /* Returns true if the data to be written is actually supported. This would, for example, allow a
@@ -84,6 +85,8 @@ class ABCAbstractWriter : public AbstractHierarchyWriter {
   virtual Alembic::Abc::OCompoundProperty abc_prop_for_custom_props() = 0;
 
  protected:
+  /* Called by prepare() when a frame is going to be written. Must not touch the archive. */
+  virtual void do_prepare(HierarchyContext &context);
   virtual void do_write(HierarchyContext &context) = 0;
 
   virtual void update_bounding_box(Object *object);
@@ -24,6 +24,7 @@
 
 #include "BLI_assert.h"
 #include "BLI_math_vector.h"
+#include "BLI_threads.h"
 
 #include "BKE_customdata.h"
 #include "BKE_lib_id.h"
@@ -83,8 +84,19 @@ static void get_loop_normals(struct Mesh *mesh,
                              std::vector<Imath::V3f> &normals,
                              bool has_flat_shaded_poly);
 
+/* Unlike clear(), this frees the memory of the vector. */
+template<typename T> static void release_vector(std::vector<T> &vector)
+{
+  std::vector<T>().swap(vector);
+}
+
 ABCGenericMeshWriter::ABCGenericMeshWriter(const ABCWriterConstructorArgs &args)
-    : ABCAbstractWriter(args), is_subd_(false)
+    : ABCAbstractWriter(args),
+      is_subd_(false),
+      is_prepared_(false),
+      prepared_mesh_(nullptr),
+      prepared_mesh_needsfree_(false),
+      has_flat_shaded_poly_(false)
 {
 }
 
@@ -115,6 +127,7 @@ void ABCGenericMeshWriter::create_alembic_objects(const HierarchyContext *contex
 
 ABCGenericMeshWriter::~ABCGenericMeshWriter()
 {
+  free_prepared_data();
 }
 
 Alembic::Abc::OObject ABCGenericMeshWriter::get_alembic_object() const
@@ -171,8 +184,11 @@ bool ABCGenericMeshWriter::is_supported(const HierarchyContext *context) const
   return true;
 }
 
-void ABCGenericMeshWriter::do_write(HierarchyContext &context)
+void ABCGenericMeshWriter::do_prepare(HierarchyContext &context)
 {
+  free_prepared_data();
+  is_prepared_ = true;
+
   Object *object = context.object;
   bool needsfree = false;
 
@@ -203,6 +219,44 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
     needsfree = true;
   }
 
+  prepared_mesh_ = mesh;
+  prepared_mesh_needsfree_ = needsfree;
+
+  get_vertices(mesh, points_);
+  get_topology(mesh, poly_verts_, loop_counts_, has_flat_shaded_poly_);
+
+  if (is_subd_) {
+    get_creases(mesh, crease_indices_, crease_lengths_, crease_sharpness_);
+    return;
+  }
+
+  if (args_.export_params->normals) {
+    /* Computing split normals adds a layer to the mesh, which may be shared with other objects
+     * that are prepared at the same time. */
+    ThreadMutex *mesh_eval_mutex = static_cast<ThreadMutex *>(mesh->runtime.eval_mutex);
+    BLI_mutex_lock(mesh_eval_mutex);
+    get_loop_normals(mesh, normals_, has_flat_shaded_poly_);
+    BLI_mutex_unlock(mesh_eval_mutex);
+  }
+
+  if (liquid_sim_modifier_ != nullptr) {
+    get_velocities(mesh, velocities_);
+  }
+}
+
+void ABCGenericMeshWriter::do_write(HierarchyContext &context)
+{
+  if (!is_prepared_) {
+    do_prepare(context);
+  }
+  is_prepared_ = false;
+
+  Mesh *mesh = prepared_mesh_;
+
+  if (mesh == nullptr) {
+    return;
+  }
+
   m_custom_data_config.pack_uvs = args_.export_params->packuv;
   m_custom_data_config.mpoly = mesh->mpoly;
   m_custom_data_config.mloop = mesh->mloop;
@@ -218,18 +272,33 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
       write_mesh(context, mesh);
     }
 
-    if (needsfree) {
-      free_export_mesh(mesh);
-    }
+    free_prepared_data();
   }
   catch (...) {
-    if (needsfree) {
-      free_export_mesh(mesh);
-    }
+    free_prepared_data();
     throw;
   }
 }
 
+void ABCGenericMeshWriter::free_prepared_data()
+{
+  if (prepared_mesh_ != nullptr && prepared_mesh_needsfree_) {
+    free_export_mesh(prepared_mesh_);
+  }
+  prepared_mesh_ = nullptr;
+  prepared_mesh_needsfree_ = false;
+
+  /* Release the memory as well, a writer keeps its arrays until the next frame otherwise. */
+  release_vector(points_);
+  release_vector(poly_verts_);
+  release_vector(loop_counts_);
+  release_vector(normals_);
+  release_vector(velocities_);
+  release_vector(crease_indices_);
+  release_vector(crease_lengths_);
+  release_vector(crease_sharpness_);
+}
+
 void ABCGenericMeshWriter::free_export_mesh(Mesh *mesh)
 {
   BKE_id_free(nullptr, mesh);
@@ -237,20 +306,12 @@ void ABCGenericMeshWriter::free_export_mesh(Mesh *mesh)
 
 void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
 {
-  std::vector<Imath::V3f> points, normals;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<Imath::V3f> velocities;
-  bool has_flat_shaded_poly = false;
-
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_shaded_poly);
-
   if (!frame_has_been_written_ && args_.export_params->face_sets) {
     write_face_sets(context.object, mesh, abc_poly_mesh_schema_);
   }
 
   OPolyMeshSchema::Sample mesh_sample = OPolyMeshSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+      V3fArraySample(points_), Int32ArraySample(poly_verts_), Int32ArraySample(loop_counts_));
 
   UVSample uvs_and_indices;
 
@@ -272,20 +333,17 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
   }
 
   if (args_.export_params->normals) {
-    get_loop_normals(mesh, normals, has_flat_shaded_poly);
-
     ON3fGeomParam::Sample normals_sample;
-    if (!normals.empty()) {
+    if (!normals_.empty()) {
       normals_sample.setScope(kFacevaryingScope);
-      normals_sample.setVals(V3fArraySample(normals));
+      normals_sample.setVals(V3fArraySample(normals_));
     }
 
     mesh_sample.setNormals(normals_sample);
   }
 
   if (liquid_sim_modifier_ != nullptr) {
-    get_velocities(mesh, velocities);
-    mesh_sample.setVelocities(V3fArraySample(velocities));
+    mesh_sample.setVelocities(V3fArraySample(velocities_));
   }
 
   update_bounding_box(context.object);
@@ -298,22 +356,12 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
 
 void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *mesh)
 {
-  std::vector<float> crease_sharpness;
-  std::vector<Imath::V3f> points;
-  std::vector<int32_t> poly_verts, loop_counts;
-  std::vector<int32_t> crease_indices, crease_lengths;
-  bool has_flat_poly = false;
-
-  get_vertices(mesh, points);
-  get_topology(mesh, poly_verts, loop_counts, has_flat_poly);
-  get_creases(mesh, crease_indices, crease_lengths, crease_sharpness);
-
   if (!frame_has_been_written_ && args_.export_params->face_sets) {
     write_face_sets(context.object, mesh, abc_subdiv_schema_);
   }
 
   OSubDSchema::Sample subdiv_sample = OSubDSchema::Sample(
-      V3fArraySample(points), Int32ArraySample(poly_verts), Int32ArraySample(loop_counts));
+      V3fArraySample(points_), Int32ArraySample(poly_verts_), Int32ArraySample(loop_counts_));
 
   UVSample sample;
   if (!frame_has_been_written_ && args_.export_params->uvs) {
@@ -333,10 +381,10 @@ void ABCGenericMeshWriter::write_subd(HierarchyContext &context, struct Mesh *me
         abc_subdiv_schema_.getArbGeomParams(), m_custom_data_config, &mesh->ldata, CD_MLOOPUV);
   }
 
-  if (!crease_indices.empty()) {
-    subdiv_sample.setCreaseIndices(Int32ArraySample(crease_indices));
-    subdiv_sample.setCreaseLengths(Int32ArraySample(crease_lengths));
-    subdiv_sample.setCreaseSharpnesses(FloatArraySample(crease_sharpness));
+  if (!crease_indices_.empty()) {
+    subdiv_sample.setCreaseIndices(Int32ArraySample(crease_indices_));
+    subdiv_sample.setCreaseLengths(Int32ArraySample(crease_lengths_));
+    subdiv_sample.setCreaseSharpnesses(FloatArraySample(crease_sharpness_));
   }
 
   update_bounding_box(context.object);
@@ -49,6 +49,20 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
 
   CDStreamConfig m_custom_data_config;
 
+  /* Mesh and arrays gathered by do_prepare(), written and released by do_write(). */
+  bool is_prepared_;
+  Mesh *prepared_mesh_;
+  bool prepared_mesh_needsfree_;
+  bool has_flat_shaded_poly_;
+  std::vector<Imath::V3f> points_;
+  std::vector<int32_t> poly_verts_;
+  std::vector<int32_t> loop_counts_;
+  std::vector<Imath::V3f> normals_;
+  std::vector<Imath::V3f> velocities_;
+  std::vector<int32_t> crease_indices_;
+  std::vector<int32_t> crease_lengths_;
+  std::vector<float> crease_sharpness_;
+
  public:
   explicit ABCGenericMeshWriter(const ABCWriterConstructorArgs &args);
   virtual ~ABCGenericMeshWriter();
@@ -59,6 +73,7 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
 
  protected:
   virtual bool is_supported(const HierarchyContext *context) const override;
+  virtual void do_prepare(HierarchyContext &context) override;
   virtual void do_write(HierarchyContext &context) override;
 
   virtual Mesh *get_export_mesh(Object *object_eval, bool &r_needsfree) = 0;
@@ -67,6 +82,7 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
   virtual bool export_as_subdivision_surface(Object *ob_eval) const;
 
  private:
+  void free_prepared_data();
   void write_mesh(HierarchyContext &context, Mesh *mesh);
   void write_subd(HierarchyContext &context, Mesh *mesh);
   template<typename Schema> void write_face_sets(Object *object, Mesh *mesh, Schema &schema);
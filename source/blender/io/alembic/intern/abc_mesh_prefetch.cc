@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup balembic
+ */
+
+#include "abc_mesh_prefetch.h"
+
+#include <cstdio>
+
+#include "DNA_modifier_types.h"
+
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_global.h"
+
+using Alembic::AbcGeom::IN3fGeomParam;
+using Alembic::AbcGeom::index_t;
+using Alembic::AbcGeom::IPolyMeshSchema;
+using Alembic::AbcGeom::ISampleSelector;
+using Alembic::AbcGeom::IV2fGeomParam;
+
+namespace blender::io::alembic {
+
+/* Number of samples read ahead of playback. */
+#define PREFETCH_SAMPLES 8
+/* Stop reading ahead when the cached samples of a mesh use this much memory. */
+#define PREFETCH_MEMORY_MAX ((size_t)256 * 1024 * 1024)
+/* Read flags which make a difference for the sample. */
+#define PREFETCH_READ_FLAGS (MOD_MESHSEQ_READ_POLY | MOD_MESHSEQ_READ_UV)
+
+template<typename ArraySamplePtr> static size_t array_memory_size(const ArraySamplePtr &array)
+{
+  return array ? array->size() * sizeof((*array)[0]) : 0;
+}
+
+size_t MeshSample::memory_size() const
+{
+  return array_memory_size(positions) + array_memory_size(face_indices) +
+         array_memory_size(face_counts) + array_memory_size(normals) + array_memory_size(uvs) +
+         array_memory_size(uvs_indices);
+}
+
+MeshSamplePrefetcher::MeshSamplePrefetcher(const IPolyMeshSchema &schema)
+    : m_schema(schema),
+      m_constant_topology(schema.valid() && schema.getTopologyVariance() !=
+                                                Alembic::AbcGeom::kHeterogenousTopology),
+      m_memory_size(0),
+      m_last_index(-1),
+      m_read_flag(0),
+      m_task_pool(nullptr),
+      m_hits(0),
+      m_misses(0)
+{
+}
+
+MeshSamplePrefetcher::~MeshSamplePrefetcher()
+{
+  if (m_task_pool != nullptr) {
+    BLI_task_pool_cancel(m_task_pool);
+    BLI_task_pool_free(m_task_pool);
+  }
+
+  if (G.debug & G_DEBUG_IO) {
+    printf("Alembic: prefetched samples of '%s': %d hits, %d misses\n",
+           m_schema.getObject().getFullName().c_str(),
+           m_hits,
+           m_misses);
+  }
+}
+
+index_t MeshSamplePrefetcher::index(const ISampleSelector &sample_sel) const
+{
+  return sample_sel.getIndex(m_schema.getTimeSampling(), m_schema.getNumSamples());
+}
+
+MeshSamplePtr MeshSamplePrefetcher::get(const index_t index,
+                                        int read_flag,
+                                        const bool is_playback)
+{
+  read_flag &= PREFETCH_READ_FLAGS;
+
+  MeshSamplePtr sample;
+  bool is_sequential = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_samples.find(index);
+    if (it != m_samples.end() && (it->second->read_flag & read_flag) == read_flag) {
+      sample = it->second;
+      m_hits++;
+    }
+    else {
+      m_misses++;
+    }
+
+    if (is_playback) {
+      is_sequential = (index == m_last_index + 1);
+      m_last_index = index;
+      m_read_flag = read_flag;
+      evict_before(index);
+    }
+    /* Extra samples and topology checks might not need normals or UVs, playback reaching the
+     * sample later on does. */
+    read_flag |= m_read_flag;
+  }
+
+  if (!sample) {
+    sample = read(index, read_flag);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index >= m_last_index) {
+      insert(index, sample);
+    }
+  }
+  /* Only read ahead during playback, not for scrubbing or a single import. */
+  if (is_sequential) {
+    prefetch_after(index);
+  }
+  return sample;
+}
+
+MeshSamplePtr MeshSamplePrefetcher::read(const index_t index, const int read_flag)
+{
+  const ISampleSelector sample_sel(index);
+  std::shared_ptr<MeshSample> sample = std::make_shared<MeshSample>();
+  sample->read_flag = read_flag;
+
+  m_schema.getPositionsProperty().get(sample->positions, sample_sel);
+
+  MeshSamplePtr topology;
+  if (m_constant_topology) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    topology = m_topology;
+  }
+  if (topology) {
+    sample->face_indices = topology->face_indices;
+    sample->face_counts = topology->face_counts;
+  }
+  else {
+    m_schema.getFaceIndicesProperty().get(sample->face_indices, sample_sel);
+    m_schema.getFaceCountsProperty().get(sample->face_counts, sample_sel);
+  }
+
+  const IN3fGeomParam &normals = m_schema.getNormalsParam();
+  if ((read_flag & MOD_MESHSEQ_READ_POLY) && normals.valid()) {
+    sample->normals = normals.getExpandedValue(sample_sel).getVals();
+  }
+
+  const IV2fGeomParam &uvs = m_schema.getUVsParam();
+  if ((read_flag & MOD_MESHSEQ_READ_UV) && uvs.valid()) {
+    IV2fGeomParam::Sample uvs_sample;
+    uvs.getIndexed(uvs_sample, sample_sel);
+    sample->uvs = uvs_sample.getVals();
+    sample->uvs_indices = uvs_sample.getIndices();
+  }
+
+  if (m_constant_topology && !topology) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_topology) {
+      m_topology = sample;
+    }
+  }
+
+  return sample;
+}
+
+/**
+ * Keep \a sample, replacing one read for fewer flags.
+ *
+ * \note Must be called with the mutex locked.
+ */
+void MeshSamplePrefetcher::insert(const index_t index, const MeshSamplePtr &sample)
+{
+  MeshSamplePtr &sample_cached = m_samples[index];
+  if (sample_cached) {
+    if ((sample_cached->read_flag & sample->read_flag) == sample->read_flag) {
+      return;
+    }
+    m_memory_size -= sample_cached->memory_size();
+  }
+  sample_cached = sample;
+  m_memory_size += sample->memory_size();
+}
+
+void MeshSamplePrefetcher::prefetch_after(const index_t index)
+{
+  const index_t num_samples = m_schema.getNumSamples();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_task_pool == nullptr) {
+    m_task_pool = BLI_task_pool_create_background(this, TASK_PRIORITY_LOW);
+  }
+
+  for (index_t i = index + 1; i <= index + PREFETCH_SAMPLES && i < num_samples; i++) {
+    if (m_memory_size >= PREFETCH_MEMORY_MAX) {
+      break;
+    }
+    if (m_samples.count(i) || m_pending.count(i)) {
+      continue;
+    }
+    m_pending.insert(i);
+    BLI_task_pool_push(m_task_pool, prefetch_task, POINTER_FROM_INT((int)i), false, nullptr);
+  }
+}
+
+/**
+ * \note Must be called with the mutex locked.
+ */
+void MeshSamplePrefetcher::evict_before(const index_t index)
+{
+  while (!m_samples.empty() && m_samples.begin()->first < index) {
+    m_memory_size -= m_samples.begin()->second->memory_size();
+    m_samples.erase(m_samples.begin());
+  }
+}
+
+void MeshSamplePrefetcher::prefetch_task(TaskPool *__restrict pool, void *taskdata)
+{
+  MeshSamplePrefetcher *prefetcher = static_cast<MeshSamplePrefetcher *>(
+      BLI_task_pool_user_data(pool));
+  const index_t index = POINTER_AS_INT(taskdata);
+
+  MeshSamplePtr sample;
+  if (!BLI_task_pool_canceled(pool)) {
+    int read_flag;
+    {
+      std::lock_guard<std::mutex> lock(prefetcher->m_mutex);
+      read_flag = prefetcher->m_read_flag;
+    }
+    try {
+      sample = prefetcher->read(index, read_flag);
+    }
+    catch (Alembic::Util::Exception & /*ex*/) {
+      /* Reported when the sample is read for playback. */
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(prefetcher->m_mutex);
+  prefetcher->m_pending.erase(index);
+  /* Playback may have moved past this sample in the meantime. */
+  if (sample && index > prefetcher->m_last_index) {
+    prefetcher->insert(index, sample);
+  }
+}
+
+}  // namespace blender::io::alembic
@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#pragma once
+
+/** \file
+ * \ingroup balembic
+ */
+
+#include <Alembic/AbcGeom/All.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+struct TaskPool;
+
+namespace blender::io::alembic {
+
+/** The arrays of one mesh sample, as read from the archive. */
+struct MeshSample {
+  Alembic::AbcGeom::P3fArraySamplePtr positions;
+  Alembic::AbcGeom::Int32ArraySamplePtr face_indices;
+  Alembic::AbcGeom::Int32ArraySamplePtr face_counts;
+
+  /* Only set when the schema has valid normals or UVs, and they were requested. */
+  Alembic::AbcGeom::N3fArraySamplePtr normals;
+  Alembic::AbcGeom::V2fArraySamplePtr uvs;
+  Alembic::AbcGeom::UInt32ArraySamplePtr uvs_indices;
+
+  /* The #MOD_MESHSEQ_READ_POLY and #MOD_MESHSEQ_READ_UV flags the sample was read for: normals
+   * are only used for polygons. */
+  int read_flag;
+
+  size_t memory_size() const;
+};
+
+using MeshSamplePtr = std::shared_ptr<const MeshSample>;
+
+/**
+ * Reads mesh samples, and once playback moves forward one sample at a time, reads the samples
+ * following it on worker threads. Playing back a heavy cache then only waits for the archive on
+ * a miss.
+ *
+ * When the topology of the schema doesn't change over time, only the first sample reads the face
+ * arrays, the others share them. Samples read on a miss are kept as well, so checking the
+ * topology and reading the mesh of a frame only read the sample once.
+ */
+class MeshSamplePrefetcher {
+  Alembic::AbcGeom::IPolyMeshSchema m_schema;
+  bool m_constant_topology;
+
+  std::mutex m_mutex;
+  std::map<Alembic::AbcGeom::index_t, MeshSamplePtr> m_samples;
+  std::set<Alembic::AbcGeom::index_t> m_pending;
+  MeshSamplePtr m_topology;
+  size_t m_memory_size;
+  Alembic::AbcGeom::index_t m_last_index;
+  /* Flags of the samples read for playback, also used for reading ahead. */
+  int m_read_flag;
+
+  TaskPool *m_task_pool;
+
+  int m_hits;
+  int m_misses;
+
+ public:
+  explicit MeshSamplePrefetcher(const Alembic::AbcGeom::IPolyMeshSchema &schema);
+  ~MeshSamplePrefetcher();
+
+  MeshSamplePrefetcher(const MeshSamplePrefetcher &other) = delete;
+  MeshSamplePrefetcher &operator=(const MeshSamplePrefetcher &other) = delete;
+
+  /** Sample index for the given selector, as used by #get. */
+  Alembic::AbcGeom::index_t index(const Alembic::Abc::ISampleSelector &sample_sel) const;
+
+  /**
+   * The sample at \a index, read now if it wasn't prefetched. Normals and UVs are only read when
+   * \a read_flag asks for them, see #MeshSample.read_flag. \a is_playback is false for extra
+   * samples, like the one interpolated towards, and topology checks, which shouldn't affect
+   * reading ahead.
+   * Throws like the Alembic API when the sample can't be read.
+   */
+  MeshSamplePtr get(Alembic::AbcGeom::index_t index, int read_flag, bool is_playback = true);
+
+  int hits() const
+  {
+    return m_hits;
+  }
+  int misses() const
+  {
+    return m_misses;
+  }
+
+ private:
+  MeshSamplePtr read(Alembic::AbcGeom::index_t index, int read_flag);
+  void insert(Alembic::AbcGeom::index_t index, const MeshSamplePtr &sample);
+  void prefetch_after(Alembic::AbcGeom::index_t index);
+  void evict_before(Alembic::AbcGeom::index_t index);
+
+  static void prefetch_task(TaskPool *__restrict pool, void *taskdata);
+};
+
+}  // namespace blender::io::alembic
@@ -48,6 +48,7 @@ using Alembic::Abc::PropertyHeader;
 
 using Alembic::AbcGeom::IC3fGeomParam;
 using Alembic::AbcGeom::IC4fGeomParam;
+using Alembic::AbcGeom::index_t;
 using Alembic::AbcGeom::IFaceSet;
 using Alembic::AbcGeom::IFaceSetSchema;
 using Alembic::AbcGeom::IN3fGeomParam;
@@ -319,23 +320,22 @@ static void process_vertex_normals(CDStreamConfig &config,
 
 static void process_normals(CDStreamConfig &config,
                             const IN3fGeomParam &normals,
-                            const ISampleSelector &selector)
+                            const N3fArraySamplePtr &normals_vals)
 {
-  if (!normals.valid()) {
+  if (!normals.valid() || !normals_vals) {
     process_no_normals(config);
     return;
   }
 
-  IN3fGeomParam::Sample normsamp = normals.getExpandedValue(selector);
   Alembic::AbcGeom::GeometryScope scope = normals.getScope();
 
   switch (scope) {
     case Alembic::AbcGeom::kFacevaryingScope: /* 'Vertex Normals' in Houdini. */
-      process_loop_normals(config, normsamp.getVals());
+      process_loop_normals(config, normals_vals);
       break;
     case Alembic::AbcGeom::kVertexScope:
     case Alembic::AbcGeom::kVaryingScope: /* 'Point Normals' in Houdini. */
-      process_vertex_normals(config, normsamp.getVals());
+      process_vertex_normals(config, normals_vals);
       break;
     case Alembic::AbcGeom::kConstantScope:
     case Alembic::AbcGeom::kUniformScope:
@@ -348,17 +348,15 @@ static void process_normals(CDStreamConfig &config,
 BLI_INLINE void read_uvs_params(CDStreamConfig &config,
                                 AbcMeshData &abc_data,
                                 const IV2fGeomParam &uv,
-                                const ISampleSelector &selector)
+                                const V2fArraySamplePtr &uvs,
+                                const UInt32ArraySamplePtr &uvs_indices)
 {
-  if (!uv.valid()) {
+  if (!uv.valid() || !uvs || !uvs_indices) {
     return;
   }
 
-  IV2fGeomParam::Sample uvsamp;
-  uv.getIndexed(uvsamp, selector);
-
-  abc_data.uvs = uvsamp.getVals();
-  abc_data.uvs_indices = uvsamp.getIndices();
+  abc_data.uvs = uvs;
+  abc_data.uvs_indices = uvs_indices;
 
   if (abc_data.uvs_indices->size() == config.totloop) {
     std::string name = Alembic::Abc::GetSourceName(uv.getMetaData());
@@ -375,6 +373,20 @@ BLI_INLINE void read_uvs_params(CDStreamConfig &config,
   }
 }
 
+BLI_INLINE void read_uvs_params(CDStreamConfig &config,
+                                AbcMeshData &abc_data,
+                                const IV2fGeomParam &uv,
+                                const ISampleSelector &selector)
+{
+  if (!uv.valid()) {
+    return;
+  }
+
+  IV2fGeomParam::Sample uvsamp;
+  uv.getIndexed(uvsamp, selector);
+  read_uvs_params(config, abc_data, uv, uvsamp.getVals(), uvsamp.getIndices());
+}
+
 static void *add_customdata_cb(Mesh *mesh, const char *name, int data_type)
 {
   CustomDataType cd_data_type = static_cast<CustomDataType>(data_type);
@@ -415,26 +427,26 @@ static void get_weight_and_index(CDStreamConfig &config,
 static void read_mesh_sample(const std::string &iobject_full_name,
                              ImportSettings *settings,
                              const IPolyMeshSchema &schema,
+                             MeshSamplePrefetcher &prefetcher,
+                             const MeshSample &sample,
                              const ISampleSelector &selector,
                              CDStreamConfig &config)
 {
-  const IPolyMeshSchema::Sample sample = schema.getValue(selector);
-
   AbcMeshData abc_mesh_data;
-  abc_mesh_data.face_counts = sample.getFaceCounts();
-  abc_mesh_data.face_indices = sample.getFaceIndices();
-  abc_mesh_data.positions = sample.getPositions();
+  abc_mesh_data.face_counts = sample.face_counts;
+  abc_mesh_data.face_indices = sample.face_indices;
+  abc_mesh_data.positions = sample.positions;
 
   get_weight_and_index(config, schema.getTimeSampling(), schema.getNumSamples());
 
   if (config.weight != 0.0f) {
-    Alembic::AbcGeom::IPolyMeshSchema::Sample ceil_sample;
-    schema.get(ceil_sample, Alembic::Abc::ISampleSelector(config.ceil_index));
-    abc_mesh_data.ceil_positions = ceil_sample.getPositions();
+    MeshSamplePtr ceil_sample = prefetcher.get(config.ceil_index, 0, false);
+    abc_mesh_data.ceil_positions = ceil_sample->positions;
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_UV) != 0) {
-    read_uvs_params(config, abc_mesh_data, schema.getUVsParam(), selector);
+    read_uvs_params(
+        config, abc_mesh_data, schema.getUVsParam(), sample.uvs, sample.uvs_indices);
   }
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_VERT) != 0) {
@@ -443,7 +455,7 @@ static void read_mesh_sample(const std::string &iobject_full_name,
 
   if ((settings->read_flag & MOD_MESHSEQ_READ_POLY) != 0) {
     read_mpolys(config, abc_mesh_data);
-    process_normals(config, schema.getNormalsParam(), selector);
+    process_normals(config, schema.getNormalsParam(), sample.normals);
   }
 
   if ((settings->read_flag & (MOD_MESHSEQ_READ_UV | MOD_MESHSEQ_READ_COLOR)) != 0) {
@@ -479,6 +491,7 @@ AbcMeshReader::AbcMeshReader(const IObject &object, ImportSettings &settings)
 
   IPolyMesh ipoly_mesh(m_iobject, kWrapExisting);
   m_schema = ipoly_mesh.getSchema();
+  m_prefetcher = std::make_unique<MeshSamplePrefetcher>(m_schema);
 
   get_min_max_time(m_iobject, m_schema, m_min_time, m_max_time);
 }
@@ -593,11 +606,18 @@ bool AbcMeshReader::accepts_object_type(
   return true;
 }
 
+static bool sample_topology_changed(const MeshSample &sample, const Mesh *existing_mesh)
+{
+  return sample.positions->size() != existing_mesh->totvert ||
+         sample.face_counts->size() != existing_mesh->totpoly ||
+         sample.face_indices->size() != existing_mesh->totloop;
+}
+
 bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector &sample_sel)
 {
-  IPolyMeshSchema::Sample sample;
+  MeshSamplePtr sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    sample = m_prefetcher->get(m_prefetcher->index(sample_sel), 0, false);
   }
   catch (Alembic::Util::Exception &ex) {
     printf("Alembic: error reading mesh sample for '%s/%s' at time %f: %s\n",
@@ -609,13 +629,7 @@ bool AbcMeshReader::topology_changed(Mesh *existing_mesh, const ISampleSelector
     return false;
   }
 
-  const P3fArraySamplePtr &positions = sample.getPositions();
-  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
-  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
-
-  return positions->size() != existing_mesh->totvert ||
-         face_counts->size() != existing_mesh->totpoly ||
-         face_indices->size() != existing_mesh->totloop;
+  return sample_topology_changed(*sample, existing_mesh);
 }
 
 Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
@@ -623,9 +637,14 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
                                int read_flag,
                                const char **err_str)
 {
-  IPolyMeshSchema::Sample sample;
+  const index_t index = m_prefetcher->index(sample_sel);
+  MeshSamplePtr sample;
   try {
-    sample = m_schema.getValue(sample_sel);
+    sample = m_prefetcher->get(index, read_flag);
+    /* A new mesh is created from all data, including normals and UVs. */
+    if (sample_topology_changed(*sample, existing_mesh)) {
+      sample = m_prefetcher->get(index, MOD_MESHSEQ_READ_ALL, false);
+    }
   }
   catch (Alembic::Util::Exception &ex) {
     if (err_str != nullptr) {
@@ -639,9 +658,9 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
     return existing_mesh;
   }
 
-  const P3fArraySamplePtr &positions = sample.getPositions();
-  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample.getFaceIndices();
-  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample.getFaceCounts();
+  const P3fArraySamplePtr &positions = sample->positions;
+  const Alembic::Abc::Int32ArraySamplePtr &face_indices = sample->face_indices;
+  const Alembic::Abc::Int32ArraySamplePtr &face_counts = sample->face_counts;
 
   /* Do some very minimal mesh validation. */
   const int poly_count = face_counts->size();
@@ -664,7 +683,7 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   ImportSettings settings;
   settings.read_flag |= read_flag;
 
-  if (topology_changed(existing_mesh, sample_sel)) {
+  if (sample_topology_changed(*sample, existing_mesh)) {
     new_mesh = BKE_mesh_new_nomain_from_template(
         existing_mesh, positions->size(), 0, 0, face_indices->size(), face_counts->size());
 
@@ -692,7 +711,8 @@ Mesh *AbcMeshReader::read_mesh(Mesh *existing_mesh,
   config.time = sample_sel.getRequestedTime();
   config.modifier_error_message = err_str;
 
-  read_mesh_sample(m_iobject.getFullName(), &settings, m_schema, sample_sel, config);
+  read_mesh_sample(
+      m_iobject.getFullName(), &settings, m_schema, *m_prefetcher, *sample, sample_sel, config);
 
   if (new_mesh) {
     /* Here we assume that the number of materials doesn't change, i.e. that
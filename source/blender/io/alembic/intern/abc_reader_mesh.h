@@ -20,14 +20,18 @@
  */
 
 #include "abc_customdata.h"
+#include "abc_mesh_prefetch.h"
 #include "abc_reader_object.h"
 
+#include <memory>
+
 struct Mesh;
 
 namespace blender::io::alembic {
 
 class AbcMeshReader : public AbcObjectReader {
   Alembic::AbcGeom::IPolyMeshSchema m_schema;
+  std::unique_ptr<MeshSamplePrefetcher> m_prefetcher;
 
   CDStreamConfig m_mesh_data;
 
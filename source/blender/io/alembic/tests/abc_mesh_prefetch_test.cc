@@ -0,0 +1,130 @@
+#include "testing/testing.h"
+
+/* Keep first since utildefines defines AT which conflicts with STL */
+#include "intern/abc_mesh_prefetch.h"
+
+#include <Alembic/AbcCoreOgawa/All.h>
+
+#include "BLI_fileops.h"
+
+#include "DNA_modifier_types.h"
+
+using namespace Alembic::AbcGeom;
+
+namespace blender::io::alembic {
+
+class AlembicMeshPrefetchTest : public testing::Test {
+ protected:
+  const char *filepath = "prefetch_test.abc";
+  const int num_samples = 4;
+
+  IArchive archive;
+  IPolyMeshSchema schema;
+
+  void SetUp() override
+  {
+    write_archive();
+    archive = IArchive(Alembic::AbcCoreOgawa::ReadArchive(), filepath);
+    schema = IPolyMesh(archive.getTop(), "quad").getSchema();
+  }
+
+  void TearDown() override
+  {
+    schema.reset();
+    archive.reset();
+    BLI_delete(filepath, false, false);
+  }
+
+  /* A quad with normals and UVs, sample i is at height i. */
+  void write_archive()
+  {
+    OArchive archive_out(Alembic::AbcCoreOgawa::WriteArchive(), filepath);
+    OPolyMesh mesh(OObject(archive_out, kTop), "quad");
+    OPolyMeshSchema &schema_out = mesh.getSchema();
+
+    const int32_t face_indices[4] = {0, 1, 2, 3};
+    const int32_t face_counts[1] = {4};
+    const V2f uvs[4] = {V2f(0, 0), V2f(1, 0), V2f(1, 1), V2f(0, 1)};
+    const N3f normals[4] = {N3f(0, 0, 1), N3f(0, 0, 1), N3f(0, 0, 1), N3f(0, 0, 1)};
+    for (int i = 0; i < num_samples; i++) {
+      const float z = (float)i;
+      const V3f positions[4] = {V3f(0, 0, z), V3f(1, 0, z), V3f(1, 1, z), V3f(0, 1, z)};
+      OV2fGeomParam::Sample uvs_sample(V2fArraySample(uvs, 4), kFacevaryingScope);
+      ON3fGeomParam::Sample normals_sample(N3fArraySample(normals, 4), kFacevaryingScope);
+      OPolyMeshSchema::Sample sample(P3fArraySample(positions, 4),
+                                     Int32ArraySample(face_indices, 4),
+                                     Int32ArraySample(face_counts, 1),
+                                     uvs_sample,
+                                     normals_sample);
+      schema_out.set(sample);
+    }
+  }
+};
+
+TEST_F(AlembicMeshPrefetchTest, ReadFlags)
+{
+  MeshSamplePrefetcher prefetcher(schema);
+
+  MeshSamplePtr sample = prefetcher.get(0, MOD_MESHSEQ_READ_VERT, false);
+  ASSERT_NE(sample, nullptr);
+  EXPECT_EQ(sample->positions->size(), 4u);
+  EXPECT_EQ(sample->normals, nullptr);
+  EXPECT_EQ(sample->uvs, nullptr);
+
+  /* Asking for more data reads the sample again. */
+  sample = prefetcher.get(0, MOD_MESHSEQ_READ_VERT | MOD_MESHSEQ_READ_UV, false);
+  ASSERT_NE(sample->uvs, nullptr);
+  EXPECT_EQ(sample->uvs->size(), 4u);
+  EXPECT_EQ(sample->normals, nullptr);
+
+  sample = prefetcher.get(0, MOD_MESHSEQ_READ_ALL, false);
+  ASSERT_NE(sample->normals, nullptr);
+  EXPECT_EQ(sample->normals->size(), 4u);
+  EXPECT_EQ(prefetcher.misses(), 3);
+
+  /* Less data is taken from the sample read for more. */
+  EXPECT_EQ(prefetcher.get(0, MOD_MESHSEQ_READ_UV, false), sample);
+  EXPECT_EQ(prefetcher.hits(), 1);
+}
+
+TEST_F(AlembicMeshPrefetchTest, MissIsKept)
+{
+  MeshSamplePrefetcher prefetcher(schema);
+
+  MeshSamplePtr sample = prefetcher.get(2, MOD_MESHSEQ_READ_ALL);
+  ASSERT_NE(sample, nullptr);
+  EXPECT_FLOAT_EQ((*sample->positions)[0].z, 2.0f);
+
+  /* Checking the topology and reading the mesh of a frame only reads the sample once. */
+  EXPECT_EQ(prefetcher.get(2, 0, false), sample);
+  EXPECT_EQ(prefetcher.get(2, MOD_MESHSEQ_READ_ALL), sample);
+  EXPECT_EQ(prefetcher.hits(), 2);
+  EXPECT_EQ(prefetcher.misses(), 1);
+}
+
+TEST_F(AlembicMeshPrefetchTest, Playback)
+{
+  MeshSamplePrefetcher prefetcher(schema);
+
+  MeshSamplePtr first_sample;
+  for (int i = 0; i < num_samples; i++) {
+    /* Prefetched or not, every sample is the one asked for. */
+    MeshSamplePtr sample = prefetcher.get(i, MOD_MESHSEQ_READ_ALL);
+    ASSERT_NE(sample, nullptr);
+    EXPECT_FLOAT_EQ((*sample->positions)[0].z, (float)i);
+    ASSERT_NE(sample->uvs, nullptr);
+    ASSERT_NE(sample->normals, nullptr);
+    EXPECT_EQ(prefetcher.hits() + prefetcher.misses(), i + 1);
+
+    /* The topology doesn't change, the face arrays are shared. */
+    if (i == 0) {
+      first_sample = sample;
+    }
+    else {
+      EXPECT_EQ(sample->face_indices, first_sample->face_indices);
+      EXPECT_EQ(sample->face_counts, first_sample->face_counts);
+    }
+  }
+}
+
+}  // namespace blender::io::alembic
@@ -42,6 +42,8 @@
 #include <map>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 struct Base;
 struct Depsgraph;
@@ -126,6 +128,13 @@ struct HierarchyContext {
 class AbstractHierarchyWriter {
  public:
   virtual ~AbstractHierarchyWriter();
+
+  /* Gather the data that write() will write, without touching the exported file yet. Always
+   * called right before write() with the same context. When the iterator prepares in parallel,
+   * this runs on a worker thread concurrently with the prepare() of other writers, so it may only
+   * read the evaluated depsgraph and store its results in the writer itself.
+   * The default implementation does nothing, leaving all work to write(). */
+  virtual void prepare(HierarchyContext &context);
   virtual void write(HierarchyContext &context) = 0;
   /* TODO(Sybren): add function like absent() that's called when a writer was previously created,
    * but wasn't used while exporting the current frame (for example, a particle-instanced mesh of
@@ -168,6 +177,7 @@ class EnsuredWriter {
   static EnsuredWriter newly_created(AbstractHierarchyWriter *writer);
 
   bool is_newly_created() const;
+  AbstractHierarchyWriter *get() const;
 
   /* These operators make an EnsuredWriter* act as an AbstractHierarchyWriter* */
   operator bool() const;
@@ -222,6 +232,14 @@ class AbstractHierarchyIterator {
    * instanced datablock, the export path of the original can be looked up. */
   typedef std::map<ID *, std::string> ExportPathMap;
 
+  /* Time spent in each phase of iterate_and_write(), in seconds, summed over all iterations. */
+  struct WriteTimings {
+    double iterate;
+    double prepare;
+    double write;
+    int num_writes;
+  };
+
  protected:
   ExportGraph export_graph_;
   ExportPathMap duplisource_export_path_;
@@ -229,6 +247,12 @@ class AbstractHierarchyIterator {
   WriterMap writers_;
   ExportSubset export_subset_;
 
+  /* Writers that should write in the current iteration, in the order of the export hierarchy,
+   * together with the context to write. */
+  std::vector<std::pair<AbstractHierarchyWriter *, HierarchyContext>> queued_writes_;
+  bool parallel_prepare_;
+  WriteTimings write_timings_;
+
  public:
   explicit AbstractHierarchyIterator(Depsgraph *depsgraph);
   virtual ~AbstractHierarchyIterator();
@@ -250,6 +274,17 @@ class AbstractHierarchyIterator {
    * previous iteration. */
   void set_export_subset(ExportSubset export_subset_);
 
+  /* When enabled, the prepare() step of the writers of an iteration runs in parallel, in batches
+   * of a few writers per thread. The write() calls of a batch happen afterwards, one by one in the
+   * order of the export hierarchy, so the exported file is the same either way. Disabled by
+   * default. */
+  void set_parallel_prepare(bool parallel_prepare);
+
+  const WriteTimings &write_timings() const;
+  /* Print the write timings, prefixed with the name of the file format. Only when I/O debugging
+   * is enabled. */
+  void debug_print_write_timings(const char *format_name) const;
+
   /* Convert the given name to something that is valid for the exported file format.
    * This base implementation is a no-op; override in a concrete subclass. */
   virtual std::string make_valid_name(const std::string &name) const;
@@ -284,11 +319,15 @@ class AbstractHierarchyIterator {
   void determine_duplication_references(const HierarchyContext *parent_context,
                                         std::string indent);
 
-  /* These three functions create writers and call their write() method. */
+  /* These three functions create writers and queue them for writing. */
   void make_writers(const HierarchyContext *parent_context);
   void make_writer_object_data(const HierarchyContext *context);
   void make_writers_particle_systems(const HierarchyContext *context);
 
+  void queue_write(AbstractHierarchyWriter *writer, const HierarchyContext &context);
+  /* Prepare and write all queued writers, then clear the queue. */
+  void write_queued();
+
   /* Return the appropriate HierarchyContext for the data of the object represented by
    * object_context. */
   HierarchyContext context_for_object_data(const HierarchyContext *object_context) const;
@@ -19,6 +19,7 @@
 #include "IO_abstract_hierarchy_iterator.h"
 #include "dupli_parent_finder.hh"
 
+#include <algorithm>
 #include <climits>
 #include <cstdio>
 #include <iostream>
@@ -27,6 +28,7 @@
 
 #include "BKE_anim_data.h"
 #include "BKE_duplilist.h"
+#include "BKE_global.h"
 #include "BKE_key.h"
 #include "BKE_object.h"
 #include "BKE_particle.h"
@@ -34,6 +36,8 @@
 #include "BLI_assert.h"
 #include "BLI_listbase.h"
 #include "BLI_math_matrix.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "DNA_ID.h"
 #include "DNA_layer_types.h"
@@ -44,6 +48,8 @@
 
 #include "DEG_depsgraph_query.h"
 
+#include "PIL_time.h"
+
 namespace blender::io {
 
 const HierarchyContext *HierarchyContext::root()
@@ -127,6 +133,11 @@ bool EnsuredWriter::is_newly_created() const
   return newly_created_;
 }
 
+AbstractHierarchyWriter *EnsuredWriter::get() const
+{
+  return writer_;
+}
+
 EnsuredWriter::operator bool() const
 {
   return writer_ != nullptr;
@@ -141,6 +152,10 @@ AbstractHierarchyWriter::~AbstractHierarchyWriter()
 {
 }
 
+void AbstractHierarchyWriter::prepare(HierarchyContext & /*context*/)
+{
+}
+
 bool AbstractHierarchyWriter::check_is_animated(const HierarchyContext &context) const
 {
   const Object *object = context.object;
@@ -182,7 +197,10 @@ bool AbstractHierarchyWriter::check_has_deforming_physics(const HierarchyContext
 }
 
 AbstractHierarchyIterator::AbstractHierarchyIterator(Depsgraph *depsgraph)
-    : depsgraph_(depsgraph), export_subset_({true, true})
+    : depsgraph_(depsgraph),
+      export_subset_({true, true}),
+      parallel_prepare_(false),
+      write_timings_({0.0, 0.0, 0.0, 0})
 {
 }
 
@@ -198,12 +216,17 @@ AbstractHierarchyIterator::~AbstractHierarchyIterator()
 
 void AbstractHierarchyIterator::iterate_and_write()
 {
+  const double time_start = PIL_check_seconds_timer();
+
   export_graph_construct();
   connect_loose_objects();
   export_graph_prune();
   determine_export_paths(HierarchyContext::root());
   determine_duplication_references(HierarchyContext::root(), "");
   make_writers(HierarchyContext::root());
+  write_timings_.iterate += PIL_check_seconds_timer() - time_start;
+
+  write_queued();
   export_graph_clear();
 }
 
@@ -220,6 +243,30 @@ void AbstractHierarchyIterator::set_export_subset(ExportSubset export_subset)
   export_subset_ = export_subset;
 }
 
+void AbstractHierarchyIterator::set_parallel_prepare(const bool parallel_prepare)
+{
+  parallel_prepare_ = parallel_prepare;
+}
+
+const AbstractHierarchyIterator::WriteTimings &AbstractHierarchyIterator::write_timings() const
+{
+  return write_timings_;
+}
+
+void AbstractHierarchyIterator::debug_print_write_timings(const char *format_name) const
+{
+  if ((G.debug & G_DEBUG_IO) == 0) {
+    return;
+  }
+  printf("%s export: %d writes, iterating %.3f s, preparing %.3f s%s, writing %.3f s\n",
+         format_name,
+         write_timings_.num_writes,
+         write_timings_.iterate,
+         write_timings_.prepare,
+         parallel_prepare_ ? " (in parallel)" : "",
+         write_timings_.write);
+}
+
 std::string AbstractHierarchyIterator::make_valid_name(const std::string &name) const
 {
   return name;
@@ -609,7 +656,7 @@ void AbstractHierarchyIterator::make_writers(const HierarchyContext *parent_cont
       /* XXX This can lead to too many XForms being written. For example, a camera writer can
        * refuse to write an orthographic camera. By the time that this is known, the XForm has
        * already been written. */
-      transform_writer->write(*context);
+      queue_write(transform_writer.get(), *context);
     }
 
     if (!context->weak_export) {
@@ -625,6 +672,60 @@ void AbstractHierarchyIterator::make_writers(const HierarchyContext *parent_cont
    */
 }
 
+void AbstractHierarchyIterator::queue_write(AbstractHierarchyWriter *writer,
+                                            const HierarchyContext &context)
+{
+  queued_writes_.emplace_back(writer, context);
+}
+
+static void prepare_queued_write_cb(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict /*tls*/)
+{
+  auto &queued_writes =
+      *static_cast<std::vector<std::pair<AbstractHierarchyWriter *, HierarchyContext>> *>(
+          userdata);
+  queued_writes[index].first->prepare(queued_writes[index].second);
+}
+
+void AbstractHierarchyIterator::write_queued()
+{
+  /* Prepared writers keep their data until it is written, so only prepare a few at a time to
+   * bound the memory use. Serial preparation writes each writer right away. */
+  const int num_queued = (int)queued_writes_.size();
+  const int batch_size = parallel_prepare_ ? BLI_system_thread_count() * 4 : 1;
+
+  /* Each writer typically handles a whole object, so hand them out one by one. */
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = parallel_prepare_;
+  settings.min_iter_per_thread = 1;
+
+  for (int batch_start = 0; batch_start < num_queued; batch_start += batch_size) {
+    const int batch_end = std::min(batch_start + batch_size, num_queued);
+    const double time_start = PIL_check_seconds_timer();
+
+    BLI_task_parallel_range(
+        batch_start, batch_end, &queued_writes_, prepare_queued_write_cb, &settings);
+
+    const double time_prepared = PIL_check_seconds_timer();
+
+    /* Writing to the file is not thread-safe, and is done in hierarchy order so that the output
+     * doesn't depend on scheduling. */
+    for (int index = batch_start; index < batch_end; index++) {
+      queued_writes_[index].first->write(queued_writes_[index].second);
+    }
+
+    const double time_end = PIL_check_seconds_timer();
+
+    write_timings_.prepare += time_prepared - time_start;
+    write_timings_.write += time_end - time_prepared;
+  }
+
+  write_timings_.num_writes += num_queued;
+  queued_writes_.clear();
+}
+
 HierarchyContext AbstractHierarchyIterator::context_for_object_data(
     const HierarchyContext *object_context) const
 {
@@ -659,7 +760,7 @@ void AbstractHierarchyIterator::make_writer_object_data(const HierarchyContext *
   }
 
   if (data_writer.is_newly_created() || export_subset_.shapes) {
-    data_writer->write(data_context);
+    queue_write(data_writer.get(), data_context);
   }
 }
 
@@ -695,7 +796,7 @@ void AbstractHierarchyIterator::make_writers_particle_systems(
 
     /* Always write upon creation, otherwise depend on which subset is active. */
     if (writer.is_newly_created() || export_subset_.shapes) {
-      writer->write(hair_context);
+      queue_write(writer.get(), hair_context);
     }
   }
 }
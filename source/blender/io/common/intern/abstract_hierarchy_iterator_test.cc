@@ -42,15 +42,27 @@ class TestHierarchyWriter : public AbstractHierarchyWriter {
  public:
   std::string writer_type;
   used_writers &writers_map;
+  std::string prepared_export_path;
 
   TestHierarchyWriter(const std::string &writer_type, used_writers &writers_map)
       : writer_type(writer_type), writers_map(writers_map)
   {
   }
 
+  void prepare(HierarchyContext &context) override
+  {
+    prepared_export_path = context.export_path;
+  }
+
   void write(HierarchyContext &context) override
   {
     const char *id_name = context.object->id.name;
+
+    if (prepared_export_path != context.export_path) {
+      ADD_FAILURE() << "Expected " << writer_type << " writer for " << id_name
+                    << " to be prepared for " << context.export_path;
+    }
+    prepared_export_path.clear();
     used_writers::mapped_type &writers = writers_map[id_name];
 
     if (writers.find(context.export_path) != writers.end()) {
@@ -321,6 +333,30 @@ TEST_F(AbstractHierarchyIteratorTest, ExportSubsetTest)
   EXPECT_EQ(expected_data, iterator->data_writers);
 }
 
+TEST_F(AbstractHierarchyIteratorTest, ParallelPrepareTest)
+{
+  /* Load the test blend file. */
+  if (!blendfile_load("usd/usd_hierarchy_export_test.blend")) {
+    return;
+  }
+  depsgraph_create(DAG_EVAL_RENDER);
+
+  iterator_create();
+  iterator->iterate_and_write();
+  const used_writers expected_transforms = iterator->transform_writers;
+  const used_writers expected_data = iterator->data_writers;
+  const int expected_num_writes = iterator->write_timings().num_writes;
+  iterator_free();
+
+  /* Preparing the writers in parallel should not change what is written. */
+  iterator_create();
+  iterator->set_parallel_prepare(true);
+  iterator->iterate_and_write();
+  EXPECT_EQ(expected_transforms, iterator->transform_writers);
+  EXPECT_EQ(expected_data, iterator->data_writers);
+  EXPECT_EQ(expected_num_writes, iterator->write_timings().num_writes);
+}
+
 /* Test class that constructs a depsgraph in such a way that it includes invisible objects. */
 class AbstractHierarchyIteratorInvisibleTest : public AbstractHierarchyIteratorTest {
  protected:
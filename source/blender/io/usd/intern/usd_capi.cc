@@ -128,6 +128,7 @@ static void export_startjob(void *customdata,
   }
 
   USDHierarchyIterator iter(data->depsgraph, usd_stage, data->params);
+  iter.set_parallel_prepare(true);
 
   if (data->params.export_animation) {
     /* Writing the animated frames is not 100% of the work, but it's our best guess. */
@@ -156,6 +157,7 @@ static void export_startjob(void *customdata,
   }
 
   iter.release_writers();
+  iter.debug_print_write_timings("USD");
   usd_stage->GetRootLayer()->Save();
 
   /* Finish up by going back to the keyframe that was current before we started. */
@@ -61,6 +61,19 @@ pxr::UsdTimeCode USDAbstractWriter::get_export_time_code() const
   return default_timecode;
 }
 
+void USDAbstractWriter::prepare(HierarchyContext &context)
+{
+  /* Mirror the check in write(); static data is only written once. */
+  if (frame_has_been_written_ && !is_animated_) {
+    return;
+  }
+  do_prepare(context);
+}
+
+void USDAbstractWriter::do_prepare(HierarchyContext & /*context*/)
+{
+}
+
 void USDAbstractWriter::write(HierarchyContext &context)
 {
   if (!frame_has_been_written_) {
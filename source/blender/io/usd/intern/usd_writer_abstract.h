@@ -52,6 +52,7 @@ class USDAbstractWriter : public AbstractHierarchyWriter {
   USDAbstractWriter(const USDExporterContext &usd_export_context);
   virtual ~USDAbstractWriter();
 
+  virtual void prepare(HierarchyContext &context) override;
   virtual void write(HierarchyContext &context) override;
 
   /* Returns true if the data to be written is actually supported. This would, for example, allow a
@@ -66,6 +67,8 @@ class USDAbstractWriter : public AbstractHierarchyWriter {
   const pxr::SdfPath &usd_path() const;
 
  protected:
+  /* Called by prepare() when a frame is going to be written. Must not touch the stage. */
+  virtual void do_prepare(HierarchyContext &context);
   virtual void do_write(HierarchyContext &context) = 0;
   pxr::UsdTimeCode get_export_time_code() const;
 
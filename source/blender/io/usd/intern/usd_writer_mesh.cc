@@ -46,10 +46,42 @@
 
 namespace blender::io::usd {
 
-USDGenericMeshWriter::USDGenericMeshWriter(const USDExporterContext &ctx) : USDAbstractWriter(ctx)
+struct USDMeshData {
+  pxr::VtArray<pxr::GfVec3f> points;
+  pxr::VtIntArray face_vertex_counts;
+  pxr::VtIntArray face_indices;
+  std::map<short, pxr::VtIntArray> face_groups;
+
+  /* The length of this array specifies the number of creases on the surface. Each element gives
+   * the number of (must be adjacent) vertices in each crease, whose indices are linearly laid out
+   * in the 'creaseIndices' attribute. Since each crease must be at least one edge long, each
+   * element of this array should be greater than one. */
+  pxr::VtIntArray crease_lengths;
+  /* The indices of all vertices forming creased edges. The size of this array must be equal to the
+   * sum of all elements of the 'creaseLengths' attribute. */
+  pxr::VtIntArray crease_vertex_indices;
+  /* The per-crease or per-edge sharpness for all creases (Usd.Mesh.SHARPNESS_INFINITE for a
+   * perfectly sharp crease). Since 'creaseLengths' encodes the number of vertices in each crease,
+   * the number of elements in this array will be either 'len(creaseLengths)' or the sum over all X
+   * of '(creaseLengths[X] - 1)'. Note that while the RI spec allows each crease to have either a
+   * single sharpness or a value per-edge, USD will encode either a single sharpness per crease on
+   * a mesh, or sharpness's for all edges making up the creases on a mesh. */
+  pxr::VtFloatArray crease_sharpnesses;
+};
+
+USDGenericMeshWriter::USDGenericMeshWriter(const USDExporterContext &ctx)
+    : USDAbstractWriter(ctx),
+      is_prepared_(false),
+      prepared_mesh_(nullptr),
+      prepared_mesh_needsfree_(false)
 {
 }
 
+USDGenericMeshWriter::~USDGenericMeshWriter()
+{
+  free_prepared_mesh();
+}
+
 bool USDGenericMeshWriter::is_supported(const HierarchyContext *context) const
 {
   if (usd_export_context_.export_params.visible_objects_only) {
@@ -58,8 +90,11 @@ bool USDGenericMeshWriter::is_supported(const HierarchyContext *context) const
   return true;
 }
 
-void USDGenericMeshWriter::do_write(HierarchyContext &context)
+void USDGenericMeshWriter::do_prepare(HierarchyContext &context)
 {
+  free_prepared_mesh();
+  is_prepared_ = true;
+
   Object *object_eval = context.object;
   bool needsfree = false;
   Mesh *mesh = get_export_mesh(object_eval, needsfree);
@@ -68,49 +103,50 @@ void USDGenericMeshWriter::do_write(HierarchyContext &context)
     return;
   }
 
-  try {
-    write_mesh(context, mesh);
+  prepared_mesh_ = mesh;
+  prepared_mesh_needsfree_ = needsfree;
+  prepared_data_ = std::make_unique<USDMeshData>();
+  get_geometry_data(mesh, *prepared_data_);
+}
 
-    if (needsfree) {
-      free_export_mesh(mesh);
-    }
+void USDGenericMeshWriter::do_write(HierarchyContext &context)
+{
+  if (!is_prepared_) {
+    do_prepare(context);
+  }
+  is_prepared_ = false;
+
+  Mesh *mesh = prepared_mesh_;
+
+  if (mesh == nullptr) {
+    return;
+  }
+
+  try {
+    write_mesh(context, mesh, *prepared_data_);
+    free_prepared_mesh();
   }
   catch (...) {
-    if (needsfree) {
-      free_export_mesh(mesh);
-    }
+    free_prepared_mesh();
     throw;
   }
 }
 
+void USDGenericMeshWriter::free_prepared_mesh()
+{
+  if (prepared_mesh_ != nullptr && prepared_mesh_needsfree_) {
+    free_export_mesh(prepared_mesh_);
+  }
+  prepared_mesh_ = nullptr;
+  prepared_mesh_needsfree_ = false;
+  prepared_data_.reset();
+}
+
 void USDGenericMeshWriter::free_export_mesh(Mesh *mesh)
 {
   BKE_id_free(nullptr, mesh);
 }
 
-struct USDMeshData {
-  pxr::VtArray<pxr::GfVec3f> points;
-  pxr::VtIntArray face_vertex_counts;
-  pxr::VtIntArray face_indices;
-  std::map<short, pxr::VtIntArray> face_groups;
-
-  /* The length of this array specifies the number of creases on the surface. Each element gives
-   * the number of (must be adjacent) vertices in each crease, whose indices are linearly laid out
-   * in the 'creaseIndices' attribute. Since each crease must be at least one edge long, each
-   * element of this array should be greater than one. */
-  pxr::VtIntArray crease_lengths;
-  /* The indices of all vertices forming creased edges. The size of this array must be equal to the
-   * sum of all elements of the 'creaseLengths' attribute. */
-  pxr::VtIntArray crease_vertex_indices;
-  /* The per-crease or per-edge sharpness for all creases (Usd.Mesh.SHARPNESS_INFINITE for a
-   * perfectly sharp crease). Since 'creaseLengths' encodes the number of vertices in each crease,
-   * the number of elements in this array will be either 'len(creaseLengths)' or the sum over all X
-   * of '(creaseLengths[X] - 1)'. Note that while the RI spec allows each crease to have either a
-   * single sharpness or a value per-edge, USD will encode either a single sharpness per crease on
-   * a mesh, or sharpness's for all edges making up the creases on a mesh. */
-  pxr::VtFloatArray crease_sharpnesses;
-};
-
 void USDGenericMeshWriter::write_uv_maps(const Mesh *mesh, pxr::UsdGeomMesh usd_mesh)
 {
   pxr::UsdTimeCode timecode = get_export_time_code();
@@ -144,7 +180,9 @@ void USDGenericMeshWriter::write_uv_maps(const Mesh *mesh, pxr::UsdGeomMesh usd_
   }
 }
 
-void USDGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
+void USDGenericMeshWriter::write_mesh(HierarchyContext &context,
+                                      Mesh *mesh,
+                                      const USDMeshData &usd_mesh_data)
 {
   pxr::UsdTimeCode timecode = get_export_time_code();
   pxr::UsdTimeCode defaultTime = pxr::UsdTimeCode::Default();
@@ -154,9 +192,6 @@ void USDGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
   pxr::UsdGeomMesh usd_mesh = pxr::UsdGeomMesh::Define(stage, usd_path);
   write_visibility(context, timecode, usd_mesh);
 
-  USDMeshData usd_mesh_data;
-  get_geometry_data(mesh, usd_mesh_data);
-
   if (usd_export_context_.export_params.use_instancing && context.is_instance()) {
     if (!mark_as_instance(context, usd_mesh.GetPrim())) {
       return;
@@ -22,17 +22,28 @@
 
 #include <pxr/usd/usdGeom/mesh.h>
 
+#include <memory>
+
 namespace blender::io::usd {
 
 struct USDMeshData;
 
 /* Writer for USD geometry. Does not assume the object is a mesh object. */
 class USDGenericMeshWriter : public USDAbstractWriter {
+ private:
+  /* Mesh and geometry gathered by do_prepare(), written and released by do_write(). */
+  bool is_prepared_;
+  Mesh *prepared_mesh_;
+  bool prepared_mesh_needsfree_;
+  std::unique_ptr<USDMeshData> prepared_data_;
+
  public:
   USDGenericMeshWriter(const USDExporterContext &ctx);
+  virtual ~USDGenericMeshWriter();
 
  protected:
   virtual bool is_supported(const HierarchyContext *context) const override;
+  virtual void do_prepare(HierarchyContext &context) override;
   virtual void do_write(HierarchyContext &context) override;
 
   virtual Mesh *get_export_mesh(Object *object_eval, bool &r_needsfree) = 0;
@@ -42,7 +53,8 @@ class USDGenericMeshWriter : public USDAbstractWriter {
   /* Mapping from material slot number to array of face indices with that material. */
   typedef std::map<short, pxr::VtIntArray> MaterialFaceGroups;
 
-  void write_mesh(HierarchyContext &context, Mesh *mesh);
+  void free_prepared_mesh();
+  void write_mesh(HierarchyContext &context, Mesh *mesh, const USDMeshData &usd_mesh_data);
   void get_geometry_data(const Mesh *mesh, struct USDMeshData &usd_mesh_data);
   void assign_materials(const HierarchyContext &context,
                         pxr::UsdGeomMesh usd_mesh,
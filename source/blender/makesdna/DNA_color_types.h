@@ -217,6 +217,8 @@ typedef struct ColorManagedColorspaceSettings {
 /* ColorManagedViewSettings->flag */
 enum {
   COLORMANAGE_VIEW_USE_CURVES = (1 << 0),
+  /** Always display with the exact view transform, not with a baked LUT. */
+  COLORMANAGE_VIEW_NO_DISPLAY_LUT = (1 << 1),
 };
 
 #ifdef __cplusplus
@@ -88,7 +88,11 @@ typedef struct Mesh_Runtime {
   void *batch_cache;
 
   struct SubdivCCG *subdiv_ccg;
-  void *_pad1;
+  /**
+   * Evaluated meshes shared by objects with identical modifier stacks, see
+   * #BKE_mesh_runtime_shared_eval_find. Protected by `eval_mutex` like `mesh_eval`.
+   */
+  struct MeshSharedEval *shared_eval;
   int subdiv_ccg_tot_level;
   char _pad2[4];
 
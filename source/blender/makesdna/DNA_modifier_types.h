@@ -134,6 +134,13 @@ typedef struct ModifierData {
   /* Runtime field which contains unique identifier of the modifier. */
   SessionUUID session_uuid;
 
+  /**
+   * Runtime field with the time in seconds the modifier took during the last evaluation of
+   * the object. Only set on evaluated objects, and copied back to the original object by
+   * the active depsgraph.
+   */
+  double execution_time;
+
   /* Runtime field which contains runtime data which is specific to a modifier type. */
   void *runtime;
 } ModifierData;
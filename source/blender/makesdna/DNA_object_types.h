@@ -119,6 +119,13 @@ typedef struct Object_Runtime {
    */
   CustomData_MeshMasks last_data_mask;
 
+  /**
+   * Identifies the entry of the mesh when `data_eval` is shared with other objects, zero
+   * otherwise. Kept when the evaluated data is freed, the entry is released on the next
+   * evaluation. See #BKE_mesh_runtime_shared_eval_find.
+   */
+  uint64_t shared_eval_id;
+
   /** Did last modifier stack generation need mapping support? */
   char last_need_mapping;
 
@@ -124,6 +124,9 @@ typedef struct Strip {
 
 typedef struct SequenceRuntime {
   SessionUUID session_uuid;
+  /** Seconds the last render of the strip took, including preprocessing and modifiers. */
+  float render_time;
+  char _pad[4];
 } SequenceRuntime;
 
 /**
@@ -604,6 +604,7 @@ typedef enum eSpaceSeq_RegionType {
 typedef enum eSpaceSeq_DrawFlag {
   SEQ_DRAW_BACKDROP = (1 << 0),
   SEQ_DRAW_OFFSET_EXT = (1 << 1),
+  SEQ_DRAW_RENDER_TIME = (1 << 2),
 } eSpaceSeq_DrawFlag;
 
 /* SpaceSeq.flag */
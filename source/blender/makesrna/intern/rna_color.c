@@ -1264,6 +1264,15 @@ static void rna_def_colormanage(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Use Curves", "Use RGB curved for pre-display transformation");
   RNA_def_property_update(prop, NC_WINDOW, "rna_ColorManagement_update");
 
+  prop = RNA_def_property(srna, "use_display_lut", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_negative_sdna(prop, NULL, "flag", COLORMANAGE_VIEW_NO_DISPLAY_LUT);
+  RNA_def_property_ui_text(prop,
+                           "Use Display LUT",
+                           "Display large images through a lookup table baked from the view "
+                           "transform, which is faster but may differ slightly from the exact "
+                           "transform");
+  RNA_def_property_update(prop, NC_WINDOW, "rna_ColorManagement_update");
+
   /* ** Colorspace **  */
   srna = RNA_def_struct(brna, "ColorManagedInputColorspaceSettings", NULL);
   RNA_def_struct_path_func(srna, "rna_ColorManagedInputColorspaceSettings_path");
@@ -165,6 +165,33 @@ static void deformVerts(ModifierData *md,
   MEM_SAFE_FREE(amd->vert_coords_prev);
 }
 
+static void *deformVertsRangeBegin(ModifierData *md,
+                                   const ModifierEvalContext *ctx,
+                                   const Mesh *mesh,
+                                   int UNUSED(numVerts))
+{
+  ArmatureModifierData *amd = (ArmatureModifierData *)md;
+
+  /* Blending with the previous coordinates needs them all before deforming. */
+  if (amd->multi || amd->vert_coords_prev || MOD_previous_vcos_needed(md)) {
+    return NULL;
+  }
+
+  return BKE_armature_deform_data_create(
+      amd->object, ctx->object, amd->deformflag, amd->defgrp_name, mesh);
+}
+
+static void deformVertsRange(
+    ModifierData *UNUSED(md), void *range_data, float (*vertexCos)[3], int start, int end)
+{
+  BKE_armature_deform_data_eval_range(range_data, vertexCos, start, end);
+}
+
+static void deformVertsRangeEnd(ModifierData *UNUSED(md), void *range_data)
+{
+  BKE_armature_deform_data_destroy(range_data);
+}
+
 static void deformVertsEM(ModifierData *md,
                           const ModifierEvalContext *ctx,
                           struct BMEditMesh *em,
@@ -293,6 +320,9 @@ ModifierTypeInfo modifierType_Armature = {
     /* deformMatrices */ deformMatrices,
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ deformMatricesEM,
+    /* deformVertsRangeBegin */ deformVertsRangeBegin,
+    /* deformVertsRange */ deformVertsRange,
+    /* deformVertsRangeEnd */ deformVertsRangeEnd,
     /* modifyMesh */ NULL,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -311,4 +341,5 @@ ModifierTypeInfo modifierType_Armature = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ blendRead,
+    /* sharedResultKey */ NULL,
 };
@@ -1016,6 +1016,9 @@ ModifierTypeInfo modifierType_Array = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -1034,4 +1037,5 @@ ModifierTypeInfo modifierType_Array = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ NULL,
 };
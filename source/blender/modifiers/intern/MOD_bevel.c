@@ -431,6 +431,28 @@ static void blendRead(BlendDataReader *reader, ModifierData *md)
   }
 }
 
+static bool sharedResultKey(ModifierData *md, Object *ob, struct BLI_Buffer *key)
+{
+  BevelModifierData *bmd = (BevelModifierData *)md;
+
+  /* The custom profile is a separate allocation per object, don't bother comparing it. */
+  if (bmd->profile_type == MOD_BEVEL_PROFILE_CUSTOM) {
+    return false;
+  }
+
+  /* The settings before the vertex group name are plain values. */
+  const size_t settings_size = offsetof(BevelModifierData, defgrp_name) -
+                               offsetof(BevelModifierData, value);
+  BKE_modifier_shared_key_append(key, &bmd->value, settings_size);
+
+  /* The material and the vertex group are looked up in the object. */
+  const int mat = CLAMPIS(bmd->mat, -1, ob->totcol - 1);
+  const int defgrp_index = BKE_object_defgroup_name_index(ob, bmd->defgrp_name);
+  BKE_modifier_shared_key_append(key, &mat, sizeof(mat));
+  BKE_modifier_shared_key_append(key, &defgrp_index, sizeof(defgrp_index));
+  return true;
+}
+
 ModifierTypeInfo modifierType_Bevel = {
     /* name */ "Bevel",
     /* structName */ "BevelModifierData",
@@ -445,6 +467,9 @@ ModifierTypeInfo modifierType_Bevel = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -462,4 +487,5 @@ ModifierTypeInfo modifierType_Bevel = {
     /* uiPanel */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
+    /* sharedResultKey */ sharedResultKey,
 };
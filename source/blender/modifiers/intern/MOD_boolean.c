@@ -817,6 +817,9 @@ ModifierTypeInfo modifierType_Boolean = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -835,4 +838,5 @@ ModifierTypeInfo modifierType_Boolean = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ NULL,
 };
@@ -344,6 +344,9 @@ ModifierTypeInfo modifierType_Build = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -362,4 +365,5 @@ ModifierTypeInfo modifierType_Build = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ NULL,
 };
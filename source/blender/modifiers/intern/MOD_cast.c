@@ -588,6 +588,9 @@ ModifierTypeInfo modifierType_Cast = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ NULL,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -606,4 +609,5 @@ ModifierTypeInfo modifierType_Cast = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ NULL,
 };
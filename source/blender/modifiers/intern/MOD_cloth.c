@@ -307,6 +307,9 @@ ModifierTypeInfo modifierType_Cloth = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ NULL,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -325,4 +328,5 @@ ModifierTypeInfo modifierType_Cloth = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ NULL,
 };
@@ -849,6 +849,9 @@ ModifierTypeInfo modifierType_CorrectiveSmooth = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ NULL,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -867,4 +870,5 @@ ModifierTypeInfo modifierType_CorrectiveSmooth = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
+    /* sharedResultKey */ NULL,
 };
@@ -28,10 +28,14 @@
 #include "BLT_translation.h"
 
 #include "DNA_defaults.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 #include "DNA_screen_types.h"
 
 #include "BKE_context.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
 #include "BKE_editmesh.h"
 #include "BKE_lattice.h"
 #include "BKE_lib_id.h"
@@ -131,6 +135,68 @@ static void deformVerts(ModifierData *md,
   }
 }
 
+typedef struct LatticeRangeData {
+  struct LatticeDeformData *lattice_deform_data;
+  const MDeformVert *dvert;
+  int defgrp_index;
+  float fac;
+  bool invert_vgroup;
+} LatticeRangeData;
+
+static void *deformVertsRangeBegin(ModifierData *md,
+                                   const ModifierEvalContext *ctx,
+                                   const Mesh *mesh,
+                                   int UNUSED(numVerts))
+{
+  LatticeModifierData *lmd = (LatticeModifierData *)md;
+
+  if (lmd->object->type != OB_LATTICE || MOD_previous_vcos_needed(md)) {
+    return NULL;
+  }
+
+  LatticeRangeData *data = MEM_callocN(sizeof(*data), __func__);
+  data->lattice_deform_data = BKE_lattice_deform_data_create(lmd->object, ctx->object);
+  data->defgrp_index = -1;
+  data->fac = lmd->strength;
+  data->invert_vgroup = (lmd->flag & MOD_LATTICE_INVERT_VGROUP) != 0;
+
+  if (lmd->name[0] != '\0') {
+    data->defgrp_index = BKE_object_defgroup_name_index(ctx->object, lmd->name);
+    if (data->defgrp_index != -1) {
+      data->dvert = CustomData_get_layer(&mesh->vdata, CD_MDEFORMVERT);
+    }
+  }
+
+  return data;
+}
+
+static void deformVertsRange(
+    ModifierData *UNUSED(md), void *range_data, float (*vertexCos)[3], int start, int end)
+{
+  const LatticeRangeData *data = range_data;
+
+  for (int i = start; i < end; i++) {
+    float weight = 1.0f;
+    if (data->dvert != NULL) {
+      weight = BKE_defvert_find_weight(&data->dvert[i], data->defgrp_index);
+      if (data->invert_vgroup) {
+        weight = 1.0f - weight;
+      }
+      if (weight <= 0.0f) {
+        continue;
+      }
+    }
+    BKE_lattice_deform_data_eval_co(data->lattice_deform_data, vertexCos[i], weight * data->fac);
+  }
+}
+
+static void deformVertsRangeEnd(ModifierData *UNUSED(md), void *range_data)
+{
+  LatticeRangeData *data = range_data;
+  BKE_lattice_deform_data_destroy(data->lattice_deform_data);
+  MEM_freeN(data);
+}
+
 static void deformVertsEM(ModifierData *md,
                           const ModifierEvalContext *ctx,
                           struct BMEditMesh *em,
@@ -190,6 +256,9 @@ ModifierTypeInfo modifierType_Lattice = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ deformVertsEM,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ deformVertsRangeBegin,
+    /* deformVertsRange */ deformVertsRange,
+    /* deformVertsRangeEnd */ deformVertsRangeEnd,
     /* modifyMesh */ NULL,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -208,4 +277,5 @@ ModifierTypeInfo modifierType_Lattice = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ NULL,
 };
@@ -460,6 +460,9 @@ ModifierTypeInfo modifierType_Mask = {
     /* deformMatrices */ nullptr,
     /* deformVertsEM */ nullptr,
     /* deformMatricesEM */ nullptr,
+    /* deformVertsRangeBegin */ nullptr,
+    /* deformVertsRange */ nullptr,
+    /* deformVertsRangeEnd */ nullptr,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ nullptr,
     /* modifyPointCloud */ nullptr,
@@ -478,4 +481,5 @@ ModifierTypeInfo modifierType_Mask = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ nullptr,
     /* blendRead */ nullptr,
+    /* sharedResultKey */ nullptr,
 };
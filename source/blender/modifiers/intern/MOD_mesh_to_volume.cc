@@ -293,6 +293,9 @@ ModifierTypeInfo modifierType_MeshToVolume = {
     /* deformMatrices */ nullptr,
     /* deformVertsEM */ nullptr,
     /* deformMatricesEM */ nullptr,
+    /* deformVertsRangeBegin */ nullptr,
+    /* deformVertsRange */ nullptr,
+    /* deformVertsRangeEnd */ nullptr,
     /* modifyMesh */ nullptr,
     /* modifyHair */ nullptr,
     /* modifyPointCloud */ nullptr,
@@ -311,4 +314,5 @@ ModifierTypeInfo modifierType_MeshToVolume = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ nullptr,
     /* blendRead */ nullptr,
+    /* sharedResultKey */ nullptr,
 };
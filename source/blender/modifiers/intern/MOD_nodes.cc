@@ -1061,6 +1061,9 @@ ModifierTypeInfo modifierType_Nodes = {
     /* deformMatrices */ nullptr,
     /* deformVertsEM */ nullptr,
     /* deformMatricesEM */ nullptr,
+    /* deformVertsRangeBegin */ nullptr,
+    /* deformVertsRange */ nullptr,
+    /* deformVertsRangeEnd */ nullptr,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ nullptr,
     /* modifyPointCloud */ modifyPointCloud,
@@ -1079,4 +1082,5 @@ ModifierTypeInfo modifierType_Nodes = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
+    /* sharedResultKey */ nullptr,
 };
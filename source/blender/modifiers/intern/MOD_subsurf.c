@@ -207,7 +207,13 @@ static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
   if (mesh_settings.resolution < 3) {
     return result;
   }
-  result = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+  if (ctx->flag & MOD_APPLY_TO_BASE_MESH) {
+    result = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+  }
+  else {
+    /* Playback of deforming meshes re-uses the topology of the previous frame. */
+    result = BKE_subdiv_to_mesh_with_deform_cache(subdiv, &mesh_settings, mesh);
+  }
   return result;
 }
 
@@ -505,6 +511,9 @@ ModifierTypeInfo modifierType_Subsurf = {
     /* deformMatrices */ deformMatrices,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -523,4 +532,5 @@ ModifierTypeInfo modifierType_Subsurf = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ blendRead,
+    /* sharedResultKey */ NULL,
 };
@@ -158,6 +158,15 @@ static void panelRegister(ARegionType *region_type)
   modifier_panel_register(region_type, eModifierType_Triangulate, panel_draw);
 }
 
+static bool sharedResultKey(ModifierData *md, Object *UNUSED(ob), struct BLI_Buffer *key)
+{
+  TriangulateModifierData *tmd = (TriangulateModifierData *)md;
+
+  BKE_modifier_shared_key_append(
+      key, &tmd->flag, sizeof(*tmd) - offsetof(TriangulateModifierData, flag));
+  return true;
+}
+
 ModifierTypeInfo modifierType_Triangulate = {
     /* name */ "Triangulate",
     /* structName */ "TriangulateModifierData",
@@ -175,6 +184,9 @@ ModifierTypeInfo modifierType_Triangulate = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -193,4 +205,5 @@ ModifierTypeInfo modifierType_Triangulate = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ sharedResultKey,
 };
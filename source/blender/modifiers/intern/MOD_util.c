@@ -182,6 +182,14 @@ void MOD_previous_vcos_store(ModifierData *md, const float (*vert_coords)[3])
   /* lattice/mesh modifier too */
 }
 
+/* Whether #MOD_previous_vcos_store has to be called with the coordinates before \a md. */
+bool MOD_previous_vcos_needed(const ModifierData *md)
+{
+  const ModifierData *md_next = md->next;
+  return md_next && md_next->type == eModifierType_Armature &&
+         ((const ArmatureModifierData *)md_next)->multi;
+}
+
 /* returns a mesh if mesh == NULL, for deforming modifiers that need it */
 Mesh *MOD_deform_mesh_eval_get(Object *ob,
                                struct BMEditMesh *em,
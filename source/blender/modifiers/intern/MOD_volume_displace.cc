@@ -326,6 +326,9 @@ ModifierTypeInfo modifierType_VolumeDisplace = {
     /* deformMatrices */ nullptr,
     /* deformVertsEM */ nullptr,
     /* deformMatricesEM */ nullptr,
+    /* deformVertsRangeBegin */ nullptr,
+    /* deformVertsRange */ nullptr,
+    /* deformVertsRangeEnd */ nullptr,
     /* modifyMesh */ nullptr,
     /* modifyHair */ nullptr,
     /* modifyPointCloud */ nullptr,
@@ -344,4 +347,5 @@ ModifierTypeInfo modifierType_VolumeDisplace = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ nullptr,
     /* blendRead */ nullptr,
+    /* sharedResultKey */ nullptr,
 };
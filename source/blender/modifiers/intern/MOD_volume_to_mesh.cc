@@ -333,6 +333,9 @@ ModifierTypeInfo modifierType_VolumeToMesh = {
     /* deformMatrices */ nullptr,
     /* deformVertsEM */ nullptr,
     /* deformMatricesEM */ nullptr,
+    /* deformVertsRangeBegin */ nullptr,
+    /* deformVertsRange */ nullptr,
+    /* deformVertsRangeEnd */ nullptr,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ nullptr,
     /* modifyPointCloud */ nullptr,
@@ -351,4 +354,5 @@ ModifierTypeInfo modifierType_VolumeToMesh = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ nullptr,
     /* blendRead */ nullptr,
+    /* sharedResultKey */ nullptr,
 };
@@ -745,6 +745,24 @@ static void panelRegister(ARegionType *region_type)
   modifier_panel_register(region_type, eModifierType_WeightedNormal, panel_draw);
 }
 
+static bool sharedResultKey(ModifierData *md, Object *ob, struct BLI_Buffer *key)
+{
+  WeightedNormalModifierData *wnmd = (WeightedNormalModifierData *)md;
+
+  /* Let every object report the missing 'Auto Smooth' error. */
+  if (!(((Mesh *)ob->data)->flag & ME_AUTOSMOOTH)) {
+    return false;
+  }
+
+  const int defgrp_index = BKE_object_defgroup_name_index(ob, wnmd->defgrp_name);
+  BKE_modifier_shared_key_append(key, &defgrp_index, sizeof(defgrp_index));
+  BKE_modifier_shared_key_append(key, &wnmd->mode, sizeof(wnmd->mode));
+  BKE_modifier_shared_key_append(key, &wnmd->flag, sizeof(wnmd->flag));
+  BKE_modifier_shared_key_append(key, &wnmd->weight, sizeof(wnmd->weight));
+  BKE_modifier_shared_key_append(key, &wnmd->thresh, sizeof(wnmd->thresh));
+  return true;
+}
+
 ModifierTypeInfo modifierType_WeightedNormal = {
     /* name */ "WeightedNormal",
     /* structName */ "WeightedNormalModifierData",
@@ -761,6 +779,9 @@ ModifierTypeInfo modifierType_WeightedNormal = {
     /* deformMatrices */ NULL,
     /* deformVertsEM */ NULL,
     /* deformMatricesEM */ NULL,
+    /* deformVertsRangeBegin */ NULL,
+    /* deformVertsRange */ NULL,
+    /* deformVertsRangeEnd */ NULL,
     /* modifyMesh */ modifyMesh,
     /* modifyHair */ NULL,
     /* modifyPointCloud */ NULL,
@@ -779,4 +800,5 @@ ModifierTypeInfo modifierType_WeightedNormal = {
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
+    /* sharedResultKey */ sharedResultKey,
 };
@@ -24,8 +24,6 @@
  * \ingroup bke
  */
 
-#include <time.h>
-
 #include "MEM_guardedalloc.h"
 
 #include "DNA_anim_types.h"
@@ -37,6 +35,8 @@
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -64,6 +64,8 @@
 #include "RE_engine.h"
 #include "RE_pipeline.h"
 
+#include "PIL_time.h"
+
 #include "SEQ_sequencer.h"
 
 #include "effects.h"
@@ -397,17 +399,18 @@ int seq_get_shown_sequences(ListBase *seqbasep,
   return cnt;
 }
 
-/* Estimate time spent by the program rendering the strip */
-static clock_t seq_estimate_render_cost_begin(void)
+/* Estimate time spent by the program rendering the strip. This is wall time rather than
+ * processor time, as strips and their effects render on multiple threads. */
+static double seq_estimate_render_cost_begin(void)
 {
-  return clock();
+  return PIL_check_seconds_timer();
 }
 
-static float seq_estimate_render_cost_end(Scene *scene, clock_t begin)
+static float seq_estimate_render_cost_end(Scene *scene, double begin)
 {
-  clock_t end = clock();
+  double end = PIL_check_seconds_timer();
   float time_spent = (float)(end - begin);
-  float time_max = (1.0f / scene->r.frs_sec) * CLOCKS_PER_SEC;
+  float time_max = 1.0f / scene->r.frs_sec;
 
   if (time_max != 0) {
     return time_spent / time_max;
@@ -739,7 +742,7 @@ static ImBuf *seq_render_preprocess_ibuf(const SeqRenderData *context,
                                          Sequence *seq,
                                          ImBuf *ibuf,
                                          float timeline_frame,
-                                         clock_t begin,
+                                         double begin,
                                          bool use_preprocess,
                                          const bool is_proxy_image)
 {
@@ -1076,8 +1079,13 @@ static ImBuf *seq_render_image_strip(const SeqRenderData *context,
       localcontext.view_id = view_id;
 
       if (view_id != context->view_id) {
-        ibufs_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibufs_arr[view_id], timeline_frame, clock(), true, false);
+        ibufs_arr[view_id] = seq_render_preprocess_ibuf(&localcontext,
+                                                        seq,
+                                                        ibufs_arr[view_id],
+                                                        timeline_frame,
+                                                        seq_estimate_render_cost_begin(),
+                                                        true,
+                                                        false);
       }
     }
 
@@ -1226,8 +1234,13 @@ static ImBuf *seq_render_movie_strip(const SeqRenderData *context,
       localcontext.view_id = view_id;
 
       if (view_id != context->view_id) {
-        ibuf_arr[view_id] = seq_render_preprocess_ibuf(
-            &localcontext, seq, ibuf_arr[view_id], timeline_frame, clock(), true, false);
+        ibuf_arr[view_id] = seq_render_preprocess_ibuf(&localcontext,
+                                                       seq,
+                                                       ibuf_arr[view_id],
+                                                       timeline_frame,
+                                                       seq_estimate_render_cost_begin(),
+                                                       true,
+                                                       false);
       }
     }
 
@@ -1809,7 +1822,7 @@ ImBuf *seq_render_strip(const SeqRenderData *context,
   bool use_preprocess = false;
   bool is_proxy_image = false;
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
 
   ibuf = BKE_sequencer_cache_get(
       context, seq, timeline_frame, SEQ_CACHE_STORE_PREPROCESSED, false);
@@ -1832,6 +1845,9 @@ ImBuf *seq_render_strip(const SeqRenderData *context,
         context, seq, ibuf, timeline_frame, begin, use_preprocess, is_proxy_image);
   }
 
+  /* Displayed in the timeline, cached images don't update it. */
+  seq->runtime.render_time = (float)(PIL_check_seconds_timer() - begin);
+
   if (ibuf == NULL) {
     ibuf = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
     seq_imbuf_assign_spaces(context->scene, ibuf);
@@ -1905,6 +1921,156 @@ static ImBuf *seq_render_strip_stack_apply_effect(
   return out;
 }
 
+/* Strips which don't render other strips, scenes or effects, so they can render at the same
+ * time as other such strips. Each owns its own image files and movie handles. */
+static bool seq_render_strip_is_independent(const Sequence *seq)
+{
+  if (!ELEM(seq->type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE)) {
+    return false;
+  }
+
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_input_type == SEQUENCE_MASK_INPUT_STRIP && smd->mask_sequence) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Strips blended onto the stack, rendered by tasks or by the caller of
+ * #seq_render_strip_stack_input_get, whichever gets to a strip first. */
+typedef struct RenderStackInputs {
+  const SeqRenderData *context;
+  Sequence **seq_arr;
+  float timeline_frame;
+  TaskPool *task_pool;
+
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  bool is_claimed[MAXSEQ + 1];
+  bool is_done[MAXSEQ + 1];
+  ImBuf *ibuf_arr[MAXSEQ + 1];
+  float cost_arr[MAXSEQ + 1];
+} RenderStackInputs;
+
+static bool render_stack_input_claim(RenderStackInputs *inputs, const int i)
+{
+  BLI_mutex_lock(&inputs->mutex);
+  const bool is_claimed = inputs->is_claimed[i];
+  inputs->is_claimed[i] = true;
+  BLI_mutex_unlock(&inputs->mutex);
+  return !is_claimed;
+}
+
+static void render_stack_input_render(RenderStackInputs *inputs,
+                                      SeqRenderState *state,
+                                      const int i)
+{
+  double begin = seq_estimate_render_cost_begin();
+  ImBuf *ibuf = seq_render_strip(
+      inputs->context, state, inputs->seq_arr[i], inputs->timeline_frame);
+  float cost = seq_estimate_render_cost_end(inputs->context->scene, begin);
+
+  BLI_mutex_lock(&inputs->mutex);
+  inputs->ibuf_arr[i] = ibuf;
+  inputs->cost_arr[i] = cost;
+  inputs->is_done[i] = true;
+  BLI_condition_notify_all(&inputs->cond);
+  BLI_mutex_unlock(&inputs->mutex);
+}
+
+static void render_stack_inputs_task(TaskPool *__restrict pool, void *taskdata)
+{
+  RenderStackInputs *inputs = BLI_task_pool_user_data(pool);
+  const int i = POINTER_AS_INT(taskdata);
+
+  /* The stack may have needed the strip before this task started. */
+  if (render_stack_input_claim(inputs, i)) {
+    SeqRenderState state;
+    seq_render_state_init(&state);
+    render_stack_input_render(inputs, &state, i);
+  }
+}
+
+/**
+ * Start rendering the strips of the stack which are blended onto the stack below them, from
+ * \a base up. Independent strips render at the same time when there are threads for it, the
+ * others render when the stack gets to them, as they may render the same strips or scenes.
+ */
+static void seq_render_strip_stack_inputs_begin(RenderStackInputs *inputs,
+                                                const SeqRenderData *context,
+                                                Sequence **seq_arr,
+                                                int base,
+                                                int count,
+                                                bool render_base,
+                                                float timeline_frame)
+{
+  bool use_input[MAXSEQ + 1];
+  int tot_independent = 0;
+
+  memset(inputs, 0, sizeof(*inputs));
+  inputs->context = context;
+  inputs->seq_arr = seq_arr;
+  inputs->timeline_frame = timeline_frame;
+  BLI_mutex_init(&inputs->mutex);
+  BLI_condition_init(&inputs->cond);
+
+  for (int i = base; i < count; i++) {
+    use_input[i] = (i == base) ? render_base :
+                                 (seq_get_early_out_for_blend_mode(seq_arr[i]) == EARLY_DO_EFFECT);
+    if (use_input[i] && seq_render_strip_is_independent(seq_arr[i])) {
+      tot_independent++;
+    }
+  }
+
+  if (tot_independent > 1 && BLI_system_thread_count() > 1) {
+    inputs->task_pool = BLI_task_pool_create(inputs, TASK_PRIORITY_HIGH);
+
+    for (int i = base; i < count; i++) {
+      if (use_input[i] && seq_render_strip_is_independent(seq_arr[i])) {
+        BLI_task_pool_push(
+            inputs->task_pool, render_stack_inputs_task, POINTER_FROM_INT(i), false, NULL);
+      }
+    }
+  }
+}
+
+/**
+ * Get the rendered strip \a i of the stack, rendering it now unless a task already started on
+ * it. The caller owns the result.
+ */
+static ImBuf *seq_render_strip_stack_input_get(RenderStackInputs *inputs,
+                                               SeqRenderState *state,
+                                               const int i,
+                                               float *r_cost)
+{
+  if (render_stack_input_claim(inputs, i)) {
+    render_stack_input_render(inputs, state, i);
+  }
+  else {
+    BLI_mutex_lock(&inputs->mutex);
+    while (!inputs->is_done[i]) {
+      BLI_condition_wait(&inputs->cond, &inputs->mutex);
+    }
+    BLI_mutex_unlock(&inputs->mutex);
+  }
+
+  *r_cost = inputs->cost_arr[i];
+  return inputs->ibuf_arr[i];
+}
+
+static void seq_render_strip_stack_inputs_end(RenderStackInputs *inputs)
+{
+  if (inputs->task_pool) {
+    /* All strips were blended, the remaining tasks return without rendering. */
+    BLI_task_pool_work_and_wait(inputs->task_pool);
+    BLI_task_pool_free(inputs->task_pool);
+  }
+  BLI_condition_end(&inputs->cond);
+  BLI_mutex_end(&inputs->mutex);
+}
+
 static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      SeqRenderState *state,
                                      ListBase *seqbasep,
@@ -1912,10 +2078,12 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      int chanshown)
 {
   Sequence *seq_arr[MAXSEQ + 1];
+  RenderStackInputs inputs;
   int count;
   int i;
   ImBuf *out = NULL;
-  clock_t begin;
+  bool render_base = false;
+  double begin;
 
   count = seq_get_shown_sequences(seqbasep, timeline_frame, chanshown, (Sequence **)&seq_arr);
 
@@ -1923,6 +2091,7 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
     return NULL;
   }
 
+  /* Find the strip from which on blending is needed, without rendering yet. */
   for (i = count - 1; i >= 0; i--) {
     int early_out;
     Sequence *seq = seq_arr[i];
@@ -1933,53 +2102,72 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
       break;
     }
     if (seq->blend_mode == SEQ_BLEND_REPLACE) {
-      out = seq_render_strip(context, state, seq, timeline_frame);
+      render_base = true;
       break;
     }
 
     early_out = seq_get_early_out_for_blend_mode(seq);
 
-    switch (early_out) {
-      case EARLY_NO_INPUT:
-      case EARLY_USE_INPUT_2:
-        out = seq_render_strip(context, state, seq, timeline_frame);
-        break;
-      case EARLY_USE_INPUT_1:
-        if (i == 0) {
-          out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-        }
-        break;
-      case EARLY_DO_EFFECT:
-        if (i == 0) {
-          begin = seq_estimate_render_cost_begin();
+    if (ELEM(early_out, EARLY_NO_INPUT, EARLY_USE_INPUT_2)) {
+      render_base = true;
+      break;
+    }
+    if (i == 0) {
+      if (early_out == EARLY_USE_INPUT_1) {
+        out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+      }
+      else {
+        render_base = true;
+      }
+      break;
+    }
+  }
 
-          ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-          ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
+  /* Strips above render while the ones below are blended, each one is blended and freed as soon
+   * as it's rendered. */
+  seq_render_strip_stack_inputs_begin(
+      &inputs, context, seq_arr, i, count, render_base, timeline_frame);
 
-          out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
+  if (render_base) {
+    Sequence *seq = seq_arr[i];
+    float cost_input;
+    ImBuf *ibuf = seq_render_strip_stack_input_get(&inputs, state, i, &cost_input);
 
-          float cost = seq_estimate_render_cost_end(context->scene, begin);
-          BKE_sequencer_cache_put(
-              context, seq_arr[i], timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
+    if (i == 0 && seq->blend_mode != SEQ_BLEND_REPLACE &&
+        seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
+      begin = seq_estimate_render_cost_begin();
 
-          IMB_freeImBuf(ibuf1);
-          IMB_freeImBuf(ibuf2);
-        }
-        break;
+      ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
+      ImBuf *ibuf2 = ibuf;
+
+      out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
+
+      float cost = seq_estimate_render_cost_end(context->scene, begin) + cost_input;
+      BKE_sequencer_cache_put(
+          context, seq_arr[i], timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
+
+      IMB_freeImBuf(ibuf1);
+      IMB_freeImBuf(ibuf2);
     }
-    if (out) {
-      break;
+    else {
+      out = ibuf;
     }
   }
 
   i++;
   for (; i < count; i++) {
-    begin = seq_estimate_render_cost_begin();
     Sequence *seq = seq_arr[i];
+    ImBuf *ibuf2 = NULL;
+    float cost = 0.0f;
 
     if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
+      ibuf2 = seq_render_strip_stack_input_get(&inputs, state, i, &cost);
+    }
+
+    begin = seq_estimate_render_cost_begin();
+
+    if (ibuf2) {
       ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
 
       out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
@@ -1987,11 +2175,13 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
       IMB_freeImBuf(ibuf2);
     }
 
-    float cost = seq_estimate_render_cost_end(context->scene, begin);
+    cost += seq_estimate_render_cost_end(context->scene, begin);
     BKE_sequencer_cache_put(
         context, seq_arr[i], timeline_frame, SEQ_CACHE_STORE_COMPOSITE, out, cost, false);
   }
 
+  seq_render_strip_stack_inputs_end(&inputs);
+
   return out;
 }
 
@@ -2034,7 +2224,7 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
 
   BKE_sequencer_cache_free_temp_cache(context->scene, context->task_id, timeline_frame);
 
-  clock_t begin = seq_estimate_render_cost_begin();
+  double begin = seq_estimate_render_cost_begin();
   float cost = 0;
 
   if (count && !out) {
@@ -0,0 +1,186 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "CLG_log.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_scene.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "SEQ_sequencer.h"
+
+namespace blender::seq::tests {
+
+static const int size = 32;
+
+class sequencer_render_stack : public testing::Test {
+ public:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  char temp_dir[FILE_MAX];
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    BKE_idtype_init();
+    IMB_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    IMB_exit();
+    BLI_threadapi_exit();
+    CLG_exit();
+  }
+
+  /* Images are written into a directory of their own in the system temporary directory. */
+  void SetUp() override
+  {
+    const char *tmp = BLI_getenv("TMPDIR");
+#ifdef WIN32
+    if (tmp == nullptr) {
+      tmp = BLI_getenv("TEMP");
+    }
+#endif
+    BLI_join_dirfile(temp_dir,
+                     sizeof(temp_dir),
+                     (tmp && BLI_is_dir(tmp)) ? tmp : "/tmp",
+                     "blender_sequencer_render_test");
+    BLI_path_slash_ensure(temp_dir);
+    BLI_dir_create_recursive(temp_dir);
+
+    bmain = BKE_main_new();
+    G_MAIN = bmain;
+    scene = BKE_scene_add(bmain, "Scene");
+    scene->r.xsch = size;
+    scene->r.ysch = size;
+    scene->r.size = 100;
+    BKE_sequencer_editing_ensure(scene);
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+    G_MAIN = nullptr;
+    BLI_delete(temp_dir, true, true);
+  }
+
+  /* An image strip in \a channel showing a pattern of its own, partly transparent. */
+  Sequence *image_strip_add(const int channel, const int blend_mode, const float opacity)
+  {
+    char filename[64];
+    char filepath[FILE_MAX];
+    BLI_snprintf(filename, sizeof(filename), "strip_%d.png", channel);
+    BLI_join_dirfile(filepath, sizeof(filepath), temp_dir, filename);
+
+    ImBuf *ibuf = IMB_allocImBuf(size, size, 32, IB_rect);
+    for (int y = 0; y < size; y++) {
+      for (int x = 0; x < size; x++) {
+        unsigned char *px = (unsigned char *)&ibuf->rect[y * size + x];
+        px[0] = (unsigned char)(x * 8 + channel * 20);
+        px[1] = (unsigned char)(y * 8);
+        px[2] = (unsigned char)(channel * 40);
+        px[3] = (unsigned char)(((x + channel) % 4 == 0) ? 0 : 255 - y * 4);
+      }
+    }
+    ibuf->ftype = IMB_FTYPE_PNG;
+    ibuf->foptions.quality = 15;
+    EXPECT_TRUE(IMB_saveiff(ibuf, filepath, IB_rect));
+    IMB_freeImBuf(ibuf);
+
+    Sequence *seq = BKE_sequence_alloc(&scene->ed->seqbase, 1, channel, SEQ_TYPE_IMAGE);
+    seq->len = 1;
+    seq->blend_mode = blend_mode;
+    seq->blend_opacity = opacity;
+    seq->strip->stripdata = (StripElem *)MEM_callocN(sizeof(StripElem), __func__);
+    BLI_strncpy(seq->strip->dir, temp_dir, sizeof(seq->strip->dir));
+    BLI_strncpy(seq->strip->stripdata->name, filename, sizeof(seq->strip->stripdata->name));
+    BKE_sequence_calc(scene, seq);
+    return seq;
+  }
+
+  /* A color strip, which renders on the calling thread in between the image strips. */
+  void color_strip_add(const int channel)
+  {
+    Sequence *seq = BKE_sequence_alloc(&scene->ed->seqbase, 1, channel, SEQ_TYPE_COLOR);
+    BKE_sequence_get_effect(seq).init(seq);
+    seq->len = 1;
+    seq->blend_mode = SEQ_TYPE_ALPHAOVER;
+    seq->blend_opacity = 40.0f;
+    const float color[3] = {0.2f, 0.9f, 0.4f};
+    memcpy(((SolidColorVars *)seq->effectdata)->col, color, sizeof(color));
+    BKE_sequence_calc(scene, seq);
+  }
+
+  ImBuf *render(const int num_threads)
+  {
+    SeqRenderData context;
+    SEQ_render_new_render_data(
+        bmain, nullptr, scene, size, size, SEQ_RENDER_SIZE_SCENE, false, &context);
+
+    /* Render all strips again instead of using the images cached by the previous render. */
+    BKE_sequencer_cache_cleanup(scene);
+    BLI_system_num_threads_override_set(num_threads);
+    ImBuf *ibuf = SEQ_render_give_ibuf(&context, 1.0f, 0);
+    BLI_system_num_threads_override_set(0);
+    return ibuf;
+  }
+};
+
+/* Rendering the strips of a stack at the same time blends them to the same image as rendering
+ * them one after another. */
+TEST_F(sequencer_render_stack, ParallelMatchesSerial)
+{
+  image_strip_add(1, SEQ_TYPE_CROSS, 100.0f);
+  image_strip_add(2, SEQ_TYPE_ALPHAOVER, 100.0f);
+  image_strip_add(3, SEQ_TYPE_MUL, 70.0f);
+  color_strip_add(4);
+  image_strip_add(5, SEQ_TYPE_ADD, 50.0f);
+  image_strip_add(6, SEQ_TYPE_ALPHAOVER, 80.0f);
+
+  ImBuf *serial = render(1);
+  ImBuf *parallel = render(4);
+  ASSERT_NE(serial, nullptr);
+  ASSERT_NE(parallel, nullptr);
+  ASSERT_EQ(serial->x, size);
+  ASSERT_EQ(parallel->x, size);
+  ASSERT_EQ(serial->y, size);
+  ASSERT_EQ(parallel->y, size);
+
+  if (serial->rect_float) {
+    ASSERT_NE(parallel->rect_float, nullptr);
+    EXPECT_EQ(memcmp(serial->rect_float,
+                     parallel->rect_float,
+                     sizeof(float[4]) * size * size),
+              0);
+  }
+  else {
+    ASSERT_NE(serial->rect, nullptr);
+    ASSERT_NE(parallel->rect, nullptr);
+    EXPECT_EQ(memcmp(serial->rect, parallel->rect, sizeof(unsigned int) * size * size), 0);
+  }
+
+  IMB_freeImBuf(serial);
+  IMB_freeImBuf(parallel);
+}
+
+}  // namespace blender::seq::tests
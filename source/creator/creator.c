@@ -283,20 +283,31 @@ int main(int argc,
 
   /* NOTE: Special exception for guarded allocator type switch:
    *       we need to perform switch from lock-free to fully
-   *       guarded allocator before any allocation happened.
+   *       guarded (or size class) allocator before any allocation happened.
    */
   {
     int i;
+    bool use_guarded_allocator = false, use_sizeclass_allocator = false;
     for (i = 0; i < argc; i++) {
       if (STR_ELEM(argv[i], "-d", "--debug", "--debug-memory", "--debug-all")) {
-        printf("Switching to fully guarded memory allocator.\n");
-        MEM_use_guarded_allocator();
+        use_guarded_allocator = true;
         break;
       }
+      if (STREQ(argv[i], "--enable-sizeclass-allocator")) {
+        use_sizeclass_allocator = true;
+      }
       if (STREQ(argv[i], "--")) {
         break;
       }
     }
+    if (use_guarded_allocator) {
+      printf("Switching to fully guarded memory allocator.\n");
+      MEM_use_guarded_allocator();
+    }
+    else if (use_sizeclass_allocator) {
+      printf("Switching to size class memory allocator.\n");
+      MEM_use_sizeclass_allocator();
+    }
     MEM_init_memleak_detection();
   }
 
@@ -608,6 +608,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
+  BLI_args_print_arg_doc(ba, "--enable-sizeclass-allocator");
   printf("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
   BLI_args_print_arg_doc(ba, "--env-system-scripts");
@@ -728,6 +729,18 @@ static int arg_handle_crash_handler_disable(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_sizeclass_allocator_enable_doc[] =
+    "\n\t"
+    "Use the memory allocator with per-thread caches of small blocks.\n"
+    "\tOverridden by the fully guarded allocator of '--debug-memory'.";
+static int arg_handle_sizeclass_allocator_enable(int UNUSED(argc),
+                                                 const char **UNUSED(argv),
+                                                 void *UNUSED(data))
+{
+  /* Handled on startup, before any allocation happened. */
+  return 0;
+}
+
 static const char arg_handle_abort_handler_disable_doc[] =
     "\n\t"
     "Disable the abort handler.";
@@ -2182,6 +2195,11 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_args_add(ba, NULL, "--app-template", CB(arg_handle_app_template), NULL);
   BLI_args_add(ba, NULL, "--factory-startup", CB(arg_handle_factory_startup_set), NULL);
   BLI_args_add(ba, NULL, "--enable-event-simulate", CB(arg_handle_enable_event_simulate), NULL);
+  BLI_args_add(ba,
+               NULL,
+               "--enable-sizeclass-allocator",
+               CB(arg_handle_sizeclass_allocator_enable),
+               NULL);
 
   /* Pass: Custom Window Stuff. */
   BLI_args_pass_set(ba, ARG_PASS_SETTINGS_GUI);